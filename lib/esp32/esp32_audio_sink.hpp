@@ -1,9 +1,12 @@
 #pragma once
 
 #include <driver/i2s.h>
+#include <atomic>
 #include <vector>
 #include <stdexcept>
 #include <log.hpp>
+#include <sample_format.hpp>
+#include <latency_profile.hpp>
 
 namespace esp32 {
 
@@ -27,9 +30,15 @@ namespace esp32 {
  *  - DEMP -> GND (De-emphasis off)
  *  - XSMT -> AVDD (3v3, soft mute off)
  *  - FMT -> GND (I2S format)
+ *
+ * The DMA ring (DMA_BUFFER_COUNT buffers of bufferFrames) is fixed when the
+ * driver is installed, so latency profiles only change how much each write()
+ * renders: bufferFrames for LowLatency, the whole ring for Efficiency.
  */
 class I2sAudioSink {
 public:
+    static constexpr unsigned int DMA_BUFFER_COUNT = 4;
+
     I2sAudioSink(unsigned int sampleRate = 44100,
                  unsigned int channels = 2,
                  unsigned int bufferFrames = 128,
@@ -49,7 +58,7 @@ public:
             .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,
             .communication_format = I2S_COMM_FORMAT_STAND_I2S,
             .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-            .dma_buf_count = 4,
+            .dma_buf_count = DMA_BUFFER_COUNT,
             .dma_buf_len = static_cast<int>(bufferFrames_),
             .use_apll = true,  // Use APLL for better clock accuracy
             .tx_desc_auto_clear = true,
@@ -96,11 +105,11 @@ public:
             sampleRate_ = actualSampleRate;
         }
         
-        // Allocate buffer (float samples)
-        buffer_.resize(bufferFrames_ * channels_);
+        // Allocate buffer (float samples), large enough for the Efficiency period
+        buffer_.resize(bufferFrames_ * DMA_BUFFER_COUNT * channels_);
         
         // Allocate I2S buffer (32-bit integers)
-        i2sBuffer_.resize(bufferFrames_ * channels_);
+        i2sBuffer_.resize(bufferFrames_ * DMA_BUFFER_COUNT * channels_);
         
         logInfo("I2S audio initialized: %lu Hz actual, %d channels, %d frames/buffer",
                 actualSampleRate, channels_, bufferFrames_);
@@ -114,35 +123,34 @@ public:
     I2sAudioSink(const I2sAudioSink&) = delete;
     I2sAudioSink& operator=(const I2sAudioSink&) = delete;
     
+    /**
+     * @brief Select the frames rendered per write(); takes effect at the next write
+     */
+    void setLatencyProfile(features::LatencyProfile profile) {
+        periodFrames_.store(profile == features::LatencyProfile::Efficiency
+                                ? bufferFrames_ * DMA_BUFFER_COUNT : bufferFrames_,
+                            std::memory_order_relaxed);
+    }
+
     /**
      * @brief Fill buffer and write to I2S device
      * @param fillCallback Function that generates samples: callback(buffer, numFrames)
      */
     template<typename Callback>
     void write(Callback fillCallback) {
+        unsigned int frames = periodFrames_.load(std::memory_order_relaxed);
+
         // Fill buffer with audio data (float format)
-        fillCallback(buffer_.data(), bufferFrames_);
+        fillCallback(buffer_.data(), frames);
         
-        // Convert float to 32-bit integer for I2S
-        // PCM5102 expects 32-bit data, MSB first
-        // Use 24-bit range to avoid overflow and provide headroom
-        const float scale = 8388608.0f;  // 2^23 for 24-bit range
-        
-        for (size_t i = 0; i < bufferFrames_ * channels_; ++i) {
-            // Clamp and convert float [-1.0, 1.0] to int32
-            float sample = buffer_[i];
-            if (sample > 1.0f) sample = 1.0f;
-            if (sample < -1.0f) sample = -1.0f;
-            
-            // Convert to 24-bit signed integer, then shift left 8 bits
-            // This left-justifies the 24-bit data in the 32-bit word
-            int32_t sample24 = static_cast<int32_t>(sample * scale);
-            i2sBuffer_[i] = sample24 << 8;
-        }
+        // Convert to 24-bit samples left-justified in 32-bit words, MSB
+        // first, as the PCM5102 expects; clipped at full scale
+        platform::convertInterleaved<platform::S24In32Format>(
+            buffer_.data(), i2sBuffer_.data(), frames * channels_);
         
         // Write to I2S
         size_t bytesWritten = 0;
-        size_t bytesToWrite = bufferFrames_ * channels_ * sizeof(int32_t);
+        size_t bytesToWrite = frames * channels_ * sizeof(int32_t);
         esp_err_t err = i2s_write(i2sPort_, i2sBuffer_.data(), 
                                   bytesToWrite,
                                   &bytesWritten, portMAX_DELAY);
@@ -176,12 +184,14 @@ public:
     unsigned int getSampleRate() const { return sampleRate_; }
     unsigned int getChannels() const { return channels_; }
     unsigned int getBufferFrames() const { return bufferFrames_; }
+    unsigned int getPeriodFrames() const { return periodFrames_.load(std::memory_order_relaxed); }
     
 private:
     unsigned int sampleRate_;
     unsigned int channels_;
     unsigned int bufferFrames_;
     i2s_port_t i2sPort_;
+    std::atomic<unsigned int> periodFrames_{bufferFrames_};
     
     std::vector<float> buffer_;      // Float buffer for synthesis
     std::vector<int32_t> i2sBuffer_; // I2S output buffer
@@ -1,12 +1,14 @@
 #pragma once
 
 #include <key_scanner.hpp>
+#include <scan_frame_buffer.hpp>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <driver/gpio.h>
 #include <esp_timer.h>
 #include <log.hpp>
 #include <array>
+#include <atomic>
 
 namespace esp32 {
 
@@ -16,6 +18,9 @@ namespace esp32 {
  * Uses regular GPIOs with external pull-up resistors (800kΩ recommended).
  * Measures RC discharge time to detect capacitance changes from finger touches.
  * Runs as FreeRTOS task at 100Hz with 5-sample moving average per key.
+ * Completed scans are published through a triple buffer, so consumers on other
+ * tasks see whole frames (pollFrame()/waitForFrame()) instead of a buffer the
+ * scan task is still writing.
  * 
  * Template parameter allows compile-time optimization while maintaining modular reusability.
  * 
@@ -73,16 +78,48 @@ public:
         logInfo("ESP32 capacitive scanner stopped");
     }
     
+    /**
+     * @brief Readings of the newest published frame
+     * @note Acts as the consumer side of the frame buffer; don't mix with
+     *       pollFrame() from a different task
+     */
     const uint16_t* getScanReadings() const override {
-        return currentReadings_;
+        midi::ScanFrame frame;
+        frames_.acquire(0, frame);
+        return frames_.currentReadings();
+    }
+
+    bool pollFrame(uint32_t sinceSequence, midi::ScanFrame& frame) override {
+        return frames_.acquire(sinceSequence, frame);
+    }
+
+    /**
+     * @brief Sleep on a task notification until the scan task publishes
+     */
+    bool waitForFrame(uint32_t sinceSequence, midi::ScanFrame& frame, uint32_t timeoutUs) override {
+        const int64_t deadline = esp_timer_get_time() + timeoutUs;
+        waitingTask_.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+        bool found = frames_.acquire(sinceSequence, frame);
+        while (!found) {
+            int64_t remaining = deadline - esp_timer_get_time();
+            if (remaining <= 0) {
+                break;
+            }
+            TickType_t ticks = pdMS_TO_TICKS((remaining + 999) / 1000);
+            ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1);
+            found = frames_.acquire(sinceSequence, frame);
+        }
+        waitingTask_.store(nullptr, std::memory_order_release);
+        return found;
     }
     
-    uint8_t getKeyCount() const override {
-        return static_cast<uint8_t>(NumKeys);
+    uint16_t getKeyCount() const override {
+        return static_cast<uint16_t>(NumKeys);
     }
     
 private:
-    uint16_t currentReadings_[NumKeys] = {};
+    mutable midi::ScanFrameBuffer<NumKeys> frames_;  // Mutable: consumer side advances in const getter
+    std::atomic<TaskHandle_t> waitingTask_{nullptr};
     uint16_t movingAvgBuffer_[NumKeys][MOVING_AVG_SAMPLES] = {};
     uint8_t movingAvgIndex_[NumKeys] = {};
     TaskHandle_t taskHandle_ = nullptr;
@@ -131,6 +168,7 @@ private:
      * @brief Scan all keys and update moving averages
      */
     void scanAllKeys() {
+        uint16_t* readings = frames_.writeBuffer();
         for (uint8_t i = 0; i < NumKeys; i++) {
             // Measure raw value
             uint16_t rawValue = measureKey(i);
@@ -150,7 +188,13 @@ private:
             for (uint8_t j = 0; j < MOVING_AVG_SAMPLES; j++) {
                 sum += movingAvgBuffer_[i][j];
             }
-            currentReadings_[i] = static_cast<uint16_t>(sum);
+            readings[i] = static_cast<uint16_t>(sum);
+        }
+
+        frames_.publish(esp_timer_get_time());
+        TaskHandle_t waiter = waitingTask_.load(std::memory_order_acquire);
+        if (waiter != nullptr) {
+            xTaskNotifyGive(waiter);
         }
     }
     
@@ -1,12 +1,13 @@
 #pragma once
 
 #include <telemetry_sink.hpp>
+#include <telemetry_frame.hpp>
 #include <midi_keyboard_controller.hpp>
 #include <log.hpp>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
 #include <freertos/task.h>
-#include <json.hpp>
+#include <json_writer.hpp>
 #include <cstdio>
 
 namespace esp32 {
@@ -15,11 +16,13 @@ namespace esp32 {
  * @brief ESP32 telemetry sink using FreeRTOS queue and background task
  * 
  * Generic template-based implementation that works with any telemetry data type.
- * Requires the data type to have a to_json() function defined for serialization.
- * Outputs telemetry data as JSON Lines to console.
+ * Requires the data type to have a to_json(features::JsonWriter&, ...) function defined for serialization.
+ * Outputs telemetry data to the console as JSON Lines or as binary frames
+ * (see features::TelemetryFrameWriter).
  * Properly cleans up resources in destructor.
  * 
- * @tparam TelemetryDataT Type of telemetry data (must have to_json function)
+ * @tparam TelemetryDataT Type of telemetry data (must have to_json, and
+ *         to_binary for the binary format)
  */
 template<typename TelemetryDataT>
 class Esp32TelemetrySink : public features::TelemetrySink<TelemetryDataT> {
@@ -30,9 +33,12 @@ public:
      * Creates queue and spawns background task for JSON serialization.
      * @param taskName Name of the telemetry task (for debugging)
      * @param priority FreeRTOS task priority
+     * @param format Wire format (binary is ~4x smaller and much cheaper to produce)
      */
-    Esp32TelemetrySink(const std::string taskName = "telemetry", UBaseType_t priority = 0)
-        : queue_(nullptr)
+    Esp32TelemetrySink(const std::string taskName = "telemetry", UBaseType_t priority = 0,
+                       features::TelemetryFormat format = features::TelemetryFormat::Json)
+        : format_(format)
+        , queue_(nullptr)
         , taskHandle_(nullptr)
         , shouldStop_(false)
     {
@@ -47,7 +53,7 @@ public:
         BaseType_t taskCreated = xTaskCreatePinnedToCore(
             telemetryTaskWrapper,
             taskName.c_str(),
-            8192,  // 8KB stack (JSON serialization uses stack allocation)
+            8192,  // 8KB stack (holds a copy of the telemetry struct)
             this,  // Pass 'this' pointer as parameter
             priority,
             &taskHandle_,
@@ -107,6 +113,7 @@ public:
     }
     
 private:
+    features::TelemetryFormat format_;
     QueueHandle_t queue_;
     TaskHandle_t taskHandle_;
     volatile bool shouldStop_;
@@ -119,8 +126,12 @@ private:
         sink->telemetryTask();
     }
     
+    static void writeStdout(const uint8_t* data, size_t length, void* /*context*/) {
+        fwrite(data, 1, length, stdout);
+    }
+
     /**
-     * @brief Background task that reads queue and outputs JSON Lines
+     * @brief Background task that reads queue and outputs JSON Lines or binary frames
      */
     void telemetryTask() {
         TelemetryDataT telemetry;
@@ -132,11 +143,14 @@ private:
                     break;
                 }
                 
-                // Serialize to JSON using automatic conversion via to_json()
-                nlohmann::json j = telemetry;
-                
-                // Output as JSON Lines (one object per line, starts with '{')
-                printf("%s\n", j.dump().c_str());
+                if (format_ == features::TelemetryFormat::Binary) {
+                    features::writeTelemetryFrame(telemetry, writeStdout, nullptr);
+                    fflush(stdout);
+                    continue;
+                }
+
+                // Stream JSON Lines (one object per line, starts with '{') via to_json()
+                features::writeJsonLine(telemetry, features::writeJsonToFile, stdout);
             }
         }
     }
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <audio_tap.hpp>
+#include <json_writer.hpp>
+#include <telemetry_frame.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace features {
+
+static constexpr size_t AUDIO_METER_BANDS = 32;
+constexpr float ANALYZER_PI = 3.14159265358979323846f;
+
+/**
+ * @brief Level meter and coarse spectrum for one audio tap
+ *
+ * peak and rms cover every sample consumed since the previous report; the
+ * spectrum covers the most recent FFT window. All levels are in dBFS
+ * (floored at AudioAnalyzer::FLOOR_DB).
+ */
+struct AudioMeterStats {
+    int16_t voice = -1;              // Tapped voice index, or -1 for the output
+    uint16_t decimation = 1;
+    float sampleRate = 0.0f;         // Tap sample rate (after decimation)
+    float peakDb = 0.0f;
+    float rmsDb = 0.0f;
+    uint32_t droppedBlocks = 0;
+    float bandsDb[AUDIO_METER_BANDS] = {};   // Linear bands from 0 Hz to sampleRate / 2
+};
+
+/**
+ * @brief JSON serialization for AudioMeterStats (keys in sorted order)
+ */
+inline void to_json(JsonWriter& w, const AudioMeterStats& s) {
+    w.beginObject();
+    w.arrayField("bands", s.bandsDb, AUDIO_METER_BANDS);
+    w.field("decimation", s.decimation);
+    w.field("droppedBlocks", s.droppedBlocks);
+    w.field("peak", s.peakDb);
+    w.field("rms", s.rmsDb);
+    w.field("sampleRate", s.sampleRate);
+    w.field("source", s.voice < 0 ? "output" : "voice");
+    w.field("type", "audioMeter");
+    w.field("voice", s.voice);
+    w.endObject();
+}
+
+/**
+ * @brief Binary serialization: voice(i16 as u16) decimation(u16) sampleRate(f32)
+ *        peak(f32) rms(f32) droppedBlocks(u32) bandCount(u8) bands(f32 x bandCount)
+ */
+inline void to_binary(TelemetryFrameWriter& w, const AudioMeterStats& s) {
+    w.begin(TelemetryType::AudioMeter);
+    w.putU16(static_cast<uint16_t>(s.voice));
+    w.putU16(s.decimation);
+    w.putF32(s.sampleRate);
+    w.putF32(s.peakDb);
+    w.putF32(s.rmsDb);
+    w.putU32(s.droppedBlocks);
+    w.putU8(static_cast<uint8_t>(AUDIO_METER_BANDS));
+    for (size_t i = 0; i < AUDIO_METER_BANDS; i++) {
+        w.putF32(s.bandsDb[i]);
+    }
+}
+
+/**
+ * @brief Consumer side of an AudioTap: meters plus a Hann-windowed FFT
+ *
+ * Call poll() periodically from a non-real-time thread. It drains the tap,
+ * folds every sample into the peak/RMS accumulators and keeps the newest
+ * FftSize samples. Once a full window has arrived it fills a report and
+ * returns true, at most once per call, so the report rate follows the poll
+ * rate rather than the audio rate.
+ *
+ * @tparam FftSize Window length (power of two, >= 2 * AUDIO_METER_BANDS)
+ */
+template<size_t FftSize = 256>
+class AudioAnalyzer {
+    static_assert((FftSize & (FftSize - 1)) == 0, "FftSize must be a power of two");
+    static_assert(FftSize >= 2 * AUDIO_METER_BANDS, "FftSize too small for the band count");
+
+public:
+    static constexpr float FLOOR_DB = -120.0f;
+
+    AudioAnalyzer() {
+        for (size_t i = 0; i < FftSize; i++) {
+            window_[i] = 0.5f - 0.5f * std::cos(2.0f * ANALYZER_PI * i / FftSize);
+            windowSum_ += window_[i];
+        }
+        for (size_t i = 0; i < FftSize / 2; i++) {
+            float angle = -2.0f * ANALYZER_PI * i / FftSize;
+            twiddleRe_[i] = std::cos(angle);
+            twiddleIm_[i] = std::sin(angle);
+        }
+    }
+
+    /**
+     * @brief Drain the tap and produce a report if a full window is ready
+     * @param tap Tap to read (this analyzer must be its only consumer)
+     * @param sampleRate Rate the tap was fed at, before decimation
+     * @param voice Voice index for the report (-1 = output)
+     * @param out Filled when returning true
+     */
+    template<size_t TapCapacity>
+    bool poll(AudioTap<TapCapacity>& tap, float sampleRate, int16_t voice, AudioMeterStats& out) {
+        float chunk[64];
+        size_t n;
+        while ((n = tap.read(chunk, 64)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                const float x = chunk[i];
+                const float magnitude = std::fabs(x);
+                if (magnitude > peak_) {
+                    peak_ = magnitude;
+                }
+                sumSquares_ += static_cast<double>(x) * x;
+                history_[historyPos_] = x;
+                historyPos_ = (historyPos_ + 1) & (FftSize - 1);
+            }
+            sampleCount_ += n;
+            filled_ += n;
+        }
+
+        if (filled_ < FftSize || sampleCount_ == 0) {
+            return false;
+        }
+
+        out.voice = voice;
+        out.decimation = tap.getDecimation();
+        out.sampleRate = sampleRate / out.decimation;
+        out.peakDb = toDb(peak_);
+        out.rmsDb = toDb(static_cast<float>(std::sqrt(sumSquares_ / sampleCount_)));
+        out.droppedBlocks = tap.getDroppedBlocks();
+        computeBands(out.bandsDb);
+
+        peak_ = 0.0f;
+        sumSquares_ = 0.0;
+        sampleCount_ = 0;
+        return true;
+    }
+
+private:
+    float window_[FftSize];
+    float windowSum_ = 0.0f;
+    float twiddleRe_[FftSize / 2];
+    float twiddleIm_[FftSize / 2];
+    float history_[FftSize] = {};
+    size_t historyPos_ = 0;       // Oldest sample in history_
+    size_t filled_ = 0;           // Samples seen; the window is full once >= FftSize
+    float re_[FftSize];
+    float im_[FftSize];
+
+    float peak_ = 0.0f;
+    double sumSquares_ = 0.0;
+    size_t sampleCount_ = 0;
+
+    static float toDb(float amplitude) {
+        if (amplitude <= 0.0f) {
+            return FLOOR_DB;
+        }
+        float db = 20.0f * std::log10(amplitude);
+        return db < FLOOR_DB ? FLOOR_DB : db;
+    }
+
+    /**
+     * @brief Window the history, FFT it and reduce to AUDIO_METER_BANDS peak bands
+     */
+    void computeBands(float* bandsDb) {
+        // Window in chronological order, storing bit-reversed for the in-place FFT
+        size_t bits = 0;
+        while ((static_cast<size_t>(1) << bits) < FftSize) {
+            bits++;
+        }
+        for (size_t i = 0; i < FftSize; i++) {
+            size_t reversed = 0;
+            for (size_t b = 0; b < bits; b++) {
+                reversed |= ((i >> b) & 1) << (bits - 1 - b);
+            }
+            re_[reversed] = history_[(historyPos_ + i) & (FftSize - 1)] * window_[i];
+            im_[reversed] = 0.0f;
+        }
+
+        // Iterative radix-2 decimation-in-time
+        for (size_t size = 2; size <= FftSize; size <<= 1) {
+            const size_t half = size / 2;
+            const size_t step = FftSize / size;
+            for (size_t start = 0; start < FftSize; start += size) {
+                for (size_t k = 0; k < half; k++) {
+                    const float wr = twiddleRe_[k * step];
+                    const float wi = twiddleIm_[k * step];
+                    const size_t a = start + k;
+                    const size_t b = a + half;
+                    const float tr = re_[b] * wr - im_[b] * wi;
+                    const float ti = re_[b] * wi + im_[b] * wr;
+                    re_[b] = re_[a] - tr;
+                    im_[b] = im_[a] - ti;
+                    re_[a] += tr;
+                    im_[a] += ti;
+                }
+            }
+        }
+
+        // Peak magnitude per band, scaled so a full-scale sine reads 0 dBFS
+        const size_t binsPerBand = (FftSize / 2) / AUDIO_METER_BANDS;
+        const float scale = 2.0f / windowSum_;
+        for (size_t band = 0; band < AUDIO_METER_BANDS; band++) {
+            float peak = 0.0f;
+            for (size_t k = band * binsPerBand; k < (band + 1) * binsPerBand; k++) {
+                const float magnitude = std::sqrt(re_[k] * re_[k] + im_[k] * im_[k]) * scale;
+                if (magnitude > peak) {
+                    peak = magnitude;
+                }
+            }
+            bandsDb[band] = toDb(peak);
+        }
+    }
+};
+
+} // namespace features
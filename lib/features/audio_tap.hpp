@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace features {
+
+/**
+ * @brief Lock-free single-producer, single-consumer tap on an audio stream
+ *
+ * The audio thread calls write() with each rendered block; a consumer thread
+ * (or the other core) calls read() to pull samples out for metering and
+ * analysis. The ring is a fixed member array, so a tap allocates nothing.
+ *
+ * Cost on the audio thread:
+ *   - not subscribed: one relaxed atomic load
+ *   - decimation 1: at most two memcpy()s
+ *   - decimation N: a strided copy of numFrames / N samples
+ *
+ * Decimation keeps every Nth sample with no anti-alias filter, so content
+ * above the decimated Nyquist folds down. That is fine for level meters and
+ * a coarse spectrum view, which is what the tap is for.
+ *
+ * If the consumer falls behind, whole blocks are dropped and counted, so the
+ * samples that do arrive are always contiguous within a block.
+ *
+ * @tparam Capacity Ring size in samples (power of two)
+ */
+template<size_t Capacity = 2048>
+class AudioTap {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    AudioTap() = default;
+
+    AudioTap(const AudioTap&) = delete;
+    AudioTap& operator=(const AudioTap&) = delete;
+
+    //--------------------------------------------------------------------------
+    // Control (any thread)
+    //--------------------------------------------------------------------------
+
+    /**
+     * @brief Start copying blocks, keeping every decimation-th sample
+     */
+    void subscribe(uint16_t decimation = 1) {
+        decimation_.store(decimation > 0 ? decimation : 1, std::memory_order_relaxed);
+        subscribed_.store(true, std::memory_order_release);
+    }
+
+    void unsubscribe() {
+        subscribed_.store(false, std::memory_order_release);
+    }
+
+    bool isSubscribed() const { return subscribed_.load(std::memory_order_acquire); }
+    uint16_t getDecimation() const { return decimation_.load(std::memory_order_relaxed); }
+    uint32_t getDroppedBlocks() const { return droppedBlocks_.load(std::memory_order_relaxed); }
+
+    //--------------------------------------------------------------------------
+    // Producer (audio thread)
+    //--------------------------------------------------------------------------
+
+    /**
+     * @brief Copy a block into the ring (no-op unless subscribed)
+     */
+    void write(const float* samples, size_t numFrames) {
+        if (!subscribed_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        const size_t decimation = decimation_.load(std::memory_order_relaxed);
+
+        // Samples this block contributes, continuing the decimation phase
+        if (phase_ >= numFrames) {
+            phase_ -= numFrames;
+            return;
+        }
+        const size_t count = (numFrames - phase_ + decimation - 1) / decimation;
+
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        if (Capacity - (tail - head) < count) {
+            droppedBlocks_.fetch_add(1, std::memory_order_relaxed);
+            phase_ = phase_ + count * decimation - numFrames;
+            return;
+        }
+
+        const size_t start = tail & (Capacity - 1);
+        if (decimation == 1) {
+            const size_t first = (count < Capacity - start) ? count : Capacity - start;
+            std::memcpy(&ring_[start], samples, first * sizeof(float));
+            std::memcpy(&ring_[0], samples + first, (count - first) * sizeof(float));
+        } else {
+            size_t index = start;
+            for (size_t i = phase_; i < numFrames; i += decimation) {
+                ring_[index] = samples[i];
+                index = (index + 1) & (Capacity - 1);
+            }
+        }
+        phase_ = phase_ + count * decimation - numFrames;
+        tail_.store(tail + count, std::memory_order_release);
+    }
+
+    //--------------------------------------------------------------------------
+    // Consumer
+    //--------------------------------------------------------------------------
+
+    /**
+     * @brief Samples ready to read
+     */
+    size_t available() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Move up to maxSamples samples out of the ring
+     * @return Samples read
+     */
+    size_t read(float* out, size_t maxSamples) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        size_t count = tail - head;
+        if (count > maxSamples) {
+            count = maxSamples;
+        }
+        const size_t start = head & (Capacity - 1);
+        const size_t first = (count < Capacity - start) ? count : Capacity - start;
+        std::memcpy(out, &ring_[start], first * sizeof(float));
+        std::memcpy(out + first, &ring_[0], (count - first) * sizeof(float));
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    float ring_[Capacity] = {};
+
+    // Free-running sample counters; the ring index is counter & (Capacity - 1)
+    alignas(64) std::atomic<size_t> head_{0};   // Consumer position
+    alignas(64) std::atomic<size_t> tail_{0};   // Producer position
+    size_t phase_ = 0;                          // Producer: frames to skip before the next kept sample
+
+    std::atomic<bool> subscribed_{false};
+    std::atomic<uint16_t> decimation_{1};
+    std::atomic<uint32_t> droppedBlocks_{0};
+};
+
+} // namespace features
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace features {
+
+/**
+ * @brief Vector with its capacity fixed at compile time, stored inline
+ *
+ * Elements are constructed in place in a member array, so the container
+ * never touches the heap and its size is part of sizeof() of whatever holds
+ * it. The interface is the subset of std::vector the firmware uses; code
+ * templated on the container works with either. emplace_back() on a full
+ * vector constructs nothing and returns false.
+ *
+ * @tparam T Element type (need not be default-constructible or copyable)
+ * @tparam N Capacity in elements
+ */
+template<typename T, size_t N>
+class FixedVector {
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    FixedVector() = default;
+
+    FixedVector(FixedVector&& other) {
+        for (T& element : other) {
+            emplace_back(std::move(element));
+        }
+        other.clear();
+    }
+
+    FixedVector& operator=(FixedVector&& other) {
+        if (this != &other) {
+            clear();
+            for (T& element : other) {
+                emplace_back(std::move(element));
+            }
+            other.clear();
+        }
+        return *this;
+    }
+
+    FixedVector(const FixedVector&) = delete;
+    FixedVector& operator=(const FixedVector&) = delete;
+
+    ~FixedVector() { clear(); }
+
+    /**
+     * @brief Construct an element at the end
+     * @return false if the vector is full
+     */
+    template<typename... Args>
+    bool emplace_back(Args&&... args) {
+        if (size_ == N) {
+            return false;
+        }
+        new (&storage_[size_ * sizeof(T)]) T(std::forward<Args>(args)...);
+        size_++;
+        return true;
+    }
+
+    bool push_back(const T& value) { return emplace_back(value); }
+    bool push_back(T&& value) { return emplace_back(std::move(value)); }
+
+    void clear() {
+        while (size_ > 0) {
+            data()[--size_].~T();
+        }
+    }
+
+    /** @brief No-op, for code shared with std::vector */
+    void reserve(size_t) {}
+
+    T* data() { return reinterpret_cast<T*>(storage_); }
+    const T* data() const { return reinterpret_cast<const T*>(storage_); }
+
+    T& operator[](size_t index) { return data()[index]; }
+    const T& operator[](size_t index) const { return data()[index]; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + size_; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size_; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool full() const { return size_ == N; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    alignas(T) unsigned char storage_[N * sizeof(T)];
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Aligned, uninitialised room for one T, constructed on demand
+ *
+ * For objects that need the heap-free, fixed-address placement of a global
+ * but must not be constructed before main() (hardware has to be set up
+ * first). Never destroyed: meant for objects that live until power-off.
+ *
+ * Usage:
+ * @code
+ * static features::StaticStorage<AudioSink> audioSinkStorage;
+ * AudioSink* audioSink = audioSinkStorage.emplace(SAMPLE_RATE, I2S_FIRST_PIN);
+ * @endcode
+ */
+template<typename T>
+class StaticStorage {
+public:
+    template<typename... Args>
+    T* emplace(Args&&... args) {
+        return new (storage_) T(std::forward<Args>(args)...);
+    }
+
+    static constexpr size_t size() { return sizeof(T); }
+
+private:
+    alignas(T) unsigned char storage_[sizeof(T)];
+};
+
+} // namespace features
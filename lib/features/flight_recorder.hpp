@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+namespace features {
+
+/**
+ * @brief Event kinds captured by a flight recorder
+ *
+ * Each event carries two small arguments (a, b) and a 32-bit value; their
+ * meaning depends on the kind. Values are part of the recorded file format:
+ * append new kinds, never renumber.
+ */
+enum class FlightEvent : uint8_t {
+    MidiIn = 1,          // a = MIDI byte
+    VoiceAllocate = 2,   // a = note, b = voice index
+    VoiceSteal = 3,      // a = new note, b = voice index, value = stolen note
+    VoiceRelease = 4,    // a = note, b = voice index
+    ProgramChange = 5,   // a = program
+    BlockRender = 6,     // b = frames, value = render time in ns
+    Xrun = 7             // value = total xruns so far
+};
+
+/**
+ * @brief Records compact timestamped events for post-mortem analysis
+ *
+ * Implementations must be wait-free and cheap enough to call from the audio
+ * thread on every event, and safe to call from several threads at once.
+ * Components take a FlightRecorder* that may be null (recording disabled).
+ */
+class FlightRecorder {
+public:
+    virtual ~FlightRecorder() = default;
+
+    /**
+     * @brief Record one event, timestamped by the implementation
+     */
+    virtual void record(FlightEvent event, uint8_t a = 0, uint16_t b = 0, uint32_t value = 0) = 0;
+};
+
+} // namespace features
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace features {
+
+template<typename Signature, size_t Capacity = 2 * sizeof(void*)>
+class InlineFunction;
+
+/**
+ * @brief std::function replacement that stores its callable inline
+ *
+ * The callable (a lambda and its captures) is kept in a fixed buffer of
+ * Capacity bytes inside the object; a callable that does not fit is a
+ * compile error rather than a heap allocation. The default capacity holds
+ * two pointers, enough for the [this] and [&a, &b] captures the firmware's
+ * callbacks use.
+ *
+ * @tparam Capacity Bytes available for the callable's captures
+ */
+template<typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity> {
+public:
+    InlineFunction() = default;
+    InlineFunction(std::nullptr_t) {}
+
+    template<typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, InlineFunction>::value &&
+                                                     !std::is_same<std::decay_t<F>, std::nullptr_t>::value>>
+    InlineFunction(F&& callable) {
+        using Callable = std::decay_t<F>;
+        static_assert(sizeof(Callable) <= Capacity, "Callable captures too much for this InlineFunction");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t), "Callable is over-aligned");
+        new (storage_) Callable(std::forward<F>(callable));
+        invoke_ = [](void* target, Args... args) -> R {
+            return (*static_cast<Callable*>(target))(std::forward<Args>(args)...);
+        };
+        manage_ = [](void* destination, const void* source) {
+            if (source) {
+                new (destination) Callable(*static_cast<const Callable*>(source));
+            } else {
+                static_cast<Callable*>(destination)->~Callable();
+            }
+        };
+    }
+
+    InlineFunction(const InlineFunction& other) { copyFrom(other); }
+
+    InlineFunction& operator=(const InlineFunction& other) {
+        if (this != &other) {
+            reset();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    ~InlineFunction() { reset(); }
+
+    R operator()(Args... args) const {
+        return invoke_(storage_, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const { return invoke_ != nullptr; }
+
+private:
+    using Invoke = R (*)(void*, Args...);
+    using Manage = void (*)(void* destination, const void* source);  // source nullptr = destroy
+
+    alignas(std::max_align_t) mutable unsigned char storage_[Capacity];
+    Invoke invoke_ = nullptr;
+    Manage manage_ = nullptr;
+
+    void copyFrom(const InlineFunction& other) {
+        if (other.invoke_) {
+            other.manage_(storage_, other.storage_);
+            invoke_ = other.invoke_;
+            manage_ = other.manage_;
+        }
+    }
+
+    void reset() {
+        if (invoke_) {
+            manage_(storage_, nullptr);
+            invoke_ = nullptr;
+            manage_ = nullptr;
+        }
+    }
+};
+
+template<typename Signature>
+class FunctionRef;
+
+/**
+ * @brief Non-owning reference to a callable
+ *
+ * Holds a pointer to the caller's callable plus a trampoline, the same
+ * function-pointer-and-context pair as JsonWriter::WriteFn. It never copies
+ * or allocates, so it is only valid while the referenced callable lives:
+ * use it for visitors that are passed for the duration of a call.
+ */
+template<typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+public:
+    template<typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, FunctionRef>::value>>
+    FunctionRef(F&& callable)
+        : target_(const_cast<void*>(static_cast<const void*>(&callable))) {
+        invoke_ = [](void* target, Args... args) -> R {
+            return (*static_cast<std::remove_reference_t<F>*>(target))(std::forward<Args>(args)...);
+        };
+    }
+
+    R operator()(Args... args) const {
+        return invoke_(target_, std::forward<Args>(args)...);
+    }
+
+private:
+    void* target_;
+    R (*invoke_)(void*, Args...);
+};
+
+} // namespace features
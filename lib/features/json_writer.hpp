@@ -0,0 +1,318 @@
+#pragma once
+
+#include <shortest_double.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+namespace features {
+
+/**
+ * @brief Streaming JSON writer with no heap use
+ *
+ * Formats JSON text directly into a caller-provided buffer, or into a small
+ * internal chunk that is handed to an output function whenever it fills.
+ * Commas between members and elements are inserted automatically.
+ *
+ * Output is byte-compatible with nlohmann::json::dump() for the same values:
+ * numbers use nlohmann's own shortest round-trip formatting (floats are
+ * widened to double first, as nlohmann stores them), non-finite numbers are
+ * written as null, and strings are escaped the same way. nlohmann objects are
+ * key-sorted, so serializers that must match existing output write their keys
+ * in sorted order.
+ *
+ * Nesting deeper than MAX_DEPTH is not tracked (commas may be missed), and
+ * buffer overflow truncates the output and sets overflowed().
+ */
+class JsonWriter {
+public:
+    /**
+     * @brief Output function receiving formatted text (not NUL-terminated)
+     */
+    using WriteFn = void (*)(const char* data, size_t length, void* context);
+
+    static constexpr size_t CHUNK_SIZE = 128;
+    static constexpr size_t MAX_DEPTH = 8;
+
+    /**
+     * @brief Write into a fixed buffer; result is NUL-terminated by finish()
+     * @note A zero capacity leaves the buffer untouched (everything overflows)
+     */
+    JsonWriter(char* buffer, size_t capacity)
+        : buffer_(buffer), capacity_(capacity > 0 ? capacity - 1 : 0), terminate_(capacity > 0) {}
+
+    /**
+     * @brief Stream through an internal chunk to an output function
+     */
+    JsonWriter(WriteFn write, void* context)
+        : buffer_(chunk_), capacity_(CHUNK_SIZE), write_(write), context_(context) {}
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    //--------------------------------------------------------------------------
+    // Structure
+    //--------------------------------------------------------------------------
+
+    JsonWriter& beginObject() { separate(); put('{'); push(); return *this; }
+    JsonWriter& endObject() { pop(); put('}'); return *this; }
+    JsonWriter& beginArray() { separate(); put('['); push(); return *this; }
+    JsonWriter& endArray() { pop(); put(']'); return *this; }
+
+    /**
+     * @brief Write an object key; the next value call supplies its value
+     */
+    JsonWriter& key(const char* name) {
+        separate();
+        writeString(name);
+        put(':');
+        afterKey_ = true;
+        return *this;
+    }
+
+    //--------------------------------------------------------------------------
+    // Values
+    //--------------------------------------------------------------------------
+
+    JsonWriter& value(bool v) {
+        separate();
+        v ? put("true", 4) : put("false", 5);
+        return *this;
+    }
+
+    template<typename T,
+             typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, int>::type = 0>
+    JsonWriter& value(T v) {
+        separate();
+        if (v < 0) {
+            put('-');
+            writeUnsigned(0 - static_cast<uint64_t>(static_cast<int64_t>(v)));
+        } else {
+            writeUnsigned(static_cast<uint64_t>(v));
+        }
+        return *this;
+    }
+
+    template<typename T,
+             typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value
+                                     && !std::is_same<T, bool>::value, int>::type = 0>
+    JsonWriter& value(T v) {
+        separate();
+        writeUnsigned(static_cast<uint64_t>(v));
+        return *this;
+    }
+
+    JsonWriter& value(float v) { return value(static_cast<double>(v)); }
+
+    JsonWriter& value(double v) {
+        separate();
+        if (!std::isfinite(v)) {
+            put("null", 4);
+            return *this;
+        }
+        char digits[64];
+        put(digits, formatShortestDouble(digits, sizeof(digits), v));
+        return *this;
+    }
+
+    JsonWriter& value(const char* s) {
+        separate();
+        writeString(s ? s : "");
+        return *this;
+    }
+
+    /**
+     * @brief Write a string given by pointer and length (need not be NUL-terminated)
+     */
+    JsonWriter& value(const char* s, size_t length) {
+        separate();
+        writeString(s, length);
+        return *this;
+    }
+
+    /**
+     * @brief Shorthand for key(name).value(v)
+     */
+    template<typename T>
+    JsonWriter& field(const char* name, const T& v) {
+        key(name);
+        return value(v);
+    }
+
+    /**
+     * @brief Write a key and an array of count values
+     */
+    template<typename T>
+    JsonWriter& arrayField(const char* name, const T* values, size_t count) {
+        key(name);
+        beginArray();
+        for (size_t i = 0; i < count; i++) {
+            value(values[i]);
+        }
+        return endArray();
+    }
+
+    //--------------------------------------------------------------------------
+    // Completion
+    //--------------------------------------------------------------------------
+
+    /**
+     * @brief Flush streamed output, or NUL-terminate the caller's buffer
+     * @return Characters written to the caller's buffer (0 when streaming)
+     */
+    size_t finish() {
+        if (write_) {
+            flush();
+            return 0;
+        }
+        if (terminate_) {
+            buffer_[used_] = '\0';
+        }
+        return used_;
+    }
+
+    /**
+     * @brief Write a single raw character (e.g. a trailing newline)
+     */
+    void raw(char c) { put(c); }
+
+    bool overflowed() const { return overflow_; }
+
+private:
+    char chunk_[CHUNK_SIZE];
+    char* buffer_;
+    size_t capacity_;
+    size_t used_ = 0;
+    bool terminate_ = false;   // Room was reserved for a NUL
+    WriteFn write_ = nullptr;
+    void* context_ = nullptr;
+    bool overflow_ = false;
+
+    // Whether a comma is needed before the next member/element, per level
+    bool needComma_[MAX_DEPTH] = {};
+    size_t depth_ = 0;
+    bool afterKey_ = false;
+
+    void push() {
+        depth_++;
+        if (depth_ < MAX_DEPTH) {
+            needComma_[depth_] = false;
+        }
+    }
+
+    void pop() {
+        if (depth_ > 0) {
+            depth_--;
+        }
+    }
+
+    /**
+     * @brief Emit a comma if this is not the first item at the current level
+     */
+    void separate() {
+        if (afterKey_) {
+            afterKey_ = false;
+            return;
+        }
+        if (depth_ < MAX_DEPTH) {
+            if (needComma_[depth_]) {
+                put(',');
+            }
+            needComma_[depth_] = true;
+        }
+    }
+
+    void writeUnsigned(uint64_t v) {
+        char digits[20];
+        size_t n = 0;
+        do {
+            digits[n++] = static_cast<char>('0' + v % 10);
+            v /= 10;
+        } while (v != 0);
+        while (n > 0) {
+            put(digits[--n]);
+        }
+    }
+
+    /**
+     * @brief Quote and escape a string the way nlohmann::json::dump() does
+     */
+    void writeString(const char* s) {
+        writeString(s, std::strlen(s));
+    }
+
+    void writeString(const char* s, size_t length) {
+        put('"');
+        for (size_t i = 0; i < length; i++) {
+            const unsigned char c = static_cast<unsigned char>(s[i]);
+            switch (c) {
+                case '"':  put("\\\"", 2); break;
+                case '\\': put("\\\\", 2); break;
+                case '\b': put("\\b", 2); break;
+                case '\f': put("\\f", 2); break;
+                case '\n': put("\\n", 2); break;
+                case '\r': put("\\r", 2); break;
+                case '\t': put("\\t", 2); break;
+                default:
+                    if (c <= 0x1F) {
+                        char esc[7];
+                        snprintf(esc, sizeof(esc), "\\u%04x", c);
+                        put(esc, 6);
+                    } else {
+                        put(static_cast<char>(c));
+                    }
+                    break;
+            }
+        }
+        put('"');
+    }
+
+    void put(char c) {
+        if (used_ == capacity_) {
+            if (!write_) {
+                overflow_ = true;
+                return;
+            }
+            flush();
+        }
+        buffer_[used_++] = c;
+    }
+
+    void put(const char* s, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            put(s[i]);
+        }
+    }
+
+    void flush() {
+        if (used_ > 0) {
+            write_(buffer_, used_, context_);
+            used_ = 0;
+        }
+    }
+};
+
+/**
+ * @brief Serialize any type with a to_json(JsonWriter&, const T&) overload
+ *        as one JSON line to an output function
+ */
+template<typename T>
+inline void writeJsonLine(const T& data, JsonWriter::WriteFn write, void* context) {
+    JsonWriter w(write, context);
+    to_json(w, data);
+    w.raw('\n');
+    w.finish();
+}
+
+/**
+ * @brief Output function for JsonWriter that writes to a stdio stream
+ * @param context FILE* to write to
+ */
+inline void writeJsonToFile(const char* data, size_t length, void* context) {
+    fwrite(data, 1, length, static_cast<FILE*>(context));
+}
+
+} // namespace features
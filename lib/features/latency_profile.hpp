@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+namespace features {
+
+/**
+ * @brief Audio output latency/efficiency trade-off, switchable at runtime
+ *
+ * Each audio sink maps the profiles onto its own period size and queue depth,
+ * within buffers allocated once for the largest setting, so switching never
+ * allocates:
+ *   - LowLatency: short periods, little queued audio. For playing live.
+ *   - Efficiency: long periods, more queued audio. Fewer wakeups and less
+ *     per-block overhead when the synth is in a backing role.
+ */
+enum class LatencyProfile : uint8_t {
+    LowLatency,
+    Efficiency
+};
+
+/**
+ * @brief Protocol name of a profile ("lowLatency" or "efficiency")
+ */
+inline const char* latencyProfileName(LatencyProfile profile) {
+    return profile == LatencyProfile::Efficiency ? "efficiency" : "lowLatency";
+}
+
+/**
+ * @brief Look up a profile by protocol name
+ * @return false if the name is not a profile
+ */
+inline bool parseLatencyProfile(const char* name, size_t length, LatencyProfile& profile) {
+    for (LatencyProfile candidate : {LatencyProfile::LowLatency, LatencyProfile::Efficiency}) {
+        const char* candidateName = latencyProfileName(candidate);
+        if (std::strlen(candidateName) == length && std::memcmp(candidateName, name, length) == 0) {
+            profile = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace features
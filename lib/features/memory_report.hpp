@@ -0,0 +1,62 @@
+#pragma once
+
+#include <log.hpp>
+#include <cstddef>
+#include <cstring>
+
+namespace features {
+
+/**
+ * @brief RAM used per subsystem, collected from the objects that own it
+ *
+ * Each component adds what it holds (sizeof() of its members, plus anything
+ * it allocated at setup) under a subsystem name; adding to a name that is
+ * already listed accumulates. The firmware logs the result at startup, next
+ * to the per-symbol report the build prints for the ELF.
+ */
+class MemoryReport {
+public:
+    static constexpr size_t MAX_ENTRIES = 16;
+
+    struct Entry {
+        const char* subsystem;
+        size_t bytes;
+    };
+
+    void add(const char* subsystem, size_t bytes) {
+        for (size_t i = 0; i < count_; i++) {
+            if (std::strcmp(entries_[i].subsystem, subsystem) == 0) {
+                entries_[i].bytes += bytes;
+                return;
+            }
+        }
+        if (count_ < MAX_ENTRIES) {
+            entries_[count_++] = {subsystem, bytes};
+        }
+    }
+
+    size_t total() const {
+        size_t bytes = 0;
+        for (size_t i = 0; i < count_; i++) {
+            bytes += entries_[i].bytes;
+        }
+        return bytes;
+    }
+
+    size_t size() const { return count_; }
+    const Entry& operator[](size_t index) const { return entries_[index]; }
+
+    void log() const {
+        logInfo("RAM by subsystem:");
+        for (size_t i = 0; i < count_; i++) {
+            logInfo("  %-12s %7u bytes", entries_[i].subsystem, static_cast<unsigned int>(entries_[i].bytes));
+        }
+        logInfo("  %-12s %7u bytes", "total", static_cast<unsigned int>(total()));
+    }
+
+private:
+    Entry entries_[MAX_ENTRIES] = {};
+    size_t count_ = 0;
+};
+
+} // namespace features
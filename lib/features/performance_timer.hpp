@@ -2,7 +2,9 @@
 
 #include <cstdint>
 #include <limits>
-#include <json.hpp>
+#include <type_traits>
+#include <json_writer.hpp>
+#include <telemetry_frame.hpp>
 
 namespace features {
 
@@ -44,16 +46,16 @@ struct SpanStats {
 };
 
 /**
- * @brief JSON serialization for SpanStats
+ * @brief JSON serialization for SpanStats (keys in sorted order)
  */
-inline void to_json(nlohmann::json& j, const SpanStats& s) {
-    j = nlohmann::json{
-        {"name", s.name ? s.name : ""},
-        {"min", s.min == std::numeric_limits<uint64_t>::max() ? 0 : s.min},
-        {"max", s.max},
-        {"total", s.total},
-        {"count", s.count}
-    };
+inline void to_json(JsonWriter& w, const SpanStats& s) {
+    w.beginObject();
+    w.field("count", s.count);
+    w.field("max", s.max);
+    w.field("min", s.min == std::numeric_limits<uint64_t>::max() ? 0 : s.min);
+    w.field("name", s.name ? s.name : "");
+    w.field("total", s.total);
+    w.endObject();
 }
 
 /**
@@ -75,21 +77,46 @@ struct TimingStats {
 };
 
 /**
- * @brief JSON serialization for TimingStats
+ * @brief JSON serialization for TimingStats (keys in sorted order)
  */
 template<size_t MaxSpans>
-inline void to_json(nlohmann::json& j, const TimingStats<MaxSpans>& t) {
-    nlohmann::json spansArray = nlohmann::json::array();
+inline void to_json(JsonWriter& w, const TimingStats<MaxSpans>& t) {
+    w.beginObject();
+    w.field("droppedSpans", t.droppedSpans);
+    w.field("lapCount", t.lapCount);
+    w.key("spans");
+    w.beginArray();
     for (size_t i = 0; i < t.spanCount; ++i) {
-        spansArray.push_back(t.spans[i]);
+        to_json(w, t.spans[i]);
+    }
+    w.endArray();
+    w.field("type", "timing");
+    w.field("unit", t.unit);
+    w.endObject();
+}
+
+/**
+ * @brief Binary telemetry serialization for TimingStats
+ *
+ * Fields as in to_json(): unit (string), lapCount and droppedSpans (u32),
+ * span count (u8), then per span: name (string), min, max, total (u64) and
+ * count (u32). Strings are u8-length-prefixed.
+ */
+template<size_t MaxSpans>
+inline void to_binary(TelemetryFrameWriter& w, const TimingStats<MaxSpans>& t) {
+    w.begin(TelemetryType::Timing);
+    w.putString(t.unit);
+    w.putU32(t.lapCount);
+    w.putU32(t.droppedSpans);
+    w.putU8(static_cast<uint8_t>(t.spanCount));
+    for (size_t i = 0; i < t.spanCount; ++i) {
+        const SpanStats& s = t.spans[i];
+        w.putString(s.name);
+        w.putU64(s.min == std::numeric_limits<uint64_t>::max() ? 0 : s.min);
+        w.putU64(s.max);
+        w.putU64(s.total);
+        w.putU32(s.count);
     }
-    j = nlohmann::json{
-        {"type", "timing"},
-        {"unit", t.unit},
-        {"lapCount", t.lapCount},
-        {"droppedSpans", t.droppedSpans},
-        {"spans", spansArray}
-    };
 }
 
 /**
@@ -255,4 +282,13 @@ public:
     TimingStats<MaxSpans> getStats() const { return TimingStats<MaxSpans>{}; }
 };
 
+/**
+ * @brief Timer to pass where nothing is timed
+ * 
+ * Holds no state, so creating one where it's needed (even per sample) costs
+ * nothing.
+ */
+using UntimedLapTimer = LapTimer<NoOpTimingPolicy, 1>;
+static_assert(std::is_empty<UntimedLapTimer>::value, "UntimedLapTimer must hold no state");
+
 } // namespace features
@@ -0,0 +1,21 @@
+#include "shortest_double.hpp"
+#include <json.hpp>  // nlohmann/json single-header
+
+// nlohmann::detail::to_chars (Grisu2) is not part of the library's public API.
+// It is only used here, against the vendored copy in lib/nlohmann; re-check the
+// call when that copy is updated.
+#if NLOHMANN_JSON_VERSION_MAJOR != 3 || NLOHMANN_JSON_VERSION_MINOR != 11 || NLOHMANN_JSON_VERSION_PATCH != 3
+#error "formatShortestDouble was written against nlohmann/json 3.11.3"
+#endif
+
+namespace features {
+
+size_t formatShortestDouble(char* buffer, size_t size, double value) {
+    if (size < 64) {
+        return 0;
+    }
+    char* end = nlohmann::detail::to_chars(buffer, buffer + size, value);
+    return static_cast<size_t>(end - buffer);
+}
+
+} // namespace features
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+
+namespace features {
+
+/**
+ * @brief Format a finite double as the shortest text that round-trips
+ *
+ * Produces the same digits as nlohmann::json::dump() for the value.
+ *
+ * @param buffer Destination; 64 bytes always suffice
+ * @param size Capacity of buffer in bytes
+ * @param value Finite value to format (NaN and infinity are not handled)
+ * @return Number of characters written, or 0 if buffer is smaller than 64 bytes
+ */
+size_t formatShortestDouble(char* buffer, size_t size, double value);
+
+} // namespace features
@@ -0,0 +1,380 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace features {
+
+/**
+ * @brief Wire format selected for a telemetry sink
+ */
+enum class TelemetryFormat : uint8_t {
+    Json,    // One JSON object per line (human-readable, ~1.5 KB per key scan)
+    Binary   // SLIP-framed packed fields (see TelemetryFrameWriter)
+};
+
+/**
+ * @brief Type tag carried in every binary telemetry frame
+ */
+enum class TelemetryType : uint8_t {
+    KeyScan = 1,       // midi::KeyScanStats
+    Timing = 2,        // features::TimingStats
+    KeyScanDelta = 3,  // midi::KeyScanStats delta frame (subscription mode)
+    AudioMeter = 4     // features::AudioMeterStats
+};
+
+/**
+ * @brief Binary telemetry framing constants
+ *
+ * A frame is SLIP-style byte-stuffed so it can share a serial stream with
+ * ordinary text logs:
+ *
+ *   END  version  type  fields...  crc16(LE)  END
+ *
+ * END (0xC0) never occurs in UTF-8 text, so a reader can split text lines
+ * and binary frames apart without any mode switching. Inside a frame, END,
+ * ESC and '\n' are escaped; escaping '\n' keeps frames intact through stdio
+ * layers that translate LF to CRLF (Pico SDK and ESP-IDF both do by default).
+ * All multi-byte fields are little-endian. The CRC (CRC-16/CCITT-FALSE) covers
+ * the unescaped bytes from version to the last field, so frames garbled by a
+ * log line interleaved from another core are dropped rather than misread.
+ */
+namespace telemetry_frame {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr uint8_t END = 0xC0;
+    static constexpr uint8_t ESC = 0xDB;
+    static constexpr uint8_t ESC_END = 0xDC;
+    static constexpr uint8_t ESC_ESC = 0xDD;
+    static constexpr uint8_t ESC_LF = 0xDE;
+    static constexpr size_t MAX_STRING = 255;
+
+    /**
+     * @brief Update a CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) with one byte
+     */
+    inline uint16_t crc16Update(uint16_t crc, uint8_t byte) {
+        crc ^= static_cast<uint16_t>(byte) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021)
+                                 : static_cast<uint16_t>(crc << 1);
+        }
+        return crc;
+    }
+} // namespace telemetry_frame
+
+/**
+ * @brief Streams one binary telemetry frame to an output function
+ *
+ * Fields are escaped and checksummed as they are written, into a small
+ * internal chunk that is flushed whenever it fills, so frames of any size are
+ * produced without heap allocation or a full-size staging buffer.
+ *
+ * Usage: construct, call begin() with the type tag, put the fields, finish().
+ * Types opt in by providing a to_binary(TelemetryFrameWriter&, const T&)
+ * overload next to their to_json().
+ */
+class TelemetryFrameWriter {
+public:
+    /**
+     * @brief Output function receiving encoded bytes
+     */
+    using WriteFn = void (*)(const uint8_t* data, size_t length, void* context);
+
+    static constexpr size_t CHUNK_SIZE = 64;
+
+    TelemetryFrameWriter(WriteFn write, void* context)
+        : write_(write), context_(context) {}
+
+    TelemetryFrameWriter(const TelemetryFrameWriter&) = delete;
+    TelemetryFrameWriter& operator=(const TelemetryFrameWriter&) = delete;
+
+    /**
+     * @brief Start a frame: delimiter, format version, type tag
+     */
+    void begin(TelemetryType type) {
+        crc_ = 0xFFFF;
+        emit(telemetry_frame::END);
+        putU8(telemetry_frame::VERSION);
+        putU8(static_cast<uint8_t>(type));
+    }
+
+    void putU8(uint8_t v) {
+        crc_ = telemetry_frame::crc16Update(crc_, v);
+        switch (v) {
+            case telemetry_frame::END:
+                emit(telemetry_frame::ESC);
+                emit(telemetry_frame::ESC_END);
+                break;
+            case telemetry_frame::ESC:
+                emit(telemetry_frame::ESC);
+                emit(telemetry_frame::ESC_ESC);
+                break;
+            case '\n':
+                emit(telemetry_frame::ESC);
+                emit(telemetry_frame::ESC_LF);
+                break;
+            default:
+                emit(v);
+                break;
+        }
+    }
+
+    void putBool(bool v) { putU8(v ? 1 : 0); }
+
+    void putU16(uint16_t v) {
+        putU8(static_cast<uint8_t>(v));
+        putU8(static_cast<uint8_t>(v >> 8));
+    }
+
+    void putU32(uint32_t v) {
+        putU16(static_cast<uint16_t>(v));
+        putU16(static_cast<uint16_t>(v >> 16));
+    }
+
+    void putU64(uint64_t v) {
+        putU32(static_cast<uint32_t>(v));
+        putU32(static_cast<uint32_t>(v >> 32));
+    }
+
+    void putF32(float v) {
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        putU32(bits);
+    }
+
+    /**
+     * @brief Length-prefixed (u8) string, truncated to MAX_STRING bytes
+     */
+    void putString(const char* s) {
+        size_t len = s ? std::strlen(s) : 0;
+        if (len > telemetry_frame::MAX_STRING) {
+            len = telemetry_frame::MAX_STRING;
+        }
+        putU8(static_cast<uint8_t>(len));
+        for (size_t i = 0; i < len; i++) {
+            putU8(static_cast<uint8_t>(s[i]));
+        }
+    }
+
+    /**
+     * @brief Append the checksum and closing delimiter, then flush
+     */
+    void finish() {
+        uint16_t crc = crc_;
+        putU16(crc);
+        emit(telemetry_frame::END);
+        flush();
+    }
+
+private:
+    WriteFn write_;
+    void* context_;
+    uint8_t chunk_[CHUNK_SIZE];
+    size_t used_ = 0;
+    uint16_t crc_ = 0xFFFF;
+
+    void emit(uint8_t byte) {
+        chunk_[used_++] = byte;
+        if (used_ == CHUNK_SIZE) {
+            flush();
+        }
+    }
+
+    void flush() {
+        if (used_ > 0) {
+            write_(chunk_, used_, context_);
+            used_ = 0;
+        }
+    }
+};
+
+/**
+ * @brief Serialize any type with a to_binary() overload as one complete frame
+ */
+template<typename T>
+inline void writeTelemetryFrame(const T& data, TelemetryFrameWriter::WriteFn write, void* context) {
+    TelemetryFrameWriter writer(write, context);
+    to_binary(writer, data);
+    writer.finish();
+}
+
+/**
+ * @brief Reads fields back out of a decoded frame payload
+ *
+ * Reads past the end return zero and set the overflow flag instead of
+ * touching memory, so a truncated frame can be rejected after the fact.
+ */
+class TelemetryFrameReader {
+public:
+    TelemetryFrameReader(const uint8_t* data, size_t length)
+        : data_(data), length_(length) {}
+
+    uint8_t getU8() {
+        if (pos_ >= length_) {
+            overflow_ = true;
+            return 0;
+        }
+        return data_[pos_++];
+    }
+
+    bool getBool() { return getU8() != 0; }
+
+    uint16_t getU16() {
+        uint16_t lo = getU8();
+        return static_cast<uint16_t>(lo | (getU8() << 8));
+    }
+
+    uint32_t getU32() {
+        uint32_t lo = getU16();
+        return lo | (static_cast<uint32_t>(getU16()) << 16);
+    }
+
+    uint64_t getU64() {
+        uint64_t lo = getU32();
+        return lo | (static_cast<uint64_t>(getU32()) << 32);
+    }
+
+    float getF32() {
+        uint32_t bits = getU32();
+        float v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    /**
+     * @brief Read a length-prefixed string into out (always NUL-terminated)
+     */
+    void getString(char* out, size_t capacity) {
+        size_t len = getU8();
+        for (size_t i = 0; i < len; i++) {
+            char c = static_cast<char>(getU8());
+            if (i + 1 < capacity) {
+                out[i] = c;
+            }
+        }
+        if (capacity > 0) {
+            out[len < capacity ? len : capacity - 1] = '\0';
+        }
+    }
+
+    bool overflowed() const { return overflow_; }
+    size_t remaining() const { return pos_ < length_ ? length_ - pos_ : 0; }
+
+private:
+    const uint8_t* data_;
+    size_t length_;
+    size_t pos_ = 0;
+    bool overflow_ = false;
+};
+
+/**
+ * @brief Splits a mixed byte stream into text lines and binary telemetry frames
+ *
+ * Feed received bytes one at a time. Text outside frames is collected into
+ * lines ('\r' dropped, split on '\n'); bytes between END delimiters are
+ * unescaped and CRC-checked. Over-long lines or frames are truncated or
+ * dropped, never overrun.
+ *
+ * @tparam MaxLine Longest text line kept
+ * @tparam MaxFrame Largest unescaped frame accepted
+ */
+template<size_t MaxLine = 2048, size_t MaxFrame = 4096>
+class TelemetryStreamDecoder {
+public:
+    enum class Result {
+        None,       // Need more bytes
+        TextLine,   // line() holds a complete text line
+        Frame,      // frameType()/payload() hold a valid binary frame
+        BadFrame    // A frame failed its CRC, version or size check
+    };
+
+    Result feed(uint8_t byte) {
+        if (byte == telemetry_frame::END) {
+            if (inFrame_ && frameLength_ > 0) {
+                inFrame_ = false;
+                return finishFrame();
+            }
+            // Opening delimiter (or back-to-back END): start a new frame
+            inFrame_ = true;
+            escaped_ = false;
+            frameLength_ = 0;
+            frameOverflow_ = false;
+            return Result::None;
+        }
+
+        if (inFrame_) {
+            if (escaped_) {
+                escaped_ = false;
+                switch (byte) {
+                    case telemetry_frame::ESC_END: byte = telemetry_frame::END; break;
+                    case telemetry_frame::ESC_ESC: byte = telemetry_frame::ESC; break;
+                    case telemetry_frame::ESC_LF:  byte = '\n'; break;
+                    default: frameOverflow_ = true; break;  // Invalid escape
+                }
+            } else if (byte == telemetry_frame::ESC) {
+                escaped_ = true;
+                return Result::None;
+            }
+            if (frameLength_ < MaxFrame) {
+                frame_[frameLength_++] = byte;
+            } else {
+                frameOverflow_ = true;
+            }
+            return Result::None;
+        }
+
+        if (byte == '\r') {
+            return Result::None;
+        }
+        if (byte == '\n') {
+            line_[lineLength_] = '\0';
+            lineLength_ = 0;
+            return Result::TextLine;
+        }
+        if (lineLength_ < MaxLine) {
+            line_[lineLength_++] = static_cast<char>(byte);
+        }
+        return Result::None;
+    }
+
+    /** @brief Last complete text line (valid until the next feed()) */
+    const char* line() const { return line_; }
+
+    /** @brief Type tag of the last valid frame */
+    TelemetryType frameType() const { return static_cast<TelemetryType>(frame_[1]); }
+
+    /** @brief Reader over the last valid frame's fields (after version and type) */
+    TelemetryFrameReader payload() const {
+        return TelemetryFrameReader(frame_ + 2, payloadLength_);
+    }
+
+private:
+    char line_[MaxLine + 1] = {};
+    size_t lineLength_ = 0;
+    uint8_t frame_[MaxFrame] = {};
+    size_t frameLength_ = 0;
+    size_t payloadLength_ = 0;
+    bool inFrame_ = false;
+    bool escaped_ = false;
+    bool frameOverflow_ = false;
+
+    Result finishFrame() {
+        // version + type + crc16 at minimum
+        if (frameOverflow_ || frameLength_ < 4) {
+            return Result::BadFrame;
+        }
+        uint16_t crc = 0xFFFF;
+        for (size_t i = 0; i < frameLength_ - 2; i++) {
+            crc = telemetry_frame::crc16Update(crc, frame_[i]);
+        }
+        uint16_t expected = static_cast<uint16_t>(
+            frame_[frameLength_ - 2] | (frame_[frameLength_ - 1] << 8));
+        if (crc != expected || frame_[0] != telemetry_frame::VERSION) {
+            return Result::BadFrame;
+        }
+        payloadLength_ = frameLength_ - 4;
+        return Result::Frame;
+    }
+};
+
+} // namespace features
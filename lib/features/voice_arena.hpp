@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace features {
+
+/**
+ * @brief One fixed memory region that objects of any type are carved from
+ *
+ * Objects are placed one after another (bump allocation) and only ever
+ * destroyed all together by clear(), so the region can't fragment: after a
+ * clear() the whole region is free again, whatever was in it. This is how
+ * voice pools of different synth engines share one RAM budget: rebuilding a
+ * pool with a heavier engine fits fewer voices into the same bytes.
+ *
+ * The region is either allocated once by the constructor (sized at startup)
+ * or supplied by the caller, e.g. a static array. Creating and clearing
+ * objects never touches the heap.
+ *
+ * Usage:
+ * @code
+ * features::VoiceArena arena(features::VoiceArena::bytesFor<synth::WavetableSynth>(8));
+ * auto* voice = arena.create<synth::WavetableSynth>(48000.0f);   // nullptr when full
+ * arena.clear();   // Destroys every object, newest first
+ * @endcode
+ */
+class VoiceArena {
+public:
+    /**
+     * @brief Allocate a region of the given size (once, at startup)
+     */
+    explicit VoiceArena(size_t bytes)
+        : owned_(new unsigned char[bytes])
+        , region_(owned_.get())
+        , capacity_(bytes) {}
+
+    /**
+     * @brief Use a caller-owned region, which must outlive the arena
+     */
+    VoiceArena(void* region, size_t bytes)
+        : region_(static_cast<unsigned char*>(region))
+        , capacity_(bytes) {}
+
+    VoiceArena(const VoiceArena&) = delete;
+    VoiceArena& operator=(const VoiceArena&) = delete;
+
+    ~VoiceArena() { clear(); }
+
+    /**
+     * @brief Construct a T at the end of the used part of the region
+     * @return The object, or nullptr if it doesn't fit
+     */
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(region_);
+        const uintptr_t header = alignUp(base + used_, alignof(Header));
+        const uintptr_t object = alignUp(header + sizeof(Header), alignof(T));
+        const uintptr_t end = object + sizeof(T);
+        if (end > base + capacity_) {
+            return nullptr;
+        }
+        T* created = new (reinterpret_cast<void*>(object)) T(std::forward<Args>(args)...);
+        last_ = new (reinterpret_cast<void*>(header)) Header{&destroy<T>, created, last_};
+        used_ = end - base;
+        count_++;
+        return created;
+    }
+
+    /**
+     * @brief Destroy every object, newest first, and free the whole region
+     */
+    void clear() {
+        while (last_) {
+            Header* header = last_;
+            last_ = header->previous;
+            header->destroy(header->object);
+        }
+        used_ = 0;
+        count_ = 0;
+    }
+
+    size_t capacity() const { return capacity_; }
+    size_t used() const { return used_; }
+    size_t remaining() const { return capacity_ - used_; }
+    size_t count() const { return count_; }
+
+    /**
+     * @brief Region size that holds at least count objects of type T
+     */
+    template<typename T>
+    static constexpr size_t bytesFor(size_t count) {
+        return count * (sizeof(Header) + alignof(T) - 1 + sizeof(T) + alignof(Header) - 1);
+    }
+
+private:
+    // Precedes each object, so clear() can run the right destructor
+    struct Header {
+        void (*destroy)(void* object);
+        void* object;
+        Header* previous;
+    };
+
+    std::unique_ptr<unsigned char[]> owned_;
+    unsigned char* region_;
+    size_t capacity_;
+    size_t used_ = 0;
+    size_t count_ = 0;
+    Header* last_ = nullptr;
+
+    template<typename T>
+    static void destroy(void* object) {
+        static_cast<T*>(object)->~T();
+    }
+
+    static uintptr_t alignUp(uintptr_t address, size_t alignment) {
+        return (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    }
+};
+
+} // namespace features
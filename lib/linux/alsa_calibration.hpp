@@ -0,0 +1,71 @@
+#pragma once
+
+#include <latency_calibration.hpp>
+#include <linux_audio_sink.hpp>
+#include <synth_application.hpp>
+#include <performance_timer.hpp>
+#include <log.hpp>
+#include <chrono>
+#include <cstring>
+
+namespace linux {
+
+/**
+ * @brief LatencyCalibration that soaks each candidate on an ALSA device
+ *
+ * Each soak opens an AlsaPcmOut with the candidate's period size and count
+ * and renders SOAK_MS of audio into it with the output muted, counting the
+ * xruns after the first SOAK_SETTLE_MS.
+ */
+class AlsaCalibration : public LatencyCalibration {
+public:
+    static constexpr unsigned int SOAK_MS = 1500;
+    static constexpr unsigned int SOAK_SETTLE_MS = 100;   // Xruns while starting up don't count
+
+    AlsaCalibration(const char* deviceName, unsigned int sampleRate, unsigned int channels,
+                    uint8_t maxVoices, const char* cachePath = "audio_calibration.json")
+        : LatencyCalibration(deviceName, sampleRate, channels, maxVoices,
+              [deviceName, sampleRate, channels](platform::SynthApplication& synth,
+                                                 const AlsaLatencyConfig& config, uint32_t& xruns) {
+                  return soak(deviceName, sampleRate, channels, synth, config, xruns);
+              },
+              cachePath) {}
+
+private:
+    /**
+     * @brief Play SOAK_MS of muted audio with the candidate configuration
+     * @return false if the device can't be opened with exactly this configuration
+     */
+    static bool soak(const char* deviceName, unsigned int sampleRate, unsigned int channels,
+                     platform::SynthApplication& synth, const AlsaLatencyConfig& config, uint32_t& xruns) {
+        try {
+            AlsaPcmOut out(deviceName, sampleRate, channels, config.periodFrames, PcmFormat::Float, config.periods);
+            if (out.getBufferFrames() != config.periodFrames || out.getPeriods() != config.periods) {
+                return false;
+            }
+            features::LapTimer<features::NoOpTimingPolicy, 12> timer;
+            uint32_t settledXruns = 0;
+            auto start = std::chrono::steady_clock::now();
+            auto settled = start + std::chrono::milliseconds(SOAK_SETTLE_MS);
+            auto end = start + std::chrono::milliseconds(SOAK_MS);
+            for (auto now = start; now < end; now = std::chrono::steady_clock::now()) {
+                if (now < settled) {
+                    settledXruns = out.getXrunCount();
+                }
+                out.write([&](float* buffer, unsigned int numFrames) {
+                    synth.renderAudio(buffer, numFrames, timer);
+                    timer.end();
+                    timer.reset();
+                    std::memset(buffer, 0, numFrames * channels * sizeof(float));
+                });
+            }
+            xruns = out.getXrunCount() - settledXruns;
+            return true;
+        } catch (const std::exception& e) {
+            logInfo("  %4u frames x %u periods: %s", config.periodFrames, config.periods, e.what());
+            return false;
+        }
+    }
+};
+
+} // namespace linux
@@ -0,0 +1,466 @@
+#pragma once
+
+#include <log.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace linux {
+
+/**
+ * @brief Local control server for the JSON command protocol
+ *
+ * Listens on a Unix domain socket and/or a localhost TCP port and serves any
+ * number of clients (up to MAX_CLIENTS) from one epoll loop, driven by the
+ * caller's control thread through poll(). Each client's input is assembled
+ * into lines separately, so commands from different clients never mix, and
+ * only complete lines are handed to the handler.
+ *
+ * Output goes through per-client byte queues that are flushed with
+ * non-blocking sends as the sockets accept data:
+ *   - responses written through writeResponse() while a client's line is
+ *     being handled go to that client; anything else written through it
+ *     (e.g. paramsDelta pushes) goes to every client
+ *   - publish()/publishToClients() send whole messages to every client and
+ *     may be called from any thread (e.g. a telemetry sink's writer)
+ *
+ * A client that doesn't keep up loses whole messages once its queue is full;
+ * drops are counted, and nothing ever waits for a socket.
+ *
+ * Usage:
+ * @code
+ * linux::ControlServer server("/tmp/pressence.sock", 7400);
+ * synth.setCommandOutput(linux::ControlServer::writeResponse, &server);
+ * while (running) {
+ *     server.poll(20, [&](const char* line, size_t length) {
+ *         synth.processCommandBytes(line, length);
+ *     });
+ *     synth.pushParamChanges(nowMs);
+ * }
+ * @endcode
+ */
+class ControlServer {
+public:
+    static constexpr size_t MAX_CLIENTS = 8;
+    static constexpr size_t MAX_LINE = 1024;
+    static constexpr size_t MAX_MESSAGE = 16384;
+    static constexpr size_t CLIENT_QUEUE_SIZE = 65536;
+    static constexpr int NO_TCP = -1;
+
+    /**
+     * @brief Start listening
+     * @param unixPath Unix socket path (replaced if it exists), or "" for none
+     * @param tcpPort Port on 127.0.0.1, 0 for any free port, or NO_TCP for none
+     * @throws std::runtime_error if a socket cannot be set up
+     */
+    explicit ControlServer(const std::string& unixPath, int tcpPort = NO_TCP)
+        : unixPath_(unixPath)
+        , clients_(new Client[MAX_CLIENTS])
+    {
+        epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd_ < 0) {
+            throw std::runtime_error(std::string("epoll_create1 failed: ") + strerror(errno));
+        }
+        try {
+            if (!unixPath.empty()) {
+                listenUnix(unixPath);
+            }
+            if (tcpPort != NO_TCP) {
+                listenTcp(tcpPort);
+            }
+        } catch (...) {
+            closeListeners();
+            throw;
+        }
+        if (unixFd_ < 0 && tcpFd_ < 0) {
+            closeListeners();
+            throw std::runtime_error("Control server needs a Unix socket path or a TCP port");
+        }
+    }
+
+    ~ControlServer() {
+        for (size_t i = 0; i < MAX_CLIENTS; i++) {
+            if (clients_[i].fd >= 0) {
+                ::close(clients_[i].fd);
+            }
+        }
+        closeListeners();
+    }
+
+    ControlServer(const ControlServer&) = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+    /**
+     * @brief Wait for socket activity and handle it
+     *
+     * Accepts clients, reads their input, passes each complete command line
+     * (including its newline) to handler(const char*, size_t), flushes queued
+     * output and drops clients that disconnect.
+     *
+     * @param timeoutMs Maximum wait (-1 waits indefinitely)
+     * @return Number of command lines handled
+     */
+    template<typename Handler>
+    size_t poll(int timeoutMs, Handler&& handler) {
+        epoll_event events[MAX_CLIENTS + 2];
+        int count = epoll_wait(epollFd_, events, MAX_CLIENTS + 2, timeoutMs);
+        size_t lines = 0;
+        for (int e = 0; e < count; e++) {
+            const uint64_t tag = events[e].data.u64;
+            if (tag == UNIX_LISTENER || tag == TCP_LISTENER) {
+                acceptClients(tag == UNIX_LISTENER ? unixFd_ : tcpFd_);
+                continue;
+            }
+            const size_t index = static_cast<size_t>(tag);
+            if (events[e].events & EPOLLOUT) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                flush(clients_[index]);
+            }
+            if (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
+                lines += readClient(index, handler);
+            }
+        }
+        return lines;
+    }
+
+    /**
+     * @brief Queue a complete message for every client (thread-safe)
+     */
+    void publish(const char* data, size_t length) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < MAX_CLIENTS; i++) {
+            if (clients_[i].fd >= 0) {
+                enqueue(clients_[i], data, length);
+            }
+        }
+    }
+
+    /**
+     * @brief Output function for SynthApplication::setCommandOutput
+     *
+     * Collects text up to each newline, then sends the line to the client
+     * whose command is being handled, or to every client outside a handler.
+     * Only call it from the thread that calls poll().
+     *
+     * @param context ControlServer* to write to
+     */
+    static void writeResponse(const char* data, size_t length, void* context) {
+        static_cast<ControlServer*>(context)->stageResponse(data, length);
+    }
+
+    /**
+     * @brief Output function sending whole messages to every client, e.g. for
+     *        a LinuxTelemetrySink (thread-safe)
+     * @param context ControlServer* to write to
+     */
+    static void publishToClients(const char* data, size_t length, void* context) {
+        static_cast<ControlServer*>(context)->publish(data, length);
+    }
+
+    /**
+     * @brief Messages dropped because a client's queue was full
+     */
+    uint32_t getDroppedCount() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Number of connected clients
+     */
+    size_t getClientCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t count = 0;
+        for (size_t i = 0; i < MAX_CLIENTS; i++) {
+            if (clients_[i].fd >= 0) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief TCP port actually bound (useful with port 0), or NO_TCP
+     */
+    int getTcpPort() const { return tcpPort_; }
+
+private:
+    static constexpr uint64_t UNIX_LISTENER = MAX_CLIENTS;
+    static constexpr uint64_t TCP_LISTENER = MAX_CLIENTS + 1;
+    static constexpr size_t NO_CLIENT = MAX_CLIENTS;
+
+    struct Client {
+        int fd = -1;
+        bool writable = true;               // False once a send has failed
+        bool waitingForOutput = false;      // EPOLLOUT armed
+        bool discarding = false;            // Skipping the rest of an overlong line
+        size_t lineLength = 0;
+        char line[MAX_LINE];
+        std::unique_ptr<char[]> queue{new char[CLIENT_QUEUE_SIZE]};
+        size_t queueHead = 0;
+        size_t queueUsed = 0;
+    };
+
+    std::string unixPath_;
+    int epollFd_ = -1;
+    int unixFd_ = -1;
+    int tcpFd_ = -1;
+    int tcpPort_ = NO_TCP;
+    std::unique_ptr<Client[]> clients_;
+    mutable std::mutex mutex_;                  // Guards client fds and output queues
+    std::atomic<uint32_t> dropped_{0};
+
+    // Response staging (poll() thread only)
+    size_t currentClient_ = NO_CLIENT;
+    char response_[MAX_MESSAGE];
+    size_t responseLength_ = 0;
+    bool responseOverflowed_ = false;
+
+    void listenUnix(const std::string& path) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error("Control socket path too long: " + path);
+        }
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        ::unlink(path.c_str());
+        unixFd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (unixFd_ < 0
+            || bind(unixFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+            || listen(unixFd_, static_cast<int>(MAX_CLIENTS)) < 0) {
+            throw std::runtime_error("Cannot listen on " + path + ": " + strerror(errno));
+        }
+        watch(unixFd_, UNIX_LISTENER, EPOLLIN);
+        logInfo("Control server: unix:%s", path.c_str());
+    }
+
+    void listenTcp(int port) {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);   // Local clients only
+        int reuse = 1;
+        tcpFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (tcpFd_ < 0
+            || setsockopt(tcpFd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0
+            || bind(tcpFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+            || listen(tcpFd_, static_cast<int>(MAX_CLIENTS)) < 0) {
+            throw std::runtime_error("Cannot listen on TCP port " + std::to_string(port) + ": " + strerror(errno));
+        }
+        socklen_t length = sizeof(addr);
+        getsockname(tcpFd_, reinterpret_cast<sockaddr*>(&addr), &length);
+        tcpPort_ = ntohs(addr.sin_port);
+        watch(tcpFd_, TCP_LISTENER, EPOLLIN);
+        logInfo("Control server: tcp:127.0.0.1:%d", tcpPort_);
+    }
+
+    void closeListeners() {
+        if (unixFd_ >= 0) {
+            ::close(unixFd_);
+            ::unlink(unixPath_.c_str());
+        }
+        if (tcpFd_ >= 0) {
+            ::close(tcpFd_);
+        }
+        if (epollFd_ >= 0) {
+            ::close(epollFd_);
+        }
+        unixFd_ = tcpFd_ = epollFd_ = -1;
+    }
+
+    void watch(int fd, uint64_t tag, uint32_t events) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = tag;
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void acceptClients(int listenFd) {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                return;   // EAGAIN: no more pending connections
+            }
+            if (listenFd == tcpFd_) {
+                int noDelay = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            size_t index = 0;
+            while (index < MAX_CLIENTS && clients_[index].fd >= 0) {
+                index++;
+            }
+            if (index == MAX_CLIENTS) {
+                logWarn("Control server full; rejecting client");
+                ::close(fd);
+                continue;
+            }
+            Client& client = clients_[index];
+            client.fd = fd;
+            client.writable = true;
+            client.waitingForOutput = false;
+            client.discarding = false;
+            client.lineLength = 0;
+            client.queueHead = 0;
+            client.queueUsed = 0;
+            watch(fd, index, EPOLLIN | EPOLLRDHUP);
+        }
+    }
+
+    void closeClient(size_t index) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Client& client = clients_[index];
+        if (client.fd >= 0) {
+            epoll_ctl(epollFd_, EPOLL_CTL_DEL, client.fd, nullptr);
+            ::close(client.fd);
+            client.fd = -1;
+        }
+    }
+
+    /**
+     * @brief Read everything the client sent and handle each completed line
+     */
+    template<typename Handler>
+    size_t readClient(size_t index, Handler& handler) {
+        Client& client = clients_[index];
+        size_t lines = 0;
+        char buffer[4096];
+        while (true) {
+            ssize_t n = ::read(client.fd, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && errno == EAGAIN) {
+                return lines;
+            }
+            if (n <= 0) {
+                closeClient(index);   // Disconnected (0) or failed
+                return lines;
+            }
+            for (ssize_t i = 0; i < n; i++) {
+                lines += assemble(index, buffer[i], handler);
+            }
+        }
+    }
+
+    /**
+     * @brief Add one byte to the client's line; handle the line when complete
+     * @return 1 if a line was handled
+     */
+    template<typename Handler>
+    size_t assemble(size_t index, char ch, Handler& handler) {
+        Client& client = clients_[index];
+        if (client.discarding) {
+            client.discarding = (ch != '\n');
+            return 0;
+        }
+        client.line[client.lineLength++] = ch;
+        if (ch != '\n' && client.lineLength < MAX_LINE) {
+            return 0;
+        }
+        if (ch != '\n') {
+            // Overlong: end it here so the controller rejects it as too long
+            // rather than seeing the tail as a separate command
+            client.line[MAX_LINE - 1] = '\n';
+            client.discarding = true;
+        }
+        currentClient_ = index;
+        handler(static_cast<const char*>(client.line), client.lineLength);
+        currentClient_ = NO_CLIENT;
+        client.lineLength = 0;
+        return 1;
+    }
+
+    void stageResponse(const char* data, size_t length) {
+        for (size_t i = 0; i < length; i++) {
+            if (responseLength_ < MAX_MESSAGE) {
+                response_[responseLength_++] = data[i];
+            } else {
+                responseOverflowed_ = true;
+            }
+            if (data[i] != '\n') {
+                continue;
+            }
+            if (responseOverflowed_) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+            } else if (currentClient_ != NO_CLIENT) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (clients_[currentClient_].fd >= 0) {
+                    enqueue(clients_[currentClient_], response_, responseLength_);
+                }
+            } else {
+                publish(response_, responseLength_);
+            }
+            responseLength_ = 0;
+            responseOverflowed_ = false;
+        }
+    }
+
+    /**
+     * @brief Queue a whole message for one client and send what the socket takes
+     *        (mutex_ held)
+     */
+    void enqueue(Client& client, const char* data, size_t length) {
+        if (!client.writable) {
+            return;
+        }
+        if (CLIENT_QUEUE_SIZE - client.queueUsed < length) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        size_t tail = (client.queueHead + client.queueUsed) % CLIENT_QUEUE_SIZE;
+        size_t first = std::min(length, CLIENT_QUEUE_SIZE - tail);
+        std::memcpy(client.queue.get() + tail, data, first);
+        std::memcpy(client.queue.get(), data + first, length - first);
+        client.queueUsed += length;
+        flush(client);
+    }
+
+    /**
+     * @brief Send queued output without blocking; wait for EPOLLOUT if the
+     *        socket is full (mutex_ held)
+     */
+    void flush(Client& client) {
+        while (client.writable && client.queueUsed > 0) {
+            size_t contiguous = std::min(client.queueUsed, CLIENT_QUEUE_SIZE - client.queueHead);
+            ssize_t n = send(client.fd, client.queue.get() + client.queueHead, contiguous,
+                             MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n > 0) {
+                client.queueHead = (client.queueHead + static_cast<size_t>(n)) % CLIENT_QUEUE_SIZE;
+                client.queueUsed -= static_cast<size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && errno == EAGAIN) {
+                break;
+            } else {
+                // Peer gone: stop writing; poll() closes it on the hangup
+                client.writable = false;
+                client.queueUsed = 0;
+            }
+        }
+
+        const bool wantOutput = client.writable && client.queueUsed > 0;
+        if (wantOutput != client.waitingForOutput) {
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP | (wantOutput ? EPOLLOUT : 0u);
+            ev.data.u64 = static_cast<uint64_t>(&client - clients_.get());
+            epoll_ctl(epollFd_, EPOLL_CTL_MOD, client.fd, &ev);
+            client.waitingForOutput = wantOutput;
+        }
+    }
+};
+
+} // namespace linux
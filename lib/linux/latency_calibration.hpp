@@ -0,0 +1,246 @@
+#pragma once
+
+#include <synth_application.hpp>
+#include <performance_timer.hpp>
+#include <log.hpp>
+#include <json.hpp>  // nlohmann/json single-header
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace linux {
+
+/**
+ * @brief LowLatency period size and queue depth for an AlsaPcmOut
+ */
+struct AlsaLatencyConfig {
+    unsigned int periodFrames = 0;
+    unsigned int periods = 0;
+
+    bool isValid() const { return periodFrames > 0 && periods > 0; }
+
+    /** @brief Frames queued ahead of the DAC at most, i.e. the output latency */
+    unsigned int queuedFrames() const { return periodFrames * periods; }
+
+    bool operator==(const AlsaLatencyConfig& other) const {
+        return periodFrames == other.periodFrames && periods == other.periods;
+    }
+};
+
+/**
+ * @brief Finds the smallest period configuration this machine sustains
+ *
+ * Calibration runs in two steps, both at the configured polyphony with every
+ * voice sounding:
+ *   1. Benchmark renderAudio() for each candidate period size, without the
+ *      device. Sizes whose worst render takes more than MAX_RENDER_LOAD of
+ *      the period's playback time are ruled out.
+ *   2. Soak the remaining candidates on the device, smallest latency first,
+ *      counting xruns while rendering. The first one without xruns wins, and
+ *      SAFETY_PERIODS more periods are added to it.
+ *
+ * The soak is supplied by the owner (AlsaCalibration plays through ALSA), so
+ * the search and the cache don't depend on a device. Results are cached in a
+ * JSON file keyed by device, sample rate, channels, polyphony, render rate
+ * and resampler quality, so calibration only runs the first time, or when
+ * asked to. A run where no candidate soaked cleanly is not cached.
+ */
+class LatencyCalibration {
+public:
+    static constexpr unsigned int PERIOD_SIZES[] = {32, 64, 128, 256, 512};
+    static constexpr unsigned int PERIOD_COUNTS[] = {2, 3, 4};
+    static constexpr float MAX_RENDER_LOAD = 0.5f;    // Worst render vs. period duration
+    static constexpr unsigned int SAFETY_PERIODS = 1;
+    static constexpr unsigned int BENCHMARK_FRAMES = 48000;
+
+    /**
+     * @brief Play a candidate configuration and count its xruns
+     * @return false if the output can't be opened with exactly this configuration
+     */
+    using SoakFunction = std::function<bool(platform::SynthApplication& synth,
+                                            const AlsaLatencyConfig& config, uint32_t& xruns)>;
+
+    /**
+     * @brief Worst renderAudio() time in nanoseconds for a period size
+     */
+    using BenchmarkFunction = std::function<double(platform::SynthApplication& synth, unsigned int periodFrames)>;
+
+    LatencyCalibration(const char* deviceName, unsigned int sampleRate, unsigned int channels,
+                       uint8_t maxVoices, SoakFunction soak, const char* cachePath = "audio_calibration.json")
+        : deviceName_(deviceName)
+        , sampleRate_(sampleRate)
+        , channels_(channels)
+        , maxVoices_(maxVoices)
+        , cachePath_(cachePath)
+        , renderRate_(sampleRate)
+        , soak_(std::move(soak)) {}
+
+    /**
+     * @brief Benchmark with the engine at renderRate, resampled to the device rate
+     */
+    void setRenderRate(unsigned int renderRate, platform::ResamplerQuality quality) {
+        renderRate_ = renderRate;
+        resamplerQuality_ = quality;
+    }
+
+    /**
+     * @brief Replace the render benchmark (nullptr restores the default)
+     */
+    void setBenchmark(BenchmarkFunction benchmark) {
+        benchmark_ = std::move(benchmark);
+    }
+
+    /**
+     * @brief Look up an earlier calibration result for this setup
+     * @return false if there is none
+     */
+    bool loadCached(AlsaLatencyConfig& config) const {
+        nlohmann::json cache = readCache();
+        auto entry = cache.find(cacheKey());
+        if (entry == cache.end()) {
+            return false;
+        }
+        try {
+            config.periodFrames = entry->at("periodFrames").get<unsigned int>();
+            config.periods = entry->at("periods").get<unsigned int>();
+        } catch (const std::exception& e) {
+            logWarn("Ignoring bad calibration entry in %s: %s", cachePath_, e.what());
+            return false;
+        }
+        return config.isValid();
+    }
+
+    /**
+     * @brief Benchmark, soak and cache; takes a few seconds
+     */
+    AlsaLatencyConfig calibrate() {
+        logInfo("Calibrating audio output for %s (%u voices)...", deviceName_, maxVoices_);
+        platform::SynthApplication synth(renderRate_, channels_, maxVoices_);
+        synth.setOutputRate(sampleRate_, resamplerQuality_);
+        holdAllVoices(synth);
+
+        std::vector<AlsaLatencyConfig> candidates;
+        for (unsigned int periodFrames : PERIOD_SIZES) {
+            double worstNs = benchmark_ ? benchmark_(synth, periodFrames) : worstRenderNs(synth, periodFrames);
+            double periodNs = 1e9 * periodFrames / sampleRate_;
+            logInfo("  %4u frames: worst render %.0f us, %.0f%% of the period",
+                    periodFrames, worstNs / 1000.0, 100.0 * worstNs / periodNs);
+            if (worstNs > MAX_RENDER_LOAD * periodNs) {
+                continue;
+            }
+            for (unsigned int periods : PERIOD_COUNTS) {
+                candidates.push_back({periodFrames, periods});
+            }
+        }
+        // Lowest latency first; for equal latency, longer periods wake less often
+        std::sort(candidates.begin(), candidates.end(), [](const AlsaLatencyConfig& a, const AlsaLatencyConfig& b) {
+            return a.queuedFrames() != b.queuedFrames() ? a.queuedFrames() < b.queuedFrames()
+                                                        : a.periodFrames > b.periodFrames;
+        });
+
+        for (const AlsaLatencyConfig& candidate : candidates) {
+            uint32_t xruns = 0;
+            if (!soak_(synth, candidate, xruns)) {
+                continue;
+            }
+            logInfo("  %4u frames x %u periods: %u xruns", candidate.periodFrames, candidate.periods, xruns);
+            if (xruns == 0) {
+                AlsaLatencyConfig chosen{candidate.periodFrames, candidate.periods + SAFETY_PERIODS};
+                logInfo("Calibrated %s: %u frames x %u periods (%.1f ms)", deviceName_, chosen.periodFrames,
+                        chosen.periods, 1000.0 * chosen.queuedFrames() / sampleRate_);
+                saveCached(chosen);
+                return chosen;
+            }
+        }
+
+        // Not cached: it was never shown to work, so calibrate again next time
+        AlsaLatencyConfig fallback{PERIOD_SIZES[std::size(PERIOD_SIZES) - 1],
+                                   PERIOD_COUNTS[std::size(PERIOD_COUNTS) - 1]};
+        logWarn("No stable audio configuration found; falling back to %u frames x %u periods",
+                fallback.periodFrames, fallback.periods);
+        return fallback;
+    }
+
+private:
+    const char* deviceName_;
+    unsigned int sampleRate_;
+    unsigned int channels_;
+    uint8_t maxVoices_;
+    const char* cachePath_;
+    unsigned int renderRate_;
+    platform::ResamplerQuality resamplerQuality_ = platform::ResamplerQuality::Balanced;
+    SoakFunction soak_;
+    BenchmarkFunction benchmark_;
+
+    std::string cacheKey() const {
+        char key[256];
+        int length = snprintf(key, sizeof(key), "%s@%uHz/%uch/%uvoices", deviceName_, sampleRate_, channels_,
+                              static_cast<unsigned int>(maxVoices_));
+        if (renderRate_ != sampleRate_ && length > 0 && static_cast<size_t>(length) < sizeof(key)) {
+            // The resampler only runs, and costs render time, when the rates differ
+            static const char* const QUALITY_NAMES[] = {"fast", "balanced", "high"};
+            snprintf(key + length, sizeof(key) - length, "/render%uHz/%s", renderRate_,
+                     QUALITY_NAMES[static_cast<size_t>(resamplerQuality_)]);
+        }
+        return key;
+    }
+
+    nlohmann::json readCache() const {
+        std::ifstream file(cachePath_);
+        if (!file.is_open()) {
+            return nlohmann::json::object();
+        }
+        nlohmann::json cache = nlohmann::json::parse(file, nullptr, false);
+        return cache.is_object() ? cache : nlohmann::json::object();
+    }
+
+    void saveCached(const AlsaLatencyConfig& config) const {
+        nlohmann::json cache = readCache();
+        cache[cacheKey()] = {{"periodFrames", config.periodFrames}, {"periods", config.periods}};
+        std::ofstream file(cachePath_);
+        if (!file.is_open()) {
+            logWarn("Failed to open %s; calibration will run again next time", cachePath_);
+            return;
+        }
+        file << cache.dump(2);
+    }
+
+    /**
+     * @brief Sound one note per voice, so rendering costs what it would at full polyphony
+     */
+    void holdAllVoices(platform::SynthApplication& synth) const {
+        for (uint8_t voice = 0; voice < maxVoices_; voice++) {
+            synth.processMidiByte(0x90);
+            synth.processMidiByte(static_cast<uint8_t>(48 + voice * 3));
+            synth.processMidiByte(100);
+        }
+    }
+
+    /**
+     * @brief Slowest renderAudio() call over BENCHMARK_FRAMES frames, after a warm-up
+     */
+    double worstRenderNs(platform::SynthApplication& synth, unsigned int periodFrames) const {
+        std::vector<float> buffer(periodFrames * channels_);
+        features::LapTimer<features::NoOpTimingPolicy, 12> timer;
+        const unsigned int blocks = std::max(16u, BENCHMARK_FRAMES / periodFrames);
+        double worstNs = 0.0;
+        for (unsigned int block = 0; block < blocks + 8; block++) {
+            auto start = std::chrono::steady_clock::now();
+            synth.renderAudio(buffer.data(), periodFrames, timer);
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            timer.end();
+            timer.reset();
+            if (block >= 8) {
+                worstNs = std::max(worstNs, elapsed.count());
+            }
+        }
+        return worstNs;
+    }
+};
+
+} // namespace linux
@@ -1,24 +1,63 @@
 #pragma once
 
 #include <alsa/asoundlib.h>
+#include <sample_format.hpp>
+#include <latency_profile.hpp>
+#include <log.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <vector>
 #include <stdexcept>
 #include <cstring>
+#include <cerrno>
+#include <cstdint>
 
 namespace linux {
 
+/**
+ * @brief Sample format written to the ALSA device
+ */
+enum class PcmFormat {
+    Float,  // FLOAT_LE: the render buffer as is
+    S32,    // S32_LE, converted with platform::convertInterleaved
+    S16     // S16_LE, converted with TPDF dither
+};
+
 /**
  * @brief ALSA-based audio output for Linux
+ *
+ * Uses the preferred sample format if the device supports it, otherwise the
+ * first supported one of Float, S32 and S16 (hw: devices often take integer
+ * formats only), so the device can be opened without a plug layer.
+ *
+ * The device buffer is sized once for the Efficiency profile. Switching
+ * profiles only changes how much each write() renders and how much audio is
+ * allowed to queue in that buffer:
+ *   - LowLatency: bufferFrames per write, at most `periods` periods queued
+ *   - Efficiency: EFFICIENCY_PERIODS times that per write, the whole device
+ *     buffer (two long periods) queued
+ *
+ * The period size and buffer the device actually grants are read back and
+ * used from then on; see AlsaCalibration for finding the smallest ones this
+ * machine can keep up with.
  */
 class AlsaPcmOut {
 public:
+    /** @brief Efficiency period length, in LowLatency periods */
+    static constexpr unsigned int EFFICIENCY_PERIODS = 4;
+
     AlsaPcmOut(const char* deviceName = "default", 
                    unsigned int sampleRate = 44100,
                    unsigned int channels = 2,
-                   unsigned int bufferFrames = 512)
+                   unsigned int bufferFrames = 512,
+                   PcmFormat preferredFormat = PcmFormat::Float,
+                   unsigned int periods = 2)
         : sampleRate_(sampleRate)
         , channels_(channels)
-        , bufferFrames_(bufferFrames) {
+        , bufferFrames_(bufferFrames)
+        , periods_(periods) {
         
         int err;
         
@@ -36,12 +75,16 @@ public:
         
         // Set parameters
         snd_pcm_hw_params_set_access(pcmHandle_, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED);
-        snd_pcm_hw_params_set_format(pcmHandle_, hwParams, SND_PCM_FORMAT_FLOAT_LE);
+        format_ = chooseFormat(hwParams, preferredFormat);
+        snd_pcm_hw_params_set_format(pcmHandle_, hwParams, alsaFormat(format_));
         snd_pcm_hw_params_set_channels(pcmHandle_, hwParams, channels_);
         snd_pcm_hw_params_set_rate_near(pcmHandle_, hwParams, &sampleRate_, 0);
         
-        // Set buffer size to 2 periods for low latency
-        snd_pcm_uframes_t bufferSize = bufferFrames_ * 2;
+        // Two Efficiency periods (or the LowLatency queue, if deeper);
+        // LowLatency keeps the buffer mostly empty. The hardware period stays
+        // short so LowLatency writes wake promptly.
+        const unsigned int requestedFrames = bufferFrames;
+        snd_pcm_uframes_t bufferSize = bufferFrames_ * std::max(periods_, EFFICIENCY_PERIODS * 2);
         snd_pcm_hw_params_set_buffer_size_near(pcmHandle_, hwParams, &bufferSize);
         snd_pcm_hw_params_set_period_size_near(pcmHandle_, hwParams, &bufferFrames_, 0);
         
@@ -51,8 +94,24 @@ public:
             throw std::runtime_error(std::string("Cannot set hardware parameters: ") + snd_strerror(err));
         }
         
-        // Allocate buffer
-        buffer_.resize(bufferFrames_ * channels_);
+        // Work with what the device granted, which may differ from the request
+        snd_pcm_hw_params_get_period_size(hwParams, &bufferFrames_, 0);
+        snd_pcm_hw_params_get_buffer_size(hwParams, &bufferSize);
+        if (bufferFrames_ != requestedFrames) {
+            logWarn("ALSA period is %lu frames (asked for %u)", bufferFrames_, requestedFrames);
+        }
+        periods_ = std::max<unsigned int>(1, std::min<unsigned int>(periods_, bufferSize / bufferFrames_));
+        efficiencyFrames_ = std::max(bufferFrames_, std::min<snd_pcm_uframes_t>(bufferFrames_ * EFFICIENCY_PERIODS,
+                                                                               bufferSize / 2));
+        
+        // Allocate buffers for the longest period
+        size_t maxSamples = efficiencyFrames_ * channels_;
+        buffer_.resize(maxSamples);
+        if (format_ == PcmFormat::S32) {
+            s32Buffer_.resize(maxSamples);
+        } else if (format_ == PcmFormat::S16) {
+            s16Buffer_.resize(maxSamples);
+        }
     }
     
     ~AlsaPcmOut() {
@@ -66,19 +125,59 @@ public:
     AlsaPcmOut(const AlsaPcmOut&) = delete;
     AlsaPcmOut& operator=(const AlsaPcmOut&) = delete;
     
+    /**
+     * @brief Select the period length and queue depth for subsequent writes
+     *
+     * Safe to call from any thread; takes effect at the next write().
+     */
+    void setLatencyProfile(features::LatencyProfile profile) {
+        profile_.store(profile, std::memory_order_relaxed);
+    }
+
+    features::LatencyProfile getLatencyProfile() const {
+        return profile_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Frames rendered per write() under the current profile
+     */
+    unsigned int getPeriodFrames() const {
+        return periodFrames(getLatencyProfile());
+    }
+
     /**
      * @brief Fill buffer and write to audio device
      * @param fillCallback Function that generates samples: callback(buffer, numFrames)
      */
     template<typename Callback>
     void write(Callback fillCallback) {
+        features::LatencyProfile profile = getLatencyProfile();
+        snd_pcm_uframes_t periodFrames = this->periodFrames(profile);
+        if (profile == features::LatencyProfile::LowLatency) {
+            // Render as late as possible, so input lands within `periods` periods
+            waitForQueuedBelow(periodFrames * (periods_ - 1));
+        }
+
         // Fill buffer with audio data
-        fillCallback(buffer_.data(), bufferFrames_);
+        fillCallback(buffer_.data(), static_cast<unsigned int>(periodFrames));
         
-        // Write to ALSA
-        snd_pcm_sframes_t frames = snd_pcm_writei(pcmHandle_, buffer_.data(), bufferFrames_);
+        // Convert in one pass straight from the render buffer, then write
+        size_t samples = periodFrames * channels_;
+        const void* pcm = buffer_.data();
+        if (format_ == PcmFormat::S32) {
+            platform::convertInterleaved<platform::S32Format>(buffer_.data(), s32Buffer_.data(), samples);
+            pcm = s32Buffer_.data();
+        } else if (format_ == PcmFormat::S16) {
+            platform::convertInterleaved<platform::S16Format>(buffer_.data(), s16Buffer_.data(), samples,
+                                                              1.0f, &dither_);
+            pcm = s16Buffer_.data();
+        }
+        snd_pcm_sframes_t frames = snd_pcm_writei(pcmHandle_, pcm, periodFrames);
         
         if (frames < 0) {
+            if (frames == -EPIPE) {
+                ++xrunCount_;
+            }
             // Try to recover from error
             frames = snd_pcm_recover(pcmHandle_, frames, 0);
         }
@@ -87,21 +186,72 @@ public:
             throw std::runtime_error(std::string("Audio write failed: ") + snd_strerror(frames));
         }
         
-        if (frames != static_cast<snd_pcm_sframes_t>(bufferFrames_)) {
+        if (frames != static_cast<snd_pcm_sframes_t>(periodFrames)) {
             // Short write - this is okay, just note it
         }
     }
     
     unsigned int getSampleRate() const { return sampleRate_; }
     unsigned int getChannels() const { return channels_; }
-    unsigned int getBufferFrames() const { return bufferFrames_; }
+    unsigned int getBufferFrames() const { return static_cast<unsigned int>(bufferFrames_); }
+    unsigned int getPeriods() const { return periods_; }
+    PcmFormat getFormat() const { return format_; }
+    
+    /**
+     * @brief Underruns (xruns) recovered from since the device was opened
+     */
+    uint32_t getXrunCount() const { return xrunCount_; }
 
 private:
     snd_pcm_t* pcmHandle_ = nullptr;
     unsigned int sampleRate_;
     unsigned int channels_;
     snd_pcm_uframes_t bufferFrames_;
+    unsigned int periods_;
+    snd_pcm_uframes_t efficiencyFrames_ = 0;
+    PcmFormat format_ = PcmFormat::Float;
     std::vector<float> buffer_;
+    std::vector<int32_t> s32Buffer_;
+    std::vector<int16_t> s16Buffer_;
+    platform::TpdfDither dither_;
+    uint32_t xrunCount_ = 0;
+    std::atomic<features::LatencyProfile> profile_{features::LatencyProfile::LowLatency};
+
+    snd_pcm_uframes_t periodFrames(features::LatencyProfile profile) const {
+        return profile == features::LatencyProfile::Efficiency ? efficiencyFrames_ : bufferFrames_;
+    }
+
+    /**
+     * @brief Sleep until no more than maxQueued frames are left to play
+     *
+     * Needed after switching down from Efficiency, when the device buffer
+     * holds far more than two short periods. Errors are left to writei.
+     */
+    void waitForQueuedBelow(snd_pcm_uframes_t maxQueued) {
+        snd_pcm_sframes_t queued = 0;
+        if (snd_pcm_delay(pcmHandle_, &queued) < 0 || queued <= static_cast<snd_pcm_sframes_t>(maxQueued)) {
+            return;
+        }
+        uint64_t excessUs = static_cast<uint64_t>(queued - maxQueued) * 1000000 / sampleRate_;
+        std::this_thread::sleep_for(std::chrono::microseconds(excessUs));
+    }
+
+    static snd_pcm_format_t alsaFormat(PcmFormat format) {
+        switch (format) {
+            case PcmFormat::S32: return SND_PCM_FORMAT_S32_LE;
+            case PcmFormat::S16: return SND_PCM_FORMAT_S16_LE;
+            default:             return SND_PCM_FORMAT_FLOAT_LE;
+        }
+    }
+
+    PcmFormat chooseFormat(snd_pcm_hw_params_t* hwParams, PcmFormat preferred) {
+        for (PcmFormat format : {preferred, PcmFormat::Float, PcmFormat::S32, PcmFormat::S16}) {
+            if (snd_pcm_hw_params_test_format(pcmHandle_, hwParams, alsaFormat(format)) == 0) {
+                return format;
+            }
+        }
+        return preferred;   // Let snd_pcm_hw_params() report the failure
+    }
 };
 
 } // namespace linux
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <telemetry_sink.hpp>
+#include <telemetry_frame.hpp>
+#include <json_writer.hpp>
+#include <log.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace linux {
+
+/**
+ * @brief Linux telemetry sink with a lock-free ring and a background writer
+ *
+ * sendTelemetry() copies the stats into a preallocated single-producer,
+ * single-consumer ring: constant time, no allocation, no locks and no system
+ * calls, so it is safe to call from the audio thread every block. If the ring
+ * is full the message is dropped and counted rather than blocking.
+ *
+ * A background thread drains the ring every DRAIN_INTERVAL, serializes each
+ * message (JSON Lines or binary frames, see features::TelemetryFrameWriter)
+ * and writes it to one of:
+ *   - stdout:            target "" or "-"
+ *   - a Unix socket:     target "unix:/path/to.sock" (connects as a client)
+ *   - a file:            any other target (truncated, then appended to, so
+ *                        several sinks can share one file)
+ *   - an output function, e.g. linux::ControlServer::publishToClients, which
+ *     receives one whole message per call. A message that doesn't fit in
+ *     OUTPUT_BUFFER_SIZE is dropped and counted (getOversizedCount()); the
+ *     other targets are byte streams and get it in pieces.
+ *
+ * Usage:
+ * @code
+ * linux::LinuxTelemetrySink<features::TimingStats<12>> sink("unix:/tmp/pressence.sock");
+ * // audio thread, every block:
+ * sink.sendTelemetry(timer.getStats());
+ * @endcode
+ *
+ * @tparam TelemetryDataT Trivially copyable telemetry type (must have to_json,
+ *         and to_binary for the binary format)
+ * @tparam Capacity Ring slots (power of two); one slot is always kept free
+ */
+template<typename TelemetryDataT, size_t Capacity = 64>
+class LinuxTelemetrySink : public features::TelemetrySink<TelemetryDataT> {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<TelemetryDataT>::value,
+                  "Telemetry data is copied into the ring and must be trivially copyable");
+
+public:
+    static constexpr std::chrono::milliseconds DRAIN_INTERVAL{10};
+    static constexpr size_t OUTPUT_BUFFER_SIZE = 16384;
+
+    /**
+     * @brief Open the output and start the writer thread
+     * @param target "" or "-" for stdout, "unix:<path>" for a Unix socket, otherwise a file path
+     * @param format Wire format
+     * @throws std::runtime_error if the output cannot be opened
+     */
+    explicit LinuxTelemetrySink(const std::string& target = "",
+                                features::TelemetryFormat format = features::TelemetryFormat::Json)
+        : format_(format)
+        , slots_(new TelemetryDataT[Capacity])
+    {
+        openTarget(target);
+        writer_ = std::thread([this] { drainLoop(); });
+        logInfo("Telemetry sink started: %s", target.empty() || target == "-" ? "stdout" : target.c_str());
+    }
+
+    /**
+     * @brief Hand each serialized message to an output function
+     * @param write Called from the writer thread with one complete message
+     *        (at most OUTPUT_BUFFER_SIZE bytes)
+     * @param context Passed to write
+     * @param format Wire format
+     */
+    LinuxTelemetrySink(features::JsonWriter::WriteFn write, void* context,
+                       features::TelemetryFormat format = features::TelemetryFormat::Json)
+        : format_(format)
+        , slots_(new TelemetryDataT[Capacity])
+        , write_(write)
+        , writeContext_(context)
+    {
+        writer_ = std::thread([this] { drainLoop(); });
+        logInfo("Telemetry sink started: output function");
+    }
+
+    /**
+     * @brief Stop the writer thread after flushing queued messages
+     */
+    ~LinuxTelemetrySink() override {
+        stop_.store(true, std::memory_order_release);
+        if (writer_.joinable()) {
+            writer_.join();
+        }
+        if (fd_ >= 0 && fd_ != STDOUT_FILENO) {
+            close(fd_);
+        }
+    }
+
+    // Prevent copying
+    LinuxTelemetrySink(const LinuxTelemetrySink&) = delete;
+    LinuxTelemetrySink& operator=(const LinuxTelemetrySink&) = delete;
+
+    /**
+     * @brief Queue a copy of data for output (wait-free; drops when full)
+     */
+    void sendTelemetry(const TelemetryDataT& data) override {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t next = (tail + 1) & (Capacity - 1);
+        if (next == head_.load(std::memory_order_acquire)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::memcpy(&slots_[tail], &data, sizeof(TelemetryDataT));
+        tail_.store(next, std::memory_order_release);
+    }
+
+    /**
+     * @brief Messages dropped because the ring was full
+     */
+    uint32_t getDroppedCount() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Messages dropped because they didn't fit an output function call
+     */
+    uint32_t getOversizedCount() const {
+        return oversized_.load(std::memory_order_relaxed);
+    }
+
+private:
+    features::TelemetryFormat format_;
+    std::unique_ptr<TelemetryDataT[]> slots_;
+    alignas(64) std::atomic<size_t> head_{0};   // Next slot to read (writer thread)
+    alignas(64) std::atomic<size_t> tail_{0};   // Next slot to write (producer)
+    alignas(64) std::atomic<uint32_t> dropped_{0};
+    std::atomic<uint32_t> oversized_{0};
+    std::atomic<bool> stop_{false};
+    std::thread writer_;
+
+    // Output state (writer thread only)
+    features::JsonWriter::WriteFn write_ = nullptr;
+    void* writeContext_ = nullptr;
+    int fd_ = -1;
+    bool isSocket_ = false;
+    bool outputFailed_ = false;
+    char output_[OUTPUT_BUFFER_SIZE];
+    size_t outputUsed_ = 0;
+    size_t messageStart_ = 0;          // Where the message being serialized begins
+    bool messageTooLarge_ = false;     // It overflowed the buffer of an output function
+
+    void openTarget(const std::string& target) {
+        static const char UNIX_PREFIX[] = "unix:";
+        if (target.empty() || target == "-") {
+            fd_ = STDOUT_FILENO;
+            return;
+        }
+
+        if (target.compare(0, sizeof(UNIX_PREFIX) - 1, UNIX_PREFIX) == 0) {
+            std::string path = target.substr(sizeof(UNIX_PREFIX) - 1);
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+                throw std::runtime_error("Invalid telemetry socket path: " + path);
+            }
+            std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+            fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd_ < 0 || connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+                std::string error = strerror(errno);
+                if (fd_ >= 0) {
+                    close(fd_);
+                }
+                throw std::runtime_error("Cannot connect telemetry socket " + path + ": " + error);
+            }
+            isSocket_ = true;
+            return;
+        }
+
+        fd_ = open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            throw std::runtime_error("Cannot open telemetry file " + target + ": " + strerror(errno));
+        }
+    }
+
+    /**
+     * @brief Writer thread: drain, serialize and write until stopped
+     */
+    void drainLoop() {
+        uint32_t reportedDrops = 0;
+        uint32_t reportedOversized = 0;
+        auto nextDropReport = std::chrono::steady_clock::now();
+        bool stopping = false;
+
+        while (!stopping) {
+            // Read the flag before draining so nothing queued before stop is lost
+            stopping = stop_.load(std::memory_order_acquire);
+
+            size_t head = head_.load(std::memory_order_relaxed);
+            while (head != tail_.load(std::memory_order_acquire)) {
+                serialize(slots_[head]);
+                if (write_) {
+                    flushOutput();   // Output functions take one message per call
+                }
+                head = (head + 1) & (Capacity - 1);
+                head_.store(head, std::memory_order_release);
+            }
+            flushOutput();
+
+            // Report drops at most once per second
+            const auto now = std::chrono::steady_clock::now();
+            const uint32_t drops = getDroppedCount();
+            const uint32_t oversized = getOversizedCount();
+            if ((drops != reportedDrops || oversized != reportedOversized) && now >= nextDropReport) {
+                if (drops != reportedDrops) {
+                    logWarn("Telemetry ring full: %u messages dropped", drops - reportedDrops);
+                }
+                if (oversized != reportedOversized) {
+                    logWarn("Telemetry: %u messages over %u bytes dropped",
+                            oversized - reportedOversized, static_cast<unsigned>(OUTPUT_BUFFER_SIZE));
+                }
+                reportedDrops = drops;
+                reportedOversized = oversized;
+                nextDropReport = now + std::chrono::seconds(1);
+            }
+
+            if (!stopping) {
+                std::this_thread::sleep_for(DRAIN_INTERVAL);
+            }
+        }
+    }
+
+    void serialize(const TelemetryDataT& data) {
+        messageStart_ = outputUsed_;
+        messageTooLarge_ = false;
+        if (format_ == features::TelemetryFormat::Binary) {
+            features::writeTelemetryFrame(data, appendBytes, this);
+        } else {
+            features::writeJsonLine(data, appendText, this);
+        }
+        if (messageTooLarge_) {
+            outputUsed_ = messageStart_;
+            oversized_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    static void appendBytes(const uint8_t* data, size_t length, void* context) {
+        static_cast<LinuxTelemetrySink*>(context)->append(data, length);
+    }
+
+    static void appendText(const char* data, size_t length, void* context) {
+        static_cast<LinuxTelemetrySink*>(context)->append(data, length);
+    }
+
+    void append(const void* data, size_t length) {
+        const char* bytes = static_cast<const char*>(data);
+        while (length > 0 && !messageTooLarge_) {
+            if (outputUsed_ == OUTPUT_BUFFER_SIZE) {
+                if (write_) {
+                    // Output functions only ever get whole messages
+                    messageTooLarge_ = true;
+                    return;
+                }
+                flushOutput();
+            }
+            size_t n = std::min(length, OUTPUT_BUFFER_SIZE - outputUsed_);
+            std::memcpy(output_ + outputUsed_, bytes, n);
+            outputUsed_ += n;
+            bytes += n;
+            length -= n;
+        }
+    }
+
+    /**
+     * @brief Write buffered output; on a fatal error, stop writing but keep draining
+     */
+    void flushOutput() {
+        if (outputUsed_ == 0) {
+            return;
+        }
+        if (write_) {
+            write_(output_, outputUsed_, writeContext_);
+            outputUsed_ = 0;
+            return;
+        }
+        if (fd_ == STDOUT_FILENO) {
+            // Go through stdio so telemetry lines don't split printf'd logs
+            fwrite(output_, 1, outputUsed_, stdout);
+            fflush(stdout);
+            outputUsed_ = 0;
+            return;
+        }
+
+        size_t written = 0;
+        while (!outputFailed_ && written < outputUsed_) {
+            ssize_t n = isSocket_
+                ? send(fd_, output_ + written, outputUsed_ - written, MSG_NOSIGNAL)
+                : write(fd_, output_ + written, outputUsed_ - written);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                logError("Telemetry output failed: %s", strerror(errno));
+                outputFailed_ = true;
+                break;
+            }
+            written += static_cast<size_t>(n);
+        }
+        outputUsed_ = 0;
+    }
+};
+
+} // namespace linux
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <flight_recorder.hpp>
+#include <linux_timing_policy.hpp>
+#include <log.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace linux {
+
+/**
+ * @brief Flight recorder file layout (shared with tools/flight_decode.cpp)
+ *
+ * The file is a header followed by a power-of-two ring of fixed-size slots.
+ * Writers claim a slot by incrementing writeIndex, fill it, then publish it
+ * by storing sequence = index + 1. A slot whose sequence is 0 was being
+ * written when the process died and is ignored by the decoder.
+ */
+namespace flight_record {
+    static constexpr char MAGIC[8] = {'P', 'R', 'S', 'F', 'L', 'T', '\0', '\0'};
+    static constexpr uint32_t VERSION = 1;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t slotSize;
+        uint64_t capacity;            // Slots in the ring (power of two)
+        uint64_t startMonotonicNs;    // CLOCK_MONOTONIC at creation (slot time base)
+        uint64_t startRealtimeNs;     // CLOCK_REALTIME at creation (for wall-clock display)
+        alignas(64) std::atomic<uint64_t> writeIndex;
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> sequence;   // Claimed index + 1; 0 = empty or torn
+        uint64_t timestampNs;             // CLOCK_MONOTONIC
+        uint8_t event;                    // features::FlightEvent
+        uint8_t a;
+        uint16_t b;
+        uint32_t value;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "Flight recorder needs lock-free 64-bit atomics in shared memory");
+    static_assert(sizeof(Slot) == 24, "Slot layout is part of the file format");
+
+    inline size_t headerSize() {
+        return (sizeof(Header) + 63) & ~static_cast<size_t>(63);
+    }
+
+    /**
+     * @brief One published event, as read back from a recording
+     */
+    struct Event {
+        uint64_t sequence;
+        uint64_t timestampNs;
+        uint8_t event;
+        uint8_t a;
+        uint16_t b;
+        uint32_t value;
+    };
+
+    /**
+     * @brief Contents of a recording file
+     */
+    struct Recording {
+        const Header* header = nullptr;   // Points into the decoded data
+        std::vector<Event> events;        // Published events, oldest first
+        uint64_t recorded = 0;            // Events ever claimed by writers
+        size_t torn = 0;                  // Slots skipped as inconsistent
+        size_t unpublished = 0;           // Claimed but never published (writer interrupted)
+    };
+
+    /**
+     * @brief Read the published events out of a recording file's bytes
+     *
+     * For offline use (tools/flight_decode.cpp): allocates, and expects a
+     * file that no process is writing any more, or a copy of one.
+     *
+     * @param data File contents (8-byte aligned, as from a std::vector)
+     * @return false if data is not a recording of this version
+     */
+    inline bool decode(const uint8_t* data, size_t size, Recording& out) {
+        if (size < headerSize()) {
+            return false;
+        }
+        const auto* header = reinterpret_cast<const Header*>(data);
+        if (std::memcmp(header->magic, MAGIC, sizeof(header->magic)) != 0 ||
+            header->version != VERSION ||
+            header->slotSize != sizeof(Slot) ||
+            header->capacity == 0 || (header->capacity & (header->capacity - 1)) != 0 ||
+            size < headerSize() + header->capacity * sizeof(Slot)) {
+            return false;
+        }
+        out = Recording{};
+        out.header = header;
+        out.recorded = header->writeIndex.load(std::memory_order_relaxed);
+
+        const auto* slots = reinterpret_cast<const Slot*>(data + headerSize());
+        for (uint64_t i = 0; i < header->capacity; i++) {
+            const Slot& s = slots[i];
+            const uint64_t sequence = s.sequence.load(std::memory_order_relaxed);
+            if (sequence == 0) {
+                continue;
+            }
+            if (((sequence - 1) & (header->capacity - 1)) != i || sequence > out.recorded) {
+                out.torn++;
+                continue;
+            }
+            out.events.push_back({sequence, s.timestampNs, s.event, s.a, s.b, s.value});
+        }
+        std::sort(out.events.begin(), out.events.end(),
+                  [](const Event& x, const Event& y) { return x.sequence < y.sequence; });
+
+        const uint64_t expected = std::min<uint64_t>(out.recorded, header->capacity);
+        if (out.events.size() + out.torn < expected) {
+            out.unpublished = static_cast<size_t>(expected - out.events.size() - out.torn);
+        }
+        return true;
+    }
+} // namespace flight_record
+
+/**
+ * @brief Flight recorder backed by a memory-mapped ring file
+ *
+ * Events are written straight into a MAP_SHARED mapping, so they reach the
+ * page cache as they happen and survive a crash or kill of the process (not
+ * a power loss). record() is wait-free: one atomic increment, a 24-byte store
+ * and a clock read, with no system calls (clock_gettime is served by the vDSO).
+ *
+ * The ring holds the newest `capacity` events; at a few hundred events per
+ * second the default covers a couple of minutes. Dump it with
+ * tools/flight_decode.cpp.
+ */
+class MmapFlightRecorder : public features::FlightRecorder {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 65536;
+
+    /**
+     * @brief Create (or overwrite) the ring file and map it
+     * @param path Recording file path
+     * @param capacity Ring slots (rounded up to a power of two)
+     * @throws std::runtime_error if the file cannot be created or mapped
+     */
+    explicit MmapFlightRecorder(const std::string& path, size_t capacity = DEFAULT_CAPACITY) {
+        capacity_ = 1;
+        while (capacity_ < capacity) {
+            capacity_ <<= 1;
+        }
+        mappedSize_ = flight_record::headerSize() + capacity_ * sizeof(flight_record::Slot);
+
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create flight recorder " + path + ": " + strerror(errno));
+        }
+        if (ftruncate(fd, static_cast<off_t>(mappedSize_)) < 0) {
+            std::string error = strerror(errno);
+            close(fd);
+            throw std::runtime_error("Cannot size flight recorder " + path + ": " + error);
+        }
+        void* mapping = mmap(nullptr, mappedSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Cannot map flight recorder " + path + ": " + strerror(errno));
+        }
+        base_ = static_cast<uint8_t*>(mapping);
+
+        // Fault every page in now, so the audio thread never takes a page fault
+        memset(base_, 0, mappedSize_);
+
+        header_ = new (base_) flight_record::Header{};
+        std::memcpy(header_->magic, flight_record::MAGIC, sizeof(header_->magic));
+        header_->version = flight_record::VERSION;
+        header_->slotSize = sizeof(flight_record::Slot);
+        header_->capacity = capacity_;
+        header_->startMonotonicNs = linux_platform::LinuxTimingPolicy::now();
+        header_->startRealtimeNs = realtimeNs();
+        header_->writeIndex.store(0, std::memory_order_relaxed);
+
+        slots_ = reinterpret_cast<flight_record::Slot*>(base_ + flight_record::headerSize());
+        for (size_t i = 0; i < capacity_; i++) {
+            new (&slots_[i]) flight_record::Slot{};
+        }
+
+        logInfo("Flight recorder: %s (%zu events, %zu KB)", path.c_str(), capacity_, mappedSize_ / 1024);
+    }
+
+    ~MmapFlightRecorder() override {
+        if (base_) {
+            msync(base_, mappedSize_, MS_ASYNC);
+            munmap(base_, mappedSize_);
+        }
+    }
+
+    // Prevent copying
+    MmapFlightRecorder(const MmapFlightRecorder&) = delete;
+    MmapFlightRecorder& operator=(const MmapFlightRecorder&) = delete;
+
+    void record(features::FlightEvent event, uint8_t a = 0, uint16_t b = 0, uint32_t value = 0) override {
+        const uint64_t index = header_->writeIndex.fetch_add(1, std::memory_order_relaxed);
+        flight_record::Slot& slot = slots_[index & (capacity_ - 1)];
+
+        // Unpublish while the fields are rewritten, so a crash mid-write
+        // leaves an empty slot rather than a mix of two events
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.timestampNs = linux_platform::LinuxTimingPolicy::now();
+        slot.event = static_cast<uint8_t>(event);
+        slot.a = a;
+        slot.b = b;
+        slot.value = value;
+        slot.sequence.store(index + 1, std::memory_order_release);
+    }
+
+private:
+    uint8_t* base_ = nullptr;
+    size_t mappedSize_ = 0;
+    size_t capacity_ = 0;
+    flight_record::Header* header_ = nullptr;
+    flight_record::Slot* slots_ = nullptr;
+
+    static uint64_t realtimeNs() {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000ULL +
+               static_cast<uint64_t>(ts.tv_nsec);
+    }
+};
+
+} // namespace linux
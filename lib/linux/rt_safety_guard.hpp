@@ -0,0 +1,548 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <execinfo.h>
+
+namespace linux {
+
+/**
+ * @brief Operations that are not allowed on the audio thread while rendering
+ */
+enum class RtViolation : uint8_t {
+    Malloc,
+    Calloc,
+    Realloc,
+    Free,
+    AlignedAlloc,  // aligned_alloc, posix_memalign, memalign
+    OperatorNew,   // Including the std::align_val_t overloads
+    OperatorDelete,
+    Open,
+    Write,
+    MutexLock,     // pthread_mutex_lock: a futex wait when contended
+    CondWait,      // pthread_cond_wait / timedwait: always a futex wait
+    COUNT
+};
+
+inline const char* rtViolationName(RtViolation violation) {
+    switch (violation) {
+        case RtViolation::Malloc:         return "malloc";
+        case RtViolation::Calloc:         return "calloc";
+        case RtViolation::Realloc:        return "realloc";
+        case RtViolation::Free:           return "free";
+        case RtViolation::AlignedAlloc:   return "aligned_alloc";
+        case RtViolation::OperatorNew:    return "operator new";
+        case RtViolation::OperatorDelete: return "operator delete";
+        case RtViolation::Open:           return "open";
+        case RtViolation::Write:          return "write";
+        case RtViolation::MutexLock:      return "pthread_mutex_lock";
+        case RtViolation::CondWait:       return "pthread_cond_wait";
+        case RtViolation::COUNT:          break;
+    }
+    return "unknown";
+}
+
+namespace rt_safety_detail {
+
+/**
+ * @brief Recorded call site (fixed storage, filled once by the claiming thread)
+ */
+template<int MaxFrames>
+struct SiteSlot {
+    std::atomic<uint64_t> key{0};       // Backtrace hash; 0 = free
+    std::atomic<uint32_t> count{0};
+    std::atomic<bool> ready{false};     // Fields below are valid
+    RtViolation violation = RtViolation::COUNT;
+    int frameCount = 0;
+    void* frames[MaxFrames] = {};
+};
+
+} // namespace rt_safety_detail
+
+/**
+ * @brief Debug/test check of the real-time contract on the audio thread
+ *
+ * Code that must not allocate or block runs inside an RtSafetyGuard::Scope.
+ * When the interposers are linked in (see below), every malloc/free/new/
+ * delete (aligned variants included), open/fopen, write and pthread
+ * mutex/condvar wait made by a thread while it is inside a scope is counted
+ * and its call site recorded with a backtrace. Outside a scope, and on every
+ * other thread, the interposers forward straight to libc.
+ *
+ * The interposers replace libc symbols process-wide, so exactly one
+ * translation unit of a debug or test binary defines RT_SAFETY_GUARD_INTERPOSE
+ * before including this header (the native_rtguard environment does this for
+ * main_linux.cpp). Without them, Scope only sets a thread-local flag and
+ * nothing is checked.
+ *
+ * Recording is itself allocation-free: call sites go into a fixed table and
+ * libc calls made while recording are passed through. Print the results with
+ * report() once the real-time work has stopped.
+ */
+class RtSafetyGuard {
+public:
+    static constexpr size_t MAX_SITES = 64;
+    static constexpr int MAX_FRAMES = 16;
+
+    /**
+     * @brief Marks the calling thread as real-time for its lifetime (nestable)
+     */
+    class Scope {
+    public:
+        Scope() { depth_++; }
+        ~Scope() { depth_--; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    /**
+     * @brief Distinct call site of a violation
+     */
+    struct Site {
+        RtViolation violation;
+        uint32_t count;
+        int frameCount;
+        void* const* frames;
+    };
+
+    /**
+     * @brief True if the interposers are linked into this binary
+     */
+    static bool isActive() { return active_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Total violations of all kinds since the last reset()
+     */
+    static uint32_t violationCount() {
+        uint32_t total = 0;
+        for (size_t i = 0; i < static_cast<size_t>(RtViolation::COUNT); i++) {
+            total += totals_[i].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    static uint32_t violationCount(RtViolation violation) {
+        return totals_[static_cast<size_t>(violation)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Number of distinct call sites recorded
+     */
+    static size_t siteCount() {
+        size_t n = 0;
+        for (size_t i = 0; i < MAX_SITES; i++) {
+            if (sites_[i].ready.load(std::memory_order_acquire)) {
+                n++;
+            }
+        }
+        return n;
+    }
+
+    /**
+     * @brief Call site by index (0 .. siteCount() - 1)
+     */
+    static Site getSite(size_t index) {
+        for (size_t i = 0; i < MAX_SITES; i++) {
+            const SiteSlot& slot = sites_[i];
+            if (slot.ready.load(std::memory_order_acquire) && index-- == 0) {
+                return {slot.violation, slot.count.load(std::memory_order_relaxed), slot.frameCount, slot.frames};
+            }
+        }
+        return {RtViolation::COUNT, 0, 0, nullptr};
+    }
+
+    /**
+     * @brief Forget all recorded violations (call with no scope active)
+     */
+    static void reset() {
+        for (auto& total : totals_) {
+            total.store(0, std::memory_order_relaxed);
+        }
+        for (auto& slot : sites_) {
+            slot.ready.store(false, std::memory_order_relaxed);
+            slot.count.store(0, std::memory_order_relaxed);
+            slot.key.store(0, std::memory_order_release);
+        }
+        overflow_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Print counts and a symbolized backtrace per call site
+     *
+     * Allocates (backtrace_symbols), so call it outside any scope.
+     * Link with -rdynamic for function names in the backtraces.
+     */
+    static void report(FILE* out) {
+        if (!isActive()) {
+            fprintf(out, "RT safety guard: not active (no interposers linked)\n");
+            return;
+        }
+        fprintf(out, "RT safety guard: %u violation(s)\n", violationCount());
+        for (size_t i = 0; i < static_cast<size_t>(RtViolation::COUNT); i++) {
+            uint32_t count = totals_[i].load(std::memory_order_relaxed);
+            if (count > 0) {
+                fprintf(out, "  %-20s %u\n", rtViolationName(static_cast<RtViolation>(i)), count);
+            }
+        }
+        for (size_t i = 0; i < siteCount(); i++) {
+            Site site = getSite(i);
+            fprintf(out, "\n%s x%u at:\n", rtViolationName(site.violation), site.count);
+            char** symbols = backtrace_symbols(site.frames, site.frameCount);
+            for (int f = 0; f < site.frameCount; f++) {
+                fprintf(out, "    #%d %s\n", f, symbols ? symbols[f] : "?");
+            }
+            free(symbols);
+        }
+        if (overflow_.load(std::memory_order_relaxed) > 0) {
+            fprintf(out, "\n(%u violation(s) from further call sites not shown)\n",
+                    overflow_.load(std::memory_order_relaxed));
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Interposer support
+    //--------------------------------------------------------------------------
+
+    /**
+     * @brief Called by an interposer: true if this call must be recorded
+     *
+     * Returns false outside a scope and for calls made while already
+     * recording (backtrace() may allocate on first use).
+     */
+    static bool shouldRecord() {
+        return depth_ > 0 && !recording_;
+    }
+
+    /**
+     * @brief Count a violation and record its call site
+     */
+    static void record(RtViolation violation) {
+        recording_ = true;
+        totals_[static_cast<size_t>(violation)].fetch_add(1, std::memory_order_relaxed);
+
+        void* frames[MAX_FRAMES + SKIP_FRAMES];
+        int frameCount = backtrace(frames, MAX_FRAMES + SKIP_FRAMES) - SKIP_FRAMES;
+        if (frameCount < 0) {
+            frameCount = 0;
+        }
+        void* const* siteFrames = frames + SKIP_FRAMES;
+
+        uint64_t key = 1469598103934665603ULL ^ static_cast<uint64_t>(violation);
+        for (int f = 0; f < frameCount; f++) {
+            key = (key ^ reinterpret_cast<uintptr_t>(siteFrames[f])) * 1099511628211ULL;
+        }
+        if (key == 0) {
+            key = 1;
+        }
+
+        bool stored = false;
+        for (size_t probe = 0; probe < MAX_SITES && !stored; probe++) {
+            SiteSlot& slot = sites_[(key + probe) % MAX_SITES];
+            uint64_t expected = 0;
+            if (slot.key.load(std::memory_order_acquire) == key) {
+                slot.count.fetch_add(1, std::memory_order_relaxed);
+                stored = true;
+            } else if (slot.key.compare_exchange_strong(expected, key, std::memory_order_acq_rel)) {
+                slot.violation = violation;
+                slot.frameCount = frameCount;
+                for (int f = 0; f < frameCount; f++) {
+                    slot.frames[f] = siteFrames[f];
+                }
+                slot.count.store(1, std::memory_order_relaxed);
+                slot.ready.store(true, std::memory_order_release);
+                stored = true;
+            }
+        }
+        if (!stored) {
+            overflow_.fetch_add(1, std::memory_order_relaxed);
+        }
+        recording_ = false;
+    }
+
+    /**
+     * @brief Called once by the interposer translation unit at startup
+     *
+     * Warms up backtrace() (which loads libgcc on first use) so recording
+     * never has to.
+     */
+    static void activate() {
+        void* frames[1];
+        backtrace(frames, 1);
+        active_.store(true, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int SKIP_FRAMES = 2;   // record() and the interposer
+
+    using SiteSlot = rt_safety_detail::SiteSlot<MAX_FRAMES>;
+
+    static inline thread_local int depth_ = 0;
+    static inline thread_local bool recording_ = false;
+    static inline std::atomic<bool> active_{false};
+    static inline std::atomic<uint32_t> totals_[static_cast<size_t>(RtViolation::COUNT)] = {};
+    static inline SiteSlot sites_[MAX_SITES];
+    static inline std::atomic<uint32_t> overflow_{0};
+};
+
+} // namespace linux
+
+#ifdef RT_SAFETY_GUARD_INTERPOSE
+// ============================================================================
+// Interposers (one translation unit per binary)
+//
+// The malloc family forwards to glibc's __libc_* entry points; everything else
+// forwards to the next definition found by dlsym(RTLD_NEXT).
+// ============================================================================
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <new>
+#include <pthread.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* pointer);
+}
+
+namespace linux {
+namespace rt_safety_detail {
+
+/**
+ * @brief Next definition of an interposed libc function
+ *
+ * Resolved on first use into a plain pointer rather than a function-local
+ * static, whose thread-safe initialization could itself call an interposer.
+ * Racing first calls resolve the same address, so the race is benign.
+ */
+template<typename Fn>
+Fn nextSymbol(Fn& cached, const char* name) {
+    if (!cached) {
+        cached = reinterpret_cast<Fn>(dlsym(RTLD_NEXT, name));
+    }
+    return cached;
+}
+
+struct Activate {
+    Activate() { RtSafetyGuard::activate(); }
+};
+static Activate activateOnStartup;
+
+} // namespace rt_safety_detail
+} // namespace linux
+
+#define RT_SAFETY_CHECK(violation) \
+    do { \
+        if (linux::RtSafetyGuard::shouldRecord()) { \
+            linux::RtSafetyGuard::record(violation); \
+        } \
+    } while (0)
+
+extern "C" {
+
+void* malloc(size_t size) {
+    RT_SAFETY_CHECK(linux::RtViolation::Malloc);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    RT_SAFETY_CHECK(linux::RtViolation::Calloc);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    RT_SAFETY_CHECK(linux::RtViolation::Realloc);
+    return __libc_realloc(pointer, size);
+}
+
+void free(void* pointer) {
+    if (pointer) {
+        RT_SAFETY_CHECK(linux::RtViolation::Free);
+    }
+    __libc_free(pointer);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    RT_SAFETY_CHECK(linux::RtViolation::AlignedAlloc);
+    return __libc_memalign(alignment, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    RT_SAFETY_CHECK(linux::RtViolation::AlignedAlloc);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** pointer, size_t alignment, size_t size) noexcept {
+    RT_SAFETY_CHECK(linux::RtViolation::AlignedAlloc);
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void* allocated = __libc_memalign(alignment, size);
+    if (!allocated) {
+        return ENOMEM;
+    }
+    *pointer = allocated;
+    return 0;
+}
+
+using RtOpenFn = int (*)(const char*, int, ...);
+using RtOpenAtFn = int (*)(int, const char*, int, ...);
+using RtFopenFn = FILE* (*)(const char*, const char*);
+using RtWriteFn = ssize_t (*)(int, const void*, size_t);
+using RtMutexLockFn = int (*)(pthread_mutex_t*);
+using RtCondWaitFn = int (*)(pthread_cond_t*, pthread_mutex_t*);
+using RtCondTimedWaitFn = int (*)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*);
+
+static RtOpenFn rtNextOpen = nullptr;
+static RtOpenFn rtNextOpen64 = nullptr;
+static RtOpenAtFn rtNextOpenAt = nullptr;
+static RtFopenFn rtNextFopen = nullptr;
+static RtFopenFn rtNextFopen64 = nullptr;
+static RtWriteFn rtNextWrite = nullptr;
+static RtMutexLockFn rtNextMutexLock = nullptr;
+static RtCondWaitFn rtNextCondWait = nullptr;
+static RtCondTimedWaitFn rtNextCondTimedWait = nullptr;
+
+static mode_t rtOpenMode(int flags, va_list args) {
+    return (flags & (O_CREAT | O_TMPFILE)) ? static_cast<mode_t>(va_arg(args, unsigned int)) : 0;
+}
+
+int open(const char* path, int flags, ...) {
+    RT_SAFETY_CHECK(linux::RtViolation::Open);
+    va_list args;
+    va_start(args, flags);
+    mode_t mode = rtOpenMode(flags, args);
+    va_end(args);
+    return linux::rt_safety_detail::nextSymbol(rtNextOpen, "open")(path, flags, mode);
+}
+
+int open64(const char* path, int flags, ...) {
+    RT_SAFETY_CHECK(linux::RtViolation::Open);
+    va_list args;
+    va_start(args, flags);
+    mode_t mode = rtOpenMode(flags, args);
+    va_end(args);
+    return linux::rt_safety_detail::nextSymbol(rtNextOpen64, "open64")(path, flags, mode);
+}
+
+int openat(int dirfd, const char* path, int flags, ...) {
+    RT_SAFETY_CHECK(linux::RtViolation::Open);
+    va_list args;
+    va_start(args, flags);
+    mode_t mode = rtOpenMode(flags, args);
+    va_end(args);
+    return linux::rt_safety_detail::nextSymbol(rtNextOpenAt, "openat")(dirfd, path, flags, mode);
+}
+
+FILE* fopen(const char* path, const char* mode) {
+    RT_SAFETY_CHECK(linux::RtViolation::Open);
+    return linux::rt_safety_detail::nextSymbol(rtNextFopen, "fopen")(path, mode);
+}
+
+FILE* fopen64(const char* path, const char* mode) {
+    RT_SAFETY_CHECK(linux::RtViolation::Open);
+    return linux::rt_safety_detail::nextSymbol(rtNextFopen64, "fopen64")(path, mode);
+}
+
+ssize_t write(int fd, const void* buffer, size_t count) {
+    RT_SAFETY_CHECK(linux::RtViolation::Write);
+    return linux::rt_safety_detail::nextSymbol(rtNextWrite, "write")(fd, buffer, count);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    RT_SAFETY_CHECK(linux::RtViolation::MutexLock);
+    return linux::rt_safety_detail::nextSymbol(rtNextMutexLock, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+    RT_SAFETY_CHECK(linux::RtViolation::CondWait);
+    return linux::rt_safety_detail::nextSymbol(rtNextCondWait, "pthread_cond_wait")(cond, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* deadline) {
+    RT_SAFETY_CHECK(linux::RtViolation::CondWait);
+    return linux::rt_safety_detail::nextSymbol(rtNextCondTimedWait, "pthread_cond_timedwait")(cond, mutex, deadline);
+}
+
+} // extern "C"
+
+void* operator new(size_t size) {
+    RT_SAFETY_CHECK(linux::RtViolation::OperatorNew);
+    if (void* pointer = __libc_malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    RT_SAFETY_CHECK(linux::RtViolation::OperatorNew);
+    if (void* pointer = __libc_malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    if (pointer) {
+        RT_SAFETY_CHECK(linux::RtViolation::OperatorDelete);
+    }
+    __libc_free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    if (pointer) {
+        RT_SAFETY_CHECK(linux::RtViolation::OperatorDelete);
+    }
+    __libc_free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    operator delete(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    operator delete[](pointer);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    RT_SAFETY_CHECK(linux::RtViolation::OperatorNew);
+    if (void* pointer = __libc_memalign(static_cast<size_t>(alignment), size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    if (pointer) {
+        RT_SAFETY_CHECK(linux::RtViolation::OperatorDelete);
+    }
+    __libc_free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept {
+    operator delete(pointer, alignment);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t alignment) noexcept {
+    operator delete(pointer, alignment);
+}
+
+void operator delete[](void* pointer, size_t, std::align_val_t alignment) noexcept {
+    operator delete(pointer, alignment);
+}
+
+#undef RT_SAFETY_CHECK
+
+#endif // RT_SAFETY_GUARD_INTERPOSE
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <log.hpp>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace linux {
+
+/**
+ * @brief Control panel command channel over a serial device or pty
+ *
+ * Opens a tty (a USB serial adapter, or the slave side of a pseudo-terminal
+ * for testing) in raw, non-blocking mode. drain() reads everything that has
+ * arrived in as few read() calls as possible and hands it over in chunks, the
+ * way the firmware drains its RX FIFO; write() sends responses back.
+ *
+ * Usage:
+ * @code
+ * linux::SerialCommandPort port("/dev/ttyUSB0");
+ * synth.setCommandOutput(linux::SerialCommandPort::writeToPort, &port);
+ * while (running) {
+ *     if (port.waitReadable(50)) {
+ *         port.drain([&](const char* data, size_t length) {
+ *             synth.processCommandBytes(data, length);
+ *         });
+ *     }
+ * }
+ * @endcode
+ */
+class SerialCommandPort {
+public:
+    static constexpr size_t READ_CHUNK = 512;
+    static constexpr int WRITE_TIMEOUT_MS = 100;
+
+    /**
+     * @brief Open a tty for commands
+     * @param path Device path, e.g. "/dev/ttyUSB0" or a pty slave from ptsname()
+     * @throws std::runtime_error if the device cannot be opened
+     */
+    explicit SerialCommandPort(const std::string& path) : path_(path) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (fd_ < 0) {
+            throw std::runtime_error("Cannot open command port " + path + ": " + std::strerror(errno));
+        }
+        // Raw mode: no echo, no line editing, no CR/LF translation
+        termios tio;
+        if (tcgetattr(fd_, &tio) == 0) {
+            cfmakeraw(&tio);
+            tcsetattr(fd_, TCSANOW, &tio);
+        }
+        logInfo("Command port: %s", path.c_str());
+    }
+
+    ~SerialCommandPort() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    SerialCommandPort(const SerialCommandPort&) = delete;
+    SerialCommandPort& operator=(const SerialCommandPort&) = delete;
+
+    /**
+     * @brief Wait until input is available
+     * @param timeoutMs Maximum wait (-1 waits indefinitely)
+     * @return true if there is something to drain
+     */
+    bool waitReadable(int timeoutMs) const {
+        pollfd pfd{fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, timeoutMs) <= 0) {
+            return false;
+        }
+        if (!(pfd.revents & POLLIN)) {
+            // Hung up (e.g. nothing has the pty open): poll() returns at
+            // once, so wait here instead of letting the caller spin
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Read all available input and pass it to handler(const char*, size_t)
+     *
+     * Non-blocking: returns as soon as nothing more is available.
+     *
+     * @return Number of bytes read
+     */
+    template<typename Handler>
+    size_t drain(Handler&& handler) {
+        size_t total = 0;
+        char buffer[READ_CHUNK];
+        while (true) {
+            ssize_t n = ::read(fd_, buffer, sizeof(buffer));
+            if (n > 0) {
+                handler(static_cast<const char*>(buffer), static_cast<size_t>(n));
+                total += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            // EAGAIN: drained. EIO: pty peer not open (yet). 0: end of input.
+            break;
+        }
+        return total;
+    }
+
+    /**
+     * @brief Write bytes to the port, retrying short writes
+     *
+     * Output that the peer doesn't read within WRITE_TIMEOUT_MS is dropped.
+     */
+    void write(const char* data, size_t length) {
+        while (length > 0) {
+            ssize_t n = ::write(fd_, data, length);
+            if (n > 0) {
+                data += n;
+                length -= static_cast<size_t>(n);
+            } else if (n < 0 && errno == EAGAIN) {
+                // Give a slow reader a moment, but never block for long
+                pollfd pfd{fd_, POLLOUT, 0};
+                if (::poll(&pfd, 1, WRITE_TIMEOUT_MS) <= 0) {
+                    return;
+                }
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else {
+                return;  // Peer gone; responses are dropped
+            }
+        }
+    }
+
+    /**
+     * @brief Output function for SynthApplication::setCommandOutput
+     * @param context SerialCommandPort* to write to
+     */
+    static void writeToPort(const char* data, size_t length, void* context) {
+        static_cast<SerialCommandPort*>(context)->write(data, length);
+    }
+
+    int fd() const { return fd_; }
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+    int fd_ = -1;
+};
+
+} // namespace linux
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <key_scanner.hpp>
+#include <log.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace midi {
+
+/**
+ * @brief Aggregates several key scanners into one contiguous reading vector
+ *
+ * Lets a keyboard be built from more sensors than one scanner can handle
+ * (e.g. several PIO blocks, or a PIO scanner plus an external mux board).
+ * Each sub-scanner covers a consecutive range of key indices, in the order
+ * it was added.
+ *
+ * Scheduling is per scanner: startScan() kicks off every sub-scanner at once,
+ * so hardware-driven scans run concurrently and a full sweep takes as long as
+ * the slowest scanner rather than the sum of all of them. serviceScans() lets
+ * the caller restart each scanner as soon as it finishes, so fast scanners are
+ * not held back by slow ones when oversampling.
+ *
+ * pollFrame()/waitForFrame() merge the sub-scanners' own frames, so each
+ * part of the merged frame is an untorn sub-frame. A merged frame is reported
+ * only once every sub-scanner has published a frame newer than the one it
+ * contributed to the previous merged frame; the merged sequence then advances
+ * by one.
+ *
+ * All storage is fixed at compile time; scanning and gathering never allocate
+ * and cost O(NumKeys).
+ *
+ * @tparam NumKeys Total key capacity across all sub-scanners
+ * @tparam MaxScanners Maximum number of sub-scanners
+ */
+template<uint16_t NumKeys, size_t MaxScanners = 4>
+class CompositeKeyScanner : public KeyScanner {
+public:
+    CompositeKeyScanner() = default;
+
+    // Holds references to sub-scanners; copying would alias them
+    CompositeKeyScanner(const CompositeKeyScanner&) = delete;
+    CompositeKeyScanner& operator=(const CompositeKeyScanner&) = delete;
+
+    /**
+     * @brief Append a scanner; its keys follow those of earlier scanners
+     * @param scanner Sub-scanner (must outlive this composite)
+     * @return false if the scanner or key capacity would be exceeded
+     */
+    bool addScanner(KeyScanner& scanner) {
+        uint16_t keys = scanner.getKeyCount();
+        if (scannerCount_ >= MaxScanners || keyCount_ + keys > NumKeys) {
+            logError("CompositeKeyScanner: cannot add scanner with %u keys (%u/%u keys, %u/%u scanners in use)",
+                     keys, keyCount_, NumKeys,
+                     static_cast<unsigned>(scannerCount_), static_cast<unsigned>(MaxScanners));
+            return false;
+        }
+        scanners_[scannerCount_] = &scanner;
+        offsets_[scannerCount_] = keyCount_;
+        scanCounts_[scannerCount_] = 0;
+        subSequences_[scannerCount_] = 0;
+        subTimestamps_[scannerCount_] = 0;
+        subFresh_[scannerCount_] = false;
+        scannerCount_++;
+        keyCount_ += keys;
+        return true;
+    }
+
+    /**
+     * @brief Start all sub-scanners so their scans overlap
+     */
+    void startScan() override {
+        for (size_t s = 0; s < scannerCount_; s++) {
+            scanners_[s]->startScan();
+        }
+    }
+
+    /**
+     * @brief True once every sub-scanner has finished its current scan
+     */
+    bool isScanComplete() const override {
+        for (size_t s = 0; s < scannerCount_; s++) {
+            if (!scanners_[s]->isScanComplete()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Restart each sub-scanner that has finished, independently
+     *
+     * For oversampling loops: call repeatedly; every scanner that has completed
+     * a scan gets its readings added into sums (indexed by composite key) and
+     * is restarted immediately.
+     *
+     * @param sums Per-key accumulators (length >= getKeyCount())
+     * @param counts Per-key sample counts, incremented alongside sums
+     * @return Number of sub-scanners that completed during this call
+     */
+    size_t serviceScans(uint32_t* sums, uint32_t* counts) {
+        size_t completed = 0;
+        for (size_t s = 0; s < scannerCount_; s++) {
+            KeyScanner& scanner = *scanners_[s];
+            if (!scanner.isScanComplete()) {
+                continue;
+            }
+            const uint16_t* r = scanner.getScanReadings();
+            uint16_t keys = scanner.getKeyCount();
+            uint16_t base = offsets_[s];
+            for (uint16_t i = 0; i < keys; i++) {
+                sums[base + i] += r[i];
+                counts[base + i]++;
+            }
+            scanCounts_[s]++;
+            scanner.startScan();
+            completed++;
+        }
+        return completed;
+    }
+
+    /**
+     * @brief Gather the latest readings of all sub-scanners
+     * @return Readings for getKeyCount() keys, in scanner order
+     */
+    const uint16_t* getScanReadings() const override {
+        for (size_t s = 0; s < scannerCount_; s++) {
+            const uint16_t* r = scanners_[s]->getScanReadings();
+            uint16_t keys = scanners_[s]->getKeyCount();
+            uint16_t base = offsets_[s];
+            for (uint16_t i = 0; i < keys; i++) {
+                readings_[base + i] = r[i];
+            }
+        }
+        return readings_;
+    }
+
+    /**
+     * @brief Merge the sub-scanners' newest frames
+     *
+     * Polls every sub-scanner and copies each new sub-frame into the merged
+     * readings. Reports a new merged frame once every sub-scanner has
+     * contributed a new sub-frame since the last one.
+     */
+    bool pollFrame(uint32_t sinceSequence, ScanFrame& frame) override {
+        for (size_t s = 0; s < scannerCount_; s++) {
+            ScanFrame sub;
+            if (scanners_[s]->pollFrame(subSequences_[s], sub)) {
+                mergeSubFrame(s, sub);
+            }
+        }
+        return takeMergedFrame(sinceSequence, frame);
+    }
+
+    /**
+     * @brief Wait for every sub-scanner still missing a new frame, then merge
+     *
+     * Sub-scanners are waited on one after another, each for up to timeoutUs.
+     * They scan concurrently, so later waits usually return at once.
+     */
+    bool waitForFrame(uint32_t sinceSequence, ScanFrame& frame, uint32_t timeoutUs) override {
+        for (size_t s = 0; s < scannerCount_; s++) {
+            ScanFrame sub;
+            bool got = subFresh_[s]
+                ? scanners_[s]->pollFrame(subSequences_[s], sub)
+                : scanners_[s]->waitForFrame(subSequences_[s], sub, timeoutUs);
+            if (got) {
+                mergeSubFrame(s, sub);
+            }
+        }
+        return takeMergedFrame(sinceSequence, frame);
+    }
+
+    uint16_t getKeyCount() const override {
+        return keyCount_;
+    }
+
+    size_t getScannerCount() const { return scannerCount_; }
+
+    /**
+     * @brief Number of scans completed by one sub-scanner via serviceScans()
+     */
+    uint32_t getScanCount(size_t scannerIndex) const {
+        return scannerIndex < scannerCount_ ? scanCounts_[scannerIndex] : 0;
+    }
+
+private:
+    void mergeSubFrame(size_t s, const ScanFrame& sub) {
+        uint16_t keys = scanners_[s]->getKeyCount();
+        if (sub.keyCount < keys) {
+            keys = sub.keyCount;
+        }
+        uint16_t base = offsets_[s];
+        for (uint16_t i = 0; i < keys; i++) {
+            readings_[base + i] = sub.readings[i];
+        }
+        subSequences_[s] = sub.sequence;
+        subTimestamps_[s] = sub.timestampUs;
+        subFresh_[s] = true;
+    }
+
+    bool takeMergedFrame(uint32_t sinceSequence, ScanFrame& frame) {
+        if (scannerCount_ == 0) {
+            return false;
+        }
+        bool complete = true;
+        for (size_t s = 0; s < scannerCount_; s++) {
+            complete = complete && subFresh_[s];
+        }
+        if (complete) {
+            // The merged frame is finished when its last sub-frame is
+            uint64_t latest = 0;
+            for (size_t s = 0; s < scannerCount_; s++) {
+                subFresh_[s] = false;
+                if (subTimestamps_[s] > latest) {
+                    latest = subTimestamps_[s];
+                }
+            }
+            mergedSequence_++;
+            mergedTimestampUs_ = latest;
+        }
+        // Wrap-safe "newer than" comparison, as in ScanFrameBuffer
+        if (mergedSequence_ == 0 || static_cast<int32_t>(mergedSequence_ - sinceSequence) <= 0) {
+            return false;
+        }
+        frame.readings = readings_;
+        frame.keyCount = keyCount_;
+        frame.sequence = mergedSequence_;
+        frame.timestampUs = mergedTimestampUs_;
+        return true;
+    }
+
+    KeyScanner* scanners_[MaxScanners] = {};
+    uint16_t offsets_[MaxScanners] = {};
+    uint32_t scanCounts_[MaxScanners] = {};
+    size_t scannerCount_ = 0;
+    uint16_t keyCount_ = 0;
+    uint32_t subSequences_[MaxScanners] = {};   // Last sub-frame merged, per scanner
+    uint64_t subTimestamps_[MaxScanners] = {};
+    bool subFresh_[MaxScanners] = {};           // Sub-frame merged since the last merged frame
+    uint32_t mergedSequence_ = 0;
+    uint64_t mergedTimestampUs_ = 0;
+    mutable uint16_t readings_[NumKeys] = {};  // Mutable for gathering in const getter
+};
+
+} // namespace midi
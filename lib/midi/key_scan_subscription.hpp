@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+namespace midi {
+
+/**
+ * @brief Host request for delta key scan telemetry
+ *
+ * While a subscription is active the keyboard controller stops sending the
+ * full KeyScanStats every scan. Instead, at most maxRateHz times per second
+ * it sends only the subscribed keys whose reading moved by more than
+ * readingDeadband, or whose note state or aftertouch changed, since they were
+ * last sent. Every keyframeInterval-th telemetry slot is a keyframe that
+ * carries all subscribed keys, so a host that missed frames resynchronizes.
+ *
+ * With no subscription (enabled = false) the controller sends full frames
+ * every scan, as before.
+ *
+ * The rate cap is timed by the scan timestamps, or by the controller's clock
+ * (MidiKeyboardController::setClock()) for scans that have none.
+ */
+struct KeyScanSubscription {
+    bool enabled = false;
+    uint16_t firstKey = 0;            // First subscribed key index
+    uint16_t keyCount = 0xFFFF;       // Subscribed keys from firstKey (clamped to the keyboard)
+    float maxRateHz = 30.0f;          // Telemetry frame rate cap; 0 = every scan
+    uint16_t readingDeadband = 8;     // Reading change that counts as a change
+    uint16_t keyframeInterval = 30;   // Telemetry slots between keyframes (0 = never)
+};
+
+} // namespace midi
@@ -4,9 +4,22 @@
 
 namespace midi {
 
+/**
+ * @brief One complete, published key scan
+ *
+ * Readings stay valid until the consumer's next pollFrame()/waitForFrame()
+ * call on the same scanner.
+ */
+struct ScanFrame {
+    const uint16_t* readings = nullptr;  // keyCount raw sensor values
+    uint16_t keyCount = 0;
+    uint32_t sequence = 0;               // Increments by one per completed scan; 0 = none
+    uint64_t timestampUs = 0;            // Scan completion time (scanner's clock)
+};
+
 /**
  * @brief Platform-agnostic interface for capacitive touch key scanning
- * 
+ *
  * Implementations provide hardware-specific scanning logic and return
  * raw sensor readings. The MIDI keyboard controller converts these
  * readings into musical events.
@@ -14,20 +27,77 @@ namespace midi {
 class KeyScanner {
 public:
     virtual ~KeyScanner() = default;
-    
+
     /**
      * @brief Get the current scan readings for all keys
      * @return Pointer to array of raw sensor values (higher = more capacitance)
      * @note The pointer remains valid until the next scan() call or object destruction
      * @note Array size is getKeyCount()
+     * @note Scanners that fill readings from another task or DMA may be mid-update;
+     *       prefer pollFrame() where tearing matters
      */
     virtual const uint16_t* getScanReadings() const = 0;
-    
+
     /**
      * @brief Get the number of keys supported by this scanner
      * @return Number of keys
      */
-    virtual uint8_t getKeyCount() const = 0;
+    virtual uint16_t getKeyCount() const = 0;
+
+    /**
+     * @brief Start a new scan (non-blocking)
+     *
+     * Scanners that are triggered explicitly (e.g. a DMA-driven scan sequence)
+     * override this. Free-running scanners that update in the background can
+     * keep the default no-op.
+     */
+    virtual void startScan() {}
+
+    /**
+     * @brief Check whether the scan started by startScan() has finished
+     *
+     * Free-running scanners always report true.
+     */
+    virtual bool isScanComplete() const { return true; }
+
+    /**
+     * @brief Get the newest completed frame if it is newer than sinceSequence
+     *
+     * Scanners that scan in the background publish whole frames through a
+     * ScanFrameBuffer, so the frame returned is never torn and each one is
+     * reported exactly once. A gap in sequence numbers means frames were
+     * skipped.
+     *
+     * The default suits scanners whose readings are only updated by the
+     * caller: it wraps getScanReadings() and always reports a new frame.
+     *
+     * @param sinceSequence Sequence of the last frame processed (0 for none)
+     * @param frame Filled in when a newer frame is available
+     * @return true if frame was filled
+     */
+    virtual bool pollFrame(uint32_t sinceSequence, ScanFrame& frame) {
+        frame.readings = getScanReadings();
+        frame.keyCount = getKeyCount();
+        frame.sequence = sinceSequence + 1;
+        frame.timestampUs = 0;
+        return true;
+    }
+
+    /**
+     * @brief Block until a frame newer than sinceSequence is available
+     *
+     * The default just polls once; scanners with a background producer
+     * override this to sleep until the next frame is published.
+     *
+     * @param sinceSequence Sequence of the last frame processed (0 for none)
+     * @param frame Filled in when a newer frame is available
+     * @param timeoutUs Maximum time to wait
+     * @return true if frame was filled, false on timeout
+     */
+    virtual bool waitForFrame(uint32_t sinceSequence, ScanFrame& frame, uint32_t timeoutUs) {
+        (void)timeoutUs;
+        return pollFrame(sinceSequence, frame);
+    }
 };
 
 } // namespace midi
@@ -1,14 +1,16 @@
 #pragma once
 
 #include <key_scanner.hpp>
+#include <key_scan_subscription.hpp>
 #include <telemetry_sink.hpp>
-#include <functional>
+#include <telemetry_frame.hpp>
+#include <json_writer.hpp>
+#include <inline_function.hpp>
 #include <vector>
 #include <memory>
 #include <cstdint>
 #include <cmath>
 #include <log.hpp>
-#include <json.hpp>
 
 namespace midi {
 
@@ -18,13 +20,21 @@ namespace midi {
  * Contains per-key readings, baselines, ratios, and state information
  * for visualization and analysis.
  * 
+ * A delta frame (isDelta, sent under a KeyScanSubscription) carries only
+ * deltaCount keys: the per-key arrays are packed, entry j describing key
+ * deltaKey(j). A keyframe carries the whole subscribed range from
+ * deltaFirstKey; other delta frames list up to maxDeltaKeys changed keys in
+ * deltaKeys, so the index list doesn't grow the struct the telemetry ring
+ * copies every block. Full frames use every entry, indexed by key.
+ * 
  * Template parameter allows compile-time optimization with stack arrays.
  * 
  * @tparam NumKeys Number of keys to hold stats for
  */
-template<uint8_t NumKeys>
+template<uint16_t NumKeys>
 struct KeyScanStats {
-    static constexpr uint8_t keyCount = NumKeys;
+    static constexpr uint16_t keyCount = NumKeys;
+    static constexpr uint16_t maxDeltaKeys = NumKeys < 16 ? NumKeys : 16;
     uint16_t readings[NumKeys];
     float baselines[NumKeys];
     float ratios[NumKeys];
@@ -39,6 +49,13 @@ struct KeyScanStats {
     bool isCalibrated;
     uint16_t calibrationCount;
     
+    // Delta framing (subscription mode only)
+    bool isDelta;
+    bool isKeyframe;                // Delta frame carrying every subscribed key
+    uint16_t deltaCount;
+    uint16_t deltaFirstKey;         // Keyframes: key of entry 0
+    uint16_t deltaKeys[maxDeltaKeys];   // Other delta frames: key of each entry
+    
     /**
      * @brief Default constructor - initializes all arrays to zero
      */
@@ -52,27 +69,105 @@ struct KeyScanStats {
         , noteOffThreshold(0.0f)
         , isCalibrated(false)
         , calibrationCount(0)
+        , isDelta(false)
+        , isKeyframe(false)
+        , deltaCount(0)
+        , deltaFirstKey(0)
+        , deltaKeys{}
     {}
+    
+    /**
+     * @brief Key index described by packed entry j of a delta frame
+     */
+    uint16_t deltaKey(uint16_t j) const {
+        return isKeyframe ? static_cast<uint16_t>(deltaFirstKey + j) : deltaKeys[j];
+    }
 };
 
 /**
  * @brief JSON serialization for KeyScanStats
+ *
+ * Streams straight into the writer (no DOM). Keys are in sorted order so the
+ * output matches the nlohmann::json form that tools/js expects byte for byte.
  */
-template<uint8_t NumKeys>
-inline void to_json(nlohmann::json& j, const KeyScanStats<NumKeys>& s) {
-    j = nlohmann::json{
-        {"type", "keyScan"},
-        {"keyCount", s.keyCount},
-        {"isCalibrated", s.isCalibrated},
-        {"calibrationCount", s.calibrationCount},
-        {"noteOnThreshold", s.noteOnThreshold},
-        {"noteOffThreshold", s.noteOffThreshold},
-        {"readings", std::vector<uint16_t>(s.readings, s.readings + NumKeys)},
-        {"baselines", std::vector<float>(s.baselines, s.baselines + NumKeys)},
-        {"ratios", std::vector<float>(s.ratios, s.ratios + NumKeys)},
-        {"noteStates", std::vector<bool>(s.noteStates, s.noteStates + NumKeys)},
-        {"aftertouchValues", std::vector<uint8_t>(s.aftertouchValues, s.aftertouchValues + NumKeys)}
-    };
+template<uint16_t NumKeys>
+inline void to_json(features::JsonWriter& w, const KeyScanStats<NumKeys>& s) {
+    if (s.isDelta) {
+        // {"type":"keyScanDelta", "keys":[...], per-key arrays parallel to keys}
+        w.beginObject();
+        w.arrayField("aftertouchValues", s.aftertouchValues, s.deltaCount);
+        w.arrayField("baselines", s.baselines, s.deltaCount);
+        w.field("calibrationCount", s.calibrationCount);
+        w.field("isCalibrated", s.isCalibrated);
+        w.field("keyCount", s.keyCount);
+        w.field("keyframe", s.isKeyframe);
+        w.key("keys").beginArray();
+        for (uint16_t j = 0; j < s.deltaCount; j++) w.value(s.deltaKey(j));
+        w.endArray();
+        w.field("noteOffThreshold", s.noteOffThreshold);
+        w.field("noteOnThreshold", s.noteOnThreshold);
+        w.arrayField("noteStates", s.noteStates, s.deltaCount);
+        w.arrayField("ratios", s.ratios, s.deltaCount);
+        w.arrayField("readings", s.readings, s.deltaCount);
+        w.field("type", "keyScanDelta");
+        w.endObject();
+        return;
+    }
+    w.beginObject();
+    w.arrayField("aftertouchValues", s.aftertouchValues, NumKeys);
+    w.arrayField("baselines", s.baselines, NumKeys);
+    w.field("calibrationCount", s.calibrationCount);
+    w.field("isCalibrated", s.isCalibrated);
+    w.field("keyCount", s.keyCount);
+    w.field("noteOffThreshold", s.noteOffThreshold);
+    w.field("noteOnThreshold", s.noteOnThreshold);
+    w.arrayField("noteStates", s.noteStates, NumKeys);
+    w.arrayField("ratios", s.ratios, NumKeys);
+    w.arrayField("readings", s.readings, NumKeys);
+    w.field("type", "keyScan");
+    w.endObject();
+}
+
+/**
+ * @brief Binary telemetry serialization for KeyScanStats
+ *
+ * Same fields as to_json(), packed in declaration order: keyCount (u16),
+ * isCalibrated (u8), calibrationCount (u16), noteOnThreshold and
+ * noteOffThreshold (f32), then readings (u16), baselines (f32), ratios (f32),
+ * noteStates (u8) and aftertouchValues (u8), keyCount entries each.
+ */
+template<uint16_t NumKeys>
+inline void to_binary(features::TelemetryFrameWriter& w, const KeyScanStats<NumKeys>& s) {
+    if (s.isDelta) {
+        // Header as for a full frame plus keyframe (u8) and deltaCount (u16),
+        // then deltaCount key indices (u16) followed by the packed arrays
+        w.begin(features::TelemetryType::KeyScanDelta);
+        w.putU16(s.keyCount);
+        w.putBool(s.isCalibrated);
+        w.putU16(s.calibrationCount);
+        w.putF32(s.noteOnThreshold);
+        w.putF32(s.noteOffThreshold);
+        w.putBool(s.isKeyframe);
+        w.putU16(s.deltaCount);
+        for (uint16_t i = 0; i < s.deltaCount; i++) w.putU16(s.deltaKey(i));
+        for (uint16_t i = 0; i < s.deltaCount; i++) w.putU16(s.readings[i]);
+        for (uint16_t i = 0; i < s.deltaCount; i++) w.putF32(s.baselines[i]);
+        for (uint16_t i = 0; i < s.deltaCount; i++) w.putF32(s.ratios[i]);
+        for (uint16_t i = 0; i < s.deltaCount; i++) w.putBool(s.noteStates[i]);
+        for (uint16_t i = 0; i < s.deltaCount; i++) w.putU8(s.aftertouchValues[i]);
+        return;
+    }
+    w.begin(features::TelemetryType::KeyScan);
+    w.putU16(s.keyCount);
+    w.putBool(s.isCalibrated);
+    w.putU16(s.calibrationCount);
+    w.putF32(s.noteOnThreshold);
+    w.putF32(s.noteOffThreshold);
+    for (uint16_t i = 0; i < NumKeys; i++) w.putU16(s.readings[i]);
+    for (uint16_t i = 0; i < NumKeys; i++) w.putF32(s.baselines[i]);
+    for (uint16_t i = 0; i < NumKeys; i++) w.putF32(s.ratios[i]);
+    for (uint16_t i = 0; i < NumKeys; i++) w.putBool(s.noteStates[i]);
+    for (uint16_t i = 0; i < NumKeys; i++) w.putU8(s.aftertouchValues[i]);
 }
 
 /**
@@ -84,15 +179,29 @@ inline void to_json(nlohmann::json& j, const KeyScanStats<NumKeys>& s) {
  * - Polyphonic Aftertouch based on continuous pressure sensing
  * - Baseline tracking that freezes during touch for maximum aftertouch expression
  * - Configurable transposition and velocity
+ * - Per-key note map (defaults to consecutive notes from the base note)
+ * 
+ * Keys without a MIDI note (UNMAPPED in the map, or base note plus offset
+ * above 127) still track their sensor state but send no MIDI. The default map
+ * leaves keys 128 and up unmapped rather than wrapping them onto low notes.
  * 
  * Template parameter allows compile-time optimization with stack arrays.
+ * Key counts are 16-bit so one controller can cover a full 88-key keyboard or
+ * several zones fed by a CompositeKeyScanner.
  * 
  * @tparam NumKeys Number of keys (must match scanner configuration)
  */
-template<uint8_t NumKeys>
+template<uint16_t NumKeys>
 class MidiKeyboardController {
 public:
+    using TelemetrySinkT = features::TelemetrySink<KeyScanStats<NumKeys>>;
+    /** @brief Receives the generated MIDI bytes; stored inline, so captures are limited */
+    using MidiByteCallback = features::InlineFunction<void(uint8_t), 4 * sizeof(void*)>;
+    /** @brief Monotonic clock in microseconds */
+    using ClockFn = uint64_t (*)();
+
     static constexpr uint16_t CALIBRATION_SCANS = 10;
+    static constexpr uint8_t UNMAPPED = 0xFF;          // Note map entry / note of a key that plays nothing
     static constexpr float NOTE_ON_THRESHOLD = 2.0f;    // Ratio above baseline for note on
     static constexpr float NOTE_OFF_THRESHOLD = 1.5f;   // Ratio above baseline for note off (hysteresis)
     // Runtime-tunable aftertouch input range (defaults; adjustable via the control panel)
@@ -112,14 +221,41 @@ public:
      */
     MidiKeyboardController(
         KeyScanner& scanner,
-        std::function<void(uint8_t)> midiCallback,
-        std::unique_ptr<features::TelemetrySink<KeyScanStats<NumKeys>>> telemetrySink,
+        MidiByteCallback midiCallback,
+        std::unique_ptr<TelemetrySinkT> telemetrySink,
         uint8_t baseNote = 60,
         uint8_t fixedVelocity = 64
+    )
+        : MidiKeyboardController(scanner, std::move(midiCallback), telemetrySink.get(), baseNote, fixedVelocity)
+    {
+        ownedTelemetrySink_ = std::move(telemetrySink);
+    }
+
+    /**
+     * @brief Construct with a telemetry sink owned elsewhere (e.g. in static storage)
+     * @param telemetrySink Telemetry output; must outlive this controller
+     */
+    MidiKeyboardController(
+        KeyScanner& scanner,
+        MidiByteCallback midiCallback,
+        TelemetrySinkT& telemetrySink,
+        uint8_t baseNote = 60,
+        uint8_t fixedVelocity = 64
+    )
+        : MidiKeyboardController(scanner, std::move(midiCallback), &telemetrySink, baseNote, fixedVelocity)
+    {}
+
+private:
+    MidiKeyboardController(
+        KeyScanner& scanner,
+        MidiByteCallback midiCallback,
+        TelemetrySinkT* telemetrySink,
+        uint8_t baseNote,
+        uint8_t fixedVelocity
     )
         : scanner_(scanner)
         , midiCallback_(std::move(midiCallback))
-        , telemetrySink_(std::move(telemetrySink))
+        , telemetrySink_(telemetrySink)
         , baseNote_(baseNote)
         , fixedVelocity_(fixedVelocity)
         , calibrationCount_(0)
@@ -128,8 +264,12 @@ public:
         , baselines_{}
         , keyStates_{}
         , lastAftertouch_{}
+        , soundingNotes_{}
         , telemetryEnabled_(false)
     {
+        for (uint16_t i = 0; i < NumKeys; i++) {
+            noteOffsets_[i] = i < 128 ? static_cast<uint8_t>(i) : UNMAPPED;
+        }
         if (!midiCallback_) {
             logFatal("MidiKeyboardController: midiCallback is required");
         }
@@ -138,16 +278,44 @@ public:
         }
         logInfo("MIDI keyboard controller initialized: %d keys, base note %d, velocity %d",
                 NumKeys, baseNote_, fixedVelocity_);
+        if (NumKeys > 128) {
+            logInfo("Keys 128-%d are unmapped until setNoteMap()/setKeyNote() assigns them", NumKeys - 1);
+        }
     }
+
+public:
     
     /**
-     * @brief Process current scanner readings and generate MIDI events
+     * @brief Process the scanner's newest frame and generate MIDI events
+     * 
+     * Call this periodically to convert sensor readings into MIDI messages
+     * sent via the callback. Each published frame is processed exactly once:
+     * calls between frames return without doing anything, so it is safe to
+     * call faster than the scan rate (e.g. once per audio buffer).
      * 
-     * Call this periodically (e.g., at scan rate) to convert sensor readings
-     * into MIDI messages sent via the callback.
+     * @return true if a new frame was processed
+     */
+    bool processScan() {
+        ScanFrame frame;
+        if (!scanner_.pollFrame(lastFrameSequence_, frame)) {
+            return false;
+        }
+        processFrame(frame);
+        return true;
+    }
+
+    /**
+     * @brief Wait for the scanner's next frame, then process it
+     * @param timeoutUs Maximum time to wait for a new frame
+     * @return true if a new frame was processed, false on timeout
      */
-    void processScan() {
-        processScan(scanner_.getScanReadings());
+    bool waitAndProcessScan(uint32_t timeoutUs) {
+        ScanFrame frame;
+        if (!scanner_.waitForFrame(lastFrameSequence_, frame, timeoutUs)) {
+            return false;
+        }
+        processFrame(frame);
+        return true;
     }
 
     /**
@@ -158,11 +326,14 @@ public:
      * mains hum before note-on/aftertouch detection.
      *
      * @param readings Per-key readings (length == NumKeys)
+     * @param timestampUs Scan time in microseconds, used to rate-limit
+     *        subscribed telemetry (0 = unknown; the clock set with setClock()
+     *        is read instead, and without one every scan is eligible)
      */
-    void processScan(const uint16_t* readings) {
+    void processScan(const uint16_t* readings, uint64_t timestampUs = 0) {
         // Calibration phase: accumulate baseline values
         if (!isCalibrated_) {
-            for (uint8_t i = 0; i < NumKeys; i++) {
+            for (uint16_t i = 0; i < NumKeys; i++) {
                 calibrationSums_[i] += readings[i];
             }
             
@@ -170,7 +341,7 @@ public:
             
             if (calibrationCount_ >= CALIBRATION_SCANS) {
                 // Finalize calibration with minimum baseline enforcement
-                for (uint8_t i = 0; i < NumKeys; i++) {
+                for (uint16_t i = 0; i < NumKeys; i++) {
                     float avgBaseline = static_cast<float>(calibrationSums_[i]) / CALIBRATION_SCANS;
                     baselines_[i] = std::max(avgBaseline, MIN_BASELINE);
                 }
@@ -181,19 +352,21 @@ public:
         }
         
         // Normal operation: process each key
-        for (uint8_t i = 0; i < NumKeys; i++) {
+        for (uint16_t i = 0; i < NumKeys; i++) {
             processKey(i, readings[i]);
         }
         
         // Send telemetry if enabled
-        if (telemetryEnabled_) {
+        if (telemetryEnabled_ && subscription_.enabled) {
+            sendDeltaTelemetry(readings, timestampUs);
+        } else if (telemetryEnabled_) {
             KeyScanStats<NumKeys> telemetry;
             telemetry.isCalibrated = true;
             telemetry.calibrationCount = CALIBRATION_SCANS;
             telemetry.noteOnThreshold = NOTE_ON_THRESHOLD;
             telemetry.noteOffThreshold = NOTE_OFF_THRESHOLD;
             
-            for (uint8_t i = 0; i < NumKeys; i++) {
+            for (uint16_t i = 0; i < NumKeys; i++) {
                 telemetry.readings[i] = readings[i];
                 telemetry.baselines[i] = baselines_[i];
                 telemetry.ratios[i] = (baselines_[i] > 0) ? (readings[i] / baselines_[i]) : 0.0f;  // Ratio of reading to baseline
@@ -215,11 +388,50 @@ public:
     
     /**
      * @brief Set the base MIDI note (transposition)
-     * @param baseNote MIDI note number for first key
+     * @param baseNote MIDI note number added to every key's note offset
+     *
+     * Keys that are currently held keep sounding (and release) on the note
+     * they started with; the new base note applies from their next press.
      */
     void setBaseNote(uint8_t baseNote) {
         baseNote_ = baseNote & 0x7F;
     }
+
+    /**
+     * @brief Replace the per-key note map
+     * @param offsets NumKeys note offsets, added to the base note for each key
+     *        (UNMAPPED for keys that play nothing)
+     *
+     * The default map is consecutive (key i plays baseNote + i, keys from 128
+     * unmapped). A custom map supports split/layered zones, alternative
+     * layouts, or skipping sensors.
+     */
+    void setNoteMap(const uint8_t* offsets) {
+        for (uint16_t i = 0; i < NumKeys; i++) {
+            noteOffsets_[i] = offsets[i] == UNMAPPED ? UNMAPPED : offsets[i] & 0x7F;
+        }
+    }
+
+    /**
+     * @brief Set the note offset (from the base note) of a single key, or UNMAPPED
+     */
+    void setKeyNote(uint16_t keyIndex, uint8_t offset) {
+        if (keyIndex < NumKeys) {
+            noteOffsets_[keyIndex] = offset == UNMAPPED ? UNMAPPED : offset & 0x7F;
+        }
+    }
+
+    /**
+     * @brief MIDI note a key plays under the current base note and note map
+     * @return UNMAPPED if the key is unmapped or its note would be above 127
+     */
+    uint8_t getKeyNote(uint16_t keyIndex) const {
+        const uint8_t offset = noteOffsets_[keyIndex];
+        if (offset == UNMAPPED || baseNote_ + offset > 127) {
+            return UNMAPPED;
+        }
+        return static_cast<uint8_t>(baseNote_ + offset);
+    }
     
     /**
      * @brief Check if calibration is complete
@@ -262,10 +474,56 @@ public:
     float getAftertouchMinRatio() const { return aftertouchMinRatio_; }
     float getAftertouchMaxRatio() const { return aftertouchMaxRatio_; }
 
+    /**
+     * @brief Switch between full-frame and subscribed delta telemetry
+     *
+     * Takes effect on the next scan. A new subscription always starts with
+     * a keyframe.
+     */
+    void setTelemetrySubscription(const KeyScanSubscription& subscription) {
+        subscription_ = subscription;
+        if (subscription_.firstKey > NumKeys) {
+            subscription_.firstKey = NumKeys;
+        }
+        if (subscription_.keyCount > NumKeys - subscription_.firstKey) {
+            subscription_.keyCount = NumKeys - subscription_.firstKey;
+        }
+        nextTelemetryUs_ = 0;
+        slotsSinceKeyframe_ = 0;
+        keyframePending_ = true;
+    }
+
+    const KeyScanSubscription& getTelemetrySubscription() const { return subscription_; }
+
+    /**
+     * @brief Clock for rate-limiting subscribed telemetry when scans carry no timestamp
+     *
+     * Frames from scanners that use the default KeyScanner::pollFrame(), and
+     * readings passed to processScan() without a timestamp, have no scan
+     * time. With a clock set, the controller reads it instead; with neither,
+     * maxRateHz can't be applied and every scan may send a delta.
+     *
+     * @param microseconds Monotonic microsecond clock (nullptr to unset)
+     */
+    void setClock(ClockFn microseconds) { clock_ = microseconds; }
+
+    /**
+     * @brief Sequence number of the last frame handled by processScan()
+     */
+    uint32_t getLastFrameSequence() const { return lastFrameSequence_; }
+
+    /**
+     * @brief Frames the scanner published that were never processed
+     *
+     * Grows when processScan() is called slower than the scan rate.
+     */
+    uint32_t getSkippedFrameCount() const { return skippedFrames_; }
+
 private:
     KeyScanner& scanner_;
-    std::function<void(uint8_t)> midiCallback_;
-    std::unique_ptr<features::TelemetrySink<KeyScanStats<NumKeys>>> telemetrySink_;
+    MidiByteCallback midiCallback_;
+    std::unique_ptr<TelemetrySinkT> ownedTelemetrySink_;
+    TelemetrySinkT* telemetrySink_;
     uint8_t baseNote_;
     uint8_t fixedVelocity_;
     
@@ -278,18 +536,129 @@ private:
     float baselines_[NumKeys];       // Current baseline (ambient) value
     bool keyStates_[NumKeys];        // Note on/off state
     uint8_t lastAftertouch_[NumKeys]; // Last sent aftertouch value
+    uint8_t noteOffsets_[NumKeys];   // Note map: offset from baseNote_ per key
+    uint8_t soundingNotes_[NumKeys]; // Note sent at note-on, used until note-off
     
     // Telemetry
     bool telemetryEnabled_;
 
+    // Subscribed delta telemetry: last values sent per key
+    KeyScanSubscription subscription_;
+    uint16_t sentReadings_[NumKeys] = {};
+    bool sentNoteStates_[NumKeys] = {};
+    uint8_t sentAftertouch_[NumKeys] = {};
+    uint64_t nextTelemetryUs_ = 0;
+    ClockFn clock_ = nullptr;
+    uint16_t slotsSinceKeyframe_ = 0;
+    bool keyframePending_ = true;
+
+    // Frame tracking for processScan()
+    uint32_t lastFrameSequence_ = 0;
+    uint32_t skippedFrames_ = 0;
+
     // Runtime-tunable aftertouch input range (set from the control panel)
     float aftertouchMinRatio_ = DEFAULT_AFTERTOUCH_MIN_RATIO;
     float aftertouchMaxRatio_ = DEFAULT_AFTERTOUCH_MAX_RATIO;
 
+    /**
+     * @brief Send the subscribed keys that changed since they were last sent
+     *
+     * Keys are compared against the values last sent (not the previous scan),
+     * so slow drifts still cross the deadband eventually and nothing is lost
+     * to rate limiting.
+     */
+    void sendDeltaTelemetry(const uint16_t* readings, uint64_t timestampUs) {
+        if (timestampUs == 0 && clock_) {
+            timestampUs = clock_();
+        }
+        if (timestampUs != 0 && subscription_.maxRateHz > 0.0f) {
+            if (nextTelemetryUs_ != 0 && timestampUs < nextTelemetryUs_) {
+                return;
+            }
+            nextTelemetryUs_ = timestampUs + static_cast<uint64_t>(1e6f / subscription_.maxRateHz);
+        }
+
+        bool keyframe = keyframePending_;
+        if (subscription_.keyframeInterval > 0 && ++slotsSinceKeyframe_ >= subscription_.keyframeInterval) {
+            keyframe = true;
+        }
+
+        KeyScanStats<NumKeys> telemetry;
+        telemetry.isDelta = true;
+        telemetry.isCalibrated = true;
+        telemetry.calibrationCount = CALIBRATION_SCANS;
+        telemetry.noteOnThreshold = NOTE_ON_THRESHOLD;
+        telemetry.noteOffThreshold = NOTE_OFF_THRESHOLD;
+
+        const uint16_t end = subscription_.firstKey + subscription_.keyCount;
+        if (!keyframe) {
+            // More changes than a delta frame can list: send a keyframe instead
+            uint16_t changes = 0;
+            for (uint16_t i = subscription_.firstKey; i < end && !keyframe; i++) {
+                if (keyChangedSinceSent(i, readings[i]) && ++changes > KeyScanStats<NumKeys>::maxDeltaKeys) {
+                    keyframe = true;
+                }
+            }
+        }
+        telemetry.isKeyframe = keyframe;
+        telemetry.deltaFirstKey = subscription_.firstKey;
+
+        uint16_t n = 0;
+        for (uint16_t i = subscription_.firstKey; i < end; i++) {
+            if (keyframe) {
+                // Entries follow the subscribed range; no index list needed
+            } else if (keyChangedSinceSent(i, readings[i])) {
+                telemetry.deltaKeys[n] = i;
+            } else {
+                continue;
+            }
+            telemetry.readings[n] = readings[i];
+            telemetry.baselines[n] = baselines_[i];
+            telemetry.ratios[n] = (baselines_[i] > 0) ? (readings[i] / baselines_[i]) : 0.0f;
+            telemetry.noteStates[n] = keyStates_[i];
+            telemetry.aftertouchValues[n] = lastAftertouch_[i];
+            sentReadings_[i] = readings[i];
+            sentNoteStates_[i] = keyStates_[i];
+            sentAftertouch_[i] = lastAftertouch_[i];
+            n++;
+        }
+        telemetry.deltaCount = n;
+
+        if (keyframe) {
+            keyframePending_ = false;
+            slotsSinceKeyframe_ = 0;
+        } else if (n == 0) {
+            return;  // Nothing changed: send nothing
+        }
+        telemetrySink_->sendTelemetry(telemetry);
+    }
+
+    /**
+     * @brief Whether a key moved past the deadband, or changed state, since it was last sent
+     */
+    bool keyChangedSinceSent(uint16_t key, uint16_t reading) const {
+        int diff = static_cast<int>(reading) - static_cast<int>(sentReadings_[key]);
+        return diff > subscription_.readingDeadband
+            || -diff > subscription_.readingDeadband
+            || keyStates_[key] != sentNoteStates_[key]
+            || lastAftertouch_[key] != sentAftertouch_[key];
+    }
+
+    /**
+     * @brief Process one scanner frame, counting any frames skipped before it
+     */
+    void processFrame(const ScanFrame& frame) {
+        if (lastFrameSequence_ != 0 && frame.sequence - lastFrameSequence_ > 1) {
+            skippedFrames_ += frame.sequence - lastFrameSequence_ - 1;
+        }
+        lastFrameSequence_ = frame.sequence;
+        processScan(frame.readings, frame.timestampUs);
+    }
+
     /**
      * @brief Process a single key and generate MIDI events
      */
-    void processKey(uint8_t keyIndex, uint16_t reading) {
+    void processKey(uint16_t keyIndex, uint16_t reading) {
         float baseline = baselines_[keyIndex];
         
         // Ensure baseline is never too low to prevent ratio issues
@@ -300,14 +669,17 @@ private:
         
         float ratio = reading / baseline;  // Ratio of current reading to baseline
         
-        uint8_t midiNote = baseNote_ + keyIndex;
-        
         // State machine: Note Off → Note On
         if (!keyStates_[keyIndex]) {
             if (ratio >= NOTE_ON_THRESHOLD) {
-                // Note On
+                // Note On: latch the mapped note so a base note or map change
+                // while the key is held can't strand a hanging note
+                uint8_t midiNote = getKeyNote(keyIndex);
+                soundingNotes_[keyIndex] = midiNote;
                 keyStates_[keyIndex] = true;
-                sendNoteOn(midiNote, fixedVelocity_);
+                if (midiNote != UNMAPPED) {
+                    sendNoteOn(midiNote, fixedVelocity_);
+                }
                 lastAftertouch_[keyIndex] = 0;
                 
                 // Baseline tracking freezes while key is touched
@@ -321,10 +693,13 @@ private:
         }
         // State machine: Note On → Note Off or Aftertouch
         else {
+            uint8_t midiNote = soundingNotes_[keyIndex];
             if (ratio < NOTE_OFF_THRESHOLD) {
                 // Note Off
                 keyStates_[keyIndex] = false;
-                sendNoteOff(midiNote);
+                if (midiNote != UNMAPPED) {
+                    sendNoteOff(midiNote);
+                }
                 
                 // Resume baseline tracking with minimum enforcement
                 baselines_[keyIndex] = std::max(
@@ -346,7 +721,9 @@ private:
                 // that a deadband isn't needed - and a deadband strands the value
                 // a couple of LSB above 0 until the key fully releases.
                 if (aftertouch != lastAftertouch_[keyIndex]) {
-                    sendPolyAftertouch(midiNote, aftertouch);
+                    if (midiNote != UNMAPPED) {
+                        sendPolyAftertouch(midiNote, aftertouch);
+                    }
                     lastAftertouch_[keyIndex] = aftertouch;
                 }
             }
@@ -2,7 +2,9 @@
 
 #include <biquad_filter.hpp>
 #include <sawtooth_synth.hpp>
+#include <synth_params.hpp>
 #include <voice.hpp>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <json.hpp>  // nlohmann/json single-header
@@ -16,51 +18,49 @@ using VoiceIterator = std::function<void(VoiceVisitor)>;
 /**
  * @brief Program data structure for synth presets
  * 
+ * Holds one value per entry of synth::SYNTH_PARAMS, indexed in table order.
  * Serialization to/from JSON is defined via free functions.
  * Storage implementations (elsewhere) handle actual file/memory operations.
  * 
- * When adding new parameters:
- * 1. Add a member variable with its default value (the single source of truth
- *    for that parameter's default)
- * 2. Add the member name to the NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT
- *    list below - JSON (de)serialization and default-if-missing are automatic
+ * New parameters are added to the SYNTH_PARAMS table only; capture, apply,
+ * defaults and JSON (de)serialization all follow from it.
  */
 struct ProgramData {
-    // Oscillator
-    float waveformShape = 0.0f;
-    
-    // Filter
-    float baseCutoff = 1000.0f;
-    float filterQ = 0.707f;
-    int filterMode = 0;  // Stored as int for JSON compatibility
-    
-    // Filter envelope
-    float filterEnvAmount = 0.5f;
-    float filterEnvAttack = 0.005f;
-    float filterEnvDecay = 0.2f;
-    float filterEnvSustain = 0.3f;
-    float filterEnvRelease = 0.1f;
-    
-    // Amplitude envelope
-    float ampEnvAttack = 0.01f;
-    float ampEnvDecay = 0.05f;
-    float ampEnvSustain = 0.7f;
-    float ampEnvRelease = 0.1f;
-    
-    // Vibrato (pitch modulation)
-    float vibratoRate = 5.0f;    // Hz
-    float vibratoDepth = 0.0f;   // Semitones (0 = off)
-    
-    // Tremolo (amplitude modulation)
-    float tremoloRate = 5.0f;    // Hz
-    float tremoloDepth = 0.0f;   // 0-1 (0 = off)
-    
-    // Aftertouch modulation amounts [-1.0, 1.0]
-    // 0 = no effect, positive = increase with pressure, negative = decrease
-    float baseCutoff_atMod = 0.0f;
-    float filterEnvAmount_atMod = 0.0f;
-    float vibratoDepth_atMod = 0.0f;
-    float tremoloDepth_atMod = 0.0f;
+    float values[synth::PARAM_COUNT];
+
+    ProgramData() {
+        for (size_t i = 0; i < synth::PARAM_COUNT; i++) {
+            values[i] = synth::SYNTH_PARAMS[i].defaultValue;
+        }
+    }
+
+    float& operator[](const synth::ParamDescriptor& param) {
+        return values[synth::paramIndex(param)];
+    }
+    float operator[](const synth::ParamDescriptor& param) const {
+        return values[synth::paramIndex(param)];
+    }
+
+    /**
+     * @brief Set a parameter by name
+     * @return false if there is no parameter with that name
+     */
+    bool set(const char* name, float value) {
+        const synth::ParamDescriptor* param = synth::findParam(name);
+        if (!param) {
+            return false;
+        }
+        (*this)[*param] = value;
+        return true;
+    }
+
+    /**
+     * @brief Get a parameter by name (0 if there is no such parameter)
+     */
+    float get(const char* name) const {
+        const synth::ParamDescriptor* param = synth::findParam(name);
+        return param ? (*this)[*param] : 0.0f;
+    }
     
     /**
      * @brief Capture current synth settings from voices
@@ -71,31 +71,9 @@ struct ProgramData {
         forEachVoice([&](synth::Voice& voice) {
             if (!captured) {
                 auto& ws = static_cast<synth::WavetableSynth&>(voice);
-                waveformShape = ws.getOscillator().getShape();
-                baseCutoff = ws.getBaseCutoff();
-                filterQ = ws.getFilter().getQ();
-                filterMode = static_cast<int>(ws.getFilter().getMode());
-                filterEnvAmount = ws.getFilterEnvelopeAmount();
-                filterEnvAttack = ws.getFilterEnvelope().getAttackTime();
-                filterEnvDecay = ws.getFilterEnvelope().getDecayTime();
-                filterEnvSustain = ws.getFilterEnvelope().getSustainLevel();
-                filterEnvRelease = ws.getFilterEnvelope().getReleaseTime();
-                // Amplitude envelope
-                ampEnvAttack = ws.getAmpEnvelope().getAttackTime();
-                ampEnvDecay = ws.getAmpEnvelope().getDecayTime();
-                ampEnvSustain = ws.getAmpEnvelope().getSustainLevel();
-                ampEnvRelease = ws.getAmpEnvelope().getReleaseTime();
-                // Vibrato
-                vibratoRate = ws.getVibratoRate();
-                vibratoDepth = ws.getVibratoDepth();
-                // Tremolo
-                tremoloRate = ws.getTremoloRate();
-                tremoloDepth = ws.getTremoloDepth();
-                // Aftertouch modulation
-                baseCutoff_atMod = ws.getBaseCutoffAtMod();
-                filterEnvAmount_atMod = ws.getFilterEnvAmountAtMod();
-                vibratoDepth_atMod = ws.getVibratoDepthAtMod();
-                tremoloDepth_atMod = ws.getTremoloDepthAtMod();
+                for (size_t i = 0; i < synth::PARAM_COUNT; i++) {
+                    values[i] = synth::SYNTH_PARAMS[i].get(ws);
+                }
                 captured = true;
             }
         });
@@ -110,58 +88,38 @@ struct ProgramData {
 inline void applyProgramToVoices(const ProgramData& program, VoiceIterator forEachVoice) {
     forEachVoice([&program](synth::Voice& voice) {
         auto& ws = static_cast<synth::WavetableSynth&>(voice);
-        
-        // Apply oscillator settings
-        ws.getOscillator().updateWavetable(program.waveformShape);
-        
-        // Apply filter settings
-        ws.setBaseCutoff(program.baseCutoff);
-        ws.getFilter().setQ(program.filterQ);
-        ws.getFilter().setMode(static_cast<synth::BiquadFilter::Mode>(program.filterMode));
-        
-        // Apply filter envelope settings
-        ws.setFilterEnvelopeAmount(program.filterEnvAmount);
-        ws.getFilterEnvelope().setAttackTime(program.filterEnvAttack);
-        ws.getFilterEnvelope().setDecayTime(program.filterEnvDecay);
-        ws.getFilterEnvelope().setSustainLevel(program.filterEnvSustain);
-        ws.getFilterEnvelope().setReleaseTime(program.filterEnvRelease);
-        
-        // Apply amplitude envelope settings
-        ws.getAmpEnvelope().setAttackTime(program.ampEnvAttack);
-        ws.getAmpEnvelope().setDecayTime(program.ampEnvDecay);
-        ws.getAmpEnvelope().setSustainLevel(program.ampEnvSustain);
-        ws.getAmpEnvelope().setReleaseTime(program.ampEnvRelease);
-        
-        // Apply vibrato settings
-        ws.setVibratoRate(program.vibratoRate);
-        ws.setVibratoDepth(program.vibratoDepth);
-        
-        // Apply tremolo settings
-        ws.setTremoloRate(program.tremoloRate);
-        ws.setTremoloDepth(program.tremoloDepth);
-        
-        // Apply aftertouch modulation settings
-        ws.setBaseCutoffAtMod(program.baseCutoff_atMod);
-        ws.setFilterEnvAmountAtMod(program.filterEnvAmount_atMod);
-        ws.setVibratoDepthAtMod(program.vibratoDepth_atMod);
-        ws.setTremoloDepthAtMod(program.tremoloDepth_atMod);
+        for (size_t i = 0; i < synth::PARAM_COUNT; i++) {
+            synth::SYNTH_PARAMS[i].set(ws, program.values[i]);
+        }
     });
 }
 
 // JSON serialization (must be in the same namespace as ProgramData).
 //
-// to_json/from_json are generated from the field list below. On read, any field
-// missing from the JSON falls back to a default-constructed ProgramData's value,
-// so the struct's member initializers above are the single source of truth for
-// defaults and older patches stay forward-compatible as new params are added.
-NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(ProgramData,
-    waveformShape,
-    baseCutoff, filterQ, filterMode,
-    filterEnvAmount, filterEnvAttack, filterEnvDecay, filterEnvSustain, filterEnvRelease,
-    ampEnvAttack, ampEnvDecay, ampEnvSustain, ampEnvRelease,
-    vibratoRate, vibratoDepth,
-    tremoloRate, tremoloDepth,
-    baseCutoff_atMod, filterEnvAmount_atMod, vibratoDepth_atMod, tremoloDepth_atMod)
+// Both directions walk SYNTH_PARAMS. On read, any field missing from the JSON
+// (or not a number) keeps the table default, so older patches stay
+// forward-compatible as new params are added.
+inline void to_json(nlohmann::json& j, const ProgramData& program) {
+    j = nlohmann::json::object();
+    for (size_t i = 0; i < synth::PARAM_COUNT; i++) {
+        const synth::ParamDescriptor& param = synth::SYNTH_PARAMS[i];
+        if (param.isInt) {
+            j[param.name] = static_cast<int>(program.values[i]);
+        } else {
+            j[param.name] = program.values[i];
+        }
+    }
+}
+
+inline void from_json(const nlohmann::json& j, ProgramData& program) {
+    program = ProgramData();
+    for (size_t i = 0; i < synth::PARAM_COUNT; i++) {
+        auto it = j.find(synth::SYNTH_PARAMS[i].name);
+        if (it != j.end() && it->is_number()) {
+            program.values[i] = it->get<float>();
+        }
+    }
+}
 
 } // namespace midi
 
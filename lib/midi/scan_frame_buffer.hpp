@@ -0,0 +1,121 @@
+#pragma once
+
+#include <key_scanner.hpp>
+#include <atomic>
+#include <cstdint>
+
+namespace midi {
+
+/**
+ * @brief Lock-free triple buffer for publishing complete key scan frames
+ *
+ * One producer (the scan task, DMA completion handler, ...) fills a back
+ * buffer and publishes it; one consumer picks up the most recently published
+ * frame. The two sides never touch the same slot, so the consumer cannot see
+ * a half-written frame, and neither side ever blocks or waits for the other.
+ *
+ * Each published frame carries a monotonically increasing sequence number
+ * (starting at 1; 0 means "nothing yet") and the producer's timestamp, so the
+ * consumer can tell new frames from repeats and count frames it skipped.
+ *
+ * Single producer, single consumer. The consumer's current frame stays valid
+ * until its next acquire().
+ *
+ * @tparam NumKeys Readings per frame
+ */
+template<uint16_t NumKeys>
+class ScanFrameBuffer {
+public:
+    ScanFrameBuffer() = default;
+
+    ScanFrameBuffer(const ScanFrameBuffer&) = delete;
+    ScanFrameBuffer& operator=(const ScanFrameBuffer&) = delete;
+
+    //--------------------------------------------------------------------------
+    // Producer side
+    //--------------------------------------------------------------------------
+
+    /**
+     * @brief Buffer the producer may fill with the next frame's readings
+     * @note All NumKeys entries must be written before publish()
+     */
+    uint16_t* writeBuffer() {
+        return slots_[back_].readings;
+    }
+
+    /**
+     * @brief Publish the write buffer as the newest frame
+     * @param timestampUs Time the scan completed, in the producer's microsecond clock
+     * @return Sequence number assigned to the frame
+     */
+    uint32_t publish(uint64_t timestampUs) {
+        Slot& slot = slots_[back_];
+        slot.sequence = ++producerSequence_;
+        slot.timestampUs = timestampUs;
+        // Swap back buffer with the middle one and flag it as fresh
+        uint32_t previous = middle_.exchange(back_ | FRESH_BIT, std::memory_order_acq_rel);
+        back_ = previous & INDEX_MASK;
+        latestSequence_.store(slot.sequence, std::memory_order_release);
+        return slot.sequence;
+    }
+
+    //--------------------------------------------------------------------------
+    // Consumer side
+    //--------------------------------------------------------------------------
+
+    /**
+     * @brief Take the newest frame if it is newer than a given sequence
+     * @param sinceSequence Sequence of the last frame the caller processed (0 for none)
+     * @param frame Filled with the newest frame when one is available
+     * @return true if frame holds a frame newer than sinceSequence
+     */
+    bool acquire(uint32_t sinceSequence, ScanFrame& frame) {
+        if (middle_.load(std::memory_order_acquire) & FRESH_BIT) {
+            uint32_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+            front_ = previous & INDEX_MASK;
+        }
+        const Slot& slot = slots_[front_];
+        // Wrap-safe "newer than" comparison
+        if (slot.sequence == 0 || static_cast<int32_t>(slot.sequence - sinceSequence) <= 0) {
+            return false;
+        }
+        frame.readings = slot.readings;
+        frame.keyCount = NumKeys;
+        frame.sequence = slot.sequence;
+        frame.timestampUs = slot.timestampUs;
+        return true;
+    }
+
+    /**
+     * @brief Sequence number of the newest published frame (any thread)
+     */
+    uint32_t latestSequence() const {
+        return latestSequence_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Readings of the consumer's current frame (zeros before the first frame)
+     */
+    const uint16_t* currentReadings() const {
+        return slots_[front_].readings;
+    }
+
+private:
+    static constexpr uint32_t INDEX_MASK = 0x3;
+    static constexpr uint32_t FRESH_BIT = 0x4;
+
+    struct Slot {
+        uint16_t readings[NumKeys] = {};
+        uint32_t sequence = 0;
+        uint64_t timestampUs = 0;
+    };
+
+    Slot slots_[3];
+    uint32_t back_ = 0;                     // Producer-owned slot
+    uint32_t front_ = 1;                    // Consumer-owned slot
+    std::atomic<uint32_t> middle_{2};       // Shared slot index | FRESH_BIT
+    uint32_t producerSequence_ = 0;
+    std::atomic<uint32_t> latestSequence_{0};
+};
+
+} // namespace midi
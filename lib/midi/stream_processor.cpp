@@ -105,21 +105,19 @@ void StreamProcessor::process(uint8_t data)
             uint16_t rawBend = (msb << 7) | lsb;
             int16_t signedBend = static_cast<int16_t>(rawBend) - 8192;
             target_.pitchBend(signedBend);
-        }
 
-        processorState_ = stateFromCommandByte(currentCommand_);
+        } else if (currentCommand_ == PROGRAM_CHANGE_COMMAND) {
+            // Program change is a 1-byte message
+            if (programChangeCallback_) {
+                programChangeCallback_(listenChannel_, data);
+            }
 
-    } else if (processorState_ == Initial && currentCommand_ == PROGRAM_CHANGE_COMMAND) {
-        // Program change is a 1-byte message handled here
-        if (programChangeCallback_) {
-            programChangeCallback_(listenChannel_, data);
+        } else if (currentCommand_ == CHANNEL_AFTERTOUCH_COMMAND) {
+            // Channel aftertouch is a 1-byte message
+            target_.channelAftertouch(data);
         }
-        processorState_ = Initial;
 
-    } else if (processorState_ == Initial && currentCommand_ == CHANNEL_AFTERTOUCH_COMMAND) {
-        // Channel aftertouch is a 1-byte message
-        target_.channelAftertouch(data);
-        processorState_ = Initial;
+        processorState_ = stateFromCommandByte(currentCommand_);
 
     } else {
         processorState_ = stateFromCommandByte(currentCommand_);
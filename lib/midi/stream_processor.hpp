@@ -1,7 +1,7 @@
 #pragma once
 
 #include "note_target.hpp"
-#include <functional>
+#include <inline_function.hpp>
 #include <cstdint>
 
 namespace midi {
@@ -28,9 +28,10 @@ static constexpr uint8_t SYSTEM_REALTIME_MAX = 0xFF;
  * @param cc Controller number (0-127)
  * @param value Controller value (0-127)
  * 
- * Application captures any context it needs (voice pool, etc.) in the callback.
+ * Application captures any context it needs (voice pool, etc.) in the callback;
+ * it is stored inline, so the capture must fit features::InlineFunction.
  */
-using ControlChangeCallback = std::function<void(uint8_t channel, uint8_t cc, uint8_t value)>;
+using ControlChangeCallback = features::InlineFunction<void(uint8_t channel, uint8_t cc, uint8_t value)>;
 
 /**
  * @brief Callback for program change messages
@@ -39,7 +40,7 @@ using ControlChangeCallback = std::function<void(uint8_t channel, uint8_t cc, ui
  * 
  * Application captures any context it needs in the callback.
  */
-using ProgramChangeCallback = std::function<void(uint8_t channel, uint8_t program)>;
+using ProgramChangeCallback = features::InlineFunction<void(uint8_t channel, uint8_t program)>;
 
 /**
  * @brief MIDI byte stream parser that routes events to a NoteTarget
@@ -2,8 +2,12 @@
 
 #include <note_target.hpp>
 #include <voice.hpp>
-#include <functional>
-#include <memory>
+#include <flight_recorder.hpp>
+#include <fixed_vector.hpp>
+#include <voice_arena.hpp>
+#include <log.hpp>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <cmath>
 
@@ -20,27 +24,104 @@ namespace platform {
  * - Pitch bend with 14-bit to normalized float conversion
  *
  * The voice pool is pre-allocated at construction to ensure no dynamic
- * memory allocation during real-time audio processing.
+ * memory allocation during real-time audio processing. Voices are stored
+ * inline, one contiguous array of slots, and visited through templates, so
+ * the render loop over them compiles to direct (inlinable) calls.
  *
- * @tparam VoiceT Concrete voice type (must implement synth::Voice)
+ * With MaxVoices = 0 the slots are allocated once, at construction, for
+ * whatever polyphony is asked for. With a nonzero MaxVoices they live in a
+ * FixedVector inside this object instead, so the pool's memory is fixed at
+ * compile time and the polyphony asked for at runtime is capped at it.
+ *
+ * With an abstract VoiceT (synth::EngineVoice) the voices are carved from a
+ * features::VoiceArena instead, and may be of any engine types deriving from
+ * it. rebuild() replaces them in place, e.g. on a program change: a heavier
+ * engine gets fewer voices out of the same region, a lighter one more (up to
+ * MaxVoices). Calls then go through the engine interface.
+ *
+ * @tparam VoiceT Concrete voice type (must implement synth::Voice), or
+ *                synth::EngineVoice for arena-backed voices
+ * @tparam MaxVoices Compile-time voice capacity, or 0 for heap-allocated slots
  */
-template<typename VoiceT>
+template<typename VoiceT, size_t MaxVoices = 0>
 class PolyphonicSynthTarget : public midi::NoteTarget {
 public:
-    using VoiceFactory = std::function<std::unique_ptr<VoiceT>()>;
+    /** @brief Voices live in a VoiceArena (VoiceT is an engine interface) */
+    static constexpr bool USES_ARENA = std::is_abstract<VoiceT>::value;
 
     /**
-     * @brief Construct with a voice factory
+     * @brief Construct the voices in place
      * @param maxVoices Maximum number of simultaneous voices
-     * @param factory Function that creates new voice instances
+     * @param voiceArgs Constructor arguments passed to every voice
      */
-    PolyphonicSynthTarget(uint8_t maxVoices, VoiceFactory factory)
+    template<typename... VoiceArgs>
+    explicit PolyphonicSynthTarget(uint8_t maxVoices, const VoiceArgs&... voiceArgs)
         : maxVoices_(maxVoices)
     {
-        voices_.reserve(maxVoices);
-        for (uint8_t i = 0; i < maxVoices; ++i) {
-            voices_.emplace_back(factory());
+        if (MaxVoices != 0 && maxVoices > MaxVoices) {
+            logWarn("Voice pool holds %u voices; %u requested", static_cast<unsigned int>(MaxVoices),
+                    static_cast<unsigned int>(maxVoices));
+            maxVoices_ = static_cast<uint8_t>(MaxVoices);
+        }
+        voices_.reserve(maxVoices_);
+        for (uint8_t i = 0; i < maxVoices_; ++i) {
+            voices_.emplace_back(voiceArgs...);
+        }
+    }
+
+    /**
+     * @brief Start an arena-backed pool with no voices; see rebuild()
+     * @param arena Region the voices are carved from; must outlive the pool,
+     *              and is cleared by every rebuild()
+     */
+    explicit PolyphonicSynthTarget(features::VoiceArena& arena)
+        : maxVoices_(0)
+        , arena_(&arena)
+    {
+        static_assert(USES_ARENA, "Arena-backed pools take an engine interface as VoiceT");
+        static_assert(MaxVoices != 0, "Arena-backed pools need a compile-time slot capacity");
+    }
+
+    /**
+     * @brief Replace every voice with voices of engine EngineT, as many as fit
+     *
+     * Destroys the current voices and clears the arena, then constructs up
+     * to maxVoices (and at most MaxVoices) new ones in it. Call from the
+     * thread that renders, or while rendering is stopped.
+     *
+     * @param voiceArgs Constructor arguments passed to every voice
+     * @return Voices now in the pool
+     */
+    template<typename EngineT, typename... VoiceArgs>
+    uint8_t rebuild(uint8_t maxVoices, const VoiceArgs&... voiceArgs) {
+        voices_.clear();
+        arena_->clear();
+        lastAllocatedIndex_ = 0;
+        return addVoices<EngineT>(maxVoices, voiceArgs...);
+    }
+
+    /**
+     * @brief Append voices of engine EngineT in the arena's remaining space
+     *
+     * Lets one pool mix engines; allocation treats all voices alike.
+     *
+     * @return Voices actually added (fewer than count if the arena or the
+     *         slot capacity ran out)
+     */
+    template<typename EngineT, typename... VoiceArgs>
+    uint8_t addVoices(uint8_t count, const VoiceArgs&... voiceArgs) {
+        static_assert(std::is_base_of<VoiceT, EngineT>::value, "EngineT must implement the pool's voice interface");
+        uint8_t added = 0;
+        while (added < count && !voices_.full()) {
+            EngineT* voice = arena_->template create<EngineT>(voiceArgs...);
+            if (!voice) {
+                break;
+            }
+            voices_.emplace_back(*voice);
+            added++;
         }
+        maxVoices_ = static_cast<uint8_t>(voices_.size());
+        return added;
     }
 
     // Non-copyable, movable
@@ -60,6 +141,9 @@ public:
             return;
         }
 
+        if (voices_.empty()) {
+            return;
+        }
         VoiceT* voice = allocateVoice(note);
         float hz = midiNoteToHz(note);
         float volume = velocity / 127.0f;
@@ -72,9 +156,13 @@ public:
             voice->release();
             // Mark the slot as released but keep the note association
             // until the voice becomes inactive (for aftertouch during release)
-            for (auto& slot : voices_) {
-                if (slot.voice.get() == voice && slot.isAllocated) {
+            for (size_t i = 0; i < voices_.size(); ++i) {
+                auto& slot = voices_[i];
+                if (&slot.voice == voice && slot.isAllocated) {
                     slot.isAllocated = false;  // Available for stealing
+                    if (flightRecorder_) {
+                        flightRecorder_->record(features::FlightEvent::VoiceRelease, note, static_cast<uint16_t>(i));
+                    }
                     break;
                 }
             }
@@ -96,7 +184,7 @@ public:
         // Convert 14-bit signed (-8192 to +8191) to normalized (-1.0 to +1.0)
         float normalized = bend / 8192.0f;
         for (auto& slot : voices_) {
-            slot.voice->setPitchBend(normalized);
+            slot.voice.setPitchBend(normalized);
         }
     }
 
@@ -104,8 +192,8 @@ public:
         // Apply aftertouch to all active voices
         float aftertouch = pressure / 127.0f;
         for (auto& slot : voices_) {
-            if (slot.isAllocated || slot.voice->isActive()) {
-                slot.voice->setAftertouch(aftertouch);
+            if (slot.isAllocated || slot.voice.isActive()) {
+                slot.voice.setAftertouch(aftertouch);
             }
         }
     }
@@ -116,22 +204,22 @@ public:
 
     /**
      * @brief Apply a function to each voice (for audio rendering, global effects)
-     * @param func Function to call with each voice
+     * @param func Called with each voice as VoiceT& (or anything it converts
+     *             to, such as synth::Voice&)
      */
-    void forEachVoice(std::function<void(VoiceT&)> func) {
+    template<typename Visitor>
+    void forEachVoice(Visitor&& func) {
         for (auto& slot : voices_) {
-            func(*slot.voice);
+            func(slot.voice);
         }
     }
 
     /**
-     * @brief Apply a function to each voice via base interface
-     * @param func Function to call with each voice as synth::Voice&
+     * @brief Record voice allocation, steals and releases (nullptr disables)
+     * @param recorder Recorder that must outlive this target
      */
-    void forEachVoice(std::function<void(synth::Voice&)> func) {
-        for (auto& slot : voices_) {
-            func(*slot.voice);
-        }
+    void setFlightRecorder(features::FlightRecorder* recorder) {
+        flightRecorder_ = recorder;
     }
 
     /**
@@ -141,24 +229,39 @@ public:
         return maxVoices_;
     }
 
+    /**
+     * @brief Bytes this pool occupies, including heap-allocated slots
+     */
+    size_t getMemoryBytes() const {
+        return sizeof(*this) + (MaxVoices == 0 ? voices_.size() * sizeof(VoiceSlot) : 0);
+    }
+
 private:
-    struct VoiceSlot {
-        std::unique_ptr<VoiceT> voice;
+    struct InlineSlot {
+        VoiceT voice;
         uint8_t assignedNote = 0;
         bool isAllocated = false;
 
-        explicit VoiceSlot(std::unique_ptr<VoiceT> v) : voice(std::move(v)) {}
+        template<typename... VoiceArgs>
+        explicit InlineSlot(const VoiceArgs&... voiceArgs) : voice(voiceArgs...) {}
+    };
+
+    // Same members as InlineSlot, so the allocation code serves both
+    struct ArenaSlot {
+        VoiceT& voice;
+        uint8_t assignedNote = 0;
+        bool isAllocated = false;
 
-        // Move-only
-        VoiceSlot(const VoiceSlot&) = delete;
-        VoiceSlot& operator=(const VoiceSlot&) = delete;
-        VoiceSlot(VoiceSlot&&) = default;
-        VoiceSlot& operator=(VoiceSlot&&) = default;
+        explicit ArenaSlot(VoiceT& arenaVoice) : voice(arenaVoice) {}
     };
 
-    std::vector<VoiceSlot> voices_;
+    using VoiceSlot = std::conditional_t<USES_ARENA, ArenaSlot, InlineSlot>;
+
+    std::conditional_t<MaxVoices == 0, std::vector<VoiceSlot>, features::FixedVector<VoiceSlot, MaxVoices>> voices_;
     uint8_t maxVoices_;
+    features::VoiceArena* arena_ = nullptr;
     size_t lastAllocatedIndex_ = 0;
+    features::FlightRecorder* flightRecorder_ = nullptr;
 
     /**
      * @brief Convert MIDI note number to frequency in Hz
@@ -179,25 +282,21 @@ private:
         // Check if we already have this note playing
         for (auto& slot : voices_) {
             if (slot.isAllocated && slot.assignedNote == note) {
-                return slot.voice.get();
+                return &slot.voice;
             }
         }
 
         // Find an unallocated slot
-        for (auto& slot : voices_) {
-            if (!slot.isAllocated) {
-                slot.assignedNote = note;
-                slot.isAllocated = true;
-                return slot.voice.get();
+        for (size_t i = 0; i < voices_.size(); ++i) {
+            if (!voices_[i].isAllocated) {
+                return assignSlot(i, note);
             }
         }
 
         // Find an inactive voice (finished release phase)
-        for (auto& slot : voices_) {
-            if (!slot.voice->isActive()) {
-                slot.assignedNote = note;
-                slot.isAllocated = true;
-                return slot.voice.get();
+        for (size_t i = 0; i < voices_.size(); ++i) {
+            if (!voices_[i].voice.isActive()) {
+                return assignSlot(i, note);
             }
         }
 
@@ -206,10 +305,24 @@ private:
         lastAllocatedIndex_ = stealIndex;
 
         auto& slot = voices_[stealIndex];
-        slot.voice->release();
+        if (flightRecorder_) {
+            flightRecorder_->record(features::FlightEvent::VoiceSteal, note,
+                                    static_cast<uint16_t>(stealIndex), slot.assignedNote);
+        }
+        slot.voice.release();
         slot.assignedNote = note;
         slot.isAllocated = true;
-        return slot.voice.get();
+        return &slot.voice;
+    }
+
+    VoiceT* assignSlot(size_t index, uint8_t note) {
+        auto& slot = voices_[index];
+        slot.assignedNote = note;
+        slot.isAllocated = true;
+        if (flightRecorder_) {
+            flightRecorder_->record(features::FlightEvent::VoiceAllocate, note, static_cast<uint16_t>(index));
+        }
+        return &slot.voice;
     }
 
     /**
@@ -220,8 +333,8 @@ private:
     VoiceT* findVoiceForNote(uint8_t note) {
         for (auto& slot : voices_) {
             if (slot.assignedNote == note && 
-                (slot.isAllocated || slot.voice->isActive())) {
-                return slot.voice.get();
+                (slot.isAllocated || slot.voice.isActive())) {
+                return &slot.voice;
             }
         }
         return nullptr;
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RESAMPLER_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RESAMPLER_NEON 1
+#endif
+
+namespace platform {
+
+// Define PI constant (not always available in <cmath>); double, for the filter design
+constexpr double RESAMPLER_PI = 3.14159265358979323846;
+
+/**
+ * @brief Filter length/stopband trade-off of a PolyphaseResampler
+ */
+enum class ResamplerQuality : uint8_t {
+    Fast,       // 8 taps: cheap, some aliasing near Nyquist
+    Balanced,   // 16 taps
+    High        // 32 taps: transparent for the synth's output
+};
+
+/**
+ * @brief Mono windowed-sinc resampler for arbitrary rate ratios
+ *
+ * Converts the engine's render rate to whatever rate the audio device granted,
+ * including ratios with no small rational form (44100 -> 48000, or an I2S
+ * clock that lands a few Hz off). The Kaiser-windowed sinc is tabulated at
+ * PHASES fractional positions; each output sample takes the dot products with
+ * the two nearest phases and interpolates linearly between them. The cutoff
+ * follows the lower of the two rates, so downsampling doesn't alias.
+ *
+ * The read position is 32.32 fixed point, so the ratio never drifts. Input is
+ * pulled from a source callback INPUT_BLOCK_FRAMES at a time into a fixed
+ * window; nothing allocates after construction. The dot products use SSE2 on
+ * x86, NEON on ARM with Advanced SIMD, scalar elsewhere.
+ *
+ * Usage:
+ * @code
+ * platform::PolyphaseResampler resampler(32000, 44100, platform::ResamplerQuality::Balanced);
+ * resampler.process(frames,
+ *     [&](float* in, unsigned int count) { renderMono(in, count); },
+ *     [&](unsigned int frame, float sample) { out[frame] = sample; });
+ * @endcode
+ */
+class PolyphaseResampler {
+public:
+    static constexpr unsigned int PHASE_BITS = 8;
+    static constexpr unsigned int PHASES = 1u << PHASE_BITS;
+    static constexpr unsigned int MAX_TAPS = 32;
+    static constexpr unsigned int INPUT_BLOCK_FRAMES = 32;
+
+    PolyphaseResampler(uint32_t inputRate, uint32_t outputRate,
+                       ResamplerQuality quality = ResamplerQuality::Balanced)
+        : inputRate_(inputRate)
+        , outputRate_(outputRate)
+        , quality_(quality)
+        , taps_(tapsFor(quality)) {
+        uint64_t step = (static_cast<uint64_t>(inputRate) << 32) / outputRate;
+        stepWhole_ = static_cast<uint32_t>(step >> 32);
+        stepFraction_ = static_cast<uint32_t>(step);
+        designFilter();
+        reset();
+    }
+
+    /**
+     * @brief Forget buffered input, as if just constructed
+     */
+    void reset() {
+        std::memset(window_, 0, sizeof(window_));
+        // Zeros before the first input sample, so output 0 lines up with input 0
+        available_ = taps_ / 2 - 1;
+        position_ = 0;
+        fraction_ = 0;
+    }
+
+    /**
+     * @brief Produce outputFrames samples at the output rate
+     *
+     * @param source Called as source(float* in, unsigned int count) whenever
+     *               more input is needed; must write count samples
+     * @param write  Called as write(frame, sample) for each output sample
+     */
+    template<typename Source, typename Writer>
+    void process(unsigned int outputFrames, Source&& source, Writer&& write) {
+        for (unsigned int frame = 0; frame < outputFrames; frame++) {
+            while (position_ + taps_ > available_) {
+                refill(source);
+            }
+            write(frame, interpolate());
+
+            uint64_t fraction = static_cast<uint64_t>(fraction_) + stepFraction_;
+            fraction_ = static_cast<uint32_t>(fraction);
+            position_ += stepWhole_ + static_cast<uint32_t>(fraction >> 32);
+        }
+    }
+
+    uint32_t getInputRate() const { return inputRate_; }
+    uint32_t getOutputRate() const { return outputRate_; }
+    ResamplerQuality getQuality() const { return quality_; }
+    unsigned int getTaps() const { return taps_; }
+
+    /** @brief Bytes used, including the coefficient table */
+    size_t getMemoryBytes() const { return sizeof(*this) + coefficients_.capacity() * sizeof(float); }
+
+    static unsigned int tapsFor(ResamplerQuality quality) {
+        switch (quality) {
+            case ResamplerQuality::Fast: return 8;
+            case ResamplerQuality::High: return 32;
+            default:                     return 16;
+        }
+    }
+
+private:
+    uint32_t inputRate_;
+    uint32_t outputRate_;
+    ResamplerQuality quality_;
+    unsigned int taps_;
+    uint32_t stepWhole_ = 0;
+    uint32_t stepFraction_ = 0;
+
+    std::vector<float> coefficients_;   // PHASES + 1 rows of taps_
+    float window_[MAX_TAPS + INPUT_BLOCK_FRAMES];
+    unsigned int available_ = 0;        // Input samples in window_
+    unsigned int position_ = 0;         // First tap of the next output sample
+    uint32_t fraction_ = 0;             // Output instant past the center tap, 0.32
+
+    template<typename Source>
+    void refill(Source& source) {
+        // Drop input no tap will reach again
+        unsigned int consumed = position_ < available_ ? position_ : available_;
+        std::memmove(window_, window_ + consumed, (available_ - consumed) * sizeof(float));
+        available_ -= consumed;
+        position_ -= consumed;
+        source(window_ + available_, INPUT_BLOCK_FRAMES);
+        available_ += INPUT_BLOCK_FRAMES;
+    }
+
+    float interpolate() const {
+        constexpr unsigned int SUBPHASE_BITS = 32 - PHASE_BITS;
+        const unsigned int phase = fraction_ >> SUBPHASE_BITS;
+        const float blend = static_cast<float>(fraction_ & ((1u << SUBPHASE_BITS) - 1)) *
+                            (1.0f / static_cast<float>(1u << SUBPHASE_BITS));
+        const float* below = &coefficients_[phase * taps_];
+        float a, b;
+        dot2(window_ + position_, below, below + taps_, a, b);
+        return a + blend * (b - a);
+    }
+
+    /**
+     * @brief Dot products of x with two coefficient rows; taps_ is a multiple of 4
+     */
+    void dot2(const float* x, const float* c0, const float* c1, float& out0, float& out1) const {
+#if defined(RESAMPLER_SSE2)
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        for (unsigned int k = 0; k < taps_; k += 4) {
+            __m128 v = _mm_loadu_ps(x + k);
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(v, _mm_loadu_ps(c0 + k)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(v, _mm_loadu_ps(c1 + k)));
+        }
+        // Horizontal sums: (a0+a2, a1+a3, ...) then across the pair
+        __m128 lo = _mm_unpacklo_ps(acc0, acc1);    // a0 b0 a1 b1
+        __m128 hi = _mm_unpackhi_ps(acc0, acc1);    // a2 b2 a3 b3
+        __m128 sum = _mm_add_ps(lo, hi);            // a02 b02 a13 b13
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        out0 = _mm_cvtss_f32(sum);
+        out1 = _mm_cvtss_f32(_mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+#elif defined(RESAMPLER_NEON)
+        float32x4_t acc0 = vdupq_n_f32(0.0f);
+        float32x4_t acc1 = vdupq_n_f32(0.0f);
+        for (unsigned int k = 0; k < taps_; k += 4) {
+            float32x4_t v = vld1q_f32(x + k);
+            acc0 = vmlaq_f32(acc0, v, vld1q_f32(c0 + k));
+            acc1 = vmlaq_f32(acc1, v, vld1q_f32(c1 + k));
+        }
+        float32x2_t pair = vpadd_f32(vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0)),
+                                     vadd_f32(vget_low_f32(acc1), vget_high_f32(acc1)));
+        out0 = vget_lane_f32(pair, 0);
+        out1 = vget_lane_f32(pair, 1);
+#else
+        float sum0 = 0.0f;
+        float sum1 = 0.0f;
+        for (unsigned int k = 0; k < taps_; k++) {
+            sum0 += x[k] * c0[k];
+            sum1 += x[k] * c1[k];
+        }
+        out0 = sum0;
+        out1 = sum1;
+#endif
+    }
+
+    static double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 32; k++) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    void designFilter() {
+        double beta;
+        double cutoff;  // Fraction of the lower Nyquist frequency
+        switch (quality_) {
+            case ResamplerQuality::Fast: beta = 5.0; cutoff = 0.85; break;
+            case ResamplerQuality::High: beta = 9.0; cutoff = 0.95; break;
+            default:                     beta = 7.0; cutoff = 0.91; break;
+        }
+        if (outputRate_ < inputRate_) {
+            cutoff *= static_cast<double>(outputRate_) / inputRate_;
+        }
+
+        coefficients_.resize((PHASES + 1) * taps_);
+        const double halfWidth = taps_ / 2.0;
+        const double center = taps_ / 2.0 - 1.0;
+        for (unsigned int phase = 0; phase <= PHASES; phase++) {
+            float* row = &coefficients_[phase * taps_];
+            double sum = 0.0;
+            for (unsigned int k = 0; k < taps_; k++) {
+                double t = k - center - static_cast<double>(phase) / PHASES;
+                double x = RESAMPLER_PI * cutoff * t;
+                double sinc = t == 0.0 ? 1.0 : std::sin(x) / x;
+                double edge = t / halfWidth;
+                double window = edge * edge < 1.0 ? besselI0(beta * std::sqrt(1.0 - edge * edge)) / besselI0(beta) : 0.0;
+                row[k] = static_cast<float>(sinc * window);
+                sum += row[k];
+            }
+            // Unity gain at DC for every phase, so no phase-dependent ripple
+            for (unsigned int k = 0; k < taps_; k++) {
+                row[k] = static_cast<float>(row[k] / sum);
+            }
+        }
+    }
+};
+
+} // namespace platform
@@ -0,0 +1,354 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SAMPLE_FORMAT_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SAMPLE_FORMAT_NEON 1
+#endif
+
+namespace platform {
+
+/**
+ * Float to integer sample conversion shared by the audio sinks
+ *
+ * Converts the render buffer straight into the DAC/driver buffer in one pass:
+ * gain, optional TPDF dither, saturation to the format's range and conversion
+ * (truncating toward zero, like a plain cast). NaN converts to 0, infinities
+ * saturate. SSE2 on x86, NEON on ARM with Advanced SIMD, scalar elsewhere
+ * (RP2350, ESP32); all paths produce identical output, dither included.
+ *
+ * Formats:
+ *   - S16Format:     int16_t, full scale +-32768
+ *   - S24In32Format: 24-bit value left-justified in an int32_t (low byte
+ *                    zero), as I2S DACs such as the PCM5102 expect
+ *   - S32Format:     int32_t, full scale +-2^31
+ *
+ * Usage:
+ * @code
+ * platform::convertInterleaved<platform::S16Format>(floatBuffer, pcm, frames * channels, 1.0f, &dither);
+ * platform::convertLeftChannel<platform::S32Format>(stereoBuffer, dmaBuffer, frames, volume);
+ * @endcode
+ */
+
+struct S16Format {
+    using Sample = int16_t;
+    static constexpr float SCALE = 32768.0f;
+    static constexpr float MAX_INPUT = 32767.0f / 32768.0f;
+    static constexpr int SHIFT = 0;
+};
+
+struct S24In32Format {
+    using Sample = int32_t;
+    static constexpr float SCALE = 8388608.0f;                  // 2^23
+    static constexpr float MAX_INPUT = 8388607.0f / 8388608.0f;
+    static constexpr int SHIFT = 8;
+};
+
+struct S32Format {
+    using Sample = int32_t;
+    static constexpr float SCALE = 2147483648.0f;               // 2^31
+    static constexpr float MAX_INPUT = 1.0f - 1.0f / 16777216.0f;  // Largest float below 1
+    static constexpr int SHIFT = 0;
+};
+
+/**
+ * @brief Triangular-PDF dither source
+ *
+ * Four xorshift32 generators, one per SIMD lane; sample i uses lane i % 4 so
+ * the scalar and vector paths draw the same sequence. Each sample gets the
+ * sum of two independent uniform values, i.e. +-1 LSB triangular noise.
+ */
+class TpdfDither {
+public:
+    explicit TpdfDither(uint32_t seed = 0x9E3779B9u) {
+        for (int lane = 0; lane < LANES; lane++) {
+            state_[lane] = seed ^ (0x6C078965u * static_cast<uint32_t>(lane + 1));
+            if (state_[lane] == 0) {
+                state_[lane] = 1;
+            }
+        }
+    }
+
+    /**
+     * @brief Next dither value for a lane, in LSBs (-1 to +1)
+     */
+    float next(int lane) {
+        uint32_t x = state_[lane];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        state_[lane] = x;
+        // High and low halves as two signed uniform values in [-0.5, 0.5)
+        int32_t high = static_cast<int32_t>(x) >> 16;
+        int32_t low = static_cast<int16_t>(x & 0xFFFF);
+        return static_cast<float>(high + low) * (1.0f / 65536.0f);
+    }
+
+#if defined(SAMPLE_FORMAT_SSE2)
+    __m128 next4() {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state_));
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state_), x);
+        __m128i high = _mm_srai_epi32(x, 16);
+        __m128i low = _mm_srai_epi32(_mm_slli_epi32(x, 16), 16);
+        return _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(high, low)), _mm_set1_ps(1.0f / 65536.0f));
+    }
+#elif defined(SAMPLE_FORMAT_NEON)
+    float32x4_t next4() {
+        uint32x4_t x = vld1q_u32(state_);
+        x = veorq_u32(x, vshlq_n_u32(x, 13));
+        x = veorq_u32(x, vshrq_n_u32(x, 17));
+        x = veorq_u32(x, vshlq_n_u32(x, 5));
+        vst1q_u32(state_, x);
+        int32x4_t signedX = vreinterpretq_s32_u32(x);
+        int32x4_t high = vshrq_n_s32(signedX, 16);
+        int32x4_t low = vshrq_n_s32(vshlq_n_s32(signedX, 16), 16);
+        return vmulq_n_f32(vcvtq_f32_s32(vaddq_s32(high, low)), 1.0f / 65536.0f);
+    }
+#endif
+
+private:
+    static constexpr int LANES = 4;
+    uint32_t state_[LANES];
+};
+
+namespace sample_format_detail {
+
+enum class Layout {
+    INTERLEAVED,      // n samples in, n samples out
+    MONO_TO_STEREO,   // n samples in, each written to both channels
+    LEFT_CHANNEL      // n stereo frames in, their left samples out
+};
+
+template<typename Format>
+inline typename Format::Sample convertOne(float sample, float gain, TpdfDither* dither, int lane) {
+    float v = sample * gain;
+    if (dither) {
+        v += dither->next(lane) * (1.0f / Format::SCALE);
+    }
+    // Written so NaN fails both comparisons and ends up 0 (a NaN cast is undefined)
+    v = v >= -1.0f ? (v <= Format::MAX_INPUT ? v : Format::MAX_INPUT) : (v < -1.0f ? -1.0f : 0.0f);
+    int32_t scaled = static_cast<int32_t>(v * Format::SCALE);
+    return static_cast<typename Format::Sample>(static_cast<uint32_t>(scaled) << Format::SHIFT);
+}
+
+template<typename Format>
+inline void store(typename Format::Sample* out, size_t index, typename Format::Sample value, Layout layout) {
+    if (layout == Layout::MONO_TO_STEREO) {
+        out[2 * index] = value;
+        out[2 * index + 1] = value;
+    } else {
+        out[index] = value;
+    }
+}
+
+#if defined(SAMPLE_FORMAT_SSE2)
+
+template<typename Format>
+inline __m128i convert4(__m128 v, __m128 gain, TpdfDither* dither) {
+    v = _mm_mul_ps(v, gain);
+    if (dither) {
+        v = _mm_add_ps(v, _mm_mul_ps(dither->next4(), _mm_set1_ps(1.0f / Format::SCALE)));
+    }
+    const __m128 ordered = _mm_cmpord_ps(v, v);   // All ones unless NaN
+    v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-1.0f)), _mm_set1_ps(Format::MAX_INPUT));
+    v = _mm_and_ps(v, ordered);
+    __m128i scaled = _mm_cvttps_epi32(_mm_mul_ps(v, _mm_set1_ps(Format::SCALE)));
+    return Format::SHIFT ? _mm_slli_epi32(scaled, Format::SHIFT) : scaled;
+}
+
+template<typename Format>
+inline void store4(typename Format::Sample* out, __m128i samples, Layout layout) {
+    if (sizeof(typename Format::Sample) == 2) {
+        __m128i packed = _mm_packs_epi32(samples, samples);   // Already in range
+        if (layout == Layout::MONO_TO_STEREO) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(packed, packed));
+        } else {
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out), packed);
+        }
+    } else if (layout == Layout::MONO_TO_STEREO) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi32(samples, samples));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out) + 1, _mm_unpackhi_epi32(samples, samples));
+    } else {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), samples);
+    }
+}
+
+template<typename Format>
+inline size_t convertVector(const float* in, typename Format::Sample* out, size_t count,
+                            float gain, TpdfDither* dither, Layout layout) {
+    const __m128 gainVector = _mm_set1_ps(gain);
+    const size_t outStep = layout == Layout::MONO_TO_STEREO ? 8 : 4;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 v;
+        if (layout == Layout::LEFT_CHANNEL) {
+            __m128 a = _mm_loadu_ps(in + 2 * i);
+            __m128 b = _mm_loadu_ps(in + 2 * i + 4);
+            v = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        } else {
+            v = _mm_loadu_ps(in + i);
+        }
+        store4<Format>(out + (i / 4) * outStep, convert4<Format>(v, gainVector, dither), layout);
+    }
+    return i;
+}
+
+#elif defined(SAMPLE_FORMAT_NEON)
+
+template<typename Format>
+inline int32x4_t convert4(float32x4_t v, float gain, TpdfDither* dither) {
+    v = vmulq_n_f32(v, gain);
+    if (dither) {
+        v = vmlaq_n_f32(v, dither->next4(), 1.0f / Format::SCALE);
+    }
+    v = vminq_f32(vmaxq_f32(v, vdupq_n_f32(-1.0f)), vdupq_n_f32(Format::MAX_INPUT));   // NaN stays NaN
+    int32x4_t scaled = vcvtq_s32_f32(vmulq_n_f32(v, Format::SCALE));   // NaN converts to 0
+    return Format::SHIFT ? vshlq_s32(scaled, vdupq_n_s32(Format::SHIFT)) : scaled;
+}
+
+template<typename Format>
+inline void store4(typename Format::Sample* out, int32x4_t samples, Layout layout) {
+    if (sizeof(typename Format::Sample) == 2) {
+        int16x4_t narrow = vmovn_s32(samples);   // Already in range
+        int16_t* out16 = reinterpret_cast<int16_t*>(out);
+        if (layout == Layout::MONO_TO_STEREO) {
+            vst2_s16(out16, int16x4x2_t{{narrow, narrow}});
+        } else {
+            vst1_s16(out16, narrow);
+        }
+    } else {
+        int32_t* out32 = reinterpret_cast<int32_t*>(out);
+        if (layout == Layout::MONO_TO_STEREO) {
+            vst2q_s32(out32, int32x4x2_t{{samples, samples}});
+        } else {
+            vst1q_s32(out32, samples);
+        }
+    }
+}
+
+template<typename Format>
+inline size_t convertVector(const float* in, typename Format::Sample* out, size_t count,
+                            float gain, TpdfDither* dither, Layout layout) {
+    const size_t outStep = layout == Layout::MONO_TO_STEREO ? 8 : 4;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t v = layout == Layout::LEFT_CHANNEL ? vld2q_f32(in + 2 * i).val[0] : vld1q_f32(in + i);
+        store4<Format>(out + (i / 4) * outStep, convert4<Format>(v, gain, dither), layout);
+    }
+    return i;
+}
+
+#else
+
+template<typename Format>
+inline size_t convertVector(const float*, typename Format::Sample*, size_t, float, TpdfDither*, Layout) {
+    return 0;
+}
+
+#endif
+
+template<typename Format>
+inline void convert(const float* in, typename Format::Sample* out, size_t count,
+                    float gain, TpdfDither* dither, Layout layout) {
+    size_t i = convertVector<Format>(in, out, count, gain, dither, layout);
+    const size_t inStride = layout == Layout::LEFT_CHANNEL ? 2 : 1;
+    for (; i < count; i++) {
+        store<Format>(out, i, convertOne<Format>(in[i * inStride], gain, dither, static_cast<int>(i & 3)), layout);
+    }
+}
+
+} // namespace sample_format_detail
+
+/**
+ * @brief Convert interleaved (or mono) floats sample for sample
+ * @param samples Number of samples (frames * channels)
+ * @param dither TPDF dither state, or nullptr for none
+ */
+template<typename Format>
+inline void convertInterleaved(const float* in, typename Format::Sample* out, size_t samples,
+                               float gain = 1.0f, TpdfDither* dither = nullptr) {
+    sample_format_detail::convert<Format>(in, out, samples, gain, dither,
+                                          sample_format_detail::Layout::INTERLEAVED);
+}
+
+/**
+ * @brief Convert mono floats to interleaved stereo (out holds 2 * frames samples)
+ */
+template<typename Format>
+inline void convertMonoToStereo(const float* in, typename Format::Sample* out, size_t frames,
+                                float gain = 1.0f, TpdfDither* dither = nullptr) {
+    sample_format_detail::convert<Format>(in, out, frames, gain, dither,
+                                          sample_format_detail::Layout::MONO_TO_STEREO);
+}
+
+/**
+ * @brief Convert the left channel of interleaved stereo floats to mono
+ *        (in holds 2 * frames samples)
+ */
+template<typename Format>
+inline void convertLeftChannel(const float* in, typename Format::Sample* out, size_t frames,
+                               float gain = 1.0f, TpdfDither* dither = nullptr) {
+    sample_format_detail::convert<Format>(in, out, frames, gain, dither,
+                                          sample_format_detail::Layout::LEFT_CHANNEL);
+}
+
+/**
+ * @brief Per-sample writer of processed mono audio into a float sink buffer
+ *
+ * For synth::OutputProcessor::process(): writes each sample to every channel
+ * of an interleaved float buffer.
+ */
+class FloatSampleWriter {
+public:
+    FloatSampleWriter(float* out, unsigned int channels) : out_(out), channels_(channels) {}
+
+    inline void operator()(size_t frame, float sample) const {
+        float* dest = out_ + frame * channels_;
+        for (unsigned int c = 0; c < channels_; c++) {
+            dest[c] = sample;
+        }
+    }
+
+private:
+    float* out_;
+    unsigned int channels_;
+};
+
+/**
+ * @brief Per-sample writer of processed mono audio into an integer sink buffer
+ *
+ * Same conversion as convertInterleaved() (gain, dither, saturation), done as
+ * each sample is produced so the float result is never stored.
+ */
+template<typename Format>
+class SampleWriter {
+public:
+    SampleWriter(typename Format::Sample* out, unsigned int channels,
+                 float gain = 1.0f, TpdfDither* dither = nullptr)
+        : out_(out), channels_(channels), gain_(gain), dither_(dither) {}
+
+    inline void operator()(size_t frame, float sample) const {
+        typename Format::Sample value = sample_format_detail::convertOne<Format>(
+            sample, gain_, dither_, static_cast<int>(frame & 3));
+        typename Format::Sample* dest = out_ + frame * channels_;
+        for (unsigned int c = 0; c < channels_; c++) {
+            dest[c] = value;
+        }
+    }
+
+private:
+    typename Format::Sample* out_;
+    unsigned int channels_;
+    float gain_;
+    TpdfDither* dither_;
+};
+
+} // namespace platform
@@ -1,21 +1,37 @@
 #pragma once
 
 #include <sawtooth_synth.hpp>
+#include <sample_rate.hpp>
+#include <synth_params.hpp>
+#include <param_batch.hpp>
 #include <stream_processor.hpp>
 #include <web_controller.hpp>
 #include <polyphonic_synth_target.hpp>
 #include <output_processor.hpp>
+#include <sample_format.hpp>
+#include <resampler.hpp>
 #include <performance_timer.hpp>
+#include <flight_recorder.hpp>
+#include <telemetry_sink.hpp>
+#include <memory_report.hpp>
 #include <log.hpp>
+#include <algorithm>
 #include <memory>
-#include <functional>
+#include <atomic>
 #include <cmath>
+#include <type_traits>
 
 // Feature interfaces
 #include <program_storage.hpp>
 
 #ifdef FEATURE_CLIPBOARD
 #include <clipboard.hpp>
+#include <program_data.hpp>
+#endif
+
+#ifdef FEATURE_AUDIO_TAP
+#include <audio_tap.hpp>
+#include <audio_analyzer.hpp>
 #endif
 
 namespace platform {
@@ -30,61 +46,115 @@ namespace platform {
  * - PolyphonicSynthTarget: Bridges MIDI to synth voices (owns voices)
  * - StreamProcessor: Parses MIDI bytes, routes to target
  * - OutputProcessor: Post-processing (drive, filtering)
+ *
+ * The voice and output stage types are template parameters, and voices live
+ * inline in the pool, so the whole per-block render (voice mix, clipper,
+ * post-filter, sample conversion) is visible to the compiler as one piece of
+ * code: no virtual calls or std::function hops per sample. Platforms use the
+ * SynthApplication alias.
+ *
+ * Everything the application owns is a direct member: the MIDI processor,
+ * the web controller and its callbacks, the audio taps and buffers. With a
+ * nonzero MaxVoices the voices are too (see StaticSynthApplication), so
+ * sizeof() is the application's whole footprint and it can live in static
+ * storage without touching the heap. The exceptions are opt-in and set up
+ * by the caller: an owned ProgramStorage, a resampler and a clipboard.
+ * reportMemory() breaks the footprint down by subsystem.
+ *
+ * @tparam VoiceT    Voice type; must derive from synth::WavetableSynth, which
+ *                   is what the param registry, ParamBatch and program
+ *                   staging voices operate on
+ * @tparam OutputT   Output stage with process(in, frames, writer)
+ * @tparam MaxVoices Compile-time voice capacity, or 0 to size the pool at runtime
+ * @tparam RateT     Sample rate policy for the voices' per-sample code:
+ *                   synth::RuntimeSampleRate, or synth::FixedSampleRate<Hz>
+ *                   for builds whose rate is a compile-time constant (the
+ *                   constructor's rate is then ignored in favour of Hz)
  */
-class SynthApplication {
+template<typename VoiceT = synth::WavetableSynth, typename OutputT = synth::OutputProcessor,
+         size_t MaxVoices = 0, typename RateT = synth::RuntimeSampleRate>
+class BasicSynthApplication {
+    static_assert(std::is_base_of<synth::WavetableSynth, VoiceT>::value,
+                  "VoiceT must derive from synth::WavetableSynth: the param registry and program staging use it");
+
 public:
-    using VoicePool = PolyphonicSynthTarget<synth::WavetableSynth>;
+    using VoicePool = PolyphonicSynthTarget<VoiceT, MaxVoices>;
+
+    /**
+     * @brief Frames rendered per internal sub-block
+     *
+     * renderAudio() takes any number of frames (whatever the sink's current
+     * period is) and renders them in sub-blocks of at most this size, so the
+     * working buffers are fixed and queued control changes take effect
+     * within one sub-block whatever the sink period.
+     */
+    static constexpr unsigned int RENDER_BLOCK_FRAMES = 32;
 
-    SynthApplication(unsigned int sampleRate = 44100,
+    BasicSynthApplication(unsigned int sampleRate = 44100,
                      unsigned int channels = 2,
                      uint8_t maxVoices = 8,
                      std::unique_ptr<features::ProgramStorage> programStorage = nullptr)
-        : sampleRate_(sampleRate)
+        : BasicSynthApplication(sampleRate, channels, maxVoices, programStorage.get())
+    {
+        ownedProgramStorage_ = std::move(programStorage);
+    }
+
+    /**
+     * @brief Construct with program storage owned elsewhere (e.g. in static storage)
+     * @param programStorage Storage that outlives the application, or nullptr
+     */
+    BasicSynthApplication(unsigned int sampleRate,
+                     unsigned int channels,
+                     uint8_t maxVoices,
+                     features::ProgramStorage* programStorage)
+        : sampleRate_(RateT::resolve(sampleRate))
         , channels_(channels)
-        , maxVoices_(maxVoices)
-        , outputProcessor_(0.5f, static_cast<float>(sampleRate))
-        , currentProgram_(1)
-        , programStorage_(std::move(programStorage))
+        , voicePool_(maxVoices, static_cast<float>(sampleRate_))
+        , maxVoices_(voicePool_.getVoiceCount())
+        // MIDI processor with callbacks that capture our voice pool
+        , midiProcessor_(
+            voicePool_,
+            0,  // Default channel
+            [this](uint8_t ch, uint8_t cc, uint8_t val) {
+                handleCC(ch, cc, val);
+            },
+            [this](uint8_t ch, uint8_t prog) {
+                handleProgramChange(ch, prog);
+            })
+        // Web controller for control panel communication
+        , webController_(
+            [this](auto visitor) { voicePool_.forEachVoice(visitor); },
+            programStorage)
+        , outputProcessor_(0.5f, static_cast<float>(sampleRate_))
+        , programStorage_(programStorage)
     {
         logInfo("Initializing synthesizer: %d Hz, %d voices", sampleRate_, maxVoices_);
+        if (sampleRate_ != sampleRate) {
+            logWarn("Synth is built for %u Hz; %u Hz requested", sampleRate_, sampleRate);
+        }
         
-        // Create voice pool with wavetable synth factory
-        voicePool_ = std::make_unique<VoicePool>(
-            maxVoices_,
-            [sampleRate]() {
-                return std::make_unique<synth::WavetableSynth>(static_cast<float>(sampleRate));
-            }
-        );
-        
-        // Load program using provided storage implementation
+        // Load program using provided storage implementation. The web
+        // controller is constructed but has no batch callback yet, so the
+        // program goes straight into the voices; nothing renders before the
+        // constructor returns.
         if (programStorage_) {
             loadCurrentProgram();
         } else {
             logWarn("No program storage provided; using synthesizer defaults");
         }
+        publishParams();
         
-        // Create MIDI processor with callbacks that capture our voice pool
-        midiProcessor_ = std::make_unique<midi::StreamProcessor>(
-            *voicePool_,
-            0,  // Default channel
-            [this](uint8_t ch, uint8_t cc, uint8_t val) {
-                handleCC(ch, cc, val);
-            },
-            [this](uint8_t ch, uint8_t prog) {
-                handleProgramChange(ch, prog);
-            }
-        );
-        
-        // Allocate temporary buffer for mono processing
-        monoBuffer_.resize(256);
-        
-        logInfo("MIDI processor ready with %d voices", maxVoices_);
-        
-        // Create web controller for control panel communication
-        webController_ = std::make_unique<webcontrol::WebController>(
-            [this](auto visitor) { voicePool_->forEachVoice(visitor); },
-            programStorage_.get()
-        );
+#ifdef FEATURE_AUDIO_TAP
+        webController_.setAudioTapCallback([this](bool subscribe, int voice, uint16_t decimation) {
+            return setAudioTap(subscribe, voice, decimation);
+        });
+#endif
+        // From here on control panel param changes are applied by renderAudio
+        // between blocks, and the controller reads params back from what
+        // renderAudio publishes
+        webController_.setParamBatchCallback([this](const synth::ParamBatch& batch) {
+            return pendingParams_.push(batch);
+        }, appliedParams_);
     }
     
     /**
@@ -94,7 +164,27 @@ public:
      * since the keyboard controller is not part of SynthApplication.
      */
     void setBaseNoteCallback(webcontrol::SetBaseNoteCallback callback) {
-        webController_->setBaseNoteCallback(std::move(callback));
+        webController_.setBaseNoteCallback(std::move(callback));
+    }
+
+    /**
+     * @brief Set callback for key scan telemetry subscriptions
+     * 
+     * Hook this to the keyboard controller's setTelemetrySubscription() so
+     * the control panel can switch to delta key scan telemetry.
+     */
+    void setKeyScanSubscriptionCallback(webcontrol::KeyScanSubscriptionCallback callback) {
+        webController_.setKeyScanSubscriptionCallback(std::move(callback));
+    }
+
+    /**
+     * @brief Set callback for latency profile changes
+     * 
+     * Hook this to the audio sink, which owns the period size; renderAudio()
+     * follows whatever frame count the sink asks for.
+     */
+    void setLatencyProfileCallback(webcontrol::LatencyProfileCallback callback) {
+        webController_.setLatencyProfileCallback(std::move(callback));
     }
 
     /**
@@ -104,36 +194,130 @@ public:
      * live outside the synth voices (such as the keyboard aftertouch range),
      * which SynthApplication doesn't own.
      */
-    void registerExternalParam(const std::string& name,
-                               std::function<void(float)> setter,
-                               std::function<float()> getter) {
-        webController_->registerParam(name, std::move(setter), std::move(getter));
+    bool registerExternalParam(const char* name,
+                               webcontrol::ParamSetter setter,
+                               webcontrol::ParamGetter getter) {
+        return webController_.registerParam(name, std::move(setter), std::move(getter));
+    }
+    
+#ifdef FEATURE_AUDIO_TAP
+    /**
+     * @brief Start or stop an audio tap
+     * 
+     * The output tap copies each block after the OutputProcessor; the voice
+     * tap copies one selected voice's contribution before mixing. Only one
+     * voice can be tapped at a time.
+     * 
+     * @param subscribe true to start, false to stop
+     * @param voice Voice index, or -1 for the output
+     * @param decimation Keep every Nth sample
+     * @return false if voice is out of range
+     */
+    bool setAudioTap(bool subscribe, int voice, uint16_t decimation = 1) {
+        if (voice >= static_cast<int>(maxVoices_)) {
+            return false;
+        }
+        features::AudioTap<>& tap = (voice < 0) ? outputTap_ : voiceTap_;
+        if (!subscribe) {
+            tap.unsubscribe();
+            return true;
+        }
+        if (voice >= 0) {
+            tappedVoice_.store(static_cast<uint8_t>(voice), std::memory_order_relaxed);
+        }
+        tap.subscribe(decimation);
+        return true;
+    }
+
+    /**
+     * @brief Analyze subscribed audio taps and send meter/spectrum reports
+     * 
+     * Call periodically from a non-audio thread or core (one caller only).
+     * Sends at most one report per subscribed tap per call.
+     */
+    void pollAudioTaps(features::TelemetrySink<features::AudioMeterStats>& sink) {
+        features::AudioMeterStats stats;
+        if (outputTap_.isSubscribed() && outputAnalyzer_.poll(outputTap_, sampleRate_, -1, stats)) {
+            sink.sendTelemetry(stats);
+        }
+        if (voiceTap_.isSubscribed() &&
+            voiceAnalyzer_.poll(voiceTap_, sampleRate_, tappedVoice_.load(std::memory_order_relaxed), stats)) {
+            sink.sendTelemetry(stats);
+        }
+    }
+#endif
+    
+    /**
+     * @brief Load a requested MIDI program, and report voice params changed by any source
+     * 
+     * Call periodically from the control thread or core. Program changes
+     * arrive with the MIDI stream but are loaded here, away from the audio
+     * thread, as are clipboard pastes saved to storage; a paramsDelta
+     * message is sent at most once per push interval.
+     * 
+     * @param nowMs Current time in milliseconds
+     * @return true if a message was sent
+     */
+    bool pushParamChanges(uint32_t nowMs) {
+        loadRequestedProgram();
+#ifdef FEATURE_CLIPBOARD
+        saveRequestedPaste();
+#endif
+        return webController_.pushParamChanges(nowMs);
+    }
+    
+    /**
+     * @brief Set the minimum time between paramsDelta messages (0 disables them)
+     */
+    void setParamPushInterval(uint32_t intervalMs) {
+        webController_.setParamPushInterval(intervalMs);
     }
     
     /**
      * @brief Process incoming MIDI byte
      */
     void processMidiByte(uint8_t byte) {
-        midiProcessor_->process(byte);
+        if (flightRecorder_) {
+            flightRecorder_->record(features::FlightEvent::MidiIn, byte);
+        }
+        midiProcessor_.process(byte);
+    }
+
+    /**
+     * @brief Record MIDI input, voice allocation and program changes
+     * 
+     * @param recorder Recorder that must outlive this application (nullptr disables)
+     */
+    void setFlightRecorder(features::FlightRecorder* recorder) {
+        flightRecorder_ = recorder;
+        voicePool_.setFlightRecorder(recorder);
+    }
+    
+    /**
+     * @brief Process received command bytes (for serial input)
+     * 
+     * Hand over everything received so far; lines may span calls and one
+     * call may complete several commands.
+     * 
+     * @return Number of commands processed
+     */
+    size_t processCommandBytes(const char* data, size_t length) {
+        return webController_.processBytes(data, length);
     }
     
     /**
-     * @brief Process incoming command character (for serial input)
-     * @return true if a complete command was processed
+     * @brief Write command responses and params messages through write(context)
+     *        instead of stdout
      */
-    bool processCommandChar(char ch) {
-        if (webController_->accumulate(ch)) {
-            webController_->process(webController_->getLineBuffer());
-            return true;
-        }
-        return false;
+    void setCommandOutput(features::JsonWriter::WriteFn write, void* context) {
+        webController_.setOutput(write, context);
     }
     
     /**
      * @brief Process a complete command line
      */
     void processCommand(const char* jsonLine) {
-        webController_->process(jsonLine);
+        webController_.process(jsonLine);
     }
     
     /**
@@ -141,7 +325,7 @@ public:
      * 
      * @tparam TimingPolicy Policy class providing now() and unitName()
      * @tparam MaxSpans Maximum number of span names the timer can track
-     * @param buffer Output buffer (interleaved stereo)
+     * @param buffer Output buffer (interleaved, getChannels() channels)
      * @param numFrames Number of frames to render
      * @param timer Lap timer for performance measurement. Span names are
      *  implementation details but should be consistent for telemetry output.
@@ -150,92 +334,226 @@ public:
     template<typename TimingPolicy, size_t MaxSpans>
     void renderAudio(float* buffer, unsigned int numFrames,
                      features::LapTimer<TimingPolicy, MaxSpans>& timer) {
-        // Resize mono buffer if needed
-        if (monoBuffer_.size() < numFrames) {
-            monoBuffer_.resize(numFrames);
+        renderBlock(numFrames, timer, FloatSampleWriter(buffer, channels_));
+    }
+    
+    /**
+     * @brief Render audio straight into an integer sink buffer
+     * 
+     * The output stage converts as it goes, so the sink needs no separate
+     * float-to-integer pass.
+     * 
+     * @tparam Format Sample format, e.g. platform::S32Format
+     * @param buffer Output buffer (interleaved, channels channels)
+     * @param numFrames Number of frames to render
+     * @param channels Channels in buffer; every channel gets the same (mono) output
+     * @param gain Master gain applied before saturation
+     * @param timer Lap timer (see above)
+     * @param dither TPDF dither state, or nullptr for none
+     */
+    template<typename Format, typename TimingPolicy, size_t MaxSpans>
+    void renderAudio(typename Format::Sample* buffer, unsigned int numFrames, unsigned int channels,
+                     float gain, features::LapTimer<TimingPolicy, MaxSpans>& timer,
+                     TpdfDither* dither = nullptr) {
+        renderBlock(numFrames, timer, SampleWriter<Format>(buffer, channels, gain, dither));
+    }
+
+    unsigned int getChannels() const { return channels_; }
+
+    /**
+     * @brief Resample the output to the rate the audio device runs at
+     *
+     * The engine keeps rendering at the rate it was constructed with (its
+     * DSP design rate, or a lower one to save time on slow boards), and
+     * renderAudio() frame counts are then at outputRate. Call during setup:
+     * this allocates the filter table. Equal rates turn resampling off.
+     */
+    void setOutputRate(unsigned int outputRate, ResamplerQuality quality = ResamplerQuality::Balanced) {
+        if (outputRate == sampleRate_) {
+            resampler_.reset();
+            return;
+        }
+        resampler_ = std::make_unique<PolyphaseResampler>(sampleRate_, outputRate, quality);
+        logInfo("Resampling %u Hz to %u Hz (%u taps)", sampleRate_, outputRate, resampler_->getTaps());
+    }
+
+    /** @brief Rate the engine renders at */
+    unsigned int getSampleRate() const { return sampleRate_; }
+
+    /** @brief Rate of the frames renderAudio() produces */
+    unsigned int getOutputRate() const { return resampler_ ? resampler_->getOutputRate() : sampleRate_; }
+
+    /**
+     * @brief Get the voice pool for direct access (e.g., for program loading)
+     */
+    VoicePool& getVoicePool() { return voicePool_; }
+
+    /**
+     * @brief Add the application's RAM, by subsystem, to a report
+     *
+     * Counts the members (voices, render buffers, taps and analyzers, the
+     * JSON command controller, the MIDI parser) and whatever was allocated
+     * for them at setup.
+     */
+    void reportMemory(features::MemoryReport& report) const {
+        const size_t voices = voicePool_.getMemoryBytes();
+        size_t buffers = sizeof(monoBuffer_) + sizeof(pendingParams_) + sizeof(outputProcessor_);
+        size_t telemetry = 0;
+#ifdef FEATURE_AUDIO_TAP
+        buffers += sizeof(voiceTapBuffer_);
+        telemetry += sizeof(outputTap_) + sizeof(voiceTap_) + sizeof(outputAnalyzer_) + sizeof(voiceAnalyzer_);
+#endif
+        const size_t members = sizeof(voicePool_) + buffers + telemetry + sizeof(webController_) +
+                               sizeof(midiProcessor_);
+        report.add("voices", voices);
+        report.add("buffers", buffers + (resampler_ ? resampler_->getMemoryBytes() : 0));
+        report.add("telemetry", telemetry);
+        report.add("json", sizeof(webController_));
+        report.add("midi", sizeof(midiProcessor_));
+        report.add("app", sizeof(*this) - members);
+    }
+    
+#ifdef FEATURE_CLIPBOARD
+    void setClipboard(std::unique_ptr<features::Clipboard> clipboard) {
+        clipboard_ = std::move(clipboard);
+    }
+#endif
+
+private:
+    /**
+     * @brief Render numFrames frames into writer, one sub-block at a time
+     */
+    template<typename TimingPolicy, size_t MaxSpans, typename Writer>
+    void renderBlock(unsigned int numFrames, features::LapTimer<TimingPolicy, MaxSpans>& timer,
+                     const Writer& writer) {
+        if (resampler_) {
+            // Mono at the engine rate, pulled by the resampler a sub-block at a time
+            resampler_->process(numFrames, [this, &timer](float* in, unsigned int frames) {
+                renderSubBlock(frames, timer, [in](unsigned int frame, float sample) {
+                    in[frame] = sample;
+                });
+                timer.nextSpan("app:resample");
+            }, writer);
+            return;
+        }
+        for (unsigned int offset = 0; offset < numFrames; offset += RENDER_BLOCK_FRAMES) {
+            const unsigned int frames = std::min(RENDER_BLOCK_FRAMES, numFrames - offset);
+            renderSubBlock(frames, timer, [offset, &writer](unsigned int frame, float sample) {
+                writer(offset + frame, sample);
+            });
+        }
+    }
+    
+    /**
+     * @brief Mix the voices, then run the output stage into writer in one pass
+     */
+    template<typename TimingPolicy, size_t MaxSpans, typename Writer>
+    void renderSubBlock(unsigned int numFrames, features::LapTimer<TimingPolicy, MaxSpans>& timer,
+                        const Writer& writer) {
+        // Apply queued control panel changes at the block boundary, so a
+        // batch never takes effect partway through a block
+        uint32_t changed = unpublishedParams_.exchange(0, std::memory_order_relaxed);
+        appliedBatches_ += pendingParams_.drain([this, &changed](const synth::ParamBatch& batch) {
+            voicePool_.forEachVoice([&batch](VoiceT& voice) {
+                batch.applyTo(voice);
+            });
+            changed |= static_cast<uint32_t>(batch.changed.to_ulong());
+        });
+        if (changed) {
+            // Publish before reporting, so a report never reads older values
+            publishParams();
+            webController_.markParamsChanged(changed);
         }
         
         // Pass 1: Mix all voices into mono buffer
         timer.nextSpan("app:voice_synthesis");
+#ifdef FEATURE_AUDIO_TAP
+        if (voiceTap_.isSubscribed()) {
+            mixVoicesWithTap(numFrames, timer);
+        } else {
+            mixVoices(numFrames, timer);
+        }
+#else
+        mixVoices(numFrames, timer);
+#endif
+        
+        // Pass 2: Clip, post-filter, gain and format conversion, writing
+        // each sink sample once
+        timer.nextSpan("app:output_stage");
+#ifdef FEATURE_AUDIO_TAP
+        if (outputTap_.isSubscribed()) {
+            // The output tap also needs the processed mono signal, kept in
+            // place only while it is subscribed
+            float* mono = monoBuffer_;
+            outputProcessor_.process(mono, numFrames, [mono, &writer](unsigned int frame, float sample) {
+                mono[frame] = sample;
+                writer(frame, sample);
+            });
+            outputTap_.write(mono, numFrames);
+            return;
+        }
+#endif
+        outputProcessor_.process(monoBuffer_, numFrames, writer);
+    }
+
+    /**
+     * @brief Sum the voices into monoBuffer_
+     */
+    template<typename TimingPolicy, size_t MaxSpans>
+    void mixVoices(unsigned int numFrames, features::LapTimer<TimingPolicy, MaxSpans>& timer) {
         for (unsigned int frame = 0; frame < numFrames; ++frame) {
             float sample = 0.0f;
-            voicePool_->forEachVoice([&sample, &timer](synth::WavetableSynth& synth) {
-                sample += synth.nextSample(timer);
+            voicePool_.forEachVoice([&sample, &timer](VoiceT& synth) {
+                sample += synth.template nextSample<RateT>(timer);
             });
             monoBuffer_[frame] = sample;
         }
-        
-        // Pass 2: Process with output processor
-        timer.nextSpan("app:output_processing");
-        outputProcessor_.processBuffer(monoBuffer_.data(), numFrames);
-        
-        // Pass 3: Duplicate mono to stereo
-        timer.nextSpan("app:stereo_dup");
-        for (unsigned int frame = 0; frame < numFrames; ++frame) {
-            float processed = monoBuffer_[frame];
-            buffer[frame * channels_ + 0] = processed;
-            buffer[frame * channels_ + 1] = processed;
-        }
     }
 
+#ifdef FEATURE_AUDIO_TAP
     /**
-     * @brief Get the voice pool for direct access (e.g., for program loading)
+     * @brief Same mix as mixVoices(), also copying the tapped voice's samples to its tap
      */
-    VoicePool& getVoicePool() { return *voicePool_; }
-    
-#ifdef FEATURE_CLIPBOARD
-    void setClipboard(std::unique_ptr<features::Clipboard> clipboard) {
-        clipboard_ = std::move(clipboard);
+    template<typename TimingPolicy, size_t MaxSpans>
+    void mixVoicesWithTap(unsigned int numFrames, features::LapTimer<TimingPolicy, MaxSpans>& timer) {
+        struct {
+            float sample;
+            float voiceSample;
+            uint8_t index;
+            uint8_t tapped;
+        } mix{0.0f, 0.0f, 0, tappedVoice_.load(std::memory_order_relaxed)};
+        for (unsigned int frame = 0; frame < numFrames; ++frame) {
+            mix.sample = 0.0f;
+            mix.index = 0;
+            voicePool_.forEachVoice([&mix, &timer](VoiceT& synth) {
+                float s = synth.template nextSample<RateT>(timer);
+                if (mix.index++ == mix.tapped) {
+                    mix.voiceSample = s;
+                }
+                mix.sample += s;
+            });
+            monoBuffer_[frame] = mix.sample;
+            voiceTapBuffer_[frame] = mix.voiceSample;
+        }
+        voiceTap_.write(voiceTapBuffer_, numFrames);
     }
 #endif
 
-private:
     void handleCC(uint8_t channel, uint8_t cc, uint8_t value) {
+        // Voice parameters are mapped by the registry
+        if (const synth::ParamDescriptor* param = synth::findParamByCC(cc)) {
+            float paramValue = param->fromCC(value);
+            voicePool_.forEachVoice([param, paramValue](VoiceT& voice) {
+                param->set(voice, paramValue);
+            });
+            unpublishedParams_.fetch_or(1u << synth::paramIndex(*param), std::memory_order_relaxed);
+            return;
+        }
+
+        // Everything else is an output setting or an action
         float normalized = static_cast<float>(value) / 127.0f;
         
         switch(cc) {
-            case 1: // Modulation wheel -> waveform shape
-                voicePool_->forEachVoice([normalized](synth::WavetableSynth& voice) {
-                    voice.getOscillator().updateWavetable(normalized);
-                });
-                break;
-            case 20: { // Filter cutoff (exponential 100Hz - 10kHz)
-                    const float MIN_CUTOFF = 100.0f;
-                    const float MAX_CUTOFF = 10000.0f;
-                    float cutoff = MIN_CUTOFF * std::pow(MAX_CUTOFF / MIN_CUTOFF, normalized);
-                    voicePool_->forEachVoice([cutoff](synth::WavetableSynth& voice) {
-                        voice.setBaseCutoff(cutoff);
-                    });
-                }
-                break;
-            case 21: // Filter resonance (Q 0.1 - 20.0)
-                voicePool_->forEachVoice([normalized](synth::WavetableSynth& voice) {
-                    voice.getFilter().setQ(0.1f + normalized * 19.9f);
-                });
-                break;
-            case 71: // Filter envelope attack (1ms - 2s)
-                voicePool_->forEachVoice([normalized](synth::WavetableSynth& voice) {
-                    float attackTime = 0.001f + normalized * 2.0f;
-                    voice.getFilterEnvelope().setAttackTime(attackTime);
-                });
-                break;
-            case 72: // Filter envelope decay (10ms - 5s)
-                voicePool_->forEachVoice([normalized](synth::WavetableSynth& voice) {
-                    float decayTime = 0.01f + normalized * 5.0f;
-                    voice.getFilterEnvelope().setDecayTime(decayTime);
-                });
-                break;
-            case 25: // Filter envelope sustain level
-                voicePool_->forEachVoice([normalized](synth::WavetableSynth& voice) {
-                    voice.getFilterEnvelope().setSustainLevel(normalized);
-                });
-                break;
-            case 73: // Filter envelope release (10ms - 5s)
-                voicePool_->forEachVoice([normalized](synth::WavetableSynth& voice) {
-                    float releaseTime = 0.01f + normalized * 5.0f;
-                    voice.getFilterEnvelope().setReleaseTime(releaseTime);
-                });
-                break;
             case 74: // Output drive
                 outputProcessor_.setDrive(normalized);
                 break;
@@ -253,13 +571,16 @@ private:
                     if (normalized > 0.5f) {
                         synth::BiquadFilter::Mode newMode;
                         bool modeSet = false;
-                        voicePool_->forEachVoice([&newMode, &modeSet](synth::WavetableSynth& voice) {
+                        voicePool_.forEachVoice([&newMode, &modeSet](VoiceT& voice) {
                             if (!modeSet) {
                                 newMode = synth::BiquadFilter::nextMode(voice.getFilter().getMode());
                                 modeSet = true;
                             }
                             voice.getFilter().setMode(newMode);
                         });
+                        constexpr size_t FILTER_MODE = synth::paramIndex("filterMode");
+                        static_assert(FILTER_MODE < synth::PARAM_COUNT, "filterMode is a synth param");
+                        unpublishedParams_.fetch_or(1u << FILTER_MODE, std::memory_order_relaxed);
                     }
                 }
                 break;
@@ -273,19 +594,27 @@ private:
 #ifdef FEATURE_CLIPBOARD
             case 103: // Copy to clipboard
                 if (normalized > 0.5f && clipboard_) {
-                    clipboard_->copy([this](auto visitor) { voicePool_->forEachVoice(visitor); });
+                    clipboard_->copy([this](auto visitor) { voicePool_.forEachVoice(visitor); });
                 }
                 break;
             case 104: // Paste from clipboard
                 if (normalized > 0.5f && clipboard_) {
-                    auto voiceIterator = [this](auto visitor) { voicePool_->forEachVoice(visitor); };
-                    if (currentProgram_ == 1) {
+                    auto voiceIterator = [this](auto visitor) { voicePool_.forEachVoice(visitor); };
+                    const uint8_t program = currentProgram_.load(std::memory_order_relaxed);
+                    if (program == 1) {
                         logError("Cannot paste into program 1 (protected)");
-                    } else if (programStorage_) {
-                        clipboard_->pasteAndSave(voiceIterator, currentProgram_, *programStorage_);
-                    } else {
-                        clipboard_->paste(voiceIterator);
+                    } else if (clipboard_->paste(voiceIterator) && programStorage_) {
+                        // Saving is storage I/O: capture what was pasted and
+                        // let pushParamChanges() save it on the control side
+                        if (pasteSaveProgram_.load(std::memory_order_acquire) == NO_PROGRAM_REQUEST) {
+                            pasteSaveData_.captureFromVoices(voiceIterator);
+                            pasteSaveProgram_.store(program, std::memory_order_release);
+                        } else {
+                            logWarn("Previous paste still being saved; program %d not saved", program);
+                        }
                     }
+                    unpublishedParams_.fetch_or(webcontrol::WebController::ALL_PARAMS_MASK,
+                                                std::memory_order_relaxed);
                 }
                 break;
 #endif
@@ -295,38 +624,128 @@ private:
     }
     
     void handleProgramChange(uint8_t channel, uint8_t program) {
-        currentProgram_ = program;
-        loadCurrentProgram();
+        if (flightRecorder_) {
+            flightRecorder_->record(features::FlightEvent::ProgramChange, program);
+        }
+        // Storage I/O doesn't belong on the audio thread: pushParamChanges()
+        // loads it on the control side
+        requestedProgram_.store(program, std::memory_order_release);
+    }
+    
+    void loadRequestedProgram() {
+        int program = requestedProgram_.exchange(NO_PROGRAM_REQUEST, std::memory_order_acquire);
+        if (program != NO_PROGRAM_REQUEST) {
+            currentProgram_.store(static_cast<uint8_t>(program), std::memory_order_relaxed);
+            loadCurrentProgram();
+        }
+    }
+    
+#ifdef FEATURE_CLIPBOARD
+    void saveRequestedPaste() {
+        int program = pasteSaveProgram_.load(std::memory_order_acquire);
+        if (program == NO_PROGRAM_REQUEST) {
+            return;
+        }
+        // Storage reads params from a voice: hand it a staging one
+        synth::WavetableSynth staging;
+        auto stagingIterator = [&staging](features::ProgramStorage::VoiceVisitor visitor) { visitor(staging); };
+        midi::applyProgramToVoices(pasteSaveData_, stagingIterator);
+        if (!programStorage_->saveProgram(static_cast<uint8_t>(program), stagingIterator)) {
+            logWarn("Pasted program %d not saved", program);
+        }
+        pasteSaveProgram_.store(NO_PROGRAM_REQUEST, std::memory_order_release);
     }
+#endif
     
+    /**
+     * @brief Load currentProgram_ as a full param batch through the web controller
+     */
     void loadCurrentProgram() {
-        if (programStorage_) {
-            programStorage_->loadProgram(currentProgram_, [this](auto visitor) {
-                voicePool_->forEachVoice(visitor);
-            });
-        } else {
-            logWarn("Program change requested but no storage available (program %d)", currentProgram_);
+        const uint8_t program = currentProgram_.load(std::memory_order_relaxed);
+        if (!programStorage_) {
+            logWarn("Program change requested but no storage available (program %d)", program);
+        } else if (!webController_.loadProgramSlot(program)) {
+            logWarn("Program %d not loaded; using defaults", program);
         }
     }
+    
+    /**
+     * @brief Copy the first voice's params to appliedParams_ (all voices share settings)
+     * 
+     * Called by the thread that applies param changes: the constructor, then
+     * renderAudio.
+     */
+    void publishParams() {
+        bool published = false;
+        voicePool_.forEachVoice([this, &published](VoiceT& voice) {
+            if (!published) {
+                appliedParams_.publish(voice, appliedBatches_);
+                published = true;
+            }
+        });
+    }
 
     unsigned int sampleRate_;
     unsigned int channels_;
-    uint8_t maxVoices_;
     
-    std::unique_ptr<VoicePool> voicePool_;
-    std::unique_ptr<midi::StreamProcessor> midiProcessor_;
-    std::unique_ptr<webcontrol::WebController> webController_;
+    VoicePool voicePool_;
+    uint8_t maxVoices_;     // As granted by the pool
+    midi::StreamProcessor midiProcessor_;
+    webcontrol::WebController webController_;   // The constructor body loads the startup program through it
+    
+    OutputT outputProcessor_;
+    std::atomic<uint8_t> currentProgram_{1};
+    static constexpr int NO_PROGRAM_REQUEST = -1;
+    std::atomic<int> requestedProgram_{NO_PROGRAM_REQUEST};   // Set by MIDI, loaded by pushParamChanges
     
-    synth::OutputProcessor outputProcessor_;
-    uint8_t currentProgram_;
+    float monoBuffer_[RENDER_BLOCK_FRAMES];
+    static_assert(PolyphaseResampler::INPUT_BLOCK_FRAMES <= RENDER_BLOCK_FRAMES,
+                  "resampler input must fit one sub-block");
+    std::unique_ptr<PolyphaseResampler> resampler_;   // Only when the device rate differs
     
-    std::vector<float> monoBuffer_;
+    // Control panel param changes waiting for the next block (control side pushes)
+    synth::ParamBatchQueue<8> pendingParams_;
+    
+    // Voice params as renderAudio last applied them, for the control side to read
+    synth::ParamSnapshot appliedParams_;
+    uint32_t appliedBatches_ = 0;                        // Render thread only
+    std::atomic<uint32_t> unpublishedParams_{0};         // Changed by MIDI since the last publish
+    
+#ifdef FEATURE_AUDIO_TAP
+    // Audio taps (written by the audio thread) and their analyzers (consumer side)
+    features::AudioTap<> outputTap_;
+    features::AudioTap<> voiceTap_;
+    std::atomic<uint8_t> tappedVoice_{0};
+    float voiceTapBuffer_[RENDER_BLOCK_FRAMES];
+    features::AudioAnalyzer<> outputAnalyzer_;
+    features::AudioAnalyzer<> voiceAnalyzer_;
+#endif
     
-    std::unique_ptr<features::ProgramStorage> programStorage_;
+    features::ProgramStorage* programStorage_;
+    std::unique_ptr<features::ProgramStorage> ownedProgramStorage_;   // Set by the owning constructor
+    features::FlightRecorder* flightRecorder_ = nullptr;
     
 #ifdef FEATURE_CLIPBOARD
     std::unique_ptr<features::Clipboard> clipboard_;
+    // Pasted params waiting to be saved; the audio thread writes them only
+    // while no save is pending, pushParamChanges() saves and clears the request
+    midi::ProgramData pasteSaveData_;
+    std::atomic<int> pasteSaveProgram_{NO_PROGRAM_REQUEST};
 #endif
 };
 
+/**
+ * @brief The synth every platform runs: wavetable voices into the standard output stage
+ */
+using SynthApplication = BasicSynthApplication<>;
+
+/**
+ * @brief SynthApplication with its voices inline, for static storage on microcontrollers
+ *
+ * Pass synth::FixedSampleRate<Hz> as RateT when the firmware's rate is a
+ * compile-time constant.
+ */
+template<size_t MaxVoices, typename RateT = synth::RuntimeSampleRate>
+using StaticSynthApplication = BasicSynthApplication<synth::WavetableSynth, synth::OutputProcessor, MaxVoices, RateT>;
+
 } // namespace platform
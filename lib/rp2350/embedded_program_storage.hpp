@@ -37,15 +37,15 @@ private:
     midi::ProgramData getDefaultProgram() {
         // Default program: Matches program_2.json
         midi::ProgramData p;
-        p.waveformShape = 0.0f;  // Pure sawtooth
-        p.baseCutoff = 222.0530242919922f;
-        p.filterQ = 3.9370079040527344f;
-        p.filterMode = 0;  // LOWPASS
-        p.filterEnvAmount = 0.5f;
-        p.filterEnvAttack = 0.06399212777614594f;
-        p.filterEnvDecay = 0.24622048437595367f;
-        p.filterEnvSustain = 0.023622047156095505f;
-        p.filterEnvRelease = 0.3249606192111969f;
+        p.set("waveformShape", 0.0f);  // Pure sawtooth
+        p.set("baseCutoff", 222.0530242919922f);
+        p.set("filterQ", 3.9370079040527344f);
+        p.set("filterMode", 0.0f);  // LOWPASS
+        p.set("filterEnvAmount", 0.5f);
+        p.set("filterEnvAttack", 0.06399212777614594f);
+        p.set("filterEnvDecay", 0.24622048437595367f);
+        p.set("filterEnvSustain", 0.023622047156095505f);
+        p.set("filterEnvRelease", 0.3249606192111969f);
         return p;
     }
 };
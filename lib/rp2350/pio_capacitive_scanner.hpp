@@ -1,6 +1,7 @@
 #pragma once
 
 #include <key_scanner.hpp>
+#include <scan_frame_buffer.hpp>
 #include <cstdio>
 #include <cstdlib>
 #include <algorithm>
@@ -24,6 +25,15 @@ namespace rp2350 {
  * Template parameters allow compile-time optimization while maintaining configuration
  * independence (no global defines required).
  * 
+ * Several scanners can run side by side (one state machine and two DMA channels
+ * each), e.g. on different PIO blocks, and be combined into one keyboard with
+ * midi::CompositeKeyScanner. Their scans then overlap in hardware. State
+ * machines, DMA channels and program space are claimed from the SDK, so they
+ * cannot collide; two scanners on the same PIO block each load their own copy
+ * of the program. Key pins are not claimed by the SDK: check pin ranges at
+ * compile time with sharesPinsWith(), and the constructor panics if one of its
+ * pins is already handed to a PIO block.
+ * 
  * HARDWARE REQUIREMENTS:
  * - GPIO pins (starting from FirstKeyPin) connected to capacitive touch sensors
  * - Internal pull-up resistors enabled dynamically during scan
@@ -43,6 +53,21 @@ public:
     static_assert(FirstKeyPin + NumKeys <= 32, 
                   "PioCapacitiveScanner: FirstKeyPin + NumKeys must not exceed 32 (GPIO limit)");
     
+    static constexpr uint8_t FIRST_KEY_PIN = FirstKeyPin;
+    static constexpr uint8_t NUM_KEYS = NumKeys;
+    
+    /**
+     * @brief Whether this scanner's key pins overlap another scanner's
+     *
+     * For a static_assert next to the scanner type aliases, e.g.
+     * static_assert(!LowerScanner::sharesPinsWith<UpperScanner>(), "...").
+     */
+    template<typename Other>
+    static constexpr bool sharesPinsWith() {
+        return Other::FIRST_KEY_PIN < FirstKeyPin + NumKeys &&
+               FirstKeyPin < Other::FIRST_KEY_PIN + Other::NUM_KEYS;
+    }
+
     /**
      * @brief DMA control block structure for scripted operations
      */
@@ -55,14 +80,23 @@ public:
     
     /**
      * @brief Construct and initialize the PIO-based capacitive scanner
+     * @param pio PIO block to run on (use different blocks for concurrent scanners)
      */
-    PioCapacitiveScanner() 
-        : pio_(pio0)
+    explicit PioCapacitiveScanner(PIO pio = pio0) 
+        : pio_(pio)
         , sm_(0)
         , dmaWorkerChan_(0)
         , dmaControlChan_(0)
         , controlBlocks_(nullptr) {
         
+        // Another scanner (on any PIO block) already owns one of our pins
+        for (uint i = 0; i < NumKeys; i++) {
+            uint pin = FirstKeyPin + i;
+            if (isPioFunction(gpio_get_function(pin))) {
+                panic("PIO capacitive scanner: GPIO%u is already assigned to a PIO block", pin);
+            }
+        }
+        
         // Add PIO program to PIO
         pioOffset_ = pio_add_program(pio_, &capacitive_touch_program);
         
@@ -104,21 +138,17 @@ public:
     }
     
     ~PioCapacitiveScanner() {
-        // Stop DMA
-        if (dmaWorkerChan_ != 0) {
-            dma_channel_abort(dmaWorkerChan_);
-            dma_channel_unclaim(dmaWorkerChan_);
-        }
-        if (dmaControlChan_ != 0) {
-            dma_channel_abort(dmaControlChan_);
-            dma_channel_unclaim(dmaControlChan_);
-        }
+        // Stop DMA. The constructor panics rather than leave anything
+        // unclaimed, so channel 0 and SM0 are valid claims too.
+        dma_channel_abort(dmaWorkerChan_);
+        dma_channel_unclaim(dmaWorkerChan_);
+        dma_channel_abort(dmaControlChan_);
+        dma_channel_unclaim(dmaControlChan_);
         
-        // Stop PIO
-        if (pio_ && sm_ != 0) {
-            pio_sm_set_enabled(pio_, sm_, false);
-            pio_sm_unclaim(pio_, sm_);
-        }
+        // Stop PIO and free its program space for the next scanner
+        pio_sm_set_enabled(pio_, sm_, false);
+        pio_sm_unclaim(pio_, sm_);
+        pio_remove_program(pio_, &capacitive_touch_program, pioOffset_);
         
         // Free control blocks
         if (controlBlocks_) {
@@ -126,11 +156,12 @@ public:
             controlBlocks_ = nullptr;
         }
         
-        // Reset GPIOs to safe state
+        // Reset GPIOs to safe state and release them from the PIO block
         for (uint i = 0; i < NumKeys; i++) {
             uint pin = FirstKeyPin + i;
             gpio_set_pulls(pin, false, false);
             gpio_set_dir(pin, GPIO_IN);
+            gpio_deinit(pin);
         }
     }
     
@@ -140,7 +171,9 @@ public:
      * Starts the DMA control chain that will autonomously scan all keys.
      * Non-blocking - use isScanComplete() to check when done.
      */
-    void startScan() {
+    void startScan() override {
+        scanPublished_ = false;
+
         // Clear any previous IRQ
         dma_hw->ints0 = 1u << dmaWorkerChan_;
         
@@ -155,7 +188,7 @@ public:
      * @brief Check if the current scan is complete
      * @return true if scan finished, false if still running
      */
-    bool isScanComplete() const {
+    bool isScanComplete() const override {
         return (dma_hw->intr & (1u << dmaWorkerChan_)) != 0;
     }
     
@@ -184,6 +217,39 @@ public:
         return readings16_;
     }
     
+    /**
+     * @brief Get the last completed scan as a sequence-numbered frame
+     *
+     * The DMA chain overwrites the raw buffer as soon as the next scan starts,
+     * so a completed scan is snapshotted into a frame buffer the first time it
+     * is seen here. Each startScan() therefore yields exactly one frame.
+     */
+    bool pollFrame(uint32_t sinceSequence, midi::ScanFrame& frame) override {
+        if (!scanPublished_ && isScanComplete()) {
+            uint16_t* out = frames_.writeBuffer();
+            for (uint8_t i = 0; i < NumKeys; i++) {
+                out[i] = static_cast<uint16_t>(std::min(0xFFFFFFFF - rawReadings_[i], 0xFFFFul));
+            }
+            frames_.publish(time_us_64());
+            scanPublished_ = true;
+        }
+        return frames_.acquire(sinceSequence, frame);
+    }
+
+    /**
+     * @brief Spin until the running scan completes or the timeout expires
+     */
+    bool waitForFrame(uint32_t sinceSequence, midi::ScanFrame& frame, uint32_t timeoutUs) override {
+        absolute_time_t deadline = make_timeout_time_us(timeoutUs);
+        while (!pollFrame(sinceSequence, frame)) {
+            if (time_reached(deadline)) {
+                return false;
+            }
+            tight_loop_contents();
+        }
+        return true;
+    }
+
     /**
      * @brief Get raw 32-bit readings (full resolution)
      * @return Pointer to array of 32-bit raw counter values
@@ -192,7 +258,7 @@ public:
         return rawReadings_;
     }
     
-    uint8_t getKeyCount() const override {
+    uint16_t getKeyCount() const override {
         return NumKeys;
     }
     
@@ -206,6 +272,8 @@ private:
     
     uint32_t rawReadings_[NumKeys] = {};
     mutable uint16_t readings16_[NumKeys] = {};  // Mutable for lazy conversion in const getter
+    midi::ScanFrameBuffer<NumKeys> frames_;
+    bool scanPublished_ = true;  // No scan pending until startScan()
     
     // Persistent storage for DMA control block references
     uint32_t execctrls_[NumKeys];
@@ -213,6 +281,14 @@ private:
     uint32_t pueEnableBit_ = PADS_BANK0_GPIO0_PUE_BITS;
     uint32_t restartJmp_;
     
+    static bool isPioFunction(gpio_function_t function) {
+        return function == GPIO_FUNC_PIO0 || function == GPIO_FUNC_PIO1
+#if NUM_PIOS > 2
+            || function == GPIO_FUNC_PIO2
+#endif
+            ;
+    }
+    
     /**
      * @brief One-time GPIO setup
      */
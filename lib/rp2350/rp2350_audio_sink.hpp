@@ -19,6 +19,7 @@
 #include "hardware/dma.h"
 #include "hardware/clocks.h"
 #include "i2s.pio.h"
+#include <latency_profile.hpp>
 
 namespace rp2350 {
 
@@ -31,7 +32,12 @@ namespace rp2350 {
  * The clock divider is set so that each 32-bit sample occupies exactly 64 PIO
  * cycles (32 bits × 2 clocks per bit), yielding the requested sample rate.
  *
- * @tparam BUFFER_SIZE Number of samples per buffer
+ * Each transfer sends the first getPeriodFrames() samples of a buffer. The
+ * period follows the latency profile: BUFFER_SIZE for Efficiency, a quarter
+ * of it for LowLatency. Both fit in the same buffers, so switching is just a
+ * different DMA transfer count from the next swap on.
+ *
+ * @tparam BUFFER_SIZE Number of samples per buffer (the longest period)
  */
 template<size_t BUFFER_SIZE>
 class Rp2350AudioSink {
@@ -51,6 +57,7 @@ public:
         , sm_(-1)
         , dmaChannel_(-1)
         , currentBuffer_(0)
+        , periodFrames_(BUFFER_SIZE)
     {
         memset(buffers_[0], 0, sizeof(buffers_[0]));
         memset(buffers_[1], 0, sizeof(buffers_[1]));
@@ -76,7 +83,7 @@ public:
      */
     void start() {
         currentBuffer_ = 0;
-        startDmaTransfer(0);
+        startDmaTransfer(0, periodFrames_);
         pio_sm_set_enabled(pio_, sm_, true);
     }
 
@@ -102,6 +109,23 @@ public:
     /** @brief Number of samples per buffer. */
     constexpr size_t getBufferSize() const { return BUFFER_SIZE; }
 
+    /** @brief Shortest period, used by the LowLatency profile. */
+    static constexpr size_t LOW_LATENCY_PERIOD = BUFFER_SIZE / 4;
+
+    /**
+     * @brief Select the period length for subsequent buffers.
+     *
+     * Safe to call from the other core; the audio loop picks the new period
+     * up the next time it fills a buffer.
+     */
+    void setLatencyProfile(features::LatencyProfile profile) {
+        periodFrames_ = profile == features::LatencyProfile::LowLatency
+            ? LOW_LATENCY_PERIOD : BUFFER_SIZE;
+    }
+
+    /** @brief Number of samples to render into the next inactive buffer. */
+    size_t getPeriodFrames() const { return periodFrames_; }
+
     /** @brief Sample rate in Hz. */
     uint32_t getSampleRate() const { return sampleRate_; }
 
@@ -117,10 +141,12 @@ public:
      * @brief Promote the inactive buffer to active and begin transmitting it.
      *
      * Call only after isTransferComplete() returns true.
+     *
+     * @param frames Number of samples written to the inactive buffer
      */
-    void swapBuffers() {
+    void swapBuffers(size_t frames = BUFFER_SIZE) {
         currentBuffer_ = 1 - currentBuffer_;
-        startDmaTransfer(currentBuffer_);
+        startDmaTransfer(currentBuffer_, frames);
     }
 
 private:
@@ -210,9 +236,9 @@ private:
         printf("I2S audio sink: DMA channel %d ready\n", dmaChannel_);
     }
 
-    void startDmaTransfer(uint8_t bufferIndex) {
+    void startDmaTransfer(uint8_t bufferIndex, size_t frames) {
         dma_channel_set_read_addr(dmaChannel_, buffers_[bufferIndex], false);
-        dma_channel_set_trans_count(dmaChannel_, BUFFER_SIZE, true);
+        dma_channel_set_trans_count(dmaChannel_, frames, true);
     }
 
     uint32_t sampleRate_;
@@ -223,6 +249,7 @@ private:
     uint     sm_;
     int      dmaChannel_;
     uint8_t  currentBuffer_;
+    volatile size_t periodFrames_;  // Written by core 0, read by core 1
     int32_t  buffers_[2][BUFFER_SIZE];
 };
 
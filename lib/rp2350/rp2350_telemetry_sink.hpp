@@ -1,7 +1,8 @@
 #pragma once
 
 #include <telemetry_sink.hpp>
-#include <json.hpp>
+#include <telemetry_frame.hpp>
+#include <json_writer.hpp>
 #include <cstdio>
 
 namespace rp2350 {
@@ -9,18 +10,22 @@ namespace rp2350 {
 /**
  * @brief RP2350 telemetry sink using USB serial output
  * 
- * Outputs telemetry data as JSON Lines to USB serial (stdout).
- * Synchronous output - no buffering or background tasks.
+ * Outputs telemetry data to USB serial (stdout), either as JSON Lines or as
+ * binary frames (see features::TelemetryFrameWriter) that interleave safely
+ * with text logs. Synchronous output - no buffering or background tasks.
  * 
- * @tparam TelemetryDataT Type of telemetry data (must have to_json function)
+ * @tparam TelemetryDataT Type of telemetry data (must have to_json, and
+ *         to_binary for the binary format)
  */
 template<typename TelemetryDataT>
 class Rp2350TelemetrySink : public features::TelemetrySink<TelemetryDataT> {
 public:
     /**
      * @brief Construct RP2350 telemetry sink
+     * @param format Wire format (binary is ~4x smaller and much cheaper to produce)
      */
-    Rp2350TelemetrySink() = default;
+    explicit Rp2350TelemetrySink(features::TelemetryFormat format = features::TelemetryFormat::Json)
+        : format_(format) {}
     
     ~Rp2350TelemetrySink() override = default;
     
@@ -29,8 +34,19 @@ public:
      * @param data Telemetry data to serialize and output
      */
     void sendTelemetry(const TelemetryDataT& data) override {
-        nlohmann::json j = data;
-        printf("%s\n", j.dump().c_str());
+        if (format_ == features::TelemetryFormat::Binary) {
+            features::writeTelemetryFrame(data, writeStdout, nullptr);
+            fflush(stdout);
+            return;
+        }
+        features::writeJsonLine(data, features::writeJsonToFile, stdout);
+    }
+
+private:
+    features::TelemetryFormat format_;
+
+    static void writeStdout(const uint8_t* data, size_t length, void* /*context*/) {
+        fwrite(data, 1, length, stdout);
     }
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <math.h>  // Use C math.h for single-precision cosf/sinf
+#include <sample_rate.hpp>
 
 namespace synth {
 
@@ -30,7 +31,8 @@ public:
     }
 
     BiquadFilter(float sampleRate = 44100.0f)
-        : sampleRate_(sampleRate) {
+        : sampleRate_(sampleRate)
+        , inverseSampleRate_(1.0f / sampleRate) {
         reset();
         updateCoefficients();
     }
@@ -56,10 +58,14 @@ public:
      * Only recalculates when change exceeds 1% OR 10Hz threshold.
      * This dramatically reduces CPU usage with envelope modulation while
      * remaining perceptually transparent (threshold is well below JND).
+     *
+     * @tparam Rate Sample rate policy; modulation calls this every sample, so
+     *              a FixedSampleRate folds the clamp and omega scaling
      */
+    template<typename Rate = RuntimeSampleRate>
     inline void setCutoff(float frequencyHz) {
         // Clamp to valid range
-        float nyquist = sampleRate_ * 0.5f;
+        float nyquist = Rate::rate(sampleRate_) * 0.5f;
         if (frequencyHz < 20.0f) frequencyHz = 20.0f;
         if (frequencyHz > nyquist * 0.99f) frequencyHz = nyquist * 0.99f;
         
@@ -73,7 +79,7 @@ public:
         // This aggressive threshold dramatically reduces CPU load with envelope modulation
         if (relDelta > 0.03f || absDelta > 20.0f) {
             cutoffHz_ = frequencyHz;
-            updateCoefficients();
+            updateCoefficients<Rate>();
         }
     }
     
@@ -137,11 +143,12 @@ private:
      * @brief Calculate biquad coefficients using RBJ formulas
      * Called immediately when parameters change (eager evaluation).
      */
+    template<typename Rate = RuntimeSampleRate>
     inline void updateCoefficients() {
         const float PI = 3.14159265358979323846f;
         
         // Calculate normalized frequency (omega)
-        float w0 = 2.0f * PI * cutoffHz_ / sampleRate_;
+        float w0 = 2.0f * PI * Rate::inverse(inverseSampleRate_) * cutoffHz_;
         float cosw0 = cosf(w0);   // Single-precision, hardware accelerated on ESP32
         float sinw0 = sinf(w0);   // Single-precision, hardware accelerated on ESP32
         float alpha = sinw0 / (2.0f * q_);
@@ -216,6 +223,7 @@ private:
     
     // Sample rate
     float sampleRate_;
+    float inverseSampleRate_;
     
     // Filter parameters
     Mode mode_ = Mode::LOWPASS;
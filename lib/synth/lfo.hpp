@@ -17,7 +17,8 @@ constexpr float LFO_PI = 3.14159265358979323846f;
 class Lfo {
 public:
     Lfo(float sampleRate = 44100.0f)
-        : sampleRate_(sampleRate) {
+        : sampleRate_(sampleRate)
+        , inverseSampleRate_(1.0f / sampleRate) {
         updateIncrement();
     }
 
@@ -93,10 +94,11 @@ public:
 
 private:
     inline void updateIncrement() {
-        phaseIncrement_ = rate_ / sampleRate_;
+        phaseIncrement_ = rate_ * inverseSampleRate_;
     }
 
     float sampleRate_;
+    float inverseSampleRate_;
     float rate_ = 5.0f;      // Default 5 Hz
     float depth_ = 0.0f;     // Default off
     float phase_ = 0.0f;     // Current phase [0, 1)
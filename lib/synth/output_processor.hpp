@@ -1,35 +1,19 @@
 #pragma once
 
 #include <cmath>
-#include <vector>
-#include <memory>
+#include <cstddef>
+#include <cstdint>
 #include "biquad_filter.hpp"
 
 namespace synth {
 
 /**
- * @brief Base class for clipping/waveshaping algorithms
- * 
- * ClippingAlgorithms are pure strategy objects that implement the waveshaping
- * transfer function. They are stateless and lightweight.
+ * Clipping/waveshaping algorithms
+ *
+ * Each is a stateless transfer function with a static shape(); the output
+ * processor picks one per block with a switch and instantiates its fused
+ * per-sample loop for it, so there is no call per sample or per buffer.
  */
-class ClippingAlgorithm {
-public:
-    virtual ~ClippingAlgorithm() = default;
-    
-    /**
-     * @brief Apply clipping/waveshaping to an entire buffer in-place
-     * @param buffer Mono audio buffer to process in-place
-     * @param numFrames Number of frames in buffer
-     * @param drive Amount to multiply each input sample by before clipping/waveshaping (controls intensity)
-     */
-    virtual void processBuffer(float* buffer, unsigned int numFrames, float drive) const = 0;
-    
-    /**
-     * @brief Get algorithm name for UI display
-     */
-    virtual const char* getName() const = 0;
-};
 
 /**
  * @brief Soft clipper using hyperbolic tangent waveshaping
@@ -42,14 +26,11 @@ public:
  * - Drive = 1.0: Unity gain for small signals, soft limiting for large
  * - Drive > 1.0: Adds harmonic saturation/distortion
  */
-class TanhClipping : public ClippingAlgorithm {
-public:
-    const char* getName() const override { return "TanhClipper"; }
+struct TanhClipping {
+    static constexpr const char* NAME = "TanhClipper";
     
-    void processBuffer(float* buffer, unsigned int numFrames, float drive) const override {
-        for (unsigned int i = 0; i < numFrames; ++i) {
-            buffer[i] = std::tanh(buffer[i] * drive);
-        }
+    static inline float shape(float x) {
+        return std::tanh(x);
     }
 };
 
@@ -63,24 +44,15 @@ public:
  * Multiple folds can occur for large input signals, creating complex spectra.
  * Folds at fixed ±1.0 threshold; drive controls input gain.
  */
-class WaveFoldClipping : public ClippingAlgorithm {
-public:
-    const char* getName() const override { return "WaveFolder"; }
-    
-    void processBuffer(float* buffer, unsigned int numFrames, float drive) const override {
-        for (unsigned int i = 0; i < numFrames; ++i) {
-            buffer[i] = wavefold(buffer[i] * drive);
-        }
-    }
-    
-private:
+struct WaveFoldClipping {
+    static constexpr const char* NAME = "WaveFolder";
     static constexpr float FOLD_THRESHOLD = 1.0f;
     
     /**
      * @brief Fold waveform at ±1.0 boundaries
      * Creates triangle wave pattern for signals exceeding ±1.0
      */
-    inline float wavefold(float x) const {
+    static inline float shape(float x) {
         // Normalize to [0, 1] range around threshold
         x = (x / FOLD_THRESHOLD) * 0.5f + 0.5f;
         
@@ -103,17 +75,8 @@ private:
  * creating a warmer, less aggressive character with reduced high harmonics.
  * Combines the folding concept with soft saturation at the peaks.
  */
-class SoftWaveFoldClipping : public ClippingAlgorithm {
-public:
-    const char* getName() const override { return "SoftWaveFolder"; }
-    
-    void processBuffer(float* buffer, unsigned int numFrames, float drive) const override {
-        for (unsigned int i = 0; i < numFrames; ++i) {
-            buffer[i] = wavefoldSoft(buffer[i] * drive);
-        }
-    }
-    
-private:
+struct SoftWaveFoldClipping {
+    static constexpr const char* NAME = "SoftWaveFolder";
     static constexpr float FOLD_THRESHOLD = 1.0f;
     static constexpr float SOFTNESS = 3.0f;  // Controls smoothness at fold points
     
@@ -121,7 +84,7 @@ private:
      * @brief Soft fold waveform at ±1.0 boundaries
      * Uses tanh to smooth the triangle wave peaks for warmer distortion
      */
-    inline float wavefoldSoft(float x) const {
+    static inline float shape(float x) {
         // Normalize to [0, 1] range around threshold
         x = (x / FOLD_THRESHOLD) * 0.5f + 0.5f;
         
@@ -146,47 +109,60 @@ private:
 /**
  * @brief Output processor with switchable clipping algorithms and post-filter
  * 
- * Manages multiple clipping algorithms and allows runtime switching between them.
- * Applies a shared post-filter after clipping to smooth high-frequency harmonics.
+ * Allows runtime switching between the clipping algorithms above and applies
+ * a shared post-filter after clipping to smooth high-frequency harmonics.
  * 
  * Processing chain: Input → Clipping Algorithm → Post-Filter → Output
+ * 
+ * process() runs the whole chain in one pass per block: it reads each input
+ * sample once and hands the result straight to a writer, which stores it in
+ * the sink's format (see platform::FloatSampleWriter and
+ * platform::SampleWriter), so no intermediate buffer is rewritten.
  */
 class OutputProcessor {
 public:
+    /**
+     * @brief Available clipping algorithms, in nextMode() order
+     */
+    enum class ClipMode : uint8_t {
+        TANH,
+        WAVE_FOLD,
+        SOFT_WAVE_FOLD,
+        COUNT
+    };
+    
     OutputProcessor(float normalizedDrive = 0.5f, float sampleRate = 44100.0f) 
         : drive_(normalizedDrive),
           postFilter_(sampleRate),
-          activeIndex_(0) {
+          mode_(ClipMode::TANH) {
         // Initialize post-filter as a low-pass at 10kHz with Q=0.707 (Butterworth)
         postFilter_.setMode(BiquadFilter::Mode::LOWPASS);
         postFilter_.setCutoff(10000.0f);
         postFilter_.setQ(0.707f);
-        
-        // Initialize all available clipping algorithms
-        algorithms_.push_back(std::make_unique<TanhClipping>());
-        algorithms_.push_back(std::make_unique<WaveFoldClipping>());
-        algorithms_.push_back(std::make_unique<SoftWaveFoldClipping>());
     }
     
     /**
-     * @brief Process audio buffer in-place
-     * @param buffer Mono audio buffer to process
-     * @param numFrames Number of frames in buffer
-     * 
-     * Applies active clipping algorithm then post-filter in two passes.
-     * Two-pass approach reduces virtual function call overhead.
+     * @brief Clip, filter and write a block in one pass
+     * @param input Mono mix
+     * @param numFrames Number of frames
+     * @param write Called as write(frame, sample) with each output sample
      */
-    void processBuffer(float* buffer, unsigned int numFrames) {
+    template<typename Writer>
+    void process(const float* input, unsigned int numFrames, Writer&& write) {
         // Map normalized drive [0, 1] to exponential range [0.1, 10.0]
         // 0.0 → 0.1x, 0.5 → 1.0x (unity), 1.0 → 10.0x
-        float actualDrive = 0.1f * std::pow(100.0f, drive_);
-        
-        // Pass 1: Apply clipping/waveshaping (one virtual call per buffer)
-        algorithms_[activeIndex_]->processBuffer(buffer, numFrames, actualDrive);
+        const float actualDrive = 0.1f * std::pow(100.0f, drive_);
         
-        // Pass 2: Apply post-filter
-        for (unsigned int i = 0; i < numFrames; ++i) {
-            buffer[i] = postFilter_.processSample(buffer[i]);
+        switch (mode_) {
+            case ClipMode::WAVE_FOLD:
+                processWith<WaveFoldClipping>(input, numFrames, actualDrive, write);
+                break;
+            case ClipMode::SOFT_WAVE_FOLD:
+                processWith<SoftWaveFoldClipping>(input, numFrames, actualDrive, write);
+                break;
+            default:
+                processWith<TanhClipping>(input, numFrames, actualDrive, write);
+                break;
         }
     }
     
@@ -197,7 +173,7 @@ public:
      * from incompatible delay line values.
      */
     inline void nextMode() {
-        activeIndex_ = (activeIndex_ + 1) % algorithms_.size();
+        mode_ = static_cast<ClipMode>((static_cast<size_t>(mode_) + 1) % MODE_COUNT);
         postFilter_.reset();  // Clear filter state on mode switch
     }
     
@@ -205,7 +181,7 @@ public:
      * @brief Get current algorithm index
      */
     inline size_t getModeIndex() const {
-        return activeIndex_;
+        return static_cast<size_t>(mode_);
     }
     
     /**
@@ -214,8 +190,8 @@ public:
      * Resets the post-filter state when switching to avoid transients.
      */
     inline void setModeIndex(size_t index) {
-        if (index < algorithms_.size() && index != activeIndex_) {
-            activeIndex_ = index;
+        if (index < MODE_COUNT && index != getModeIndex()) {
+            mode_ = static_cast<ClipMode>(index);
             postFilter_.reset();  // Clear filter state on mode switch
         }
     }
@@ -240,7 +216,11 @@ public:
      * @brief Get current algorithm name for UI display
      */
     const char* getName() const {
-        return algorithms_[activeIndex_]->getName();
+        switch (mode_) {
+            case ClipMode::WAVE_FOLD:      return WaveFoldClipping::NAME;
+            case ClipMode::SOFT_WAVE_FOLD: return SoftWaveFoldClipping::NAME;
+            default:                       return TanhClipping::NAME;
+        }
     }
     
     /**
@@ -256,10 +236,18 @@ public:
     BiquadFilter& getPostFilter() { return postFilter_; }
     
 private:
+    static constexpr size_t MODE_COUNT = static_cast<size_t>(ClipMode::COUNT);
+    
     float drive_;  // Normalized drive [0.0, 1.0]
     BiquadFilter postFilter_;  // Low-pass filter applied after clipping/shaping
-    std::vector<std::unique_ptr<ClippingAlgorithm>> algorithms_;
-    size_t activeIndex_;
+    ClipMode mode_;
+    
+    template<typename Clipper, typename Writer>
+    void processWith(const float* input, unsigned int numFrames, float drive, Writer& write) {
+        for (unsigned int i = 0; i < numFrames; ++i) {
+            write(i, postFilter_.processSample(Clipper::shape(input[i] * drive)));
+        }
+    }
 };
 
 } // namespace synth
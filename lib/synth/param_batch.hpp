@@ -0,0 +1,175 @@
+#pragma once
+
+#include <synth_params.hpp>
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+namespace synth {
+
+/**
+ * @brief A set of voice parameter changes applied together
+ *
+ * Holds at most one value per SYNTH_PARAMS entry; setting a parameter twice
+ * keeps the last value. Fixed size, so batches can be copied between threads
+ * without touching the heap.
+ */
+struct ParamBatch {
+    std::bitset<PARAM_COUNT> changed;
+    float values[PARAM_COUNT];
+
+    void set(const ParamDescriptor& param, float value) {
+        size_t index = paramIndex(param);
+        values[index] = value;
+        changed.set(index);
+    }
+
+    /**
+     * @brief Add another batch's changes; its values win where both set a param
+     */
+    void merge(const ParamBatch& other) {
+        for (size_t i = 0; i < PARAM_COUNT; i++) {
+            if (other.changed.test(i)) {
+                values[i] = other.values[i];
+            }
+        }
+        changed |= other.changed;
+    }
+
+    /**
+     * @brief Set every parameter to the value it has in one voice
+     */
+    void captureFrom(WavetableSynth& voice) {
+        for (size_t i = 0; i < PARAM_COUNT; i++) {
+            values[i] = SYNTH_PARAMS[i].get(voice);
+        }
+        changed.set();
+    }
+
+    void clear() { changed.reset(); }
+    bool empty() const { return changed.none(); }
+    size_t size() const { return changed.count(); }
+
+    /**
+     * @brief Apply every changed parameter to one voice, in table order
+     */
+    void applyTo(WavetableSynth& voice) const {
+        for (size_t i = 0; i < PARAM_COUNT; i++) {
+            if (changed.test(i)) {
+                SYNTH_PARAMS[i].set(voice, values[i]);
+            }
+        }
+    }
+};
+
+/**
+ * @brief Lock-free single-producer, single-consumer queue of parameter batches
+ *
+ * The control thread (or core) pushes batches; the audio thread drains them
+ * between blocks, so all changes in a batch take effect at the same sample
+ * and no block is rendered with half of them applied.
+ *
+ * @tparam Capacity Number of batches that can be pending (power of two)
+ */
+template<size_t Capacity>
+class ParamBatchQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    /**
+     * @brief Queue a batch (producer side)
+     * @return false if the queue is full; the batch is dropped
+     */
+    bool push(const ParamBatch& batch) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        slots_[tail & (Capacity - 1)] = batch;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Hand every pending batch, oldest first, to apply(const ParamBatch&)
+     *        (consumer side)
+     * @return Number of batches applied
+     */
+    template<typename Apply>
+    size_t drain(Apply&& apply) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        const uint32_t tail = tail_.load(std::memory_order_acquire);
+        size_t count = 0;
+        while (head != tail) {
+            apply(static_cast<const ParamBatch&>(slots_[head & (Capacity - 1)]));
+            head++;
+            count++;
+        }
+        head_.store(head, std::memory_order_release);
+        return count;
+    }
+
+private:
+    ParamBatch slots_[Capacity];
+    std::atomic<uint32_t> head_{0};
+    std::atomic<uint32_t> tail_{0};
+};
+
+/**
+ * @brief Voice param values published by the audio side, readable from any thread
+ *
+ * The audio thread publishes after it changes voice params; other threads
+ * copy the values out instead of reading the voices while they render.
+ * A sequence lock: publish() never waits, and read() retries if a publish
+ * overlapped. Alongside the values it carries how many queued batches they
+ * include, so the control side can tell which of its changes are still in
+ * flight. One publishing thread only.
+ */
+class ParamSnapshot {
+public:
+    /**
+     * @brief Publish a voice's params (audio thread)
+     * @param voice Any voice; all voices share their params
+     * @param appliedBatches Batches drained from the queue so far
+     */
+    void publish(WavetableSynth& voice, uint32_t appliedBatches) {
+        const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < PARAM_COUNT; i++) {
+            values_[i].store(SYNTH_PARAMS[i].get(voice), std::memory_order_relaxed);
+        }
+        appliedBatches_.store(appliedBatches, std::memory_order_relaxed);
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy the published values (any thread)
+     * @param values Receives PARAM_COUNT values in table order
+     * @return Batches included in the values
+     */
+    uint32_t read(float* values) const {
+        for (;;) {
+            const uint32_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            for (size_t i = 0; i < PARAM_COUNT; i++) {
+                values[i] = values_[i].load(std::memory_order_relaxed);
+            }
+            const uint32_t applied = appliedBatches_.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                return applied;
+            }
+        }
+    }
+
+private:
+    std::atomic<uint32_t> sequence_{0};   // Odd while a publish is in progress
+    std::atomic<float> values_[PARAM_COUNT] = {};
+    std::atomic<uint32_t> appliedBatches_{0};
+};
+
+} // namespace synth
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+namespace synth {
+
+/**
+ * @brief Sample rate policy: the rate the component was constructed with
+ *
+ * DSP components keep their rate and its reciprocal as members, so the
+ * runtime version multiplies by a stored reciprocal instead of dividing.
+ * Per-sample methods take the rate policy as a template parameter
+ * (defaulting to this one) and ask it for the rate through these functions,
+ * handing in the stored values.
+ */
+struct RuntimeSampleRate {
+    static constexpr bool IS_FIXED = false;
+
+    static unsigned int resolve(unsigned int requested) { return requested; }
+    static float rate(float stored) { return stored; }
+    static float inverse(float storedInverse) { return storedInverse; }
+};
+
+/**
+ * @brief Sample rate policy: a rate fixed at compile time
+ *
+ * For firmware builds, where the rate is a constexpr anyway. The stored
+ * values are ignored, so reciprocals and Nyquist clamps in the per-sample
+ * code fold to constants. Components must still be constructed with the
+ * same rate, for what they derive at setup (see resolve()).
+ *
+ * @tparam Hz Sample rate
+ */
+template<uint32_t Hz>
+struct FixedSampleRate {
+    static_assert(Hz > 0, "Sample rate must be positive");
+    static constexpr bool IS_FIXED = true;
+    static constexpr uint32_t HZ = Hz;
+
+    /** @brief The rate to construct components with, whatever was asked for */
+    static constexpr unsigned int resolve(unsigned int) { return Hz; }
+    static constexpr float rate(float) { return static_cast<float>(Hz); }
+    static constexpr float inverse(float) { return 1.0f / static_cast<float>(Hz); }
+};
+
+} // namespace synth
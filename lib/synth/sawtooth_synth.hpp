@@ -7,6 +7,7 @@
 #include <lfo.hpp>
 #include <aftertouch_modulator.hpp>
 #include <performance_timer.hpp>
+#include <sample_rate.hpp>
 #include <cmath>
 
 namespace synth {
@@ -28,7 +29,7 @@ namespace synth {
  * Filter envelope amount controls modulation depth.
  * Aftertouch can modulate filter cutoff, filter env amount, vibrato, and tremolo.
  */
-class WavetableSynth : public Voice {
+class WavetableSynth final : public EngineVoice {
 public:
     WavetableSynth(float sampleRate = 44100.0f) 
         : sampleRate_(sampleRate),
@@ -194,7 +195,7 @@ public:
      * @brief Set per-voice aftertouch level
      * @param aftertouch Normalized aftertouch [0.0, 1.0]
      */
-    void setAftertouch(float aftertouch) {
+    void setAftertouch(float aftertouch) override {
         aftertouch_ = aftertouch;
         if (aftertouch_ < 0.0f) aftertouch_ = 0.0f;
         if (aftertouch_ > 1.0f) aftertouch_ = 1.0f;
@@ -220,15 +221,26 @@ public:
     void setTremoloDepthAtMod(float amount) { tremoloDepth_atMod_ = amount; }
     float getTremoloDepthAtMod() const { return tremoloDepth_atMod_; }
     
+    /**
+     * @brief Generate the next audio sample, untimed (for mixed-engine pools)
+     */
+    float nextSample() override {
+        features::UntimedLapTimer timer;
+        return nextSample(timer);
+    }
+
     /**
      * @brief Generate the next audio sample
      * 
+     * @tparam Rate Sample rate policy. FixedSampleRate (matching the rate
+     *              this voice was constructed with) turns the per-sample
+     *              rate arithmetic of the oscillator and filter into constants.
      * @tparam TimingPolicy Policy class providing now() and unitName()
      * @tparam MaxSpans Maximum number of span names the timer can track
      * @param timer Lap timer for performance measurement. Span names use "synth:" prefix.
      * @return Audio sample in range [-1.0, 1.0]
      */
-    template<typename TimingPolicy, size_t MaxSpans>
+    template<typename Rate = RuntimeSampleRate, typename TimingPolicy, size_t MaxSpans>
     float nextSample(features::LapTimer<TimingPolicy, MaxSpans>& timer) {
         if (!ampEnvelope_.isActive()) {
             timer.nextSpan("synth:inactive");
@@ -264,7 +276,7 @@ public:
         
         // Generate oscillator sample
         timer.nextSpan("synth:oscillator");
-        float sample = oscillator_.nextSample(frequency);
+        float sample = oscillator_.template nextSample<Rate>(frequency);
         
         // Calculate filter cutoff with envelope modulation
         timer.nextSpan("synth:filter_env");
@@ -275,7 +287,7 @@ public:
         float modulatedCutoff = effectiveCutoff * (1.0f + envModulation * 9.0f);  // Up to 10x base cutoff
         
         timer.nextSpan("synth:filter");
-        filter_.setCutoff(modulatedCutoff);
+        filter_.template setCutoff<Rate>(modulatedCutoff);
         
         // Apply filter
         sample = filter_.processSample(sample);
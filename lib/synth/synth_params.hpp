@@ -0,0 +1,297 @@
+#pragma once
+
+#include <sawtooth_synth.hpp>
+#include <biquad_filter.hpp>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace synth {
+
+/**
+ * @brief How a 7-bit MIDI CC value maps onto a parameter's range
+ */
+enum class ParamCurve : uint8_t {
+    LINEAR,       // min + n * (max - min)
+    EXPONENTIAL,  // min * (max / min)^n, for frequencies
+    STEPPED       // Linear, rounded to the nearest integer
+};
+
+/**
+ * @brief Describes one synth voice parameter
+ *
+ * min/max is the range a mapped CC sweeps; parameters without a CC keep the
+ * control panel's range for reference. Values set by name (control panel,
+ * presets) are applied as given.
+ */
+struct ParamDescriptor {
+    const char* name;                            // Control panel / preset JSON key
+    uint8_t cc;                                  // MIDI CC number, or NO_CC
+    float min;
+    float max;
+    ParamCurve curve;
+    float defaultValue;                          // Used when a preset doesn't set it
+    bool isInt;                                  // Serialized as an integer
+    void (*set)(WavetableSynth& voice, float value);
+    float (*get)(WavetableSynth& voice);
+
+    /**
+     * @brief Map a 7-bit CC value onto this parameter's range
+     */
+    float fromCC(uint8_t value) const {
+        float normalized = static_cast<float>(value) / 127.0f;
+        switch (curve) {
+            case ParamCurve::EXPONENTIAL:
+                return min * std::pow(max / min, normalized);
+            case ParamCurve::STEPPED:
+                return std::round(min + normalized * (max - min));
+            case ParamCurve::LINEAR:
+            default:
+                return min + normalized * (max - min);
+        }
+    }
+};
+
+static constexpr uint8_t NO_CC = 0xFF;
+
+/**
+ * @brief The synth voice parameters, in the order they are applied
+ *
+ * This table is the single description of every voice parameter: CC
+ * dispatch, setParam/getParams, presets and params telemetry all iterate or
+ * index it. Adding a parameter is one line here. Names must be unique, CC
+ * numbers must be unique, and the table is limited to 254 entries (checked at
+ * compile time below).
+ */
+static constexpr ParamDescriptor SYNTH_PARAMS[] = {
+    // Oscillator
+    {"waveformShape",         1,     0.0f,   1.0f,     ParamCurve::LINEAR,      0.0f,   false,
+        [](WavetableSynth& v, float x) { v.getOscillator().updateWavetable(x); },
+        [](WavetableSynth& v) { return v.getOscillator().getShape(); }},
+    // Filter
+    {"baseCutoff",            20,    100.0f, 10000.0f, ParamCurve::EXPONENTIAL, 1000.0f, false,
+        [](WavetableSynth& v, float x) { v.setBaseCutoff(x); },
+        [](WavetableSynth& v) { return v.getBaseCutoff(); }},
+    {"filterQ",               21,    0.1f,   20.0f,    ParamCurve::LINEAR,      0.707f, false,
+        [](WavetableSynth& v, float x) { v.getFilter().setQ(x); },
+        [](WavetableSynth& v) { return v.getFilter().getQ(); }},
+    {"filterMode",            NO_CC, 0.0f,   static_cast<float>(static_cast<int>(BiquadFilter::Mode::__COUNT) - 1),
+                                                       ParamCurve::STEPPED,     0.0f,   true,
+        [](WavetableSynth& v, float x) { v.getFilter().setMode(static_cast<BiquadFilter::Mode>(static_cast<int>(x))); },
+        [](WavetableSynth& v) { return static_cast<float>(static_cast<int>(v.getFilter().getMode())); }},
+    // Filter envelope
+    {"filterEnvAmount",       NO_CC, 0.0f,   1.0f,     ParamCurve::LINEAR,      0.5f,   false,
+        [](WavetableSynth& v, float x) { v.setFilterEnvelopeAmount(x); },
+        [](WavetableSynth& v) { return v.getFilterEnvelopeAmount(); }},
+    {"filterEnvAttack",       71,    0.001f, 2.001f,   ParamCurve::LINEAR,      0.005f, false,
+        [](WavetableSynth& v, float x) { v.getFilterEnvelope().setAttackTime(x); },
+        [](WavetableSynth& v) { return v.getFilterEnvelope().getAttackTime(); }},
+    {"filterEnvDecay",        72,    0.01f,  5.01f,    ParamCurve::LINEAR,      0.2f,   false,
+        [](WavetableSynth& v, float x) { v.getFilterEnvelope().setDecayTime(x); },
+        [](WavetableSynth& v) { return v.getFilterEnvelope().getDecayTime(); }},
+    {"filterEnvSustain",      25,    0.0f,   1.0f,     ParamCurve::LINEAR,      0.3f,   false,
+        [](WavetableSynth& v, float x) { v.getFilterEnvelope().setSustainLevel(x); },
+        [](WavetableSynth& v) { return v.getFilterEnvelope().getSustainLevel(); }},
+    {"filterEnvRelease",      73,    0.01f,  5.01f,    ParamCurve::LINEAR,      0.1f,   false,
+        [](WavetableSynth& v, float x) { v.getFilterEnvelope().setReleaseTime(x); },
+        [](WavetableSynth& v) { return v.getFilterEnvelope().getReleaseTime(); }},
+    // Amplitude envelope
+    {"ampEnvAttack",          NO_CC, 0.001f, 2.0f,     ParamCurve::LINEAR,      0.01f,  false,
+        [](WavetableSynth& v, float x) { v.getAmpEnvelope().setAttackTime(x); },
+        [](WavetableSynth& v) { return v.getAmpEnvelope().getAttackTime(); }},
+    {"ampEnvDecay",           NO_CC, 0.01f,  5.0f,     ParamCurve::LINEAR,      0.05f,  false,
+        [](WavetableSynth& v, float x) { v.getAmpEnvelope().setDecayTime(x); },
+        [](WavetableSynth& v) { return v.getAmpEnvelope().getDecayTime(); }},
+    {"ampEnvSustain",         NO_CC, 0.0f,   1.0f,     ParamCurve::LINEAR,      0.7f,   false,
+        [](WavetableSynth& v, float x) { v.getAmpEnvelope().setSustainLevel(x); },
+        [](WavetableSynth& v) { return v.getAmpEnvelope().getSustainLevel(); }},
+    {"ampEnvRelease",         NO_CC, 0.01f,  5.0f,     ParamCurve::LINEAR,      0.1f,   false,
+        [](WavetableSynth& v, float x) { v.getAmpEnvelope().setReleaseTime(x); },
+        [](WavetableSynth& v) { return v.getAmpEnvelope().getReleaseTime(); }},
+    // Vibrato (pitch modulation): rate in Hz, depth in semitones
+    {"vibratoRate",           NO_CC, 0.1f,   20.0f,    ParamCurve::LINEAR,      5.0f,   false,
+        [](WavetableSynth& v, float x) { v.setVibratoRate(x); },
+        [](WavetableSynth& v) { return v.getVibratoRate(); }},
+    {"vibratoDepth",          NO_CC, 0.0f,   1.0f,     ParamCurve::LINEAR,      0.0f,   false,
+        [](WavetableSynth& v, float x) { v.setVibratoDepth(x); },
+        [](WavetableSynth& v) { return v.getVibratoDepth(); }},
+    // Tremolo (amplitude modulation)
+    {"tremoloRate",           NO_CC, 0.1f,   20.0f,    ParamCurve::LINEAR,      5.0f,   false,
+        [](WavetableSynth& v, float x) { v.setTremoloRate(x); },
+        [](WavetableSynth& v) { return v.getTremoloRate(); }},
+    {"tremoloDepth",          NO_CC, 0.0f,   1.0f,     ParamCurve::LINEAR,      0.0f,   false,
+        [](WavetableSynth& v, float x) { v.setTremoloDepth(x); },
+        [](WavetableSynth& v) { return v.getTremoloDepth(); }},
+    // Aftertouch modulation amounts: 0 = no effect, positive = increase with pressure
+    {"baseCutoff_atMod",      NO_CC, -1.0f,  1.0f,     ParamCurve::LINEAR,      0.0f,   false,
+        [](WavetableSynth& v, float x) { v.setBaseCutoffAtMod(x); },
+        [](WavetableSynth& v) { return v.getBaseCutoffAtMod(); }},
+    {"filterEnvAmount_atMod", NO_CC, -1.0f,  1.0f,     ParamCurve::LINEAR,      0.0f,   false,
+        [](WavetableSynth& v, float x) { v.setFilterEnvAmountAtMod(x); },
+        [](WavetableSynth& v) { return v.getFilterEnvAmountAtMod(); }},
+    {"vibratoDepth_atMod",    NO_CC, -1.0f,  1.0f,     ParamCurve::LINEAR,      0.0f,   false,
+        [](WavetableSynth& v, float x) { v.setVibratoDepthAtMod(x); },
+        [](WavetableSynth& v) { return v.getVibratoDepthAtMod(); }},
+    {"tremoloDepth_atMod",    NO_CC, -1.0f,  1.0f,     ParamCurve::LINEAR,      0.0f,   false,
+        [](WavetableSynth& v, float x) { v.setTremoloDepthAtMod(x); },
+        [](WavetableSynth& v) { return v.getTremoloDepthAtMod(); }},
+};
+
+static constexpr size_t PARAM_COUNT = sizeof(SYNTH_PARAMS) / sizeof(SYNTH_PARAMS[0]);
+static constexpr uint8_t NO_PARAM = 0xFF;
+
+namespace param_index_detail {
+
+constexpr bool namesEqual(const char* a, const char* b, size_t bLength) {
+    for (size_t i = 0; i < bLength; i++) {
+        if (a[i] != b[i] || a[i] == '\0') {
+            return false;
+        }
+    }
+    return a[bLength] == '\0';
+}
+
+constexpr size_t nameLength(const char* s) {
+    size_t n = 0;
+    while (s[n] != '\0') {
+        n++;
+    }
+    return n;
+}
+
+// FNV-1a, shared by the compile-time table builder and runtime lookups
+constexpr uint32_t hashName(const char* s, size_t length) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        h = (h ^ static_cast<uint8_t>(s[i])) * 16777619u;
+    }
+    return h;
+}
+
+// Open-addressing hash slots, at least 4x the parameter count
+constexpr size_t hashSlots() {
+    size_t slots = 1;
+    while (slots < PARAM_COUNT * 4) {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+constexpr std::array<uint8_t, 128> buildCCIndex() {
+    std::array<uint8_t, 128> index{};
+    for (auto& slot : index) {
+        slot = NO_PARAM;
+    }
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        if (SYNTH_PARAMS[i].cc != NO_CC) {
+            index[SYNTH_PARAMS[i].cc] = static_cast<uint8_t>(i);
+        }
+    }
+    return index;
+}
+
+constexpr std::array<uint8_t, hashSlots()> buildNameIndex() {
+    std::array<uint8_t, hashSlots()> index{};
+    for (auto& slot : index) {
+        slot = NO_PARAM;
+    }
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        const char* name = SYNTH_PARAMS[i].name;
+        size_t slot = hashName(name, nameLength(name)) & (hashSlots() - 1);
+        while (index[slot] != NO_PARAM) {
+            slot = (slot + 1) & (hashSlots() - 1);
+        }
+        index[slot] = static_cast<uint8_t>(i);
+    }
+    return index;
+}
+
+constexpr bool namesAndCCsUnique() {
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        if (SYNTH_PARAMS[i].cc != NO_CC && SYNTH_PARAMS[i].cc > 127) {
+            return false;
+        }
+        for (size_t j = i + 1; j < PARAM_COUNT; j++) {
+            const char* other = SYNTH_PARAMS[j].name;
+            if (namesEqual(SYNTH_PARAMS[i].name, other, nameLength(other))) {
+                return false;
+            }
+            if (SYNTH_PARAMS[i].cc != NO_CC && SYNTH_PARAMS[i].cc == SYNTH_PARAMS[j].cc) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace param_index_detail
+
+static_assert(PARAM_COUNT < NO_PARAM, "Too many synth params for 8-bit indices");
+static_assert(param_index_detail::namesAndCCsUnique(), "Synth param names and CC numbers must be unique");
+
+/**
+ * @brief Parameter index by CC number (NO_PARAM if unmapped)
+ */
+static constexpr std::array<uint8_t, 128> PARAM_BY_CC = param_index_detail::buildCCIndex();
+
+/**
+ * @brief Parameter index hash table keyed by name (see findParam)
+ */
+static constexpr auto PARAM_BY_NAME = param_index_detail::buildNameIndex();
+
+/**
+ * @brief Look up a parameter by name in constant time
+ * @param name Name characters (need not be null-terminated)
+ * @param length Name length
+ * @return Descriptor, or nullptr if no parameter has that name
+ */
+inline const ParamDescriptor* findParam(const char* name, size_t length) {
+    const size_t mask = PARAM_BY_NAME.size() - 1;
+    size_t slot = param_index_detail::hashName(name, length) & mask;
+    while (PARAM_BY_NAME[slot] != NO_PARAM) {
+        const ParamDescriptor& p = SYNTH_PARAMS[PARAM_BY_NAME[slot]];
+        if (param_index_detail::namesEqual(p.name, name, length)) {
+            return &p;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return nullptr;
+}
+
+inline const ParamDescriptor* findParam(const char* name) {
+    return findParam(name, param_index_detail::nameLength(name));
+}
+
+/**
+ * @brief Look up the parameter mapped to a CC number
+ * @return Descriptor, or nullptr if the CC isn't mapped to a voice parameter
+ */
+inline const ParamDescriptor* findParamByCC(uint8_t cc) {
+    if (cc >= PARAM_BY_CC.size() || PARAM_BY_CC[cc] == NO_PARAM) {
+        return nullptr;
+    }
+    return &SYNTH_PARAMS[PARAM_BY_CC[cc]];
+}
+
+/**
+ * @brief Index of a parameter in SYNTH_PARAMS
+ */
+inline size_t paramIndex(const ParamDescriptor& param) {
+    return static_cast<size_t>(&param - SYNTH_PARAMS);
+}
+
+/**
+ * @brief Index of a parameter by name, for use in constant expressions
+ * @return PARAM_COUNT if no parameter has that name
+ */
+constexpr size_t paramIndex(const char* name) {
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        if (param_index_detail::namesEqual(SYNTH_PARAMS[i].name, name, param_index_detail::nameLength(name))) {
+            return i;
+        }
+    }
+    return PARAM_COUNT;
+}
+
+} // namespace synth
@@ -84,4 +84,26 @@ public:
     virtual bool isActive() const = 0;
 };
 
+/**
+ * @brief A voice that can be allocated and rendered through the interface alone
+ *
+ * Adds what a voice pool and mixer need beyond Voice: aftertouch and the
+ * next output sample. Pools that hold several engine types in one
+ * features::VoiceArena use this as their voice type; each engine derives
+ * from it.
+ */
+class EngineVoice : public Voice {
+public:
+    /**
+     * @brief Set per-voice aftertouch level
+     * @param aftertouch Normalized aftertouch [0.0, 1.0]
+     */
+    virtual void setAftertouch(float aftertouch) = 0;
+
+    /**
+     * @brief Generate the next audio sample, in range [-1.0, 1.0]
+     */
+    virtual float nextSample() = 0;
+};
+
 } // namespace synth
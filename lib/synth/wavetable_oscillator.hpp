@@ -1,5 +1,7 @@
 #pragma once
 
+#include <sample_rate.hpp>
+
 namespace synth {
 
 /**
@@ -16,7 +18,8 @@ namespace synth {
 class WavetableOscillator {
 public:
     WavetableOscillator(float sampleRate = 44100.0f)
-        : sampleRate_(sampleRate) {
+        : sampleRate_(sampleRate)
+        , inverseSampleRate_(1.0f / sampleRate) {
         updateWavetable(0.0f);  // Start with sawtooth
     }
 
@@ -52,11 +55,13 @@ public:
 
     /**
      * @brief Generate the next audio sample
+     * @tparam Rate Sample rate policy (FixedSampleRate folds the reciprocal)
      * @param frequency Frequency in Hz
      * @return Audio sample in range [-1.0, 1.0]
      */
+    template<typename Rate = RuntimeSampleRate>
     inline float nextSample(float frequency) {
-        const float dt = frequency / sampleRate_;  // phase increment per sample
+        const float dt = frequency * Rate::inverse(inverseSampleRate_);  // phase increment per sample
         const float t = phase_;
 
         // Naive (pre-band-limiting) morphed waveform value at the current phase.
@@ -141,6 +146,7 @@ private:
 
     float phase_ = 0.0f;
     float sampleRate_;
+    float inverseSampleRate_;
     float shape_ = 0.0f;     // Current waveform shape
     float wSaw_ = 1.0f;      // Morph weight: sawtooth component
     float wTriangle_ = 0.0f; // Morph weight: triangle component
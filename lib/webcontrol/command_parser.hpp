@@ -0,0 +1,448 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace webcontrol {
+
+/**
+ * @brief Unowned span of characters inside a command line
+ */
+struct TextSpan {
+    const char* text = nullptr;
+    size_t length = 0;
+
+    bool equals(const char* s) const {
+        return std::strncmp(text, s, length) == 0 && s[length] == '\0';
+    }
+};
+
+/**
+ * @brief Compare a span with a null-terminated name (strcmp ordering)
+ */
+inline int compareName(const TextSpan& span, const char* name) {
+    for (size_t i = 0; i < span.length; i++) {
+        if (name[i] == '\0') {
+            return 1;
+        }
+        int diff = static_cast<unsigned char>(span.text[i]) - static_cast<unsigned char>(name[i]);
+        if (diff != 0) {
+            return diff;
+        }
+    }
+    return name[span.length] == '\0' ? 0 : -1;
+}
+
+/**
+ * @brief Entry of a name lookup table, sorted by name
+ */
+template<typename T>
+struct NamedEntry {
+    const char* name;
+    T value;
+};
+
+constexpr int constexprStrcmp(const char* a, const char* b) {
+    while (*a != '\0' && *a == *b) {
+        a++;
+        b++;
+    }
+    return static_cast<unsigned char>(*a) - static_cast<unsigned char>(*b);
+}
+
+/**
+ * @brief True if a lookup table is strictly sorted (use in a static_assert)
+ */
+template<typename T, size_t N>
+constexpr bool isSortedByName(const NamedEntry<T> (&table)[N]) {
+    for (size_t i = 1; i < N; i++) {
+        if (constexprStrcmp(table[i - 1].name, table[i].name) >= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Binary search a sorted name table
+ * @return Matching entry, or nullptr
+ */
+template<typename T, size_t N>
+const NamedEntry<T>* findByName(const NamedEntry<T> (&table)[N], const TextSpan& name) {
+    size_t low = 0;
+    size_t high = N;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        int cmp = compareName(name, table[mid].name);
+        if (cmp == 0) {
+            return &table[mid];
+        }
+        if (cmp < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Zero-allocation parser for one control panel command line
+ *
+ * Validates a complete JSON document and indexes the members of a top-level
+ * object in place: keys and values are spans into the caller's line, which
+ * must outlive the parser. Nested objects and arrays are validated and kept
+ * as raw spans. Nothing is copied and nothing is allocated, so a line costs
+ * one linear scan plus a number conversion per numeric field read.
+ *
+ * Keys are matched as written; the protocol's keys and names never contain
+ * escapes. A valid document that is not an object parses with no fields.
+ * For duplicate keys the last one wins, as with nlohmann::json.
+ */
+class CommandParser {
+public:
+    static constexpr size_t MAX_FIELDS = 16;
+    static constexpr int MAX_DEPTH = 8;
+
+    enum class ValueType : uint8_t { String, Number, Bool, Null, Object, Array };
+
+    struct Field {
+        TextSpan key;
+        TextSpan value;     // String: contents without quotes; otherwise the raw token
+        ValueType type;
+    };
+
+    /**
+     * @brief Parse a null-terminated line
+     * @return false if the line is not valid JSON or has more than MAX_FIELDS members
+     */
+    bool parse(const char* line) {
+        fieldCount_ = 0;
+        pos_ = line;
+        skipWhitespace();
+        if (*pos_ == '{') {
+            if (!parseTopLevelObject()) {
+                return false;
+            }
+        } else {
+            ValueType type;
+            TextSpan value;
+            if (!parseValue(type, value, 0)) {
+                return false;
+            }
+        }
+        skipWhitespace();
+        return *pos_ == '\0';
+    }
+
+    size_t fieldCount() const { return fieldCount_; }
+    const Field& field(size_t index) const { return fields_[index]; }
+
+    /**
+     * @brief Find a member by key
+     * @return The member, or nullptr if absent
+     */
+    const Field* find(const char* key) const {
+        for (size_t i = fieldCount_; i > 0; i--) {
+            if (fields_[i - 1].key.equals(key)) {
+                return &fields_[i - 1];
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief String member (without quotes, escapes left as written)
+     * @return false if absent or not a string
+     */
+    bool getString(const char* key, TextSpan& out) const {
+        const Field* f = find(key);
+        if (!f || f->type != ValueType::String) {
+            return false;
+        }
+        out = f->value;
+        return true;
+    }
+
+    /**
+     * @brief Numeric member
+     * @return false if absent or not a number
+     */
+    bool getNumber(const char* key, double& out) const {
+        const Field* f = find(key);
+        return f && getNumber(*f, out);
+    }
+
+    /**
+     * @brief Value of a numeric field
+     * @return false if the field is not a number
+     */
+    static bool getNumber(const Field& f, double& out) {
+        if (f.type != ValueType::Number) {
+            return false;
+        }
+        // The token was validated as a JSON number and is followed by a
+        // delimiter, so strtod stops exactly at its end
+        out = std::strtod(f.value.text, nullptr);
+        return true;
+    }
+
+    /**
+     * @brief Visit the members of a nested object or array field
+     *
+     * Calls visit(const Field&) once per member, in order, without storing
+     * them, so containers may hold any number of members. Array elements have
+     * an empty key. Visitors may iterate a nested member in turn.
+     *
+     * @param container A field of this parser (or a member passed to a visitor)
+     * @return false if the field is not an object or array
+     */
+    template<typename Visitor>
+    bool forEachMember(const Field& container, Visitor&& visit) {
+        if (container.type != ValueType::Object && container.type != ValueType::Array) {
+            return false;
+        }
+        const char* saved = pos_;
+        const bool isObject = container.type == ValueType::Object;
+        const char close = isObject ? '}' : ']';
+        pos_ = container.value.text + 1;
+        skipWhitespace();
+        // The container was validated when the line was parsed
+        while (*pos_ != close) {
+            Field member{};
+            if (isObject) {
+                parseString(member.key);
+                skipWhitespace();
+                pos_++;  // ':'
+                skipWhitespace();
+            }
+            parseValue(member.type, member.value, 0);
+            const char* next = pos_;
+            visit(static_cast<const Field&>(member));
+            pos_ = next;
+            skipWhitespace();
+            if (*pos_ == ',') {
+                pos_++;
+                skipWhitespace();
+            }
+        }
+        pos_ = saved;
+        return true;
+    }
+
+    /**
+     * @brief Numeric member converted to T, or a default if absent or not a number
+     */
+    template<typename T>
+    T value(const char* key, T defaultValue) const {
+        double number;
+        return getNumber(key, number) ? static_cast<T>(number) : defaultValue;
+    }
+
+private:
+    Field fields_[MAX_FIELDS];
+    size_t fieldCount_ = 0;
+    const char* pos_ = nullptr;
+
+    void skipWhitespace() {
+        while (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\n' || *pos_ == '\r') {
+            pos_++;
+        }
+    }
+
+    bool parseTopLevelObject() {
+        pos_++;  // '{'
+        skipWhitespace();
+        if (*pos_ == '}') {
+            pos_++;
+            return true;
+        }
+        while (true) {
+            skipWhitespace();
+            TextSpan key;
+            if (*pos_ != '"' || !parseString(key)) {
+                return false;
+            }
+            skipWhitespace();
+            if (*pos_ != ':') {
+                return false;
+            }
+            pos_++;
+            skipWhitespace();
+            if (fieldCount_ == MAX_FIELDS) {
+                return false;
+            }
+            Field& f = fields_[fieldCount_];
+            if (!parseValue(f.type, f.value, 1)) {
+                return false;
+            }
+            f.key = key;
+            fieldCount_++;
+            skipWhitespace();
+            if (*pos_ == ',') {
+                pos_++;
+            } else if (*pos_ == '}') {
+                pos_++;
+                return true;
+            } else {
+                return false;
+            }
+        }
+    }
+
+    bool parseValue(ValueType& type, TextSpan& value, int depth) {
+        const char* start = pos_;
+        switch (*pos_) {
+            case '"':
+                type = ValueType::String;
+                return parseString(value);
+            case '{':
+            case '[':
+                type = (*pos_ == '{') ? ValueType::Object : ValueType::Array;
+                if (!skipContainer(depth + 1)) {
+                    return false;
+                }
+                break;
+            case 't':
+                type = ValueType::Bool;
+                if (!parseLiteral("true")) return false;
+                break;
+            case 'f':
+                type = ValueType::Bool;
+                if (!parseLiteral("false")) return false;
+                break;
+            case 'n':
+                type = ValueType::Null;
+                if (!parseLiteral("null")) return false;
+                break;
+            default:
+                type = ValueType::Number;
+                if (!parseNumber()) return false;
+                break;
+        }
+        value.text = start;
+        value.length = static_cast<size_t>(pos_ - start);
+        return true;
+    }
+
+    /**
+     * @brief Parse a string at pos_ (which is on the opening quote)
+     */
+    bool parseString(TextSpan& out) {
+        pos_++;
+        out.text = pos_;
+        while (*pos_ != '"') {
+            unsigned char c = static_cast<unsigned char>(*pos_);
+            if (c < 0x20) {
+                return false;   // Control character or end of line
+            }
+            if (c == '\\') {
+                pos_++;
+                switch (*pos_) {
+                    case '"': case '\\': case '/': case 'b':
+                    case 'f': case 'n': case 'r': case 't':
+                        break;
+                    case 'u':
+                        for (int i = 1; i <= 4; i++) {
+                            if (!isHexDigit(pos_[i])) {
+                                return false;
+                            }
+                        }
+                        pos_ += 4;
+                        break;
+                    default:
+                        return false;
+                }
+            }
+            pos_++;
+        }
+        out.length = static_cast<size_t>(pos_ - out.text);
+        pos_++;
+        return true;
+    }
+
+    bool parseNumber() {
+        if (*pos_ == '-') {
+            pos_++;
+        }
+        if (*pos_ == '0') {
+            pos_++;
+        } else if (isDigit(*pos_)) {
+            while (isDigit(*pos_)) pos_++;
+        } else {
+            return false;
+        }
+        if (*pos_ == '.') {
+            pos_++;
+            if (!isDigit(*pos_)) return false;
+            while (isDigit(*pos_)) pos_++;
+        }
+        if (*pos_ == 'e' || *pos_ == 'E') {
+            pos_++;
+            if (*pos_ == '+' || *pos_ == '-') pos_++;
+            if (!isDigit(*pos_)) return false;
+            while (isDigit(*pos_)) pos_++;
+        }
+        return true;
+    }
+
+    bool parseLiteral(const char* literal) {
+        size_t length = std::strlen(literal);
+        if (std::strncmp(pos_, literal, length) != 0) {
+            return false;
+        }
+        pos_ += length;
+        return true;
+    }
+
+    /**
+     * @brief Validate and skip a nested object or array
+     */
+    bool skipContainer(int depth) {
+        if (depth > MAX_DEPTH) {
+            return false;
+        }
+        const char close = (*pos_ == '{') ? '}' : ']';
+        pos_++;
+        skipWhitespace();
+        if (*pos_ == close) {
+            pos_++;
+            return true;
+        }
+        while (true) {
+            skipWhitespace();
+            if (close == '}') {
+                TextSpan key;
+                if (*pos_ != '"' || !parseString(key)) return false;
+                skipWhitespace();
+                if (*pos_ != ':') return false;
+                pos_++;
+                skipWhitespace();
+            }
+            ValueType type;
+            TextSpan value;
+            if (!parseValue(type, value, depth)) {
+                return false;
+            }
+            skipWhitespace();
+            if (*pos_ == ',') {
+                pos_++;
+            } else if (*pos_ == close) {
+                pos_++;
+                return true;
+            } else {
+                return false;
+            }
+        }
+    }
+
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    static bool isHexDigit(char c) {
+        return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+};
+
+} // namespace webcontrol
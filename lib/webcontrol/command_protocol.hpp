@@ -1,6 +1,9 @@
 #pragma once
 
-#include <json.hpp>
+#include "command_parser.hpp"
+#include <json_writer.hpp>
+#include <synth_params.hpp>
+#include <cstring>
 #include <string>
 
 namespace webcontrol {
@@ -13,113 +16,153 @@ namespace webcontrol {
  */
 enum class CommandType {
     SET_PARAM,      // Set a single parameter: {"cmd": "setParam", "param": "baseCutoff", "value": 500.0}
+    SET_PARAMS,     // Set several parameters at once: {"cmd": "setParams", "params": {"baseCutoff": 500.0, "filterQ": 2.0}}
+                    // (or "params": [{"param": "baseCutoff", "value": 500.0}, ...])
     GET_PARAMS,     // Request all current parameters: {"cmd": "getParams"}
     SAVE_PROGRAM,   // Save current settings to program slot: {"cmd": "saveProgram", "bank": 0, "program": 1}
     LOAD_PROGRAM,   // Load settings from program slot: {"cmd": "loadProgram", "bank": 0, "program": 1}
     SET_BASE_NOTE,  // Set keyboard base note: {"cmd": "setBaseNote", "note": 48}
+    SUBSCRIBE_KEY_SCAN,   // Delta key scan telemetry: {"cmd": "subscribeKeyScan", "first": 0, "count": 16, "maxRate": 30, "deadband": 8, "keyframeInterval": 30}
+    UNSUBSCRIBE_KEY_SCAN, // Back to full key scan frames: {"cmd": "unsubscribeKeyScan"}
+    SUBSCRIBE_AUDIO_TAP,  // Audio meters/spectrum: {"cmd": "subscribeAudioTap", "voice": -1, "decimation": 1} (voice -1 = output)
+    UNSUBSCRIBE_AUDIO_TAP, // Stop audio meters: {"cmd": "unsubscribeAudioTap", "voice": -1}
+    SET_LATENCY_PROFILE,  // Audio output profile: {"cmd": "setLatencyProfile", "profile": "lowLatency"} (or "efficiency")
     UNKNOWN
 };
 
 /**
- * @brief Parse command type from string
+ * @brief Command names, sorted for binary search
  */
+static constexpr NamedEntry<CommandType> COMMAND_NAMES[] = {
+    {"getParams", CommandType::GET_PARAMS},
+    {"loadProgram", CommandType::LOAD_PROGRAM},
+    {"saveProgram", CommandType::SAVE_PROGRAM},
+    {"setBaseNote", CommandType::SET_BASE_NOTE},
+    {"setLatencyProfile", CommandType::SET_LATENCY_PROFILE},
+    {"setParam", CommandType::SET_PARAM},
+    {"setParams", CommandType::SET_PARAMS},
+    {"subscribeAudioTap", CommandType::SUBSCRIBE_AUDIO_TAP},
+    {"subscribeKeyScan", CommandType::SUBSCRIBE_KEY_SCAN},
+    {"unsubscribeAudioTap", CommandType::UNSUBSCRIBE_AUDIO_TAP},
+    {"unsubscribeKeyScan", CommandType::UNSUBSCRIBE_KEY_SCAN},
+};
+static_assert(isSortedByName(COMMAND_NAMES), "COMMAND_NAMES must be sorted by name");
+
+/**
+ * @brief Parse command type from its name
+ */
+inline CommandType parseCommandType(const TextSpan& cmd) {
+    const auto* entry = findByName(COMMAND_NAMES, cmd);
+    return entry ? entry->value : CommandType::UNKNOWN;
+}
+
 inline CommandType parseCommandType(const std::string& cmd) {
-    if (cmd == "setParam") return CommandType::SET_PARAM;
-    if (cmd == "getParams") return CommandType::GET_PARAMS;
-    if (cmd == "saveProgram") return CommandType::SAVE_PROGRAM;
-    if (cmd == "loadProgram") return CommandType::LOAD_PROGRAM;
-    if (cmd == "setBaseNote") return CommandType::SET_BASE_NOTE;
-    return CommandType::UNKNOWN;
+    return parseCommandType(TextSpan{cmd.data(), cmd.size()});
 }
 
+/**
+ * @brief One rejected item of a setParams command
+ */
+struct ParamError {
+    TextSpan param;     // Name as sent (empty if the item had none)
+    const char* error;
+};
+
 /**
  * @brief Response sent back to control panel
  */
 struct CommandResponse {
-    std::string ack;      // Command that was acknowledged
-    std::string status;   // "ok" or "error"
-    std::string error;    // Error message if status is "error"
+    const char* ack = "";        // Command that was acknowledged
+    const char* status = "";     // "ok" or "error"
+    const char* error = nullptr; // Error message if status is "error"
+    const ParamError* paramErrors = nullptr;  // setParams only: per-item errors
+    size_t paramErrorCount = 0;
 };
 
-// JSON serialization for CommandResponse
-inline void to_json(nlohmann::json& j, const CommandResponse& r) {
-    j = nlohmann::json{
-        {"type", "cmdResponse"},
-        {"ack", r.ack},
-        {"status", r.status}
-    };
-    if (!r.error.empty()) {
-        j["error"] = r.error;
+// JSON serialization for CommandResponse (keys in sorted order)
+inline void to_json(features::JsonWriter& w, const CommandResponse& r) {
+    w.beginObject();
+    w.field("ack", r.ack);
+    if (r.error && r.error[0] != '\0') {
+        w.field("error", r.error);
+    }
+    if (r.paramErrors) {
+        w.key("errors").beginArray();
+        for (size_t i = 0; i < r.paramErrorCount; i++) {
+            w.beginObject();
+            w.field("error", r.paramErrors[i].error);
+            w.key("param").value(r.paramErrors[i].param.text, r.paramErrors[i].param.length);
+            w.endObject();
+        }
+        w.endArray();
     }
+    w.field("status", r.status);
+    w.field("type", "cmdResponse");
+    w.endObject();
 }
 
 /**
- * @brief Params telemetry sent to control panel
- * 
- * Sent in response to getParams command or when parameters change.
+ * @brief One named value in a params message
+ *
+ * Params messages are assembled as a flat list so that externally registered
+ * params can be merged in and the whole list written in sorted key order.
  */
-struct ParamsTelemetry {
-    // Oscillator
-    float waveformShape;
-    
-    // Filter
-    float baseCutoff;
-    float filterQ;
-    int filterMode;
-    
-    // Filter envelope
-    float filterEnvAmount;
-    float filterEnvAttack;
-    float filterEnvDecay;
-    float filterEnvSustain;
-    float filterEnvRelease;
-    
-    // Amplitude envelope
-    float ampEnvAttack;
-    float ampEnvDecay;
-    float ampEnvSustain;
-    float ampEnvRelease;
-    
-    // Vibrato
-    float vibratoRate;
-    float vibratoDepth;
-    
-    // Tremolo
-    float tremoloRate;
-    float tremoloDepth;
-    
-    // Aftertouch modulation
-    float baseCutoff_atMod;
-    float filterEnvAmount_atMod;
-    float vibratoDepth_atMod;
-    float tremoloDepth_atMod;
+struct ParamEntry {
+    const char* name;
+    float value;
+    bool isInt;
 };
 
-inline void to_json(nlohmann::json& j, const ParamsTelemetry& p) {
-    j = nlohmann::json{
-        {"type", "params"},
-        {"waveformShape", p.waveformShape},
-        {"baseCutoff", p.baseCutoff},
-        {"filterQ", p.filterQ},
-        {"filterMode", p.filterMode},
-        {"filterEnvAmount", p.filterEnvAmount},
-        {"filterEnvAttack", p.filterEnvAttack},
-        {"filterEnvDecay", p.filterEnvDecay},
-        {"filterEnvSustain", p.filterEnvSustain},
-        {"filterEnvRelease", p.filterEnvRelease},
-        {"ampEnvAttack", p.ampEnvAttack},
-        {"ampEnvDecay", p.ampEnvDecay},
-        {"ampEnvSustain", p.ampEnvSustain},
-        {"ampEnvRelease", p.ampEnvRelease},
-        {"vibratoRate", p.vibratoRate},
-        {"vibratoDepth", p.vibratoDepth},
-        {"tremoloRate", p.tremoloRate},
-        {"tremoloDepth", p.tremoloDepth},
-        {"baseCutoff_atMod", p.baseCutoff_atMod},
-        {"filterEnvAmount_atMod", p.filterEnvAmount_atMod},
-        {"vibratoDepth_atMod", p.vibratoDepth_atMod},
-        {"tremoloDepth_atMod", p.tremoloDepth_atMod}
-    };
+/**
+ * @brief Fill entries with the synth voice params, in SYNTH_PARAMS order
+ * @param values One value per SYNTH_PARAMS entry
+ * @return Number of entries written (synth::PARAM_COUNT)
+ */
+inline size_t collectParamEntries(const float* values, ParamEntry* out) {
+    for (size_t i = 0; i < synth::PARAM_COUNT; i++) {
+        out[i] = {synth::SYNTH_PARAMS[i].name, values[i], synth::SYNTH_PARAMS[i].isInt};
+    }
+    return synth::PARAM_COUNT;
+}
+
+/**
+ * @brief Write a params message from a list of entries
+ *
+ * Sorts the entries in place (insertion sort; the list is short) and emits
+ * them with the "type" key merged in, matching nlohmann's key order.
+ *
+ * @param type Message type: "params" for the full set, "paramsDelta" for
+ *  changed values only
+ */
+inline void writeParamsJson(features::JsonWriter& w, ParamEntry* entries, size_t count,
+                            const char* type = "params") {
+    for (size_t i = 1; i < count; i++) {
+        ParamEntry e = entries[i];
+        size_t j = i;
+        while (j > 0 && std::strcmp(entries[j - 1].name, e.name) > 0) {
+            entries[j] = entries[j - 1];
+            j--;
+        }
+        entries[j] = e;
+    }
+
+    w.beginObject();
+    bool typeWritten = false;
+    for (size_t i = 0; i < count; i++) {
+        if (!typeWritten && std::strcmp(entries[i].name, "type") > 0) {
+            w.field("type", type);
+            typeWritten = true;
+        }
+        if (entries[i].isInt) {
+            w.field(entries[i].name, static_cast<int>(entries[i].value));
+        } else {
+            w.field(entries[i].name, entries[i].value);
+        }
+    }
+    if (!typeWritten) {
+        w.field("type", type);
+    }
+    w.endObject();
 }
 
 } // namespace webcontrol
@@ -1,15 +1,21 @@
 #pragma once
 
 #include "command_protocol.hpp"
-#include <json.hpp>
+#include "command_parser.hpp"
+#include <json_writer.hpp>
 #include <sawtooth_synth.hpp>
+#include <synth_params.hpp>
+#include <param_batch.hpp>
 #include <program_storage.hpp>
 #include <log.hpp>
-#include <functional>
-#include <string>
-#include <vector>
+#include <key_scan_subscription.hpp>
+#include <latency_profile.hpp>
+#include <inline_function.hpp>
+#include <fixed_vector.hpp>
+#include <atomic>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 
 namespace webcontrol {
 
@@ -19,20 +25,64 @@ namespace webcontrol {
  * This allows external code (e.g. main) to hook into base note commands
  * since the keyboard controller is not part of WebController.
  */
-using SetBaseNoteCallback = std::function<void(uint8_t note)>;
+using SetBaseNoteCallback = features::InlineFunction<void(uint8_t note)>;
+
+/**
+ * @brief Callback type for key scan telemetry subscription changes
+ * 
+ * Receives the requested subscription (enabled = false to unsubscribe).
+ */
+using KeyScanSubscriptionCallback = features::InlineFunction<void(const midi::KeyScanSubscription&)>;
+
+/**
+ * @brief Callback type for audio tap subscription changes
+ * 
+ * @param subscribe true to start metering, false to stop
+ * @param voice Voice index, or -1 for the post-processing output
+ * @param decimation Keep every Nth sample
+ * @return false if the tap doesn't exist
+ */
+using AudioTapCallback = features::InlineFunction<bool(bool subscribe, int voice, uint16_t decimation)>;
+
+/**
+ * @brief Callback type for latency profile changes
+ * 
+ * @return false if the audio output doesn't support switching profiles
+ */
+using LatencyProfileCallback = features::InlineFunction<bool(features::LatencyProfile profile)>;
+
+/**
+ * @brief Callback type for handing voice parameter changes to the audio side
+ * 
+ * @param batch Changes to apply together
+ * @return false if the batch could not be queued
+ */
+using ParamBatchCallback = features::InlineFunction<bool(const synth::ParamBatch& batch)>;
 
 /**
  * @brief Type aliases for voice iteration (same pattern as ProgramStorage)
+ *
+ * The visitor is only passed for the duration of a call, so it is a
+ * non-owning FunctionRef; the iterator is kept, so it is stored inline.
  */
-using VoiceVisitor = std::function<void(synth::Voice&)>;
-using VoiceIterator = std::function<void(VoiceVisitor)>;
+using VoiceVisitor = features::FunctionRef<void(synth::Voice&)>;
+using VoiceIterator = features::InlineFunction<void(VoiceVisitor)>;
+
+/**
+ * @brief Callbacks of an externally-registered param
+ */
+using ParamSetter = features::InlineFunction<void(float value)>;
+using ParamGetter = features::InlineFunction<float()>;
 
 /**
  * @brief Web control panel controller
  * 
  * Parses JSON command lines from the control panel and directly manipulates
  * synth voices. This class knows about synth internals and provides a web
- * interface to control the synthesizer.
+ * interface to control the synthesizer. Lines are parsed in place by
+ * CommandParser and names resolved through constant tables, so processing a
+ * command does not touch the heap. Callbacks and the external param registry
+ * are stored inline as well, so a WebController never allocates at all.
  * 
  * Usage:
  *   WebController controller(
@@ -41,16 +91,16 @@ using VoiceIterator = std::function<void(VoiceVisitor)>;
  *       [](uint8_t note) { keyboard.setBaseNote(note); }
  *   );
  *   
- *   // In main loop:
- *   if (controller.accumulate(ch)) {
- *       controller.process(controller.getLineBuffer());
- *   }
+ *   // Whenever input arrives (any number of bytes, any split):
+ *   controller.processBytes(data, length);
  */
 class WebController {
 public:
     /**
      * @brief Construct with voice iterator and optional storage
-     * @param voiceIterator Function to iterate all voices
+     * @param voiceIterator Function to iterate all voices; they must be
+     *        synth::WavetableSynth (or derived), like the staging voices
+     *        programs are loaded into and saved from
      * @param programStorage Optional program storage for save/load
      * @param onSetBaseNote Optional callback for base note changes
      */
@@ -68,48 +118,54 @@ public:
      * @return true if command was parsed and dispatched successfully
      */
     bool process(const char* jsonLine) {
-        if (!jsonLine || jsonLine[0] == '\0') {
-            return false;
-        }
-        
-        // Use non-throwing JSON parse (for embedded targets without exceptions)
-        nlohmann::json j = nlohmann::json::parse(jsonLine, nullptr, false);
-        
-        // Check if parse failed
-        if (j.is_discarded()) {
-            sendError("JSON parse error");
-            return false;
-        }
-        
-        // Get command type
-        if (!j.contains("cmd") || !j["cmd"].is_string()) {
-            sendError("missing or invalid 'cmd' field");
-            return false;
+        bool ok = processLine(jsonLine);
+        flushParamChanges();
+        return ok;
+    }
+    
+    /**
+     * @brief Process received command bytes
+     * 
+     * Assembles lines across calls and processes every line completed by
+     * this chunk, so a whole receive buffer can be handed over at once. Voice
+     * param changes from all of the chunk's commands are handed on as one
+     * batch. A line longer than the line buffer is discarded with an error
+     * rather than processed truncated.
+     * 
+     * @param data Received bytes (not NUL-terminated)
+     * @param length Number of bytes
+     * @return Number of command lines processed
+     */
+    size_t processBytes(const char* data, size_t length) {
+        size_t lines = 0;
+        for (size_t i = 0; i < length; i++) {
+            if (accumulate(data[i])) {
+                processLine(lineBuffer_);
+                lines++;
+            }
         }
-        
-        std::string cmdStr = j["cmd"].get<std::string>();
-        auto cmdType = parseCommandType(cmdStr);
-        
-        switch (cmdType) {
-            case CommandType::SET_PARAM:
-                return handleSetParam(j);
-                
-            case CommandType::GET_PARAMS:
-                return handleGetParams();
-                
-            case CommandType::SAVE_PROGRAM:
-                return handleSaveProgram(j);
-                
-            case CommandType::LOAD_PROGRAM:
-                return handleLoadProgram(j);
-                
-            case CommandType::SET_BASE_NOTE:
-                return handleSetBaseNote(j);
-                
-            case CommandType::UNKNOWN:
-            default:
-                sendError("unknown command: " + cmdStr);
-                return false;
+        flushParamChanges();
+        return lines;
+    }
+    
+    /**
+     * @brief Hand pending voice param changes to the batch callback
+     * 
+     * Called after each command and chunk. If the callback can't take them
+     * (queue full) they stay pending, keep collecting later changes, and are
+     * retried on the next call, so nothing is dropped and no batch is split.
+     */
+    void flushParamChanges() {
+        if (onParamBatch_ && !pendingParams_.empty() && onParamBatch_(pendingParams_)) {
+            // Remember the values until the applied params include this batch
+            pushedBatches_++;
+            for (size_t i = 0; i < synth::PARAM_COUNT; i++) {
+                if (pendingParams_.changed.test(i)) {
+                    inFlightValues_[i] = pendingParams_.values[i];
+                    inFlightBatch_[i] = pushedBatches_;
+                }
+            }
+            pendingParams_.clear();
         }
     }
     
@@ -120,6 +176,12 @@ public:
      */
     bool accumulate(char ch) {
         if (ch == '\n' || ch == '\r') {
+            if (lineOverflowed_) {
+                lineOverflowed_ = false;
+                bufferLen_ = 0;
+                sendError("command line too long");
+                return false;
+            }
             if (bufferLen_ > 0) {
                 lineBuffer_[bufferLen_] = '\0';
                 bufferLen_ = 0;
@@ -130,8 +192,9 @@ public:
         
         if (bufferLen_ < sizeof(lineBuffer_) - 1) {
             lineBuffer_[bufferLen_++] = ch;
+        } else {
+            lineOverflowed_ = true;
         }
-        // If buffer overflows, we'll just truncate
         return false;
     }
     
@@ -148,9 +211,21 @@ public:
      */
     void resetBuffer() {
         bufferLen_ = 0;
+        lineOverflowed_ = false;
         lineBuffer_[0] = '\0';
     }
     
+    /**
+     * @brief Send responses and params messages somewhere other than stdout
+     * 
+     * @param write Output function (see features::JsonWriter::WriteFn)
+     * @param context Passed to write
+     */
+    void setOutput(features::JsonWriter::WriteFn write, void* context) {
+        output_ = write;
+        outputContext_ = context;
+    }
+    
     /**
      * @brief Set callback for base note changes
      */
@@ -158,6 +233,49 @@ public:
         onSetBaseNote_ = std::move(callback);
     }
 
+    /**
+     * @brief Set callback for subscribeKeyScan/unsubscribeKeyScan commands
+     */
+    void setKeyScanSubscriptionCallback(KeyScanSubscriptionCallback callback) {
+        onKeyScanSubscription_ = std::move(callback);
+    }
+
+    /**
+     * @brief Set callback for subscribeAudioTap/unsubscribeAudioTap commands
+     */
+    void setAudioTapCallback(AudioTapCallback callback) {
+        onAudioTap_ = std::move(callback);
+    }
+
+    /**
+     * @brief Set callback for setLatencyProfile commands
+     */
+    void setLatencyProfileCallback(LatencyProfileCallback callback) {
+        onLatencyProfile_ = std::move(callback);
+    }
+
+    /**
+     * @brief Set callback that applies voice parameter changes
+     *
+     * Without one, setParam/setParams/loadProgram change the voices directly
+     * from the calling thread, and params are read back from the voices. With
+     * one, the changes made by each process() or processBytes() call are
+     * merged and handed over as a single batch, e.g. to be applied by the
+     * audio thread between blocks. The callback returns false to have the
+     * batch offered again later (see flushParamChanges).
+     *
+     * The voices are then never touched from this thread: params are read
+     * back from `applied`, which the side applying the batches publishes,
+     * with any batches it hasn't applied yet laid over it.
+     *
+     * @param callback Queues a batch
+     * @param applied Params as of the last batch applied (must outlive this controller)
+     */
+    void setParamBatchCallback(ParamBatchCallback callback, const synth::ParamSnapshot& applied) {
+        onParamBatch_ = std::move(callback);
+        appliedParams_ = &applied;
+    }
+
     /**
      * @brief Register an external float parameter (e.g. a keyboard setting)
      *
@@ -169,34 +287,279 @@ public:
      * @param name    Parameter name as used by the control panel
      * @param setter  Applies a new value
      * @param getter  Reports the current value (for getParams readback)
+     * @return false if the name is too long or MAX_EXTERNAL_PARAMS are registered
      */
-    void registerParam(const std::string& name,
-                       std::function<void(float)> setter,
-                       std::function<float()> getter) {
-        externalParams_.push_back({name, std::move(setter), std::move(getter)});
+    bool registerParam(const char* name, ParamSetter setter, ParamGetter getter) {
+        if (std::strlen(name) >= MAX_EXTERNAL_PARAM_NAME || externalParams_.full()) {
+            logError("Cannot register external param %s", name);
+            return false;
+        }
+        ExternalParam param;
+        std::strcpy(param.name, name);
+        param.set = std::move(setter);
+        param.get = std::move(getter);
+        return externalParams_.push_back(param);
+    }
+
+    /**
+     * @brief Record that voice params changed, from any thread
+     *
+     * Call wherever voice params are changed outside of this controller (MIDI
+     * CC, program changes, queued batches); pushParamChanges() reports them.
+     *
+     * @param mask Bit i set for each changed SYNTH_PARAMS[i]
+     */
+    void markParamsChanged(uint32_t mask) {
+        changedParams_.fetch_or(mask, std::memory_order_relaxed);
+    }
+    
+    static_assert(synth::PARAM_COUNT <= 32, "Changed-param mask holds 32 params");
+    static constexpr uint32_t ALL_PARAMS_MASK =
+        synth::PARAM_COUNT == 32 ? 0xFFFFFFFFu : (1u << synth::PARAM_COUNT) - 1;
+    
+    void markAllParamsChanged() {
+        markParamsChanged(ALL_PARAMS_MASK);
+    }
+    
+    /**
+     * @brief Load a program slot from storage, applied like a setParams of every param
+     *
+     * The program is read into a full batch, so with a batch callback it is
+     * queued behind earlier changes rather than written into the voices.
+     *
+     * @return false if there is no storage or the slot couldn't be read
+     *         (the storage's defaults are applied then)
+     */
+    bool loadProgramSlot(uint8_t slot) {
+        if (!programStorage_) {
+            return false;
+        }
+        // Storage writes params into a voice: a staging one, not a live one
+        synth::WavetableSynth staging;
+        bool loaded = programStorage_->loadProgram(slot, [&staging](features::ProgramStorage::VoiceVisitor visitor) { visitor(staging); });
+        synth::ParamBatch batch;
+        batch.captureFrom(staging);
+        // The program replaces every param, so changes made earlier in the
+        // same chunk must not be applied after it
+        pendingParams_.clear();
+        applyBatch(batch);
+        flushParamChanges();
+        return loaded;
+    }
+    
+    /**
+     * @brief Send the params changed since the last report as a paramsDelta message
+     *
+     * Call periodically from the control thread. Sends nothing if no param
+     * changed, or if the last report was less than the push interval ago, so
+     * the control panel stays current without polling getParams.
+     *
+     * @param nowMs Current time in milliseconds (any monotonic origin)
+     * @return true if a message was sent
+     */
+    bool pushParamChanges(uint32_t nowMs) {
+        flushParamChanges();
+        if (paramPushIntervalMs_ == 0 || nowMs - lastParamPushMs_ < paramPushIntervalMs_) {
+            return false;
+        }
+        uint32_t changed = changedParams_.exchange(0, std::memory_order_acquire);
+        if (changed == 0) {
+            return false;
+        }
+        lastParamPushMs_ = nowMs;
+        
+        float values[synth::PARAM_COUNT];
+        captureParams(values);
+        ParamEntry entries[synth::PARAM_COUNT];
+        size_t count = 0;
+        for (size_t i = 0; i < synth::PARAM_COUNT; i++) {
+            if (changed & (1u << i)) {
+                entries[count++] = {synth::SYNTH_PARAMS[i].name, values[i], synth::SYNTH_PARAMS[i].isInt};
+            }
+        }
+        features::JsonWriter w(output_, outputContext_);
+        writeParamsJson(w, entries, count, "paramsDelta");
+        w.raw('\n');
+        w.finish();
+        return true;
+    }
+    
+    /**
+     * @brief Set the minimum time between paramsDelta messages (0 disables them)
+     */
+    void setParamPushInterval(uint32_t intervalMs) {
+        paramPushIntervalMs_ = intervalMs;
     }
 
 private:
-    bool handleSetParam(const nlohmann::json& j) {
-        if (!j.contains("param") || !j.contains("value")) {
-            sendError("setParam requires 'param' and 'value'");
+    /**
+     * @brief Parse and dispatch one command line
+     */
+    bool processLine(const char* jsonLine) {
+        if (!jsonLine || jsonLine[0] == '\0') {
+            return false;
+        }
+        
+        if (!parser_.parse(jsonLine)) {
+            sendError("JSON parse error");
+            return false;
+        }
+        const CommandParser& j = parser_;
+        
+        // Get command type
+        TextSpan cmdName;
+        if (!j.getString("cmd", cmdName)) {
+            sendError("missing or invalid 'cmd' field");
             return false;
         }
         
-        std::string param = j["param"].get<std::string>();
-        float value = j["value"].get<float>();
+        auto cmdType = parseCommandType(cmdName);
+        
+        switch (cmdType) {
+            case CommandType::SET_PARAM:
+                return handleSetParam(j);
+                
+            case CommandType::SET_PARAMS:
+                return handleSetParams();
+                
+            case CommandType::GET_PARAMS:
+                return handleGetParams();
+                
+            case CommandType::SAVE_PROGRAM:
+                return handleSaveProgram(j);
+                
+            case CommandType::LOAD_PROGRAM:
+                return handleLoadProgram(j);
+                
+            case CommandType::SET_BASE_NOTE:
+                return handleSetBaseNote(j);
+                
+            case CommandType::SUBSCRIBE_KEY_SCAN:
+                return handleSubscribeKeyScan(j, true);
+                
+            case CommandType::UNSUBSCRIBE_KEY_SCAN:
+                return handleSubscribeKeyScan(j, false);
+                
+            case CommandType::SUBSCRIBE_AUDIO_TAP:
+                return handleSubscribeAudioTap(j, true);
+                
+            case CommandType::UNSUBSCRIBE_AUDIO_TAP:
+                return handleSubscribeAudioTap(j, false);
+                
+            case CommandType::SET_LATENCY_PROFILE:
+                return handleSetLatencyProfile(j);
+                
+            case CommandType::UNKNOWN:
+            default: {
+                char message[96];
+                snprintf(message, sizeof(message), "unknown command: %.*s",
+                         static_cast<int>(cmdName.length), cmdName.text);
+                sendError(message);
+                return false;
+            }
+        }
+    }
+    
+    bool handleSetParam(const CommandParser& j) {
+        TextSpan param;
+        double value;
+        if (!j.getString("param", param) || !j.getNumber("value", value)) {
+            sendError("setParam requires 'param' and 'value'");
+            return false;
+        }
         
-        setParameter(param, value);
+        setParameter(param, static_cast<float>(value));
         sendAck("setParam");
         return true;
     }
     
+    /**
+     * @brief Apply a setParams command
+     * 
+     * Voice params are applied together as one batch; externally registered
+     * params are set immediately. Unknown names and non-numeric values are
+     * skipped and reported per item in the single response.
+     */
+    bool handleSetParams() {
+        const CommandParser::Field* params = parser_.find("params");
+        if (!params || (params->type != CommandParser::ValueType::Object &&
+                        params->type != CommandParser::ValueType::Array)) {
+            sendError("setParams requires a 'params' object or array");
+            return false;
+        }
+        
+        synth::ParamBatch batch;
+        ParamError errors[MAX_PARAM_ERRORS];
+        size_t errorCount = 0;
+        size_t failed = 0;
+        size_t items = 0;
+        auto reject = [&](const TextSpan& name, const char* error) {
+            if (errorCount < MAX_PARAM_ERRORS) {
+                errors[errorCount++] = {name, error};
+            }
+            failed++;
+        };
+        
+        const bool isObject = params->type == CommandParser::ValueType::Object;
+        parser_.forEachMember(*params, [&](const CommandParser::Field& item) {
+            items++;
+            TextSpan name = item.key;
+            double value = 0.0;
+            bool isNumber = false;
+            if (isObject) {
+                isNumber = CommandParser::getNumber(item, value);
+            } else {
+                // Array items are {"param": name, "value": number}
+                name = TextSpan{};
+                parser_.forEachMember(item, [&](const CommandParser::Field& f) {
+                    if (f.key.equals("param") && f.type == CommandParser::ValueType::String) {
+                        name = f.value;
+                    } else if (f.key.equals("value")) {
+                        isNumber = CommandParser::getNumber(f, value);
+                    }
+                });
+                if (name.text == nullptr) {
+                    reject(name, "missing 'param'");
+                    return;
+                }
+            }
+            if (!isNumber) {
+                reject(name, "value must be a number");
+                return;
+            }
+            
+            if (const synth::ParamDescriptor* p = synth::findParam(name.text, name.length)) {
+                batch.set(*p, static_cast<float>(value));
+            } else if (!applyExternalParam(name, static_cast<float>(value))) {
+                reject(name, "unknown parameter");
+            }
+        });
+        
+        applyBatch(batch);
+        
+        CommandResponse resp;
+        resp.ack = "setParams";
+        resp.paramErrors = errors;
+        resp.paramErrorCount = errorCount;
+        char message[48];
+        if (failed == 0) {
+            resp.status = "ok";
+        } else {
+            snprintf(message, sizeof(message), "%u of %u params not applied",
+                     static_cast<unsigned>(failed), static_cast<unsigned>(items));
+            resp.status = "error";
+            resp.error = message;
+        }
+        features::writeJsonLine(resp, output_, outputContext_);
+        return failed == 0;
+    }
+    
     bool handleGetParams() {
         sendCurrentParams();
         return true;
     }
     
-    bool handleSaveProgram(const nlohmann::json& j) {
+    bool handleSaveProgram(const CommandParser& j) {
         uint8_t bank = j.value("bank", 0);
         uint8_t program = j.value("program", 0);
         
@@ -205,7 +568,7 @@ private:
         return true;
     }
     
-    bool handleLoadProgram(const nlohmann::json& j) {
+    bool handleLoadProgram(const CommandParser& j) {
         uint8_t bank = j.value("bank", 0);
         uint8_t program = j.value("program", 0);
         
@@ -214,7 +577,7 @@ private:
         return true;
     }
     
-    bool handleSetBaseNote(const nlohmann::json& j) {
+    bool handleSetBaseNote(const CommandParser& j) {
         uint8_t note = j.value("note", 48);  // Default to C3
         
         if (onSetBaseNote_) {
@@ -225,94 +588,96 @@ private:
         return true;
     }
     
-    /**
-     * @brief Set a synth parameter by name
-     */
-    void setParameter(const std::string& param, float value) {
-        // Oscillator
-        if (param == "waveformShape") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.getOscillator().updateWavetable(value); });
-        }
-        // Filter
-        else if (param == "baseCutoff") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.setBaseCutoff(value); });
-        }
-        else if (param == "filterQ") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.getFilter().setQ(value); });
-        }
-        else if (param == "filterMode") {
-            int mode = static_cast<int>(value);
-            forEachWavetableSynth([mode](synth::WavetableSynth& v) { v.getFilter().setMode(static_cast<synth::BiquadFilter::Mode>(mode)); });
-        }
-        // Filter envelope
-        else if (param == "filterEnvAmount") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.setFilterEnvelopeAmount(value); });
-        }
-        else if (param == "filterEnvAttack") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.getFilterEnvelope().setAttackTime(value); });
-        }
-        else if (param == "filterEnvDecay") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.getFilterEnvelope().setDecayTime(value); });
-        }
-        else if (param == "filterEnvSustain") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.getFilterEnvelope().setSustainLevel(value); });
-        }
-        else if (param == "filterEnvRelease") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.getFilterEnvelope().setReleaseTime(value); });
-        }
-        // Amp envelope
-        else if (param == "ampEnvAttack") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.getAmpEnvelope().setAttackTime(value); });
-        }
-        else if (param == "ampEnvDecay") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.getAmpEnvelope().setDecayTime(value); });
-        }
-        else if (param == "ampEnvSustain") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.getAmpEnvelope().setSustainLevel(value); });
-        }
-        else if (param == "ampEnvRelease") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.getAmpEnvelope().setReleaseTime(value); });
-        }
-        // Vibrato
-        else if (param == "vibratoRate") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.setVibratoRate(value); });
-        }
-        else if (param == "vibratoDepth") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.setVibratoDepth(value); });
-        }
-        // Tremolo
-        else if (param == "tremoloRate") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.setTremoloRate(value); });
+    bool handleSubscribeKeyScan(const CommandParser& j, bool subscribe) {
+        const char* cmd = subscribe ? "subscribeKeyScan" : "unsubscribeKeyScan";
+        if (!onKeyScanSubscription_) {
+            sendError("key scan telemetry not available");
+            return false;
         }
-        else if (param == "tremoloDepth") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.setTremoloDepth(value); });
+        
+        midi::KeyScanSubscription subscription;
+        subscription.enabled = subscribe;
+        if (subscribe) {
+            subscription.firstKey = j.value("first", subscription.firstKey);
+            subscription.keyCount = j.value("count", subscription.keyCount);
+            subscription.maxRateHz = j.value("maxRate", subscription.maxRateHz);
+            subscription.readingDeadband = j.value("deadband", subscription.readingDeadband);
+            subscription.keyframeInterval = j.value("keyframeInterval", subscription.keyframeInterval);
+        }
+        onKeyScanSubscription_(subscription);
+        
+        sendAck(cmd);
+        return true;
+    }
+    
+    bool handleSubscribeAudioTap(const CommandParser& j, bool subscribe) {
+        const char* cmd = subscribe ? "subscribeAudioTap" : "unsubscribeAudioTap";
+        int voice = j.value("voice", -1);
+        uint16_t decimation = j.value("decimation", static_cast<uint16_t>(1));
+        
+        if (!onAudioTap_ || !onAudioTap_(subscribe, voice, decimation)) {
+            sendError("no such audio tap");
+            return false;
         }
-        // Aftertouch modulation
-        else if (param == "baseCutoff_atMod") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.setBaseCutoffAtMod(value); });
+        
+        sendAck(cmd);
+        return true;
+    }
+    
+    bool handleSetLatencyProfile(const CommandParser& j) {
+        TextSpan name;
+        features::LatencyProfile profile;
+        if (!j.getString("profile", name) || !features::parseLatencyProfile(name.text, name.length, profile)) {
+            sendError("unknown latency profile");
+            return false;
         }
-        else if (param == "filterEnvAmount_atMod") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.setFilterEnvAmountAtMod(value); });
+        if (!onLatencyProfile_ || !onLatencyProfile_(profile)) {
+            sendError("latency profiles not supported");
+            return false;
         }
-        else if (param == "vibratoDepth_atMod") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.setVibratoDepthAtMod(value); });
+        sendAck("setLatencyProfile");
+        return true;
+    }
+    
+    /**
+     * @brief Set a synth parameter by name
+     */
+    void setParameter(const TextSpan& param, float value) {
+        const synth::ParamDescriptor* p = synth::findParam(param.text, param.length);
+        if (!p) {
+            // Externally-registered params (e.g. keyboard aftertouch range)
+            if (!applyExternalParam(param, value)) {
+                logWarn("Unknown parameter: %.*s", static_cast<int>(param.length), param.text);
+            }
+            return;
         }
-        else if (param == "tremoloDepth_atMod") {
-            forEachWavetableSynth([value](synth::WavetableSynth& v) { v.setTremoloDepthAtMod(value); });
+        synth::ParamBatch batch;
+        batch.set(*p, value);
+        applyBatch(batch);
+    }
+    
+    /**
+     * @brief Collect a batch for the batch callback, or apply it to the voices now
+     */
+    void applyBatch(const synth::ParamBatch& batch) {
+        if (batch.empty()) {
+            return;
         }
-        // Externally-registered params (e.g. keyboard aftertouch range)
-        else if (!applyExternalParam(param, value)) {
-            logWarn("Unknown parameter: %s", param.c_str());
+        if (onParamBatch_) {
+            pendingParams_.merge(batch);
+            return;
         }
+        forEachWavetableSynth([&batch](synth::WavetableSynth& v) { batch.applyTo(v); });
+        markParamsChanged(static_cast<uint32_t>(batch.changed.to_ulong()));
     }
 
     /**
      * @brief Apply a value to an externally-registered param
      * @return true if the param was registered (and applied), false otherwise
      */
-    bool applyExternalParam(const std::string& param, float value) {
+    bool applyExternalParam(const TextSpan& param, float value) {
         for (auto& p : externalParams_) {
-            if (p.name == param) {
+            if (std::strlen(p.name) == param.length && std::memcmp(p.name, param.text, param.length) == 0) {
                 if (p.set) p.set(value);
                 return true;
             }
@@ -324,40 +689,63 @@ private:
      * @brief Send current parameters as telemetry
      */
     void sendCurrentParams() {
-        ParamsTelemetry params;
-        bool captured = false;
-        forEachWavetableSynth([&params, &captured](synth::WavetableSynth& v) {
-            if (!captured) {
-                params.waveformShape = v.getOscillator().getShape();
-                params.baseCutoff = v.getBaseCutoff();
-                params.filterQ = v.getFilter().getQ();
-                params.filterMode = static_cast<int>(v.getFilter().getMode());
-                params.filterEnvAmount = v.getFilterEnvelopeAmount();
-                params.filterEnvAttack = v.getFilterEnvelope().getAttackTime();
-                params.filterEnvDecay = v.getFilterEnvelope().getDecayTime();
-                params.filterEnvSustain = v.getFilterEnvelope().getSustainLevel();
-                params.filterEnvRelease = v.getFilterEnvelope().getReleaseTime();
-                params.ampEnvAttack = v.getAmpEnvelope().getAttackTime();
-                params.ampEnvDecay = v.getAmpEnvelope().getDecayTime();
-                params.ampEnvSustain = v.getAmpEnvelope().getSustainLevel();
-                params.ampEnvRelease = v.getAmpEnvelope().getReleaseTime();
-                params.vibratoRate = v.getVibratoRate();
-                params.vibratoDepth = v.getVibratoDepth();
-                params.tremoloRate = v.getTremoloRate();
-                params.tremoloDepth = v.getTremoloDepth();
-                params.baseCutoff_atMod = v.getBaseCutoffAtMod();
-                params.filterEnvAmount_atMod = v.getFilterEnvAmountAtMod();
-                params.vibratoDepth_atMod = v.getVibratoDepthAtMod();
-                params.tremoloDepth_atMod = v.getTremoloDepthAtMod();
-                captured = true;
-            }
-        });
-        nlohmann::json j = params;
-        // Append externally-registered params (e.g. keyboard aftertouch range)
+        // A full report supersedes any pending changes
+        changedParams_.store(0, std::memory_order_relaxed);
+        float values[synth::PARAM_COUNT];
+        captureParams(values);
+        ParamEntry entries[MAX_PARAM_ENTRIES];
+        size_t count = collectParamEntries(values, entries);
+        // Merge in externally-registered params (e.g. keyboard aftertouch range)
         for (const auto& p : externalParams_) {
-            j[p.name] = p.get ? p.get() : 0.0f;
+            float value = p.get ? p.get() : 0.0f;
+            size_t i = 0;
+            while (i < count && std::strcmp(p.name, entries[i].name) != 0) {
+                i++;
+            }
+            if (i < count) {
+                entries[i] = {entries[i].name, value, false};
+            } else if (count < MAX_PARAM_ENTRIES) {
+                entries[count++] = {p.name, value, false};
+            } else {
+                logWarn("Too many params to report; dropping %s", p.name);
+            }
+        }
+        features::JsonWriter w(output_, outputContext_);
+        writeParamsJson(w, entries, count);
+        w.raw('\n');
+        w.finish();
+    }
+    
+    /**
+     * @brief Read every voice param as it stands once queued changes are applied
+     *
+     * With a batch callback: the applied snapshot, overlaid with the batches
+     * handed over since and then with changes not handed over yet, so earlier
+     * commands in the same chunk are seen. Without one: the first voice (all
+     * voices share settings).
+     */
+    void captureParams(float* values) {
+        if (!appliedParams_) {
+            bool captured = false;
+            forEachWavetableSynth([values, &captured](synth::WavetableSynth& v) {
+                if (!captured) {
+                    for (size_t i = 0; i < synth::PARAM_COUNT; i++) {
+                        values[i] = synth::SYNTH_PARAMS[i].get(v);
+                    }
+                    captured = true;
+                }
+            });
+            return;
+        }
+        flushParamChanges();
+        const uint32_t applied = appliedParams_->read(values);
+        for (size_t i = 0; i < synth::PARAM_COUNT; i++) {
+            if (pendingParams_.changed.test(i)) {
+                values[i] = pendingParams_.values[i];   // The queue was full
+            } else if (static_cast<int32_t>(inFlightBatch_[i] - applied) > 0) {
+                values[i] = inFlightValues_[i];
+            }
         }
-        printf("%s\n", j.dump().c_str());
     }
     
     /**
@@ -366,7 +754,14 @@ private:
     void saveProgram(uint8_t bank, uint8_t program) {
         if (programStorage_) {
             uint8_t slot = bank * 8 + program;  // Simple slot calculation
-            programStorage_->saveProgram(slot, voiceIterator_);
+            // Storage reads params from a voice: hand it a copy, not a live one
+            float values[synth::PARAM_COUNT];
+            captureParams(values);
+            synth::WavetableSynth staging;
+            for (size_t i = 0; i < synth::PARAM_COUNT; i++) {
+                synth::SYNTH_PARAMS[i].set(staging, values[i]);
+            }
+            programStorage_->saveProgram(slot, [&staging](features::ProgramStorage::VoiceVisitor visitor) { visitor(staging); });
             logInfo("Saved program to bank %d, slot %d", bank, program);
         } else {
             logWarn("No program storage available");
@@ -379,7 +774,7 @@ private:
     void loadProgram(uint8_t bank, uint8_t program) {
         if (programStorage_) {
             uint8_t slot = bank * 8 + program;  // Simple slot calculation
-            programStorage_->loadProgram(slot, voiceIterator_);
+            loadProgramSlot(slot);
             logInfo("Loaded program from bank %d, slot %d", bank, program);
             // Send updated params to control panel
             sendCurrentParams();
@@ -388,21 +783,19 @@ private:
         }
     }
     
-    void sendAck(const std::string& cmd) {
+    void sendAck(const char* cmd) {
         CommandResponse resp;
         resp.ack = cmd;
         resp.status = "ok";
-        nlohmann::json j = resp;
-        printf("%s\n", j.dump().c_str());
+        features::writeJsonLine(resp, output_, outputContext_);
     }
     
-    void sendError(const std::string& message) {
+    void sendError(const char* message) {
         CommandResponse resp;
         resp.ack = "error";
         resp.status = "error";
         resp.error = message;
-        nlohmann::json j = resp;
-        printf("%s\n", j.dump().c_str());
+        features::writeJsonLine(resp, output_, outputContext_);
     }
     
     /**
@@ -419,18 +812,48 @@ private:
     VoiceIterator voiceIterator_;
     features::ProgramStorage* programStorage_;
     SetBaseNoteCallback onSetBaseNote_;
+    KeyScanSubscriptionCallback onKeyScanSubscription_;
+    AudioTapCallback onAudioTap_;
+    LatencyProfileCallback onLatencyProfile_;
+    ParamBatchCallback onParamBatch_;
+    synth::ParamBatch pendingParams_;    // Voice changes not yet taken by onParamBatch_
+    
+    // Batches taken by onParamBatch_ and not yet known to be applied: the
+    // newest value handed over for each param and the batch that carried it
+    const synth::ParamSnapshot* appliedParams_ = nullptr;
+    float inFlightValues_[synth::PARAM_COUNT] = {};
+    uint32_t inFlightBatch_[synth::PARAM_COUNT] = {};
+    uint32_t pushedBatches_ = 0;
 
     // Registry of params that live outside the synth voices
+    static constexpr size_t MAX_EXTERNAL_PARAMS = 8;
+    static constexpr size_t MAX_EXTERNAL_PARAM_NAME = 32;
     struct ExternalParam {
-        std::string name;
-        std::function<void(float)> set;
-        std::function<float()> get;
+        char name[MAX_EXTERNAL_PARAM_NAME];
+        ParamSetter set;
+        ParamGetter get;
     };
-    std::vector<ExternalParam> externalParams_;
+    features::FixedVector<ExternalParam, MAX_EXTERNAL_PARAMS> externalParams_;
+    static constexpr size_t MAX_PARAM_ENTRIES = synth::PARAM_COUNT + MAX_EXTERNAL_PARAMS;
+    static constexpr size_t MAX_PARAM_ERRORS = 8;   // Listed in a setParams response
+    
+    // Voice params changed since the last report, one bit per SYNTH_PARAMS entry
+    static constexpr uint32_t DEFAULT_PARAM_PUSH_INTERVAL_MS = 100;
+    std::atomic<uint32_t> changedParams_{0};
+    uint32_t paramPushIntervalMs_ = DEFAULT_PARAM_PUSH_INTERVAL_MS;
+    uint32_t lastParamPushMs_ = 0;
+    
+    // Parsed view of the line being processed
+    CommandParser parser_;
+    
+    // Where responses and params messages are written
+    features::JsonWriter::WriteFn output_ = features::writeJsonToFile;
+    void* outputContext_ = stdout;
     
     // Line accumulation buffer
     char lineBuffer_[512] = {0};
     size_t bufferLen_ = 0;
+    bool lineOverflowed_ = false;   // Discarding the rest of an overlong line
 };
 
 } // namespace webcontrol
@@ -35,6 +35,9 @@ static constexpr size_t NUM_KEYS = sizeof(KEY_GPIOS) / sizeof(KEY_GPIOS[0]);
 // Scanner is templated so compiler can optimize code for actual key count
 using ScannerType = esp32::ESP32CapacitiveScanner<KEY_GPIOS, NUM_KEYS>;
 
+// Telemetry wire format (Binary or Json; the control panel accepts both)
+static constexpr features::TelemetryFormat TELEMETRY_FORMAT = features::TelemetryFormat::Binary;
+
 // MIDI controller type with compile-time configuration
 using MidiControllerType = midi::MidiKeyboardController<NUM_KEYS>;
 
@@ -55,7 +58,7 @@ void audioTask(void* parameter) {
     
     // Main audio loop
     while (true) {
-        // Process keyboard scan (called from audio loop, scanner runs in separate task)
+        // Process the newest keyboard scan frame, if any (scanner publishes from its own task)
         keyboard->processScan();
 
         // Fill and write audio buffer
@@ -73,6 +76,9 @@ extern "C" void app_main(void) {
     
     // Audio configuration
     const unsigned int REQUESTED_SAMPLE_RATE = 44100;
+    // Engine rate; 0 renders at the actual I2S rate. A lower rate (e.g. 32000)
+    // saves DSP time and is resampled to the I2S rate.
+    const unsigned int RENDER_SAMPLE_RATE = 0;
     const unsigned int CHANNELS = 2;
     const unsigned int BUFFER_FRAMES = 128;
     const uint8_t MAX_VOICES = 8;
@@ -90,10 +96,11 @@ extern "C" void app_main(void) {
     
     logInfo("Initializing synthesizer...");
     synthApp = std::make_unique<platform::SynthApplication>(
-        actualSampleRate,
+        RENDER_SAMPLE_RATE != 0 ? RENDER_SAMPLE_RATE : actualSampleRate,
         CHANNELS,
         MAX_VOICES,
         std::make_unique<esp32::EmbeddedProgramStorage>());
+    synthApp->setOutputRate(actualSampleRate, platform::ResamplerQuality::Fast);
         
     // Start capacitive touch keyboard
     logInfo("Starting capacitive keyboard scanner...");
@@ -103,7 +110,7 @@ extern "C" void app_main(void) {
     keyboard = std::make_unique<MidiControllerType>(
         *scanner,
         [](uint8_t byte) { synthApp->processMidiByte(byte); },
-        std::make_unique<esp32::Esp32TelemetrySink<midi::KeyScanStats<NUM_KEYS>>>("keyscan_telem", 0),
+        std::make_unique<esp32::Esp32TelemetrySink<midi::KeyScanStats<NUM_KEYS>>>("keyscan_telem", 0, TELEMETRY_FORMAT),
         60-24,  // Base note: C4
         20   // Fixed velocity
     );
@@ -133,8 +140,11 @@ extern "C" void app_main(void) {
     logInfo("Audio/MIDI processing started!");
     logInfo("App_main running on core %d", xPortGetCoreID());
     
-    // All work is now in other tasks. Just idle.
+    // No control panel to report to, but MIDI program changes are still
+    // loaded here rather than on the audio task
+    synthApp->setParamPushInterval(0);
     while (true) {
-        vTaskDelay(pdMS_TO_TICKS(10000));  // Sleep, let other tasks run
+        synthApp->pushParamChanges(static_cast<uint32_t>(esp_timer_get_time() / 1000));
+        vTaskDelay(pdMS_TO_TICKS(20));
     }
 }
@@ -1,10 +1,26 @@
 #include <linux_audio_sink.hpp>
+#include <alsa_calibration.hpp>
 #include <alsa_midi_in.hpp>
+#include <linux_telemetry_sink.hpp>
+#include <mmap_flight_recorder.hpp>
+#include <serial_command_port.hpp>
+#include <control_server.hpp>
+#include <linux_timing_policy.hpp>
 #include <synth_application.hpp>
 #include <performance_timer.hpp>
 #include <log.hpp>
+
+// The native_rtguard environment links the real-time safety interposers in here
+#ifdef RT_SAFETY_GUARD
+#define RT_SAFETY_GUARD_INTERPOSE
+#endif
+#include <rt_safety_guard.hpp>
 #include <csignal>
 #include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
 
 // Platform-specific implementations
 #include <filesystem_program_storage.hpp>
@@ -20,12 +36,49 @@ void signalHandler(int signum) {
     running = false;
 }
 
+// Audio timing telemetry: one TimingStats message per audio block. Without
+// --telemetry nothing reads the spans, so the render runs untimed.
+using AudioTimer = features::LapTimer<linux_platform::LinuxTimingPolicy, 12>;
+using UntimedAudioTimer = features::LapTimer<features::NoOpTimingPolicy, 12>;
+using TimingStatsType = features::TimingStats<12>;
+
+/**
+ * @brief Create a telemetry sink for a --telemetry target
+ *
+ * "control" fans messages out to the control server's clients; anything else
+ * is a LinuxTelemetrySink target (stdout, file or unix:<path>).
+ */
+template<typename TelemetryDataT>
+std::unique_ptr<linux::LinuxTelemetrySink<TelemetryDataT>> makeTelemetrySink(
+        const char* target, bool binary, linux::ControlServer* controlServer) {
+    const features::TelemetryFormat format =
+        binary ? features::TelemetryFormat::Binary : features::TelemetryFormat::Json;
+    if (strcmp(target, "control") == 0) {
+        if (!controlServer) {
+            throw std::runtime_error("--telemetry=control needs --control-socket or --control-tcp");
+        }
+        return std::make_unique<linux::LinuxTelemetrySink<TelemetryDataT>>(
+            linux::ControlServer::publishToClients, controlServer, format);
+    }
+    return std::make_unique<linux::LinuxTelemetrySink<TelemetryDataT>>(target, format);
+}
+
 extern "C" {
-  int app_main(const char* midiDevice = nullptr);
+  int app_main(const char* midiDevice = nullptr, const char* telemetryTarget = nullptr, bool binaryTelemetry = false,
+               const char* flightRecorderPath = nullptr, bool audioMeter = false,
+               const char* controlPath = nullptr, const char* controlSocketPath = nullptr,
+               int controlTcpPort = linux::ControlServer::NO_TCP,
+               bool recalibrate = false, unsigned int periodFrames = 0, unsigned int periods = 0,
+               unsigned int renderRate = 0,
+               platform::ResamplerQuality resamplerQuality = platform::ResamplerQuality::Balanced);
   int main(int argc, char** argv);
 }
 
-int app_main(const char* midiDevice) {
+int app_main(const char* midiDevice, const char* telemetryTarget, bool binaryTelemetry,
+             const char* flightRecorderPath, bool audioMeter, const char* controlPath,
+             const char* controlSocketPath, int controlTcpPort,
+             bool recalibrate, unsigned int periodFrames, unsigned int periods,
+             unsigned int renderRate, platform::ResamplerQuality resamplerQuality) {
     try {
         logInfo("Pressence Synthesizer - Linux");
         logInfo("=============================");
@@ -47,8 +100,18 @@ int app_main(const char* midiDevice) {
         // Check if device was specified
         if (midiDevice == nullptr) {
             logInfo("\nNo MIDI device specified. Exiting.");
-            logInfo("Usage: program <midi-device-name>");
+            logInfo("Usage: program <midi-device-name> [--telemetry[=<target>]] [--telemetry-binary] [--flight-recorder=<file>] [--audio-meter]");
+            logInfo("                [--control=<tty> | --control-socket=<path> --control-tcp=<port>]");
+            logInfo("                [--calibrate] [--period=<frames>] [--periods=<n>]");
+            logInfo("                [--render-rate=<hz>] [--resampler=fast|balanced|high]");
             logInfo("Example: program hw:1,0,0");
+            logInfo("Telemetry target: stdout (default), a file path, unix:<socket-path>, or control (control server clients)");
+            logInfo("Control panel commands: --control=<tty> reads a serial device or pty;");
+            logInfo("  --control-socket/--control-tcp serve local clients on a Unix socket and/or 127.0.0.1:<port>");
+            logInfo("Audio period: calibrated on first run and cached in audio_calibration.json;");
+            logInfo("  --calibrate runs it again; --period skips it, --periods overrides its period count");
+            logInfo("The synth renders at --render-rate (default: the device rate) and is resampled");
+            logInfo("  to whatever rate the device grants");
             return 1;
         }
         
@@ -57,9 +120,9 @@ int app_main(const char* midiDevice) {
         signal(SIGTERM, signalHandler);
         
         // Audio configuration
-        const unsigned int SAMPLE_RATE = 44100;
+        const unsigned int SAMPLE_RATE = 44100;   // Requested; the device may grant another
         const unsigned int CHANNELS = 2;
-        const unsigned int BUFFER_FRAMES = 128;
+        const char* AUDIO_DEVICE = "default";
         const uint8_t MAX_VOICES = 8;
         
         // Create MIDI input
@@ -67,44 +130,211 @@ int app_main(const char* midiDevice) {
         linux::AlsaMidiIn midiIn(midiDevice);
         logInfo("MIDI input ready: %s", midiIn.getDeviceName().c_str());
         
+        // Smallest period configuration this machine keeps up with, unless
+        // given on the command line; --periods alone overrides just the count
+        linux::AlsaLatencyConfig latency{periodFrames, 2};
+        if (periodFrames == 0) {
+            linux::AlsaCalibration calibration(AUDIO_DEVICE, SAMPLE_RATE, CHANNELS, MAX_VOICES);
+            calibration.setRenderRate(renderRate != 0 ? renderRate : SAMPLE_RATE, resamplerQuality);
+            if (recalibrate || !calibration.loadCached(latency)) {
+                latency = calibration.calibrate();
+            }
+        }
+        if (periods != 0) {
+            latency.periods = periods;
+        }
+        
         // Create audio sink
         logInfo("\nInitializing audio output...");
-        linux::AlsaPcmOut audioSink("default", SAMPLE_RATE, CHANNELS, BUFFER_FRAMES);
-        logInfo("Audio: %d Hz, %d channels, %d frames/buffer",
+        linux::AlsaPcmOut audioSink(AUDIO_DEVICE, SAMPLE_RATE, CHANNELS, latency.periodFrames,
+                                    linux::PcmFormat::Float, latency.periods);
+        static const char* const FORMAT_NAMES[] = {"float", "s32", "s16"};
+        logInfo("Audio: %d Hz, %d channels, %d frames/buffer x %d (%d in efficiency profile), %s",
                audioSink.getSampleRate(), 
                audioSink.getChannels(), 
-               audioSink.getBufferFrames());
+               audioSink.getBufferFrames(),
+               audioSink.getPeriods(),
+               audioSink.getBufferFrames() * linux::AlsaPcmOut::EFFICIENCY_PERIODS,
+               FORMAT_NAMES[static_cast<int>(audioSink.getFormat())]);
         
         // Create synthesizer application with platform implementations
         auto programStorage = std::make_unique<linux::FilesystemProgramStorage>();
-        platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES, std::move(programStorage));
+        // Render at the chosen rate, or at the rate the device actually
+        // runs at; any difference is resampled rather than left to detune
+        const unsigned int deviceRate = audioSink.getSampleRate();
+        platform::SynthApplication synth(renderRate != 0 ? renderRate : deviceRate, CHANNELS, MAX_VOICES,
+                                         std::move(programStorage));
+        synth.setOutputRate(deviceRate, resamplerQuality);
 
 #ifdef FEATURE_CLIPBOARD
         synth.setClipboard(std::make_unique<linux::PresetClipboard>());
 #endif
+
+        // The sink picks the new period up at its next write
+        synth.setLatencyProfileCallback([&audioSink](features::LatencyProfile profile) {
+            audioSink.setLatencyProfile(profile);
+            logInfo("Latency profile: %s (%u frames per write)",
+                    features::latencyProfileName(profile), audioSink.getPeriodFrames());
+            return true;
+        });
+        
+        // Optional control panel commands, handled on their own thread: from
+        // a serial device or pty, or from local clients of the control
+        // server. Voice param changes reach the audio thread through
+        // SynthApplication's queue; responses go back to the sender.
+        const bool serveControl = controlSocketPath != nullptr || controlTcpPort != linux::ControlServer::NO_TCP;
+        if (controlPath != nullptr && serveControl) {
+            logError("Use either --control or --control-socket/--control-tcp");
+            return 1;
+        }
+        std::unique_ptr<linux::SerialCommandPort> controlPort;
+        std::unique_ptr<linux::ControlServer> controlServer;
+        if (controlPath != nullptr) {
+            controlPort = std::make_unique<linux::SerialCommandPort>(controlPath);
+            synth.setCommandOutput(linux::SerialCommandPort::writeToPort, controlPort.get());
+        } else if (serveControl) {
+            controlServer = std::make_unique<linux::ControlServer>(
+                controlSocketPath ? controlSocketPath : "", controlTcpPort);
+            synth.setCommandOutput(linux::ControlServer::writeResponse, controlServer.get());
+        }
+        
+        // Optional timing telemetry. The sink only copies into a ring on the
+        // audio thread; serializing and writing happen on its own thread.
+        std::unique_ptr<linux::LinuxTelemetrySink<TimingStatsType>> timingSink;
+        if (telemetryTarget != nullptr) {
+            timingSink = makeTelemetrySink<TimingStatsType>(telemetryTarget, binaryTelemetry, controlServer.get());
+        }
+        
+        // Optional flight recorder: a crash-safe ring of recent events for
+        // post-mortem analysis of glitches (dump with tools/flight_decode)
+        std::unique_ptr<linux::MmapFlightRecorder> flightRecorder;
+        if (flightRecorderPath != nullptr) {
+            flightRecorder = std::make_unique<linux::MmapFlightRecorder>(flightRecorderPath);
+            synth.setFlightRecorder(flightRecorder.get());
+        }
+        uint32_t lastXrunCount = 0;
+        
+        // Optional output meter/spectrum: the audio thread only copies each
+        // block into the tap; analysis runs here on its own thread
+        std::thread meterThread;
+#ifdef FEATURE_AUDIO_TAP
+        std::unique_ptr<linux::LinuxTelemetrySink<features::AudioMeterStats>> meterSink;
+        if (audioMeter) {
+            meterSink = makeTelemetrySink<features::AudioMeterStats>(
+                telemetryTarget ? telemetryTarget : "-", binaryTelemetry, controlServer.get());
+            synth.setAudioTap(true, -1);
+            meterThread = std::thread([&]() {
+                while (running) {
+                    synth.pollAudioTaps(*meterSink);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                }
+            });
+        }
+#else
+        if (audioMeter) {
+            logWarn("--audio-meter needs a build with FEATURE_AUDIO_TAP; ignoring it");
+        }
+#endif
+        
+        std::thread controlThread;
+        auto nowMs = []() {
+            return static_cast<uint32_t>(linux_platform::LinuxTimingPolicy::now() / 1000000);
+        };
+        if (controlPort) {
+            controlThread = std::thread([&]() {
+                while (running) {
+                    if (controlPort->waitReadable(20)) {
+                        controlPort->drain([&](const char* data, size_t length) {
+                            synth.processCommandBytes(data, length);
+                        });
+                    }
+                    synth.pushParamChanges(nowMs());
+                }
+            });
+        } else if (controlServer) {
+            controlThread = std::thread([&]() {
+                uint32_t reportedDrops = 0;
+                while (running) {
+                    controlServer->poll(20, [&](const char* line, size_t length) {
+                        synth.processCommandBytes(line, length);
+                    });
+                    synth.pushParamChanges(nowMs());
+                    if (controlServer->getDroppedCount() - reportedDrops >= 100) {
+                        reportedDrops = controlServer->getDroppedCount();
+                        logWarn("Control server: %u messages dropped for slow clients", reportedDrops);
+                    }
+                }
+            });
+        } else {
+            // No control panel to report to, but MIDI program changes are
+            // still loaded here rather than on the audio thread
+            synth.setParamPushInterval(0);
+            controlThread = std::thread([&]() {
+                while (running) {
+                    synth.pushParamChanges(nowMs());
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                }
+            });
+        }
+        
+        struct StopThreadsOnExit {
+            std::thread& meter;
+            std::thread& control;
+            ~StopThreadsOnExit() {
+                running = false;
+                for (std::thread* thread : {&meter, &control}) {
+                    if (thread->joinable()) {
+                        thread->join();
+                    }
+                }
+            }
+        } stopThreads{meterThread, controlThread};
         
         // Main audio loop
         logInfo("\nStarting audio/MIDI processing (Ctrl+C to stop)...");
         logInfo("Play notes on your MIDI device!");
         
-        // Timer for performance measurement (NoOp for now - enable with LinuxTimingPolicy)
-        features::LapTimer<features::NoOpTimingPolicy, 12> timer;
+        AudioTimer timer;
+        UntimedAudioTimer untimed;
         
         while (running) {
             // Fill and write audio buffer
             audioSink.write([&](float* buffer, unsigned int numFrames) {
+                // Everything in this callback must be real-time safe
+                linux::RtSafetyGuard::Scope realtime;
+                
                 // First, drain MIDI input and process all pending messages
                 midiIn.pollAndRead([&](uint8_t byte) {
                     synth.processMidiByte(byte);
                 });
                 
                 // Render audio
-                synth.renderAudio(buffer, numFrames, timer);
-                timer.end();
+                uint64_t renderStart = flightRecorder ? linux_platform::LinuxTimingPolicy::now() : 0;
+                if (timingSink) {
+                    synth.renderAudio(buffer, numFrames, timer);
+                    timer.end();
+                    timingSink->sendTelemetry(timer.getStats());
+                    timer.reset();
+                } else {
+                    synth.renderAudio(buffer, numFrames, untimed);
+                }
+                if (flightRecorder) {
+                    uint64_t renderNs = linux_platform::LinuxTimingPolicy::now() - renderStart;
+                    flightRecorder->record(features::FlightEvent::BlockRender, 0,
+                                           static_cast<uint16_t>(numFrames), static_cast<uint32_t>(renderNs));
+                }
             });
+            
+            if (flightRecorder && audioSink.getXrunCount() != lastXrunCount) {
+                lastXrunCount = audioSink.getXrunCount();
+                flightRecorder->record(features::FlightEvent::Xrun, 0, 0, lastXrunCount);
+            }
         }
         
         logInfo("\nPlayback stopped.");
+        if (linux::RtSafetyGuard::isActive()) {
+            linux::RtSafetyGuard::report(stderr);
+        }
         return 0;
         
     } catch (const std::exception& e) {
@@ -114,6 +344,55 @@ int app_main(const char* midiDevice) {
 }
 
 int main(int argc, char** argv) {
-  const char* midiDevice = (argc > 1) ? argv[1] : nullptr;
-  return app_main(midiDevice);
+  const char* midiDevice = nullptr;
+  const char* telemetryTarget = nullptr;
+  bool binaryTelemetry = false;
+  const char* flightRecorderPath = nullptr;
+  bool audioMeter = false;
+  const char* controlPath = nullptr;
+  const char* controlSocketPath = nullptr;
+  int controlTcpPort = linux::ControlServer::NO_TCP;
+  bool recalibrate = false;
+  unsigned int periodFrames = 0;
+  unsigned int periods = 0;
+  unsigned int renderRate = 0;
+  platform::ResamplerQuality resamplerQuality = platform::ResamplerQuality::Balanced;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--telemetry") == 0) {
+      telemetryTarget = "-";
+    } else if (strncmp(argv[i], "--telemetry=", 12) == 0) {
+      telemetryTarget = argv[i] + 12;
+    } else if (strcmp(argv[i], "--telemetry-binary") == 0) {
+      binaryTelemetry = true;
+    } else if (strncmp(argv[i], "--flight-recorder=", 18) == 0) {
+      flightRecorderPath = argv[i] + 18;
+    } else if (strcmp(argv[i], "--audio-meter") == 0) {
+      audioMeter = true;
+    } else if (strncmp(argv[i], "--control=", 10) == 0) {
+      controlPath = argv[i] + 10;
+    } else if (strncmp(argv[i], "--control-socket=", 17) == 0) {
+      controlSocketPath = argv[i] + 17;
+    } else if (strncmp(argv[i], "--control-tcp=", 14) == 0) {
+      controlTcpPort = atoi(argv[i] + 14);
+    } else if (strcmp(argv[i], "--calibrate") == 0) {
+      recalibrate = true;
+    } else if (strncmp(argv[i], "--period=", 9) == 0) {
+      periodFrames = static_cast<unsigned int>(atoi(argv[i] + 9));
+    } else if (strncmp(argv[i], "--periods=", 10) == 0) {
+      periods = static_cast<unsigned int>(atoi(argv[i] + 10));
+    } else if (strncmp(argv[i], "--render-rate=", 14) == 0) {
+      renderRate = static_cast<unsigned int>(atoi(argv[i] + 14));
+    } else if (strcmp(argv[i], "--resampler=fast") == 0) {
+      resamplerQuality = platform::ResamplerQuality::Fast;
+    } else if (strcmp(argv[i], "--resampler=high") == 0) {
+      resamplerQuality = platform::ResamplerQuality::High;
+    } else if (strcmp(argv[i], "--resampler=balanced") == 0) {
+      resamplerQuality = platform::ResamplerQuality::Balanced;
+    } else if (midiDevice == nullptr) {
+      midiDevice = argv[i];
+    }
+  }
+  return app_main(midiDevice, telemetryTarget, binaryTelemetry, flightRecorderPath, audioMeter, controlPath,
+                  controlSocketPath, controlTcpPort, recalibrate, periodFrames, periods,
+                  renderRate, resamplerQuality);
 }
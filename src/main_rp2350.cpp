@@ -7,7 +7,6 @@
 #include <stdio.h>
 #include <cstdint>
 #include <cmath>
-#include <memory>
 #include <type_traits>
 #include "pico/stdlib.h"
 #include "pico/multicore.h"
@@ -29,6 +28,9 @@
 // MIDI keyboard controller
 #include <midi_keyboard_controller.hpp>
 
+#include <fixed_vector.hpp>
+#include <memory_report.hpp>
+
 // System clock: overclock to 300 MHz (2x the RP2350's 150 MHz default spec).
 // Requires a core-voltage bump to stay stable; see main().
 static constexpr uint32_t TARGET_SYS_CLOCK_KHZ = 300000;
@@ -52,16 +54,24 @@ static constexpr int MAINS_FREQUENCY_HZ = 60;
 static constexpr int MAINS_CYCLES_PER_SCAN = 1;  // integration window, in line cycles
 static constexpr int64_t MAINS_AVERAGE_WINDOW_US =
     (1000000LL * MAINS_CYCLES_PER_SCAN) / MAINS_FREQUENCY_HZ;
+static constexpr uint32_t SCAN_TIMEOUT_US = 5000;  // Far longer than one full sub-scan
 static constexpr uint8_t NUM_VOICES = 8;
 
 static constexpr float MASTER_VOLUME = 0.05f;  // Master volume scaling factor (0.0 to 1.0)
 
 static constexpr bool ENABLE_AUDIO_TIMING_TELEMETRY = false;  // Set to true to enable timing telemetry output (adds overhead)
 
+// Telemetry wire format: Binary keeps key scan telemetry at full scan rate over
+// USB CDC; Json is easier to read in a plain serial terminal. The control panel
+// accepts both.
+static constexpr features::TelemetryFormat TELEMETRY_FORMAT = features::TelemetryFormat::Binary;
+
 // Type aliases
 using Scanner = rp2350::PioCapacitiveScanner<FIRST_KEY_PIN, NUM_KEYS>;
 using AudioSink = rp2350::Rp2350AudioSink<BUFFER_SIZE>;
 using MidiController = midi::MidiKeyboardController<NUM_KEYS>;
+using SynthApp = platform::StaticSynthApplication<NUM_VOICES, synth::FixedSampleRate<SAMPLE_RATE>>;
+using KeyScanTelemetrySink = rp2350::Rp2350TelemetrySink<midi::KeyScanStats<NUM_KEYS>>;
 using AudioTimer = features::LapTimer<
     std::conditional_t<ENABLE_AUDIO_TIMING_TELEMETRY,
                        rp2350::Rp2350TimingPolicy,
@@ -70,13 +80,29 @@ using AudioTimer = features::LapTimer<
 using AudioTimingStats = features::TimingStats<12>;
 
 // Telemetry emission interval (in audio frames)
-static constexpr uint32_t TIMING_TELEMETRY_INTERVAL = 100;  // ~every 0.5 seconds at 48kHz/256 frames
+static constexpr uint32_t TIMING_TELEMETRY_FRAMES = SAMPLE_RATE / 2;  // ~every 0.5 seconds, whatever the period
+
+// Global instances. Each lives in static storage sized at compile time and is
+// constructed in main() once the clocks are set up; nothing is heap-allocated,
+// so the linker's .bss size is the firmware's whole RAM footprint.
+static features::StaticStorage<rp2350::EmbeddedProgramStorage> programStorageStorage;
+static features::StaticStorage<SynthApp> synthAppStorage;
+static features::StaticStorage<Scanner> scannerStorage;
+static features::StaticStorage<AudioSink> audioSinkStorage;
+static features::StaticStorage<KeyScanTelemetrySink> keyScanSinkStorage;
+static features::StaticStorage<MidiController> keyboardStorage;
+static features::StaticStorage<rp2350::Rp2350TelemetrySink<AudioTimingStats>> timingSinkStorage;
+#ifdef FEATURE_AUDIO_TAP
+static features::StaticStorage<rp2350::Rp2350TelemetrySink<features::AudioMeterStats>> audioMeterSinkStorage;
+#endif
 
-// Global instances
 static AudioSink* audioSink = nullptr;
 static MidiController* keyboard = nullptr;
-static platform::SynthApplication* synthApp = nullptr;
+static SynthApp* synthApp = nullptr;
 static rp2350::Rp2350TelemetrySink<AudioTimingStats>* timingSink = nullptr;
+#ifdef FEATURE_AUDIO_TAP
+static rp2350::Rp2350TelemetrySink<features::AudioMeterStats>* audioMeterSink = nullptr;
+#endif
 
 // Shared state for cross-core timing telemetry
 // Core 1 writes stats here, core 0 reads and emits telemetry
@@ -87,21 +113,35 @@ static AudioTimingStats sharedTimingStats;
  * @brief Generate audio samples from all synth voices into the buffer
  */
 void generateAudio(int32_t* buffer, size_t length, AudioTimer& timer) {
-    // Use a temporary float buffer for SynthApplication
-    static float floatBuffer[BUFFER_SIZE * 2];  // Stereo
-    
-    synthApp->renderAudio(floatBuffer, length, timer);
-    
-    // Convert stereo float to mono int32 (take left channel)
-    timer.nextSpan("main:float_to_int");
-    const float INTEGER_SCALE = 1073741824.0f; // 2^30
-    for (size_t i = 0; i < length; i++) {
-        float sample = floatBuffer[i * 2] * MASTER_VOLUME * INTEGER_SCALE;
-        buffer[i] = static_cast<int32_t>(sample);
-    }
+    // Render mono straight into the DMA buffer. Full scale is 2^30, half
+    // the int32 range, hence the extra 0.5 on the master volume.
+    synthApp->renderAudio<platform::S32Format>(buffer, length, 1, MASTER_VOLUME * 0.5f, timer);
     timer.end();
 }
 
+/**
+ * @brief Hand every byte waiting in the serial RX buffer to the command parser
+ *
+ * Called every key-scan loop iteration and between sub-scans: a whole
+ * control panel line arrives in one go instead of one character per ~16 ms
+ * mains-synchronous scan window.
+ */
+void drainSerialCommands() {
+    char bytes[64];
+    size_t count = 0;
+    int ch;
+    while ((ch = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        bytes[count++] = static_cast<char>(ch);
+        if (count == sizeof(bytes)) {
+            synthApp->processCommandBytes(bytes, count);
+            count = 0;
+        }
+    }
+    if (count > 0) {
+        synthApp->processCommandBytes(bytes, count);
+    }
+}
+
 /**
  * @brief Audio generation loop (runs on core 1)
  *
@@ -116,8 +156,11 @@ void core1_audio_loop() {
     AudioTimer timer;
     uint32_t frameCount = 0;
     
-    // Pre-fill the inactive buffer so it's ready when the first DMA completes
-    generateAudio(audioSink->getInactiveBuffer(), BUFFER_SIZE, timer);
+    // Pre-fill the inactive buffer so it's ready when the first DMA completes.
+    // The period is re-read before every fill so latency profile changes from
+    // core 0 take effect at the next buffer boundary.
+    size_t filled = audioSink->getPeriodFrames();
+    generateAudio(audioSink->getInactiveBuffer(), filled, timer);
 
     while (true) {
         // Start measuring wait time for the next audio frame request
@@ -129,14 +172,16 @@ void core1_audio_loop() {
         }
 
         // Immediately swap to the pre-filled buffer and start DMA
-        audioSink->swapBuffers();
+        audioSink->swapBuffers(filled);
         
         // Now fill the new inactive buffer while DMA runs on the other one
-        generateAudio(audioSink->getInactiveBuffer(), BUFFER_SIZE, timer);
+        filled = audioSink->getPeriodFrames();
+        generateAudio(audioSink->getInactiveBuffer(), filled, timer);
         
         // Periodically signal core 0 to emit timing telemetry
         // (Don't do printf/JSON from core 1 - causes crashes)
-        if (++frameCount >= TIMING_TELEMETRY_INTERVAL) {
+        frameCount += filled;
+        if (frameCount >= TIMING_TELEMETRY_FRAMES) {
             if (!timingStatsReady) {
                 // Copy stats to shared buffer for core 0 to emit
                 sharedTimingStats = timer.getStats();
@@ -174,56 +219,45 @@ int main() {
     
     // Create synth application (handles voices, MIDI processing, audio rendering)
     printf("Initializing %d-voice polyphonic synthesizer...\n", NUM_VOICES);
-    synthApp = new platform::SynthApplication(
+    synthApp = synthAppStorage.emplace(
         SAMPLE_RATE, 
         2,  // channels
         NUM_VOICES, 
-        std::make_unique<rp2350::EmbeddedProgramStorage>()
+        programStorageStorage.emplace()
     );
     printf("Synth initialized\n");
     
     // Set up a key scanner that feeds into the synth via MIDI events
     printf("Initializing PIO capacitive key scanner...\n");
-    std::unique_ptr<Scanner> scanner = std::make_unique<Scanner>();
-    
-    if (!scanner) {
-        printf("ERROR: Failed to create scanner!\n");
-        return 1;
-    }
+    Scanner* scanner = scannerStorage.emplace();
     printf("Scanner initialized with %d keys\n", scanner->getKeyCount());
     
     // Initialize audio sink
     printf("Initializing I2S audio output...\n");
-    audioSink = new AudioSink(SAMPLE_RATE, I2S_FIRST_PIN);
-    
-    if (!audioSink) {
-        printf("ERROR: Failed to create audio sink!\n");
-        return 1;
-    }
+    audioSink = audioSinkStorage.emplace(SAMPLE_RATE, I2S_FIRST_PIN);
     printf("Audio sink initialized\n");
     
     // Initialize timing telemetry sink (only if telemetry is enabled)
     if constexpr (ENABLE_AUDIO_TIMING_TELEMETRY) {
-        timingSink = new rp2350::Rp2350TelemetrySink<AudioTimingStats>();
+        timingSink = timingSinkStorage.emplace(TELEMETRY_FORMAT);
         printf("Timing telemetry sink initialized\n");
     }
     
+#ifdef FEATURE_AUDIO_TAP
+    // Audio meters/spectrum for taps the control panel subscribes to; analyzed on core 0
+    audioMeterSink = audioMeterSinkStorage.emplace(TELEMETRY_FORMAT);
+#endif
+    
     // Initialize MIDI keyboard controller with telemetry
     printf("Initializing MIDI keyboard controller...\n");
-    auto telemetrySink = std::make_unique<rp2350::Rp2350TelemetrySink<midi::KeyScanStats<NUM_KEYS>>>();
-    keyboard = new MidiController(
+    keyboard = keyboardStorage.emplace(
         *scanner,
         [](uint8_t byte) { synthApp->processMidiByte(byte); },
-        std::move(telemetrySink),
+        *keyScanSinkStorage.emplace(TELEMETRY_FORMAT),
         36,  // Base note (C4=60, C3=48, C2=36)
         100  // Velocity
     );
     
-    if (!keyboard) {
-        printf("ERROR: Failed to create keyboard controller!\n");
-        return 1;
-    }
-    
     // Wire up base note callback so control panel can change keyboard base note
     synthApp->setBaseNoteCallback([](uint8_t note) {
         if (keyboard) {
@@ -231,6 +265,21 @@ int main() {
         }
     });
 
+    // Latency profile changes only set the DMA period; core 1 picks it up
+    // at its next buffer fill
+    synthApp->setLatencyProfileCallback([](features::LatencyProfile profile) {
+        audioSink->setLatencyProfile(profile);
+        return true;
+    });
+
+    // Let the control panel switch key scan telemetry to subscribed deltas.
+    // Commands are handled on this core, between scans, so no locking needed.
+    synthApp->setKeyScanSubscriptionCallback([](const midi::KeyScanSubscription& subscription) {
+        if (keyboard) {
+            keyboard->setTelemetrySubscription(subscription);
+        }
+    });
+
     // Wire up aftertouch range knobs so the control panel can tune touch response
     synthApp->registerExternalParam("aftertouchMinRatio",
         [](float v) { if (keyboard) keyboard->setAftertouchMinRatio(v); },
@@ -242,6 +291,19 @@ int main() {
     // Enable telemetry output
     keyboard->setTelemetryEnabled(true);
     printf("Keyboard controller initialized\n");
+
+    // Where the RAM goes; tools/ram_report.py gives the same from the ELF at build time
+    features::MemoryReport memory;
+    synthApp->reportMemory(memory);
+    memory.add("audio sink", sizeof(AudioSink));
+    memory.add("keys", sizeof(Scanner) + sizeof(MidiController));
+    size_t telemetryBytes = sizeof(KeyScanTelemetrySink) + timingSinkStorage.size() + sizeof(sharedTimingStats);
+#ifdef FEATURE_AUDIO_TAP
+    telemetryBytes += audioMeterSinkStorage.size();
+#endif
+    memory.add("telemetry", telemetryBytes);
+    memory.add("storage", programStorageStorage.size());
+    memory.log();
     printf("Calibrating... (this takes a few seconds)\n\n");
 
     // Pre-fill audio buffer before starting
@@ -260,6 +322,7 @@ int main() {
     printf("========================================\n\n");
     
     // Core 0 runs the key scan loop
+    uint32_t lastScanSequence = 0;
     while (true) {
         // Check if core 1 has timing stats ready to emit
         if (timingStatsReady) {
@@ -270,11 +333,8 @@ int main() {
             timingStatsReady = false;
         }
         
-        // Check for incoming serial commands (non-blocking)
-        int ch = getchar_timeout_us(0);
-        if (ch != PICO_ERROR_TIMEOUT) {
-            synthApp->processCommandChar(static_cast<char>(ch));
-        }
+        // Process all pending serial commands (non-blocking)
+        drainSerialCommands();
         
         // Mains-synchronous averaging: oversample the keys for one full AC
         // line cycle and average, so 60 Hz hum (and its harmonics) integrate
@@ -285,12 +345,19 @@ int main() {
         absolute_time_t windowEnd = make_timeout_time_us(MAINS_AVERAGE_WINDOW_US);
         do {
             scanner->startScan();
-            scanner->waitForScanComplete();
-            const uint16_t* r = scanner->getScanReadings();
+            midi::ScanFrame frame;
+            if (!scanner->waitForFrame(lastScanSequence, frame, SCAN_TIMEOUT_US)) {
+                printf("WARNING: key scan timed out\n");
+                continue;
+            }
+            lastScanSequence = frame.sequence;
             for (uint8_t i = 0; i < NUM_KEYS; i++) {
-                readingSums[i] += r[i];
+                readingSums[i] += frame.readings[i];
             }
             sampleCount++;
+            
+            // Commands arriving mid-window are handled now, not a cycle later
+            drainSerialCommands();
         } while (!time_reached(windowEnd));
 
         uint16_t averagedReadings[NUM_KEYS];
@@ -301,7 +368,15 @@ int main() {
         }
 
         // Process averaged readings and generate MIDI events -> synth
-        keyboard->processScan(averagedReadings);
+        keyboard->processScan(averagedReadings, time_us_64());
+        
+#ifdef FEATURE_AUDIO_TAP
+        // Meter any subscribed audio taps (core 1 only copies samples)
+        synthApp->pollAudioTaps(*audioMeterSink);
+#endif
+        
+        // Keep the control panel in sync with CC and program changes
+        synthApp->pushParamChanges(to_ms_since_boot(get_absolute_time()));
     }
     
     return 0;
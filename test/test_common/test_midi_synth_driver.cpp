@@ -283,6 +283,8 @@ void test_statusByteInterruption_shouldDiscardPartialMessage(void) {
     // Program Change messages should not call noteOn
     TEST_ASSERT_EQUAL_INT_MESSAGE(0, fixture.target.noteOnCallCount, "Incomplete Note On and Program Change should not call noteOn");
     TEST_ASSERT_EQUAL_INT_MESSAGE(0, fixture.target.noteOffCallCount, "Should not call noteOff either");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(2, fixture.programChangeCallCount, "Both Program Changes should be reported");
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(0x41, fixture.lastProgram, "Should receive the running status program");
 }
 
 void test_systemRealTime_shouldNotInterruptPartialMessage(void) {
@@ -0,0 +1,191 @@
+/**
+ * Audio tap ring and analyzer (lib/features/audio_tap.hpp, audio_analyzer.hpp)
+ *
+ * Checks what the audio thread hands over (every sample, or every Nth sample
+ * with the decimation phase carried across blocks, and whole blocks dropped
+ * when the reader falls behind) and what the analyzer makes of it: peak and
+ * RMS levels, and a spectrum that puts a full-scale sine at 0 dBFS in the
+ * right band.
+ */
+
+#include <unity.h>
+#include <audio_tap.hpp>
+#include <audio_analyzer.hpp>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+static constexpr float SAMPLE_RATE = 48000.0f;
+static constexpr size_t FFT_SIZE = 256;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static std::vector<float> ramp(size_t first, size_t count) {
+    std::vector<float> samples(count);
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = static_cast<float>(first + i);
+    }
+    return samples;
+}
+
+template<size_t Capacity>
+static std::vector<float> readAll(features::AudioTap<Capacity>& tap) {
+    std::vector<float> samples(Capacity);
+    samples.resize(tap.read(samples.data(), Capacity));
+    return samples;
+}
+
+/**
+ * @brief Sine at FFT bin `bin`, written to the tap in 64-frame blocks
+ */
+template<size_t Capacity>
+static void writeSine(features::AudioTap<Capacity>& tap, float amplitude, size_t bin, size_t count) {
+    std::vector<float> samples(count);
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = amplitude * std::sin(2.0f * features::ANALYZER_PI * bin * i / FFT_SIZE);
+    }
+    for (size_t offset = 0; offset < count; offset += 64) {
+        tap.write(samples.data() + offset, 64);
+    }
+}
+
+void test_tap_copiesBlocksOnlyWhileSubscribed(void) {
+    features::AudioTap<64> tap;
+    std::vector<float> block = ramp(0, 40);
+    tap.write(block.data(), block.size());
+    TEST_ASSERT_EQUAL_UINT32(0, tap.available());
+
+    tap.subscribe();
+    tap.write(block.data(), block.size());
+    std::vector<float> read = readAll(tap);
+    TEST_ASSERT_EQUAL_UINT32(40, read.size());
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(block.data(), read.data(), block.size());
+
+    // The second block wraps the ring
+    block = ramp(40, 40);
+    tap.write(block.data(), block.size());
+    read = readAll(tap);
+    TEST_ASSERT_EQUAL_UINT32(40, read.size());
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(block.data(), read.data(), block.size());
+
+    tap.unsubscribe();
+    tap.write(block.data(), block.size());
+    TEST_ASSERT_EQUAL_UINT32(0, tap.available());
+}
+
+void test_tap_decimatesAcrossBlockBoundaries(void) {
+    features::AudioTap<64> tap;
+    tap.subscribe(3);
+    // Blocks shorter than, equal to and longer than the decimation
+    const size_t sizes[] = {5, 7, 1, 2, 3, 10};
+    size_t frame = 0;
+    for (size_t size : sizes) {
+        std::vector<float> block = ramp(frame, size);
+        tap.write(block.data(), size);
+        frame += size;
+    }
+    std::vector<float> read = readAll(tap);
+    TEST_ASSERT_EQUAL_UINT32((frame + 2) / 3, read.size());
+    for (size_t i = 0; i < read.size(); i++) {
+        TEST_ASSERT_EQUAL_FLOAT(static_cast<float>(i * 3), read[i]);
+    }
+}
+
+void test_tap_dropsWholeBlocksWhenFull(void) {
+    features::AudioTap<4> tap;
+    tap.subscribe(2);
+    std::vector<float> block0 = ramp(0, 7);     // Keeps 0, 2, 4, 6: the ring is full
+    std::vector<float> block1 = ramp(7, 7);     // Would keep 8, 10, 12
+    std::vector<float> block2 = ramp(14, 7);    // Keeps 14, 16, 18, 20
+    tap.write(block0.data(), 7);
+    tap.write(block1.data(), 7);
+    TEST_ASSERT_EQUAL_UINT32(1, tap.getDroppedBlocks());
+
+    std::vector<float> read = readAll(tap);
+    const float first[] = {0, 2, 4, 6};
+    TEST_ASSERT_EQUAL_UINT32(4, read.size());
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(first, read.data(), 4);
+
+    // The dropped block still advanced the decimation phase
+    tap.write(block2.data(), 7);
+    read = readAll(tap);
+    const float third[] = {14, 16, 18, 20};
+    TEST_ASSERT_EQUAL_UINT32(4, read.size());
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(third, read.data(), 4);
+    TEST_ASSERT_EQUAL_UINT32(1, tap.getDroppedBlocks());
+}
+
+void test_analyzer_reportsOnceAWindowIsFull(void) {
+    features::AudioTap<> tap;
+    features::AudioAnalyzer<FFT_SIZE> analyzer;
+    features::AudioMeterStats stats;
+    tap.subscribe();
+
+    writeSine(tap, 1.0f, 8, FFT_SIZE / 2);
+    TEST_ASSERT_FALSE(analyzer.poll(tap, SAMPLE_RATE, -1, stats));
+    writeSine(tap, 1.0f, 8, FFT_SIZE / 2);
+    TEST_ASSERT_TRUE(analyzer.poll(tap, SAMPLE_RATE, -1, stats));
+
+    // Nothing new since the report
+    TEST_ASSERT_FALSE(analyzer.poll(tap, SAMPLE_RATE, -1, stats));
+
+    // After the first window every poll with new samples reports
+    writeSine(tap, 1.0f, 8, 64);
+    TEST_ASSERT_TRUE(analyzer.poll(tap, SAMPLE_RATE, 3, stats));
+    TEST_ASSERT_EQUAL_INT16(3, stats.voice);
+}
+
+void test_analyzer_measuresSineLevelAndBand(void) {
+    features::AudioTap<> tap;
+    features::AudioAnalyzer<FFT_SIZE> analyzer;
+    features::AudioMeterStats stats;
+    tap.subscribe();
+
+    // Half scale at bin 40, the first bin of band 10 (4 bins per band)
+    writeSine(tap, 0.5f, 40, FFT_SIZE);
+    TEST_ASSERT_TRUE(analyzer.poll(tap, SAMPLE_RATE, -1, stats));
+    const float halfScaleDb = 20.0f * std::log10(0.5f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, halfScaleDb, stats.peakDb);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, halfScaleDb - 3.0103f, stats.rmsDb);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, halfScaleDb, stats.bandsDb[10]);
+
+    // Hann leakage reaches the neighbouring bin (band 9) at -6 dB, and no further
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, halfScaleDb - 6.0206f, stats.bandsDb[9]);
+    for (size_t band = 0; band < features::AUDIO_METER_BANDS; band++) {
+        if (band != 9 && band != 10) {
+            TEST_ASSERT_TRUE(stats.bandsDb[band] < -80.0f);
+        }
+    }
+    TEST_ASSERT_EQUAL_INT16(-1, stats.voice);
+    TEST_ASSERT_EQUAL_FLOAT(SAMPLE_RATE, stats.sampleRate);
+}
+
+void test_analyzer_floorsSilenceAndReportsDecimatedRate(void) {
+    features::AudioTap<> tap;
+    features::AudioAnalyzer<FFT_SIZE> analyzer;
+    features::AudioMeterStats stats;
+    tap.subscribe(4);
+
+    std::vector<float> silence(FFT_SIZE * 4, 0.0f);
+    tap.write(silence.data(), silence.size());
+    TEST_ASSERT_TRUE(analyzer.poll(tap, SAMPLE_RATE, -1, stats));
+    TEST_ASSERT_EQUAL_FLOAT(features::AudioAnalyzer<FFT_SIZE>::FLOOR_DB, stats.peakDb);
+    TEST_ASSERT_EQUAL_FLOAT(features::AudioAnalyzer<FFT_SIZE>::FLOOR_DB, stats.rmsDb);
+    for (size_t band = 0; band < features::AUDIO_METER_BANDS; band++) {
+        TEST_ASSERT_EQUAL_FLOAT(features::AudioAnalyzer<FFT_SIZE>::FLOOR_DB, stats.bandsDb[band]);
+    }
+    TEST_ASSERT_EQUAL_UINT16(4, stats.decimation);
+    TEST_ASSERT_EQUAL_FLOAT(SAMPLE_RATE / 4, stats.sampleRate);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_tap_copiesBlocksOnlyWhileSubscribed);
+    RUN_TEST(test_tap_decimatesAcrossBlockBoundaries);
+    RUN_TEST(test_tap_dropsWholeBlocksWhenFull);
+    RUN_TEST(test_analyzer_reportsOnceAWindowIsFull);
+    RUN_TEST(test_analyzer_measuresSineLevelAndBand);
+    RUN_TEST(test_analyzer_floorsSilenceAndReportsDecimatedRate);
+    return UNITY_END();
+}
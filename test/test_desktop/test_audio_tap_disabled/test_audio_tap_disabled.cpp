@@ -0,0 +1,98 @@
+/**
+ * SynthApplication built without FEATURE_AUDIO_TAP
+ *
+ * The taps and analyzers cost about 28 KB of RAM, so builds that leave the
+ * feature off must not carry them. Checks that the app still renders, that
+ * subscribeAudioTap is refused instead of silently acked, and that the
+ * memory report has nothing under telemetry.
+ */
+
+// This suite checks the build without the feature, whatever the environment sets
+#undef FEATURE_AUDIO_TAP
+
+#include <unity.h>
+#include <synth_application.hpp>
+#include <memory_report.hpp>
+#include <performance_timer.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+static constexpr unsigned int SAMPLE_RATE = 48000;
+static constexpr unsigned int CHANNELS = 2;
+static constexpr uint8_t MAX_VOICES = 4;
+
+using Timer = features::LapTimer<features::NoOpTimingPolicy, 12>;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * @brief SynthApplication with its command output captured
+ */
+struct Fixture {
+    std::unique_ptr<platform::SynthApplication> synth;
+    std::string output;
+    Timer timer;
+
+    Fixture() : synth(std::make_unique<platform::SynthApplication>(SAMPLE_RATE, CHANNELS, MAX_VOICES)) {
+        synth->setCommandOutput(capture, this);
+    }
+
+    static void capture(const char* data, size_t length, void* context) {
+        static_cast<Fixture*>(context)->output.append(data, length);
+    }
+
+    void send(const char* line) {
+        synth->processCommandBytes(line, std::strlen(line));
+    }
+};
+
+void test_subscribeAudioTap_isRefused(void) {
+    Fixture f;
+    f.send(R"({"cmd":"subscribeAudioTap"})" "\n"
+           R"({"cmd":"subscribeAudioTap","voice":0,"decimation":4})" "\n");
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, f.output.find("no such audio tap"));
+    TEST_ASSERT_EQUAL(std::string::npos, f.output.find(R"("ack":"subscribeAudioTap")"));
+}
+
+void test_renderAudio_stillPlays(void) {
+    Fixture f;
+    for (uint8_t byte : {uint8_t(0x90), uint8_t(60), uint8_t(100)}) {
+        f.synth->processMidiByte(byte);
+    }
+    std::vector<float> out(256 * CHANNELS);
+    f.synth->renderAudio(out.data(), 256, f.timer);
+    f.timer.end();
+
+    float peak = 0.0f;
+    for (float sample : out) {
+        peak = std::max(peak, std::abs(sample));
+    }
+    TEST_ASSERT_TRUE_MESSAGE(peak > 0.0f, "Note played without the audio tap feature rendered silence");
+}
+
+void test_reportMemory_hasNoTelemetry(void) {
+    Fixture f;
+    features::MemoryReport report;
+    f.synth->reportMemory(report);
+    bool found = false;
+    for (size_t i = 0; i < report.size(); i++) {
+        if (std::strcmp(report[i].subsystem, "telemetry") == 0) {
+            found = true;
+            TEST_ASSERT_EQUAL_UINT32(0, report[i].bytes);
+        }
+    }
+    TEST_ASSERT_TRUE(found);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_subscribeAudioTap_isRefused);
+    RUN_TEST(test_renderAudio_stillPlays);
+    RUN_TEST(test_reportMemory_hasNoTelemetry);
+    return UNITY_END();
+}
@@ -0,0 +1,322 @@
+/**
+ * Control panel command parser: conformance and throughput
+ *
+ * Checks that CommandParser accepts and rejects the same lines as
+ * nlohmann::json and extracts the same cmd/param/value, that parsing and
+ * parameter lookup never touch the heap (using the real-time safety guard's
+ * allocation interposers), and benchmarks it against the previous path:
+ * nlohmann DOM parse, std::string copy of "cmd", and string comparison
+ * chains for the command and parameter names.
+ */
+
+#define RT_SAFETY_GUARD_INTERPOSE
+#include <rt_safety_guard.hpp>
+
+#include <unity.h>
+#include <command_protocol.hpp>
+#include <command_parser.hpp>
+#include <synth_params.hpp>
+#include <json.hpp>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using webcontrol::CommandParser;
+using webcontrol::CommandType;
+using webcontrol::TextSpan;
+
+static const char* const PROTOCOL_LINES[] = {
+    R"({"cmd": "setParam", "param": "baseCutoff", "value": 500.0})",
+    R"({"cmd":"setParam","param":"filterEnvAmount_atMod","value":-0.25})",
+    R"({"cmd": "setParam", "param": "filterMode", "value": 2})",
+    R"({"cmd": "setParam", "param": "waveformShape", "value": 1e-3})",
+    R"({"cmd": "setParam", "param": "aftertouchRange", "value": 0.5})",
+    R"({"cmd": "setParams", "params": {"baseCutoff": 500, "filterQ": 2.5, "bogus": 1, "filterMode": "x"}})",
+    R"({"cmd": "setParams", "params": [{"param": "baseCutoff", "value": 500}, {"value": 1}, 3, {"param": "filterQ", "value": -1e2}]})",
+    R"({"cmd": "getParams"})",
+    R"({"cmd": "saveProgram", "bank": 0, "program": 1})",
+    R"({"cmd": "loadProgram", "bank": 0, "program": 1})",
+    R"({"cmd": "setBaseNote", "note": 48})",
+    R"({"cmd": "subscribeKeyScan", "first": 0, "count": 16, "maxRate": 30, "deadband": 8, "keyframeInterval": 30})",
+    R"({"cmd": "unsubscribeKeyScan"})",
+    R"({"cmd": "subscribeAudioTap", "voice": -1, "decimation": 1})",
+    R"({"cmd": "unsubscribeAudioTap", "voice": -1})",
+    R"(  { "value" : 3 , "cmd" : "setParam" , "param" : "filterQ" }  )",
+    R"({"cmd": "setParam", "param": "filterQ", "value": 1, "extra": {"nested": [1, 2, {"a": null}]}})",
+    R"({"cmd": "bogus"})",
+    R"({"cmd": "set\"Param"})",
+    R"({"cmd": 5})",
+    R"({"nocmd": true})",
+    R"({})",
+    R"([1, 2, 3])",
+    R"("just a string")",
+};
+
+static const char* const MALFORMED_LINES[] = {
+    R"({"cmd": "setParam")",
+    R"({"cmd": "setParam",})",
+    R"({"cmd" "setParam"})",
+    R"({cmd: "setParam"})",
+    R"({"cmd": 'setParam'})",
+    R"({"cmd": "setParam"} trailing)",
+    R"({"value": 01})",
+    R"({"value": 1.})",
+    R"({"value": .5})",
+    R"({"value": +1})",
+    R"({"value": tru})",
+    R"({"value": "bad \x escape"})",
+    R"({"value": [1, 2})",
+    R"({"value": {"a" 1}})",
+    R"({"cmd": "a", "cmd": })",
+    R"(not json)",
+};
+
+// Previous dispatch, kept here as the benchmark baseline
+static CommandType legacyCommandType(const std::string& cmd) {
+    if (cmd == "setParam") return CommandType::SET_PARAM;
+    if (cmd == "setParams") return CommandType::SET_PARAMS;
+    if (cmd == "getParams") return CommandType::GET_PARAMS;
+    if (cmd == "saveProgram") return CommandType::SAVE_PROGRAM;
+    if (cmd == "loadProgram") return CommandType::LOAD_PROGRAM;
+    if (cmd == "setBaseNote") return CommandType::SET_BASE_NOTE;
+    if (cmd == "subscribeKeyScan") return CommandType::SUBSCRIBE_KEY_SCAN;
+    if (cmd == "unsubscribeKeyScan") return CommandType::UNSUBSCRIBE_KEY_SCAN;
+    if (cmd == "subscribeAudioTap") return CommandType::SUBSCRIBE_AUDIO_TAP;
+    if (cmd == "unsubscribeAudioTap") return CommandType::UNSUBSCRIBE_AUDIO_TAP;
+    if (cmd == "setLatencyProfile") return CommandType::SET_LATENCY_PROFILE;
+    return CommandType::UNKNOWN;
+}
+
+static const char* const LEGACY_PARAM_ORDER[] = {
+    "waveformShape", "baseCutoff", "filterQ", "filterMode", "filterEnvAmount", "filterEnvAttack",
+    "filterEnvDecay", "filterEnvSustain", "filterEnvRelease", "ampEnvAttack", "ampEnvDecay",
+    "ampEnvSustain", "ampEnvRelease", "vibratoRate", "vibratoDepth", "tremoloRate", "tremoloDepth",
+    "baseCutoff_atMod", "filterEnvAmount_atMod", "vibratoDepth_atMod", "tremoloDepth_atMod",
+};
+
+static int legacyParamIndex(const std::string& param) {
+    for (size_t i = 0; i < sizeof(LEGACY_PARAM_ORDER) / sizeof(LEGACY_PARAM_ORDER[0]); i++) {
+        if (param == LEGACY_PARAM_ORDER[i]) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_parser_matchesNlohmannOnProtocolLines(void) {
+    CommandParser parser;
+    for (const char* line : PROTOCOL_LINES) {
+        nlohmann::json j = nlohmann::json::parse(line, nullptr, false);
+        TEST_ASSERT_FALSE_MESSAGE(j.is_discarded(), line);
+        TEST_ASSERT_TRUE_MESSAGE(parser.parse(line), line);
+
+        bool hasCmd = j.is_object() && j.contains("cmd") && j["cmd"].is_string();
+        TextSpan cmd;
+        TEST_ASSERT_EQUAL_MESSAGE(hasCmd, parser.getString("cmd", cmd), line);
+        if (!hasCmd) {
+            continue;
+        }
+        std::string expectedCmd = j["cmd"].get<std::string>();
+        if (expectedCmd.find('"') == std::string::npos) {
+            TEST_ASSERT_EQUAL_STRING_LEN_MESSAGE(expectedCmd.c_str(), cmd.text, cmd.length, line);
+            TEST_ASSERT_EQUAL_MESSAGE(static_cast<int>(legacyCommandType(expectedCmd)),
+                                      static_cast<int>(webcontrol::parseCommandType(cmd)), line);
+        }
+
+        if (j.contains("param")) {
+            TextSpan param;
+            TEST_ASSERT_TRUE_MESSAGE(parser.getString("param", param), line);
+            std::string expectedParam = j["param"].get<std::string>();
+            TEST_ASSERT_EQUAL_STRING_LEN_MESSAGE(expectedParam.c_str(), param.text, param.length, line);
+            const auto* entry = synth::findParam(param.text, param.length);
+            TEST_ASSERT_EQUAL_MESSAGE(legacyParamIndex(expectedParam) >= 0, entry != nullptr, line);
+        }
+        if (j.contains("value")) {
+            double value;
+            TEST_ASSERT_TRUE_MESSAGE(parser.getNumber("value", value), line);
+            TEST_ASSERT_EQUAL_FLOAT_MESSAGE(j["value"].get<float>(), static_cast<float>(value), line);
+        }
+        for (const char* key : {"bank", "program", "note", "first", "count", "voice", "decimation"}) {
+            if (j.contains(key)) {
+                TEST_ASSERT_EQUAL_MESSAGE(j[key].get<int>(), parser.value(key, 12345), line);
+            }
+        }
+    }
+}
+
+void test_parser_iteratesNestedMembersLikeNlohmann(void) {
+    CommandParser parser;
+    for (const char* line : PROTOCOL_LINES) {
+        nlohmann::json j = nlohmann::json::parse(line, nullptr, false);
+        if (!j.is_object() || !j.contains("params")) {
+            continue;
+        }
+        TEST_ASSERT_TRUE_MESSAGE(parser.parse(line), line);
+        const CommandParser::Field* params = parser.find("params");
+        TEST_ASSERT_NOT_NULL_MESSAGE(params, line);
+
+        // Array elements are {"param", "value"} objects, iterated one level down
+        size_t index = 0;
+        parser.forEachMember(*params, [&](const CommandParser::Field& item) {
+            size_t position = index++;
+            if (j["params"].is_object()) {
+                // nlohmann sorts object keys, so match by name
+                std::string key(item.key.text, item.key.length);
+                double value;
+                TEST_ASSERT_EQUAL_MESSAGE(j["params"][key].is_number(),
+                                          CommandParser::getNumber(item, value), line);
+                return;
+            }
+            const nlohmann::json& expected = j["params"][position];
+            TEST_ASSERT_EQUAL_MESSAGE(expected.is_object(),
+                                      item.type == CommandParser::ValueType::Object, line);
+            if (expected.is_object()) {
+                size_t members = 0;
+                parser.forEachMember(item, [&](const CommandParser::Field& f) {
+                    std::string key(f.key.text, f.key.length);
+                    TEST_ASSERT_TRUE_MESSAGE(expected.contains(key), line);
+                    double value;
+                    if (CommandParser::getNumber(f, value)) {
+                        TEST_ASSERT_EQUAL_FLOAT_MESSAGE(expected[key].get<float>(), static_cast<float>(value), line);
+                    }
+                    members++;
+                });
+                TEST_ASSERT_EQUAL_MESSAGE(expected.size(), members, line);
+            }
+        });
+        TEST_ASSERT_EQUAL_MESSAGE(j["params"].size(), index, line);
+        // Iteration leaves the top-level fields usable
+        TextSpan cmd;
+        TEST_ASSERT_TRUE_MESSAGE(parser.getString("cmd", cmd) && cmd.equals("setParams"), line);
+    }
+}
+
+void test_parser_rejectsMalformedLines(void) {
+    CommandParser parser;
+    for (const char* line : MALFORMED_LINES) {
+        TEST_ASSERT_TRUE_MESSAGE(nlohmann::json::parse(line, nullptr, false).is_discarded(), line);
+        TEST_ASSERT_FALSE_MESSAGE(parser.parse(line), line);
+    }
+}
+
+void test_nameTables_resolveEveryName(void) {
+    for (const auto& entry : webcontrol::COMMAND_NAMES) {
+        TextSpan name{entry.name, strlen(entry.name)};
+        TEST_ASSERT_EQUAL(static_cast<int>(entry.value), static_cast<int>(webcontrol::parseCommandType(name)));
+        TEST_ASSERT_EQUAL(static_cast<int>(legacyCommandType(entry.name)), static_cast<int>(entry.value));
+    }
+    TEST_ASSERT_EQUAL(static_cast<int>(CommandType::UNKNOWN), static_cast<int>(webcontrol::parseCommandType(TextSpan{"set", 3})));
+}
+
+void test_parser_doesNotAllocate(void) {
+    CommandParser parser;
+    linux::RtSafetyGuard::reset();
+    {
+        linux::RtSafetyGuard::Scope noHeap;
+        for (const char* line : PROTOCOL_LINES) {
+            if (parser.parse(line)) {
+                TextSpan cmd, param;
+                double value;
+                parser.getString("cmd", cmd);
+                webcontrol::parseCommandType(cmd);
+                if (parser.getString("param", param)) {
+                    synth::findParam(param.text, param.length);
+                }
+                parser.getNumber("value", value);
+            }
+        }
+    }
+    if (linux::RtSafetyGuard::violationCount() > 0) {
+        linux::RtSafetyGuard::report(stdout);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, linux::RtSafetyGuard::violationCount());
+}
+
+void test_benchmark_againstNlohmannParser(void) {
+    // What the control panel sends while a knob is dragged
+    static const char* const knobLines[] = {
+        R"({"cmd":"setParam","param":"baseCutoff","value":1234.5})",
+        R"({"cmd":"setParam","param":"tremoloDepth_atMod","value":0.42})",
+        R"({"cmd":"setParam","param":"ampEnvRelease","value":0.8})",
+    };
+    constexpr int ITERATIONS = 200000;
+    constexpr int COUNTED_ITERATIONS = 300;
+
+    auto legacy = [](int iterations) {
+        int checksum = 0;
+        for (int i = 0; i < iterations; i++) {
+            nlohmann::json j = nlohmann::json::parse(knobLines[i % 3], nullptr, false);
+            std::string cmd = j["cmd"].get<std::string>();
+            if (legacyCommandType(cmd) == CommandType::SET_PARAM) {
+                checksum += legacyParamIndex(j["param"].get<std::string>());
+                checksum += static_cast<int>(j["value"].get<float>());
+            }
+        }
+        return checksum;
+    };
+
+    CommandParser parser;
+    auto current = [&parser](int iterations) {
+        int checksum = 0;
+        for (int i = 0; i < iterations; i++) {
+            parser.parse(knobLines[i % 3]);
+            TextSpan cmd, param;
+            double value = 0;
+            parser.getString("cmd", cmd);
+            if (webcontrol::parseCommandType(cmd) == CommandType::SET_PARAM &&
+                parser.getString("param", param) && parser.getNumber("value", value)) {
+                const auto* entry = synth::findParam(param.text, param.length);
+                checksum += entry ? static_cast<int>(synth::paramIndex(*entry)) : -1;
+                checksum += static_cast<int>(static_cast<float>(value));
+            }
+        }
+        return checksum;
+    };
+
+    // Time without the guard's scope (recording a backtrace per allocation
+    // would dominate), then count allocations over a shorter run
+    auto nsPerLine = [](auto&& run, int& checksum) {
+        auto start = std::chrono::steady_clock::now();
+        checksum = run(ITERATIONS);
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ITERATIONS;
+    };
+    auto allocationsPerLine = [](auto&& run) {
+        linux::RtSafetyGuard::reset();
+        {
+            linux::RtSafetyGuard::Scope countAllocations;
+            run(COUNTED_ITERATIONS);
+        }
+        uint32_t count = linux::RtSafetyGuard::violationCount(linux::RtViolation::Malloc) +
+                         linux::RtSafetyGuard::violationCount(linux::RtViolation::OperatorNew);
+        linux::RtSafetyGuard::reset();
+        return static_cast<double>(count) / COUNTED_ITERATIONS;
+    };
+
+    int legacyChecksum = 0;
+    int checksum = 0;
+    double legacyNs = nsPerLine(legacy, legacyChecksum);
+    double parserNs = nsPerLine(current, checksum);
+    double legacyAllocations = allocationsPerLine(legacy);
+    double parserAllocations = allocationsPerLine(current);
+
+    printf("\n%-28s %10s %12s\n", "setParam line", "ns/line", "allocs/line");
+    printf("%-28s %10.0f %12.1f\n", "nlohmann + string chains", legacyNs, legacyAllocations);
+    printf("%-28s %10.0f %12.1f\n", "CommandParser + tables", parserNs, parserAllocations);
+    printf("speedup: %.1fx\n", legacyNs / parserNs);
+
+    // Parameter indices differ between the two orders, so only check both ran
+    TEST_ASSERT_TRUE(legacyChecksum != 0 && checksum != 0);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, parserAllocations);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_parser_matchesNlohmannOnProtocolLines);
+    RUN_TEST(test_parser_iteratesNestedMembersLikeNlohmann);
+    RUN_TEST(test_parser_rejectsMalformedLines);
+    RUN_TEST(test_nameTables_resolveEveryName);
+    RUN_TEST(test_parser_doesNotAllocate);
+    RUN_TEST(test_benchmark_againstNlohmannParser);
+    return UNITY_END();
+}
@@ -0,0 +1,166 @@
+/**
+ * Serial command ingestion over a pseudo-terminal
+ *
+ * The test plays the control panel on the pty master; SynthApplication reads
+ * the slave through SerialCommandPort exactly as main_linux does with
+ * --control=<tty>. Covers several commands arriving in one read, lines split
+ * across reads, CRLF endings, overlong lines, and responses written back to
+ * the port.
+ */
+
+#include <unity.h>
+#include <serial_command_port.hpp>
+#include <synth_application.hpp>
+#include <performance_timer.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+static constexpr unsigned int SAMPLE_RATE = 48000;
+static constexpr unsigned int CHANNELS = 2;
+static constexpr uint8_t MAX_VOICES = 4;
+
+/**
+ * @brief Pty pair: the test writes commands to master, the port opens the slave
+ */
+struct Pty {
+    int master = -1;
+    std::string slavePath;
+
+    Pty() {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        TEST_ASSERT_TRUE(master >= 0);
+        TEST_ASSERT_EQUAL(0, grantpt(master));
+        TEST_ASSERT_EQUAL(0, unlockpt(master));
+        slavePath = ptsname(master);
+    }
+
+    ~Pty() {
+        close(master);
+    }
+
+    void send(const char* text) {
+        TEST_ASSERT_EQUAL(static_cast<ssize_t>(strlen(text)), write(master, text, strlen(text)));
+    }
+
+    /**
+     * @brief Read whatever the port wrote back, waiting briefly for it
+     */
+    std::string receive() {
+        std::string out;
+        char buffer[1024];
+        pollfd pfd{master, POLLIN, 0};
+        while (poll(&pfd, 1, 50) > 0) {
+            ssize_t n = read(master, buffer, sizeof(buffer));
+            if (n <= 0) {
+                break;
+            }
+            out.append(buffer, static_cast<size_t>(n));
+        }
+        return out;
+    }
+};
+
+static size_t countOccurrences(const std::string& text, const char* needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Drain the port into the synth, as the control thread does
+ */
+static size_t drainInto(linux::SerialCommandPort& port, platform::SynthApplication& synth) {
+    size_t commands = 0;
+    if (port.waitReadable(100)) {
+        port.drain([&](const char* data, size_t length) {
+            commands += synth.processCommandBytes(data, length);
+        });
+    }
+    return commands;
+}
+
+static void renderBlock(platform::SynthApplication& synth) {
+    float buffer[128 * CHANNELS];
+    features::LapTimer<features::NoOpTimingPolicy, 12> timer;
+    synth.renderAudio(buffer, 128, timer);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_manyCommandsInOneRead_areAllProcessed(void) {
+    Pty pty;
+    linux::SerialCommandPort port(pty.slavePath);
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES);
+    synth.setCommandOutput(linux::SerialCommandPort::writeToPort, &port);
+
+    std::string burst;
+    for (int i = 0; i < 20; i++) {
+        burst += R"({"cmd":"setParam","param":"filterQ","value":)" + std::to_string(1 + i % 4) + "}\n";
+    }
+    burst += R"({"cmd":"setParams","params":{"baseCutoff":432,"ampEnvRelease":0.25}})" "\r\n";
+    pty.send(burst.c_str());
+
+    TEST_ASSERT_EQUAL(21, drainInto(port, synth));
+    std::string responses = pty.receive();
+    TEST_ASSERT_EQUAL(20, countOccurrences(responses, R"("ack":"setParam",)"));
+    TEST_ASSERT_EQUAL(1, countOccurrences(responses, R"("ack":"setParams","errors":[],"status":"ok")"));
+
+    renderBlock(synth);
+    synth.getVoicePool().forEachVoice([](synth::WavetableSynth& voice) {
+        TEST_ASSERT_EQUAL_FLOAT(432.0f, voice.getBaseCutoff());
+        TEST_ASSERT_EQUAL_FLOAT(0.25f, voice.getAmpEnvelope().getReleaseTime());
+        TEST_ASSERT_EQUAL_FLOAT(4.0f, voice.getFilter().getQ());
+    });
+}
+
+void test_linesSplitAcrossReads_areReassembled(void) {
+    Pty pty;
+    linux::SerialCommandPort port(pty.slavePath);
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES);
+    synth.setCommandOutput(linux::SerialCommandPort::writeToPort, &port);
+
+    pty.send(R"({"cmd":"setParam","par)");
+    TEST_ASSERT_EQUAL(0, drainInto(port, synth));
+    pty.send(R"(am":"vibratoRate","value":7.5})" "\n" R"({"cmd":"getPa)");
+    TEST_ASSERT_EQUAL(1, drainInto(port, synth));
+    renderBlock(synth);
+    pty.send("rams\"}\n");
+    TEST_ASSERT_EQUAL(1, drainInto(port, synth));
+
+    std::string responses = pty.receive();
+    TEST_ASSERT_EQUAL(1, countOccurrences(responses, R"("ack":"setParam",)"));
+    TEST_ASSERT_EQUAL(1, countOccurrences(responses, R"("vibratoRate":7.5)"));
+}
+
+void test_overlongLine_isRejectedWithoutLosingTheNext(void) {
+    Pty pty;
+    linux::SerialCommandPort port(pty.slavePath);
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES);
+    synth.setCommandOutput(linux::SerialCommandPort::writeToPort, &port);
+
+    std::string line = R"({"cmd":"setParam","param":"filterQ","value":1,"pad":")";
+    line += std::string(2000, 'x');
+    line += "\"}\n";
+    line += R"({"cmd":"setParam","param":"filterQ","value":3})" "\n";
+    pty.send(line.c_str());
+
+    TEST_ASSERT_EQUAL(1, drainInto(port, synth));
+    std::string responses = pty.receive();
+    TEST_ASSERT_EQUAL(1, countOccurrences(responses, "command line too long"));
+    TEST_ASSERT_EQUAL(1, countOccurrences(responses, R"("ack":"setParam",)"));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_manyCommandsInOneRead_areAllProcessed);
+    RUN_TEST(test_linesSplitAcrossReads_areReassembled);
+    RUN_TEST(test_overlongLine_isRejectedWithoutLosingTheNext);
+    return UNITY_END();
+}
@@ -0,0 +1,200 @@
+/**
+ * Local control server: several clients over a Unix socket and localhost TCP
+ *
+ * The tests connect real sockets to linux::ControlServer and drive it with
+ * SynthApplication the way main_linux's control thread does. Covers partial
+ * lines from different clients not mixing, responses going to the sender,
+ * pushes reaching every client, and slow clients losing messages instead of
+ * stalling the server.
+ */
+
+#include <unity.h>
+#include <control_server.hpp>
+#include <synth_application.hpp>
+#include <performance_timer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static constexpr unsigned int SAMPLE_RATE = 48000;
+static constexpr unsigned int CHANNELS = 2;
+static constexpr uint8_t MAX_VOICES = 4;
+static const char* SOCKET_PATH = "/tmp/pressence_test_control.sock";
+
+/**
+ * @brief A connected client socket
+ */
+struct TestClient {
+    int fd = -1;
+
+    explicit TestClient(const char* path) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        TEST_ASSERT_EQUAL(0, connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)));
+    }
+
+    explicit TestClient(int tcpPort) {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(tcpPort));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        TEST_ASSERT_EQUAL(0, connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)));
+    }
+
+    ~TestClient() {
+        close(fd);
+    }
+
+    void send(const char* text) {
+        TEST_ASSERT_EQUAL(static_cast<ssize_t>(strlen(text)), write(fd, text, strlen(text)));
+    }
+
+    std::string receive(int timeoutMs = 50) {
+        std::string out;
+        char buffer[4096];
+        pollfd pfd{fd, POLLIN, 0};
+        while (poll(&pfd, 1, timeoutMs) > 0) {
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            if (n <= 0) {
+                break;
+            }
+            out.append(buffer, static_cast<size_t>(n));
+        }
+        return out;
+    }
+};
+
+static size_t countOccurrences(const std::string& text, const char* needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Run the server loop briefly, as the control thread does
+ */
+static size_t serve(linux::ControlServer& server, platform::SynthApplication& synth, int rounds = 5) {
+    size_t lines = 0;
+    for (int i = 0; i < rounds; i++) {
+        lines += server.poll(10, [&](const char* line, size_t length) {
+            synth.processCommandBytes(line, length);
+        });
+    }
+    return lines;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_interleavedClients_getTheirOwnResponses(void) {
+    linux::ControlServer server(SOCKET_PATH, 0);
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES);
+    synth.setCommandOutput(linux::ControlServer::writeResponse, &server);
+
+    TestClient unixClient(SOCKET_PATH);
+    TestClient tcpClient(server.getTcpPort());
+    serve(server, synth);
+    TEST_ASSERT_EQUAL(2, server.getClientCount());
+
+    // Halves of two commands arrive interleaved; neither may corrupt the other
+    unixClient.send(R"({"cmd":"setParam","param":"filt)");
+    tcpClient.send(R"({"cmd":"getPar)");
+    serve(server, synth);
+    unixClient.send("erQ\",\"value\":3}\n");
+    tcpClient.send("ams\"}\n");
+    TEST_ASSERT_EQUAL(2, serve(server, synth));
+
+    std::string unixOut = unixClient.receive();
+    std::string tcpOut = tcpClient.receive();
+    TEST_ASSERT_EQUAL(1, countOccurrences(unixOut, R"("ack":"setParam",)"));
+    TEST_ASSERT_EQUAL(0, countOccurrences(unixOut, R"("type":"params")"));
+    TEST_ASSERT_EQUAL(0, countOccurrences(tcpOut, R"("ack":"setParam",)"));
+    TEST_ASSERT_EQUAL(1, countOccurrences(tcpOut, R"("type":"params")"));
+
+    // Pushed changes go to everyone
+    float buffer[128 * CHANNELS];
+    features::LapTimer<features::NoOpTimingPolicy, 12> timer;
+    synth.renderAudio(buffer, 128, timer);
+    TEST_ASSERT_TRUE(synth.pushParamChanges(1000));
+    serve(server, synth, 1);
+    TEST_ASSERT_EQUAL(1, countOccurrences(unixClient.receive(), R"("filterQ":3.0,"type":"paramsDelta")"));
+    TEST_ASSERT_EQUAL(1, countOccurrences(tcpClient.receive(), R"("filterQ":3.0,"type":"paramsDelta")"));
+}
+
+void test_slowClient_dropsMessagesWithoutBlocking(void) {
+    linux::ControlServer server(SOCKET_PATH);
+    TestClient slowClient(SOCKET_PATH);
+    TestClient fastClient(SOCKET_PATH);
+    server.poll(10, [](const char*, size_t) {});
+    TEST_ASSERT_EQUAL(2, server.getClientCount());
+
+    // Far more than the socket buffer plus the client queue; the slow client
+    // never reads, the fast one keeps up
+    std::string message(1000, 'x');
+    message += '\n';
+    const int MESSAGES = 2000;
+    size_t fastReceived = 0;
+    std::chrono::steady_clock::duration slowestPublish{0};
+    for (int i = 0; i < MESSAGES; i++) {
+        auto start = std::chrono::steady_clock::now();
+        server.publish(message.data(), message.size());
+        slowestPublish = std::max(slowestPublish, std::chrono::steady_clock::now() - start);
+        if (i % 16 == 0) {
+            server.poll(0, [](const char*, size_t) {});
+            fastReceived += fastClient.receive(0).size();
+        }
+    }
+    for (int i = 0; i < 10; i++) {
+        server.poll(10, [](const char*, size_t) {});
+        fastReceived += fastClient.receive().size();
+    }
+
+    TEST_ASSERT_TRUE(server.getDroppedCount() > 0);
+    TEST_ASSERT_TRUE(server.getDroppedCount() < static_cast<uint32_t>(MESSAGES));
+    TEST_ASSERT_EQUAL(MESSAGES * message.size(), fastReceived);
+    TEST_ASSERT_TRUE(slowestPublish < std::chrono::milliseconds(50));
+}
+
+void test_overlongLine_isRejectedForThatClientOnly(void) {
+    linux::ControlServer server(SOCKET_PATH);
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES);
+    synth.setCommandOutput(linux::ControlServer::writeResponse, &server);
+    TestClient noisyClient(SOCKET_PATH);
+    TestClient otherClient(SOCKET_PATH);
+    serve(server, synth);
+
+    std::string line = R"({"cmd":"setParam","param":"filterQ","value":1,"pad":")";
+    line += std::string(3000, 'x');
+    line += "\"}\n";
+    line += R"({"cmd":"setParam","param":"filterQ","value":2})" "\n";
+    noisyClient.send(line.c_str());
+    otherClient.send(R"({"cmd":"setParam","param":"filterQ","value":3})" "\n");
+    serve(server, synth);
+
+    std::string noisyOut = noisyClient.receive();
+    std::string otherOut = otherClient.receive();
+    TEST_ASSERT_EQUAL(1, countOccurrences(noisyOut, "command line too long"));
+    TEST_ASSERT_EQUAL(1, countOccurrences(noisyOut, R"("ack":"setParam",)"));
+    TEST_ASSERT_EQUAL(0, countOccurrences(otherOut, "command line too long"));
+    TEST_ASSERT_EQUAL(1, countOccurrences(otherOut, R"("ack":"setParam",)"));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_interleavedClients_getTheirOwnResponses);
+    RUN_TEST(test_slowClient_dropsMessagesWithoutBlocking);
+    RUN_TEST(test_overlongLine_isRejectedForThatClientOnly);
+    return UNITY_END();
+}
@@ -0,0 +1,183 @@
+/**
+ * Memory-mapped flight recorder and its decoder (lib/linux/mmap_flight_recorder.hpp)
+ *
+ * Records events into a ring file, reads the file back the way
+ * tools/flight_decode.cpp does, and checks that the events come out oldest
+ * first with their fields intact: after the ring wraps, with several threads
+ * writing at once, and with the leftovers of a crash (a slot caught
+ * mid-write, a slot that doesn't belong where it is) in the file.
+ */
+
+#include <unity.h>
+#include <mmap_flight_recorder.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using features::FlightEvent;
+namespace flight_record = linux::flight_record;
+
+static char path[64];
+
+void setUp(void) {
+    std::strcpy(path, "/tmp/flight_recorder_testXXXXXX");
+    int fd = mkstemp(path);
+    close(fd);
+}
+
+void tearDown(void) {
+    unlink(path);
+}
+
+static std::vector<uint8_t> readFile() {
+    std::vector<uint8_t> data;
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        return data;
+    }
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(in);
+    return data;
+}
+
+static flight_record::Slot& slotAt(std::vector<uint8_t>& data, size_t index) {
+    return *reinterpret_cast<flight_record::Slot*>(
+        data.data() + flight_record::headerSize() + index * sizeof(flight_record::Slot));
+}
+
+void test_decode_returnsEventsOldestFirst(void) {
+    {
+        linux::MmapFlightRecorder recorder(path, 8);
+        recorder.record(FlightEvent::MidiIn, 0x90);
+        recorder.record(FlightEvent::VoiceAllocate, 60, 3);
+        recorder.record(FlightEvent::VoiceSteal, 64, 3, 60);
+        recorder.record(FlightEvent::BlockRender, 0, 256, 123456);
+        recorder.record(FlightEvent::Xrun, 0, 0, 1);
+    }
+    std::vector<uint8_t> data = readFile();
+    flight_record::Recording recording;
+    TEST_ASSERT_TRUE(flight_record::decode(data.data(), data.size(), recording));
+    TEST_ASSERT_EQUAL_UINT32(8, recording.header->capacity);
+    TEST_ASSERT_EQUAL_UINT32(5, recording.recorded);
+    TEST_ASSERT_EQUAL_UINT32(0, recording.torn);
+    TEST_ASSERT_EQUAL_UINT32(0, recording.unpublished);
+    TEST_ASSERT_EQUAL_UINT32(5, recording.events.size());
+
+    const flight_record::Event& steal = recording.events[2];
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(FlightEvent::VoiceSteal), steal.event);
+    TEST_ASSERT_EQUAL_UINT8(64, steal.a);
+    TEST_ASSERT_EQUAL_UINT16(3, steal.b);
+    TEST_ASSERT_EQUAL_UINT32(60, steal.value);
+    TEST_ASSERT_EQUAL_UINT32(123456, recording.events[3].value);
+    for (size_t i = 1; i < recording.events.size(); i++) {
+        TEST_ASSERT_EQUAL_UINT32(i + 1, recording.events[i].sequence);
+        TEST_ASSERT_TRUE(recording.events[i].timestampNs >= recording.events[i - 1].timestampNs);
+    }
+    TEST_ASSERT_TRUE(recording.events[0].timestampNs >= recording.header->startMonotonicNs);
+}
+
+void test_decode_keepsNewestEventsAfterWrap(void) {
+    {
+        linux::MmapFlightRecorder recorder(path, 6);   // Rounded up to 8
+        for (uint32_t i = 1; i <= 20; i++) {
+            recorder.record(FlightEvent::MidiIn, static_cast<uint8_t>(i), 0, i);
+        }
+    }
+    std::vector<uint8_t> data = readFile();
+    flight_record::Recording recording;
+    TEST_ASSERT_TRUE(flight_record::decode(data.data(), data.size(), recording));
+    TEST_ASSERT_EQUAL_UINT32(20, recording.recorded);
+    TEST_ASSERT_EQUAL_UINT32(8, recording.events.size());
+    for (size_t i = 0; i < 8; i++) {
+        TEST_ASSERT_EQUAL_UINT32(13 + i, recording.events[i].value);
+    }
+}
+
+void test_decode_skipsCrashLeftovers(void) {
+    {
+        linux::MmapFlightRecorder recorder(path, 8);
+        for (uint32_t i = 1; i <= 6; i++) {
+            recorder.record(FlightEvent::MidiIn, 0, 0, i);
+        }
+    }
+    std::vector<uint8_t> data = readFile();
+
+    // Event 3 was being rewritten (unpublished), event 5's slot holds a
+    // sequence that belongs elsewhere, and a seventh event was claimed but
+    // never stored
+    slotAt(data, 2).sequence.store(0);
+    slotAt(data, 4).sequence.store(2);
+    auto* header = reinterpret_cast<flight_record::Header*>(data.data());
+    header->writeIndex.store(7);
+
+    flight_record::Recording recording;
+    TEST_ASSERT_TRUE(flight_record::decode(data.data(), data.size(), recording));
+    TEST_ASSERT_EQUAL_UINT32(4, recording.events.size());
+    TEST_ASSERT_EQUAL_UINT32(1, recording.torn);
+    TEST_ASSERT_EQUAL_UINT32(2, recording.unpublished);
+    const uint32_t expected[] = {1, 2, 4, 6};
+    for (size_t i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_UINT32(expected[i], recording.events[i].value);
+    }
+}
+
+void test_decode_rejectsOtherFiles(void) {
+    {
+        linux::MmapFlightRecorder recorder(path, 8);
+        recorder.record(FlightEvent::Xrun);
+    }
+    std::vector<uint8_t> data = readFile();
+    flight_record::Recording recording;
+    TEST_ASSERT_FALSE(flight_record::decode(data.data(), flight_record::headerSize() - 1, recording));
+    TEST_ASSERT_FALSE(flight_record::decode(data.data(), data.size() - 1, recording));   // Truncated ring
+    data[0] = 'X';
+    TEST_ASSERT_FALSE(flight_record::decode(data.data(), data.size(), recording));
+}
+
+void test_record_isSafeFromSeveralThreads(void) {
+    static constexpr int THREADS = 4;
+    static constexpr uint32_t EVENTS = 1000;
+    {
+        linux::MmapFlightRecorder recorder(path, THREADS * EVENTS);
+        std::vector<std::thread> writers;
+        for (int t = 0; t < THREADS; t++) {
+            writers.emplace_back([&recorder, t] {
+                for (uint32_t i = 0; i < EVENTS; i++) {
+                    recorder.record(FlightEvent::MidiIn, static_cast<uint8_t>(t), 0, i);
+                }
+            });
+        }
+        for (std::thread& writer : writers) {
+            writer.join();
+        }
+    }
+    std::vector<uint8_t> data = readFile();
+    flight_record::Recording recording;
+    TEST_ASSERT_TRUE(flight_record::decode(data.data(), data.size(), recording));
+    TEST_ASSERT_EQUAL_UINT32(THREADS * EVENTS, recording.events.size());
+
+    // Every event is there once, and each thread's events are in its order
+    uint32_t next[THREADS] = {};
+    for (const flight_record::Event& e : recording.events) {
+        TEST_ASSERT_TRUE(e.a < THREADS);
+        TEST_ASSERT_EQUAL_UINT32(next[e.a], e.value);
+        next[e.a]++;
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_decode_returnsEventsOldestFirst);
+    RUN_TEST(test_decode_keepsNewestEventsAfterWrap);
+    RUN_TEST(test_decode_skipsCrashLeftovers);
+    RUN_TEST(test_decode_rejectsOtherFiles);
+    RUN_TEST(test_record_isSafeFromSeveralThreads);
+    return UNITY_END();
+}
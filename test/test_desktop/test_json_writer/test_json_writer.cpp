@@ -0,0 +1,235 @@
+/**
+ * JsonWriter output parity with nlohmann::json::dump()
+ *
+ * Telemetry and command responses moved from nlohmann::json documents to the
+ * streaming features::JsonWriter, and tools/js parses the result expecting
+ * the old text. These tests serialize the same values both ways and require
+ * identical bytes: escaped strings, non-finite and negative-zero floats,
+ * integer extremes, and the key-scan and timing messages (rebuilt here in
+ * the DOM form the firmware used before).
+ */
+
+#include <unity.h>
+#include <json_writer.hpp>
+#include <json.hpp>
+#include <midi_keyboard_controller.hpp>
+#include <performance_timer.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+using nlohmann::json;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * @brief Serialize with JsonWriter into a buffer (overflow shows up as a mismatch)
+ */
+template<typename WriteFn>
+static std::string writeWith(WriteFn fn) {
+    static char buffer[16384];
+    features::JsonWriter w(buffer, sizeof(buffer));
+    fn(w);
+    w.finish();
+    return w.overflowed() ? std::string("<overflow>") : std::string(buffer);
+}
+
+static void appendString(const char* data, size_t length, void* context) {
+    static_cast<std::string*>(context)->append(data, length);
+}
+
+void test_floats_matchDump(void) {
+    const float values[] = {
+        0.0f, -0.0f, 1.0f, -1.5f, 0.1f, 1.0f / 3.0f, 1e-7f, 123456789.0f,
+        std::numeric_limits<float>::min(),
+        std::numeric_limits<float>::denorm_min(),
+        std::numeric_limits<float>::max(),
+        -std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(),
+    };
+    for (float v : values) {
+        std::string written = writeWith([v](features::JsonWriter& w) { w.value(v); });
+        TEST_ASSERT_EQUAL_STRING(json(v).dump().c_str(), written.c_str());
+    }
+
+    const double doubles[] = {-0.0, 0.1, 1e300, -1e-300, std::nan(""), -HUGE_VAL};
+    for (double v : doubles) {
+        std::string written = writeWith([v](features::JsonWriter& w) { w.value(v); });
+        TEST_ASSERT_EQUAL_STRING(json(v).dump().c_str(), written.c_str());
+    }
+    TEST_ASSERT_EQUAL_STRING("-0.0", writeWith([](features::JsonWriter& w) { w.value(-0.0f); }).c_str());
+    TEST_ASSERT_EQUAL_STRING("null", writeWith([](features::JsonWriter& w) { w.value(NAN); }).c_str());
+}
+
+void test_integersAndBools_matchDump(void) {
+    json reference = json::array({
+        std::numeric_limits<int64_t>::min(),
+        std::numeric_limits<int64_t>::max(),
+        std::numeric_limits<uint64_t>::max(),
+        static_cast<int16_t>(-1),
+        static_cast<uint8_t>(255),
+        0,
+        true,
+        false,
+    });
+    std::string written = writeWith([](features::JsonWriter& w) {
+        w.beginArray();
+        w.value(std::numeric_limits<int64_t>::min());
+        w.value(std::numeric_limits<int64_t>::max());
+        w.value(std::numeric_limits<uint64_t>::max());
+        w.value(static_cast<int16_t>(-1));
+        w.value(static_cast<uint8_t>(255));
+        w.value(0);
+        w.value(true);
+        w.value(false);
+        w.endArray();
+    });
+    TEST_ASSERT_EQUAL_STRING(reference.dump().c_str(), written.c_str());
+}
+
+void test_strings_escapeLikeDump(void) {
+    std::string every;
+    for (int c = 1; c < 0x80; c++) {
+        every += static_cast<char>(c);
+    }
+    const std::string strings[] = {
+        "",
+        every,
+        "quote \" backslash \\ slash /",
+        "tab\tnewline\nreturn\rbackspace\bformfeed\f",
+        "\xC3\xA9t\xC3\xA9 \xE2\x99\xAA \xF0\x9F\x8E\xB9",   // UTF-8 passes through
+    };
+    for (const std::string& s : strings) {
+        std::string written = writeWith([&s](features::JsonWriter& w) { w.value(s.c_str(), s.size()); });
+        TEST_ASSERT_EQUAL_STRING(json(s).dump().c_str(), written.c_str());
+    }
+
+    // Keys are escaped the same way
+    json object = {{"a\"b\x01", 1}};
+    std::string written = writeWith([](features::JsonWriter& w) {
+        w.beginObject();
+        w.field("a\"b\x01", 1);
+        w.endObject();
+    });
+    TEST_ASSERT_EQUAL_STRING(object.dump().c_str(), written.c_str());
+}
+
+void test_keyScanStats_matchPreviousDom(void) {
+    static constexpr uint16_t KEYS = 6;
+    midi::KeyScanStats<KEYS> s;
+    s.isCalibrated = true;
+    s.calibrationCount = 10;
+    s.noteOnThreshold = 2.0f;
+    s.noteOffThreshold = 1.5f;
+    const float baselines[KEYS] = {1000.0f, -0.0f, 1.0f, 0.1f, 3.4e38f, 1e-7f};
+    const float ratios[KEYS] = {1.0f, NAN, INFINITY, -INFINITY, 0.0f, 2.718281828f};
+    for (uint16_t i = 0; i < KEYS; i++) {
+        s.readings[i] = static_cast<uint16_t>(i * 9000);
+        s.baselines[i] = baselines[i];
+        s.ratios[i] = ratios[i];
+        s.noteStates[i] = (i % 2) != 0;
+        s.aftertouchValues[i] = static_cast<uint8_t>(i * 25);
+    }
+
+    // The nlohmann document the firmware used to build and dump
+    json reference = {
+        {"type", "keyScan"},
+        {"keyCount", s.keyCount},
+        {"isCalibrated", s.isCalibrated},
+        {"calibrationCount", s.calibrationCount},
+        {"noteOnThreshold", s.noteOnThreshold},
+        {"noteOffThreshold", s.noteOffThreshold},
+        {"readings", std::vector<uint16_t>(s.readings, s.readings + KEYS)},
+        {"baselines", std::vector<float>(s.baselines, s.baselines + KEYS)},
+        {"ratios", std::vector<float>(s.ratios, s.ratios + KEYS)},
+        {"noteStates", std::vector<bool>(s.noteStates, s.noteStates + KEYS)},
+        {"aftertouchValues", std::vector<uint8_t>(s.aftertouchValues, s.aftertouchValues + KEYS)}
+    };
+
+    std::string written = writeWith([&s](features::JsonWriter& w) { midi::to_json(w, s); });
+    TEST_ASSERT_EQUAL_STRING(reference.dump().c_str(), written.c_str());
+}
+
+void test_timingStats_matchPreviousDom(void) {
+    features::TimingStats<4> t;
+    t.lapCount = 1234;
+    t.droppedSpans = 2;
+    t.unit = "us";
+    t.spanCount = 3;
+    t.spans[0].name = "app:voice_synthesis";
+    t.spans[0].record(17);
+    t.spans[0].record(UINT64_MAX / 2);
+    t.spans[1].name = "sink \"quoted\"";
+    t.spans[2].name = nullptr;   // Never recorded: min serializes as 0
+    t.spans[2].max = 5;
+
+    json spans = json::array();
+    for (size_t i = 0; i < t.spanCount; i++) {
+        const features::SpanStats& span = t.spans[i];
+        spans.push_back({
+            {"name", span.name ? span.name : ""},
+            {"min", span.min == std::numeric_limits<uint64_t>::max() ? 0 : span.min},
+            {"max", span.max},
+            {"total", span.total},
+            {"count", span.count}
+        });
+    }
+    json reference = {
+        {"type", "timing"},
+        {"unit", t.unit},
+        {"lapCount", t.lapCount},
+        {"droppedSpans", t.droppedSpans},
+        {"spans", spans}
+    };
+
+    std::string written = writeWith([&t](features::JsonWriter& w) { features::to_json(w, t); });
+    TEST_ASSERT_EQUAL_STRING(reference.dump().c_str(), written.c_str());
+}
+
+void test_streaming_matchesBufferedAndReportsOverflow(void) {
+    // Longer than several chunks, so values straddle chunk boundaries
+    midi::KeyScanStats<64> s;
+    for (uint16_t i = 0; i < 64; i++) {
+        s.ratios[i] = 1.0f / (i + 1);
+    }
+    std::string buffered = writeWith([&s](features::JsonWriter& w) { midi::to_json(w, s); });
+    std::string streamed;
+    features::writeJsonLine(s, appendString, &streamed);
+    TEST_ASSERT_TRUE(buffered.size() > 4 * features::JsonWriter::CHUNK_SIZE);
+    TEST_ASSERT_EQUAL_STRING((buffered + "\n").c_str(), streamed.c_str());
+
+    // A fixed buffer truncates, stays NUL-terminated, and says so
+    char small[16];
+    features::JsonWriter w(small, sizeof(small));
+    midi::to_json(w, s);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(small) - 1, w.finish());
+    TEST_ASSERT_TRUE(w.overflowed());
+    TEST_ASSERT_EQUAL_STRING(buffered.substr(0, sizeof(small) - 1).c_str(), small);
+}
+
+void test_zeroCapacity_leavesBufferUntouched(void) {
+    char buffer[2] = {'x', 'y'};
+    features::JsonWriter w(buffer, 0);
+    w.beginObject().key("a").value(1).endObject();
+    TEST_ASSERT_EQUAL_UINT32(0, w.finish());
+    TEST_ASSERT_TRUE(w.overflowed());
+    TEST_ASSERT_EQUAL_UINT8('x', buffer[0]);
+    TEST_ASSERT_EQUAL_UINT8('y', buffer[1]);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_floats_matchDump);
+    RUN_TEST(test_integersAndBools_matchDump);
+    RUN_TEST(test_strings_escapeLikeDump);
+    RUN_TEST(test_keyScanStats_matchPreviousDom);
+    RUN_TEST(test_timingStats_matchPreviousDom);
+    RUN_TEST(test_streaming_matchesBufferedAndReportsOverflow);
+    RUN_TEST(test_zeroCapacity_leavesBufferUntouched);
+    return UNITY_END();
+}
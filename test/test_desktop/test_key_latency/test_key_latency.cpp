@@ -0,0 +1,309 @@
+/**
+ * End-to-end key-to-audio latency harness
+ *
+ * Drives the real MidiKeyboardController -> SynthApplication chain with a
+ * scripted key scanner and a model of the audio sink, all on a simulated
+ * sample clock. A key press is injected at a known sample time; the harness
+ * then reports how long it takes until the first output sample that differs
+ * audibly from a reference run without the press.
+ *
+ * Latency is broken down into the stages it actually passes through:
+ *
+ *   scan    press time -> end of the mains-averaging window that detects it
+ *   midi    wall-clock cost of processScan() encoding + StreamProcessor parsing
+ *   block   detection -> start of the next renderAudio() block
+ *   attack  block start -> first sample above threshold (envelope ramp)
+ *   sink    queued sink periods ahead of the block being rendered
+ *
+ * The wall-clock cost of each renderAudio() block is reported alongside, since
+ * that (not the simulated latency) is what voice count changes: a block that
+ * takes longer than its own duration to render is an xrun.
+ *
+ * The sweep covers scan window, block size, and voice count (background notes
+ * are held down so render cost matches a busy keyboard). Results are printed
+ * as a table so configurations can be picked from data.
+ */
+
+#include <unity.h>
+#include <midi_keyboard_controller.hpp>
+#include <synth_application.hpp>
+#include <performance_timer.hpp>
+#include <telemetry_sink.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+static constexpr unsigned int SAMPLE_RATE = 48000;
+static constexpr unsigned int CHANNELS = 2;
+static constexpr uint8_t NUM_KEYS = 16;
+static constexpr uint8_t BASE_NOTE = 36;
+static constexpr uint8_t TEST_KEY = 0;
+static constexpr uint16_t IDLE_READING = 1000;
+static constexpr uint16_t PRESSED_READING = 3000;    // Ratio 3.0, above NOTE_ON_THRESHOLD
+static constexpr unsigned int SUB_SCAN_SAMPLES = 24; // 0.5 ms per full sub-scan of all keys
+static constexpr unsigned int SINK_PERIODS = 2;      // Double-buffered, like ALSA and the RP2350 sink
+static constexpr float OUTPUT_THRESHOLD = 0.001f;    // -60 dBFS
+static constexpr unsigned int TRIALS_PER_CONFIG = 32;
+static constexpr unsigned int TIMEOUT_SAMPLES = SAMPLE_RATE / 4;
+
+using Controller = midi::MidiKeyboardController<NUM_KEYS>;
+using Timer = features::LapTimer<features::NoOpTimingPolicy, 12>;
+
+/**
+ * @brief Key scanner whose readings are a function of simulated time
+ *
+ * The test key reads PRESSED_READING from the injected press sample onwards;
+ * every other key (and the test key before the press) reads IDLE_READING.
+ */
+class InjectedPressScanner : public midi::KeyScanner {
+public:
+    void setPressTime(uint64_t sample) { pressSample_ = sample; }
+
+    void sampleAt(uint64_t sample) {
+        for (uint8_t i = 0; i < NUM_KEYS; i++) {
+            readings_[i] = IDLE_READING;
+        }
+        if (sample >= pressSample_) {
+            readings_[TEST_KEY] = PRESSED_READING;
+        }
+    }
+
+    const uint16_t* getScanReadings() const override { return readings_; }
+    uint16_t getKeyCount() const override { return NUM_KEYS; }
+
+private:
+    uint64_t pressSample_ = UINT64_MAX;
+    uint16_t readings_[NUM_KEYS] = {};
+};
+
+/**
+ * @brief One point in the configuration sweep
+ */
+struct LatencyConfig {
+    unsigned int scanWindowSamples;
+    unsigned int blockFrames;
+    uint8_t voices;
+};
+
+/**
+ * @brief Per-trial stage breakdown, all in samples except midiMicros
+ */
+struct LatencySample {
+    double scan;
+    double midiMicros;
+    double block;
+    double attack;
+    double sink;
+    double total;
+    double renderMicros;   // Mean wall-clock cost of one renderAudio() block
+};
+
+/**
+ * @brief Simple LCG so the press phases are reproducible across runs
+ */
+static uint32_t nextRandom(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+/**
+ * @brief Run one trial: calibrate, hold background notes, press, measure
+ * @return false if no audible output appeared before the timeout
+ */
+static bool runTrial(const LatencyConfig& config, uint64_t pressOffset, LatencySample& out) {
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, config.voices);
+    platform::SynthApplication reference(SAMPLE_RATE, CHANNELS, config.voices);
+
+    InjectedPressScanner scanner;
+    uint64_t detectSample = 0;
+    bool detected = false;
+    uint64_t currentSample = 0;
+    Controller keyboard(
+        scanner,
+        [&](uint8_t byte) {
+            if (!detected && (byte & 0xF0) == 0x90) {
+                detected = true;
+                detectSample = currentSample;
+            }
+            synth.processMidiByte(byte);
+        },
+        std::make_unique<features::NoTelemetrySink<midi::KeyScanStats<NUM_KEYS>>>(),
+        BASE_NOTE,
+        100
+    );
+
+    // Background load: hold voices-1 other notes on both engines
+    for (uint8_t v = 1; v < config.voices; v++) {
+        const uint8_t note = 72 + v;
+        for (auto* app : {&synth, &reference}) {
+            app->processMidiByte(0x90);
+            app->processMidiByte(note);
+            app->processMidiByte(64);
+        }
+    }
+
+    // Press lands somewhere after calibration (CALIBRATION_SCANS full windows)
+    const uint64_t calibrationEnd =
+        static_cast<uint64_t>(Controller::CALIBRATION_SCANS) * config.scanWindowSamples;
+    const uint64_t pressSample = calibrationEnd + pressOffset;
+    scanner.setPressTime(pressSample);
+
+    std::vector<float> buffer(config.blockFrames * CHANNELS);
+    std::vector<float> refBuffer(config.blockFrames * CHANNELS);
+    std::vector<uint32_t> sums(NUM_KEYS);
+    std::vector<uint16_t> averaged(NUM_KEYS);
+    Timer timer;
+
+    uint64_t windowStart = 0;
+    uint64_t nextBlock = 0;
+    double midiMicros = 0.0;
+    double renderMicros = 0.0;
+    uint32_t renderedBlocks = 0;
+
+    while (currentSample < pressSample + TIMEOUT_SAMPLES) {
+        // Control side: one mains-averaged scan window, then processScan()
+        const uint64_t windowEnd = windowStart + config.scanWindowSamples;
+        std::fill(sums.begin(), sums.end(), 0);
+        uint32_t subScans = 0;
+        for (uint64_t t = windowStart; t < windowEnd; t += SUB_SCAN_SAMPLES) {
+            scanner.sampleAt(t);
+            const uint16_t* r = scanner.getScanReadings();
+            for (uint8_t i = 0; i < NUM_KEYS; i++) {
+                sums[i] += r[i];
+            }
+            subScans++;
+        }
+        for (uint8_t i = 0; i < NUM_KEYS; i++) {
+            averaged[i] = static_cast<uint16_t>(sums[i] / subScans);
+        }
+
+        // Audio side: render every block that starts before this window ends
+        while (nextBlock < windowEnd) {
+            currentSample = nextBlock;
+            auto renderStart = std::chrono::steady_clock::now();
+            synth.renderAudio(buffer.data(), config.blockFrames, timer);
+            auto renderEnd = std::chrono::steady_clock::now();
+            renderMicros += std::chrono::duration<double, std::micro>(renderEnd - renderStart).count();
+            renderedBlocks++;
+            reference.renderAudio(refBuffer.data(), config.blockFrames, timer);
+            if (detected) {
+                for (unsigned int f = 0; f < config.blockFrames; f++) {
+                    float diff = std::fabs(buffer[f * CHANNELS] - refBuffer[f * CHANNELS]);
+                    if (diff > OUTPUT_THRESHOLD) {
+                        out.scan = static_cast<double>(detectSample - pressSample);
+                        out.midiMicros = midiMicros;
+                        out.block = static_cast<double>(nextBlock - detectSample);
+                        out.attack = static_cast<double>(f);
+                        out.sink = static_cast<double>((SINK_PERIODS - 1) * config.blockFrames);
+                        out.total = out.scan + out.block + out.attack + out.sink;
+                        out.renderMicros = renderMicros / renderedBlocks;
+                        return true;
+                    }
+                }
+            }
+            nextBlock += config.blockFrames;
+        }
+
+        // Scan result is handed to the controller at the end of the window
+        currentSample = windowEnd;
+        auto start = std::chrono::steady_clock::now();
+        keyboard.processScan(averaged.data());
+        auto end = std::chrono::steady_clock::now();
+        if (detected && midiMicros == 0.0) {
+            midiMicros = std::chrono::duration<double, std::micro>(end - start).count();
+        }
+        windowStart = windowEnd;
+    }
+    return false;
+}
+
+/**
+ * @brief Summary statistics over one stage of a config's trials
+ */
+struct Distribution {
+    double min, p50, p95, max, mean;
+};
+
+static Distribution summarize(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    Distribution d{};
+    if (values.empty()) return d;
+    d.min = values.front();
+    d.max = values.back();
+    d.p50 = values[values.size() / 2];
+    d.p95 = values[std::min(values.size() - 1, (values.size() * 95) / 100)];
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    d.mean = sum / values.size();
+    return d;
+}
+
+static double toMs(double samples) {
+    return samples * 1000.0 / SAMPLE_RATE;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_latency_sweep_reportsPerStageBreakdown(void) {
+    const unsigned int scanWindows[] = {
+        SAMPLE_RATE / 500,   // 2 ms (no mains averaging)
+        SAMPLE_RATE / 120,   // half a 60 Hz cycle
+        SAMPLE_RATE / 60,    // one 60 Hz cycle (current RP2350 setting)
+    };
+    const unsigned int blockSizes[] = {64, 128, 256};
+    const uint8_t voiceCounts[] = {1, 8, 16};
+
+    printf("\n%-8s %-6s %-6s | %-29s | %-7s %-7s %-7s %-7s %-7s | %-9s\n",
+           "scan_ms", "block", "voices",
+           "total ms (min/p50/p95/max)",
+           "scan", "midi_us", "block", "attack", "sink", "render_us");
+
+    uint32_t rng = 12345;
+    for (unsigned int window : scanWindows) {
+        for (unsigned int block : blockSizes) {
+            for (uint8_t voices : voiceCounts) {
+                LatencyConfig config{window, block, voices};
+                std::vector<double> total, scan, midi, blockWait, attack, sink, render;
+
+                for (unsigned int trial = 0; trial < TRIALS_PER_CONFIG; trial++) {
+                    // Spread presses across a full window and a full block
+                    uint64_t offset = nextRandom(rng) % (window + block);
+                    LatencySample s{};
+                    bool heard = runTrial(config, offset, s);
+                    TEST_ASSERT_TRUE_MESSAGE(heard, "Key press should produce audible output");
+                    if (!heard) return;
+
+                    // Each stage is bounded by its own mechanism
+                    TEST_ASSERT_TRUE_MESSAGE(s.scan <= 2.0 * window, "Scan stage should finish within two windows");
+                    TEST_ASSERT_TRUE_MESSAGE(s.block < block, "Block wait should be shorter than one block");
+
+                    total.push_back(toMs(s.total));
+                    scan.push_back(toMs(s.scan));
+                    midi.push_back(s.midiMicros);
+                    blockWait.push_back(toMs(s.block));
+                    attack.push_back(toMs(s.attack));
+                    sink.push_back(toMs(s.sink));
+                    render.push_back(s.renderMicros);
+                }
+
+                Distribution t = summarize(total);
+                printf("%-8.2f %-6u %-6u | %6.2f %6.2f %6.2f %6.2f   | %-7.2f %-7.1f %-7.2f %-7.2f %-7.2f | %-9.1f\n",
+                       toMs(window), block, voices,
+                       t.min, t.p50, t.p95, t.max,
+                       summarize(scan).mean, summarize(midi).mean,
+                       summarize(blockWait).mean, summarize(attack).mean,
+                       summarize(sink).mean, summarize(render).mean);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_latency_sweep_reportsPerStageBreakdown);
+    return UNITY_END();
+}
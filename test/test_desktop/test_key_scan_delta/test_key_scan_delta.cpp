@@ -0,0 +1,253 @@
+/**
+ * Subscribed delta key-scan telemetry (MidiKeyboardController)
+ *
+ * Checks the three knobs of a KeyScanSubscription: keys are only sent once
+ * they move past the deadband from the value last sent, every
+ * keyframeInterval-th slot carries all subscribed keys (as does any slot with
+ * more changed keys than a delta frame lists), and messages are
+ * capped at maxRateHz, timed by scan timestamps or, without them, by the
+ * controller's clock.
+ */
+
+#include <unity.h>
+#include <midi_keyboard_controller.hpp>
+#include <telemetry_sink.hpp>
+#include <cstdint>
+#include <vector>
+
+static constexpr uint16_t KEYS = 8;
+static constexpr uint16_t IDLE_READING = 1000;
+
+using Controller = midi::MidiKeyboardController<KEYS>;
+using Stats = midi::KeyScanStats<KEYS>;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+class CapturingSink : public features::TelemetrySink<Stats> {
+public:
+    void sendTelemetry(const Stats& data) override { messages.push_back(data); }
+    std::vector<Stats> messages;
+};
+
+static uint64_t fakeClockUs = 0;
+static uint64_t fakeClock() { return fakeClockUs; }
+
+struct Fixture {
+    uint16_t readings[KEYS];
+    CapturingSink sink;
+    Controller controller;
+
+    explicit Fixture(midi::KeyScanner& scanner)
+        : controller(scanner, [](uint8_t) {}, sink) {
+        for (uint16_t i = 0; i < KEYS; i++) {
+            readings[i] = IDLE_READING;
+        }
+        for (uint16_t i = 0; i < Controller::CALIBRATION_SCANS; i++) {
+            controller.processScan(readings);
+        }
+        controller.setTelemetryEnabled(true);
+    }
+
+    void subscribe(float maxRateHz, uint16_t deadband, uint16_t keyframeInterval,
+                   uint16_t firstKey = 0, uint16_t keyCount = KEYS) {
+        midi::KeyScanSubscription subscription;
+        subscription.enabled = true;
+        subscription.firstKey = firstKey;
+        subscription.keyCount = keyCount;
+        subscription.maxRateHz = maxRateHz;
+        subscription.readingDeadband = deadband;
+        subscription.keyframeInterval = keyframeInterval;
+        controller.setTelemetrySubscription(subscription);
+    }
+
+    void scan(uint64_t timestampUs = 0) { controller.processScan(readings, timestampUs); }
+};
+
+/**
+ * @brief Scanner updated by the test, relying on the default pollFrame()
+ */
+class IdleScanner : public midi::KeyScanner {
+public:
+    IdleScanner() {
+        for (uint16_t i = 0; i < KEYS; i++) {
+            readings[i] = IDLE_READING;
+        }
+    }
+    const uint16_t* getScanReadings() const override { return readings; }
+    uint16_t getKeyCount() const override { return KEYS; }
+
+    uint16_t readings[KEYS];
+};
+
+void test_deadband_comparesAgainstLastSentValue(void) {
+    IdleScanner scanner;
+    Fixture f(scanner);
+    f.subscribe(0.0f, 8, 0);
+
+    // A new subscription starts with a keyframe of every subscribed key
+    f.scan();
+    TEST_ASSERT_EQUAL_UINT32(1, f.sink.messages.size());
+    TEST_ASSERT_TRUE(f.sink.messages[0].isDelta);
+    TEST_ASSERT_TRUE(f.sink.messages[0].isKeyframe);
+    TEST_ASSERT_EQUAL_UINT16(KEYS, f.sink.messages[0].deltaCount);
+
+    // Within the deadband: nothing at all is sent
+    f.readings[3] = IDLE_READING + 5;
+    f.scan();
+    TEST_ASSERT_EQUAL_UINT32(1, f.sink.messages.size());
+
+    // A slow drift crosses it eventually, measured from the last sent value
+    f.readings[3] = IDLE_READING + 10;
+    f.scan();
+    TEST_ASSERT_EQUAL_UINT32(2, f.sink.messages.size());
+    const Stats& delta = f.sink.messages[1];
+    TEST_ASSERT_FALSE(delta.isKeyframe);
+    TEST_ASSERT_EQUAL_UINT16(1, delta.deltaCount);
+    TEST_ASSERT_EQUAL_UINT16(3, delta.deltaKey(0));
+    TEST_ASSERT_EQUAL_UINT16(IDLE_READING + 10, delta.readings[0]);
+
+    // Downward moves count too
+    f.readings[3] = IDLE_READING + 1;
+    f.scan();
+    TEST_ASSERT_EQUAL_UINT32(3, f.sink.messages.size());
+    TEST_ASSERT_EQUAL_UINT16(IDLE_READING + 1, f.sink.messages[2].readings[0]);
+}
+
+void test_keyframeInterval_resendsSubscribedKeys(void) {
+    IdleScanner scanner;
+    Fixture f(scanner);
+    f.subscribe(0.0f, 8, 3, 2, 4);
+
+    for (int i = 0; i < 7; i++) {
+        f.scan();
+    }
+    // Slots 0 (subscription), 3 and 6 are keyframes; nothing changed in between
+    TEST_ASSERT_EQUAL_UINT32(3, f.sink.messages.size());
+    for (const Stats& message : f.sink.messages) {
+        TEST_ASSERT_TRUE(message.isKeyframe);
+        TEST_ASSERT_EQUAL_UINT16(4, message.deltaCount);
+        TEST_ASSERT_EQUAL_UINT16(2, message.deltaKey(0));
+        TEST_ASSERT_EQUAL_UINT16(5, message.deltaKey(3));
+    }
+
+    // Keys outside the subscription never show up
+    f.readings[0] = IDLE_READING + 100;
+    f.scan();
+    TEST_ASSERT_EQUAL_UINT32(3, f.sink.messages.size());
+}
+
+void test_manyChanges_sendKeyframeInsteadOfDelta(void) {
+    static constexpr uint16_t MANY_KEYS = 40;
+    using ManyStats = midi::KeyScanStats<MANY_KEYS>;
+    static_assert(ManyStats::maxDeltaKeys < MANY_KEYS, "delta list is capped below the key count");
+
+    struct ManySink : public features::TelemetrySink<ManyStats> {
+        void sendTelemetry(const ManyStats& data) override { messages.push_back(data); }
+        std::vector<ManyStats> messages;
+    } sink;
+    std::vector<uint16_t> readings(MANY_KEYS, IDLE_READING);
+    struct : public midi::KeyScanner {   // Readings are passed to processScan() directly
+        const uint16_t* getScanReadings() const override { return nullptr; }
+        uint16_t getKeyCount() const override { return MANY_KEYS; }
+    } scanner;
+    midi::MidiKeyboardController<MANY_KEYS> controller(scanner, [](uint8_t) {}, sink);
+    for (uint16_t i = 0; i < Controller::CALIBRATION_SCANS; i++) {
+        controller.processScan(readings.data());
+    }
+    controller.setTelemetryEnabled(true);
+    midi::KeyScanSubscription subscription;
+    subscription.enabled = true;
+    subscription.firstKey = 4;
+    subscription.maxRateHz = 0.0f;
+    subscription.keyframeInterval = 0;
+    controller.setTelemetrySubscription(subscription);
+    controller.processScan(readings.data());
+    TEST_ASSERT_EQUAL_UINT32(1, sink.messages.size());
+
+    // Up to maxDeltaKeys changes still go as a delta listing each key
+    for (uint16_t i = 0; i < ManyStats::maxDeltaKeys; i++) {
+        readings[10 + i] = IDLE_READING + 20;
+    }
+    controller.processScan(readings.data());
+    TEST_ASSERT_EQUAL_UINT32(2, sink.messages.size());
+    TEST_ASSERT_FALSE(sink.messages[1].isKeyframe);
+    TEST_ASSERT_EQUAL_UINT16(ManyStats::maxDeltaKeys, sink.messages[1].deltaCount);
+    TEST_ASSERT_EQUAL_UINT16(10, sink.messages[1].deltaKey(0));
+
+    // One more than that: the whole subscribed range goes as a keyframe
+    for (uint16_t i = 0; i <= ManyStats::maxDeltaKeys; i++) {
+        readings[10 + i] = IDLE_READING + 40;
+    }
+    controller.processScan(readings.data());
+    TEST_ASSERT_EQUAL_UINT32(3, sink.messages.size());
+    const ManyStats& keyframe = sink.messages[2];
+    TEST_ASSERT_TRUE(keyframe.isKeyframe);
+    TEST_ASSERT_EQUAL_UINT16(MANY_KEYS - 4, keyframe.deltaCount);
+    TEST_ASSERT_EQUAL_UINT16(4, keyframe.deltaKey(0));
+    TEST_ASSERT_EQUAL_UINT16(MANY_KEYS - 1, keyframe.deltaKey(MANY_KEYS - 5));
+    TEST_ASSERT_EQUAL_UINT16(IDLE_READING + 40, keyframe.readings[10 - 4]);
+
+    // Everything was sent: the next scan has nothing to report
+    controller.processScan(readings.data());
+    TEST_ASSERT_EQUAL_UINT32(3, sink.messages.size());
+}
+
+/**
+ * @brief Scan every millisecond for 100 ms with a key that keeps moving
+ * @return Messages sent
+ */
+static size_t scanFor100ms(Fixture& f, bool timestamps) {
+    size_t before = f.sink.messages.size();
+    for (uint64_t ms = 1; ms <= 100; ms++) {
+        fakeClockUs = 1000000 + ms * 1000;
+        f.readings[0] = static_cast<uint16_t>(IDLE_READING + 9 * ms);
+        f.scan(timestamps ? fakeClockUs : 0);
+    }
+    return f.sink.messages.size() - before;
+}
+
+void test_rateLimit_usesScanTimestamps(void) {
+    IdleScanner scanner;
+    Fixture f(scanner);
+    f.subscribe(100.0f, 8, 0);
+    TEST_ASSERT_EQUAL_UINT32(10, scanFor100ms(f, true));
+}
+
+void test_rateLimit_fallsBackToClockWithoutTimestamps(void) {
+    IdleScanner scanner;
+    Fixture f(scanner);
+    f.subscribe(100.0f, 8, 0);
+    f.controller.setClock(fakeClock);
+    TEST_ASSERT_EQUAL_UINT32(10, scanFor100ms(f, false));
+
+    // Neither timestamps nor a clock: the cap can't apply
+    f.controller.setClock(nullptr);
+    TEST_ASSERT_EQUAL_UINT32(100, scanFor100ms(f, false));
+}
+
+void test_rateLimit_appliesToDefaultPollFrame(void) {
+    // Frames from KeyScanner::pollFrame() carry no timestamp
+    IdleScanner scanner;
+    Fixture f(scanner);
+    f.subscribe(100.0f, 8, 0);
+    f.controller.setClock(fakeClock);
+    size_t before = f.sink.messages.size();
+    for (uint64_t ms = 1; ms <= 50; ms++) {
+        fakeClockUs = 2000000 + ms * 1000;
+        scanner.readings[0] = static_cast<uint16_t>(IDLE_READING + 9 * ms);
+        TEST_ASSERT_TRUE(f.controller.processScan());
+    }
+    TEST_ASSERT_EQUAL_UINT32(5, f.sink.messages.size() - before);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_deadband_comparesAgainstLastSentValue);
+    RUN_TEST(test_keyframeInterval_resendsSubscribedKeys);
+    RUN_TEST(test_manyChanges_sendKeyframeInsteadOfDelta);
+    RUN_TEST(test_rateLimit_usesScanTimestamps);
+    RUN_TEST(test_rateLimit_fallsBackToClockWithoutTimestamps);
+    RUN_TEST(test_rateLimit_appliesToDefaultPollFrame);
+    return UNITY_END();
+}
@@ -0,0 +1,269 @@
+/**
+ * Key scanning beyond one 8-bit scanner
+ *
+ * Checks that CompositeKeyScanner lays its sub-scanners out as one reading
+ * vector, refuses what doesn't fit, restarts each sub-scanner on its own
+ * schedule, and merges sub-frames into one frame per round of new
+ * sub-frames; and that MidiKeyboardController handles more than 255 keys,
+ * maps them through its note map (leaving keys without a MIDI note silent),
+ * and latches the note a key started so note-off and aftertouch follow it
+ * through a transposition.
+ */
+
+#include <unity.h>
+#include <composite_key_scanner.hpp>
+#include <scan_frame_buffer.hpp>
+#include <midi_keyboard_controller.hpp>
+#include <telemetry_sink.hpp>
+#include <cstdint>
+#include <vector>
+
+static constexpr uint16_t IDLE_READING = 1000;
+static constexpr uint16_t PRESSED_READING = 3000;  // Ratio 3.0, above NOTE_ON_THRESHOLD
+static constexpr uint16_t HARD_READING = 9000;     // Well into the aftertouch range
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * @brief Scanner with scripted readings whose scans complete on request
+ */
+class ScriptedScanner : public midi::KeyScanner {
+public:
+    explicit ScriptedScanner(uint16_t keyCount, uint16_t firstValue)
+        : readings_(keyCount) {
+        for (uint16_t i = 0; i < keyCount; i++) {
+            readings_[i] = static_cast<uint16_t>(firstValue + i);
+        }
+    }
+
+    const uint16_t* getScanReadings() const override { return readings_.data(); }
+    uint16_t getKeyCount() const override { return static_cast<uint16_t>(readings_.size()); }
+    void startScan() override { complete_ = false; starts_++; }
+    bool isScanComplete() const override { return complete_; }
+
+    void finishScan() { complete_ = true; }
+    int starts() const { return starts_; }
+
+private:
+    std::vector<uint16_t> readings_;
+    bool complete_ = true;
+    int starts_ = 0;
+};
+
+/**
+ * @brief Scanner that publishes whole frames through a ScanFrameBuffer
+ */
+template<uint16_t NumKeys>
+class FramedScanner : public midi::KeyScanner {
+public:
+    const uint16_t* getScanReadings() const override { return nullptr; }
+    uint16_t getKeyCount() const override { return NumKeys; }
+
+    bool pollFrame(uint32_t sinceSequence, midi::ScanFrame& frame) override {
+        return frames_.acquire(sinceSequence, frame);
+    }
+
+    void publish(uint16_t value, uint64_t timestampUs) {
+        uint16_t* out = frames_.writeBuffer();
+        for (uint16_t i = 0; i < NumKeys; i++) {
+            out[i] = value;
+        }
+        frames_.publish(timestampUs);
+    }
+
+private:
+    midi::ScanFrameBuffer<NumKeys> frames_;
+};
+
+/**
+ * @brief Records the MIDI bytes a controller sends
+ */
+struct MidiLog {
+    std::vector<uint8_t> bytes;
+
+    bool contains(uint8_t status, uint8_t note) const {
+        for (size_t i = 0; i + 1 < bytes.size(); i += 3) {
+            if (bytes[i] == status && bytes[i + 1] == note) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+template<uint16_t NumKeys>
+struct ControllerFixture {
+    std::vector<uint16_t> readings = std::vector<uint16_t>(NumKeys, IDLE_READING);
+    ScriptedScanner scanner{NumKeys, 0};
+    features::NoTelemetrySink<midi::KeyScanStats<NumKeys>> sink;
+    MidiLog midi;
+    midi::MidiKeyboardController<NumKeys> controller;
+
+    explicit ControllerFixture(uint8_t baseNote)
+        : controller(scanner, [this](uint8_t byte) { midi.bytes.push_back(byte); }, sink, baseNote) {
+        for (uint16_t i = 0; i < midi::MidiKeyboardController<NumKeys>::CALIBRATION_SCANS; i++) {
+            scan();
+        }
+    }
+
+    void scan() { controller.processScan(readings.data()); }
+};
+
+void test_composite_concatenatesScannersInOrder(void) {
+    ScriptedScanner a(200, 0);
+    ScriptedScanner b(100, 1000);
+    midi::CompositeKeyScanner<300, 2> composite;
+    TEST_ASSERT_TRUE(composite.addScanner(a));
+    TEST_ASSERT_TRUE(composite.addScanner(b));
+    TEST_ASSERT_EQUAL_UINT16(300, composite.getKeyCount());
+
+    const uint16_t* readings = composite.getScanReadings();
+    TEST_ASSERT_EQUAL_UINT16(0, readings[0]);
+    TEST_ASSERT_EQUAL_UINT16(199, readings[199]);
+    TEST_ASSERT_EQUAL_UINT16(1000, readings[200]);
+    TEST_ASSERT_EQUAL_UINT16(1099, readings[299]);
+
+    // Out of keys, then out of scanner slots
+    ScriptedScanner one(1, 0);
+    TEST_ASSERT_FALSE(composite.addScanner(one));
+    midi::CompositeKeyScanner<300, 1> single;
+    TEST_ASSERT_TRUE(single.addScanner(one));
+    TEST_ASSERT_FALSE(single.addScanner(one));
+    TEST_ASSERT_EQUAL_UINT16(1, single.getKeyCount());
+}
+
+void test_composite_servicesEachScannerOnItsOwnSchedule(void) {
+    ScriptedScanner fast(2, 10);
+    ScriptedScanner slow(2, 20);
+    midi::CompositeKeyScanner<4> composite;
+    composite.addScanner(fast);
+    composite.addScanner(slow);
+
+    composite.startScan();
+    TEST_ASSERT_FALSE(composite.isScanComplete());
+    uint32_t sums[4] = {};
+    uint32_t counts[4] = {};
+
+    // The fast scanner completes three times while the slow one completes once
+    for (int i = 0; i < 3; i++) {
+        fast.finishScan();
+        TEST_ASSERT_EQUAL_UINT32(1, composite.serviceScans(sums, counts));
+    }
+    slow.finishScan();
+    TEST_ASSERT_EQUAL_UINT32(1, composite.serviceScans(sums, counts));
+    TEST_ASSERT_EQUAL_UINT32(0, composite.serviceScans(sums, counts));
+
+    TEST_ASSERT_EQUAL_UINT32(3, composite.getScanCount(0));
+    TEST_ASSERT_EQUAL_UINT32(1, composite.getScanCount(1));
+    TEST_ASSERT_EQUAL_INT(4, fast.starts());   // Started together, then restarted after each scan
+    TEST_ASSERT_EQUAL_INT(2, slow.starts());
+    TEST_ASSERT_EQUAL_UINT32(3, counts[1]);
+    TEST_ASSERT_EQUAL_UINT32(3 * 11, sums[1]);
+    TEST_ASSERT_EQUAL_UINT32(1, counts[3]);
+    TEST_ASSERT_EQUAL_UINT32(21, sums[3]);
+}
+
+void test_composite_reportsMergedFrameOnlyWhenEveryScannerHasANewOne(void) {
+    FramedScanner<2> a;
+    FramedScanner<3> b;
+    midi::CompositeKeyScanner<5> composite;
+    composite.addScanner(a);
+    composite.addScanner(b);
+    midi::ScanFrame frame;
+    TEST_ASSERT_FALSE_MESSAGE(composite.pollFrame(0, frame), "No frame before any sub-frame");
+
+    // One scanner alone doesn't complete a merged frame
+    a.publish(1, 100);
+    TEST_ASSERT_FALSE(composite.pollFrame(0, frame));
+    b.publish(2, 150);
+    TEST_ASSERT_TRUE(composite.pollFrame(0, frame));
+    TEST_ASSERT_EQUAL_UINT32(1, frame.sequence);
+    TEST_ASSERT_EQUAL_UINT16(5, frame.keyCount);
+    TEST_ASSERT_EQUAL_UINT16(1, frame.readings[1]);
+    TEST_ASSERT_EQUAL_UINT16(2, frame.readings[2]);
+    TEST_ASSERT_TRUE(frame.timestampUs == 150);
+
+    // Repeats are suppressed until both scanners have published again
+    TEST_ASSERT_FALSE_MESSAGE(composite.pollFrame(frame.sequence, frame), "Same frame must not be reported twice");
+    a.publish(3, 200);
+    a.publish(4, 250);
+    TEST_ASSERT_FALSE(composite.pollFrame(1, frame));
+    TEST_ASSERT_FALSE(composite.waitForFrame(1, frame, 0));
+    b.publish(5, 220);
+    TEST_ASSERT_TRUE(composite.waitForFrame(1, frame, 0));
+    TEST_ASSERT_EQUAL_UINT32(2, frame.sequence);
+    TEST_ASSERT_EQUAL_UINT16(4, frame.readings[0]);
+    TEST_ASSERT_EQUAL_UINT16(5, frame.readings[4]);
+    TEST_ASSERT_TRUE(frame.timestampUs == 250);
+    TEST_ASSERT_FALSE(composite.pollFrame(2, frame));
+}
+
+void test_controller_mapsKeysBeyond255(void) {
+    static constexpr uint16_t KEYS = 300;
+    ControllerFixture<KEYS> f(0);
+    TEST_ASSERT_TRUE(f.controller.isCalibrated());
+
+    // Default map is consecutive up to the top of the MIDI range; later keys are unmapped
+    using Controller = midi::MidiKeyboardController<KEYS>;
+    TEST_ASSERT_EQUAL_UINT8(127, f.controller.getKeyNote(127));
+    TEST_ASSERT_EQUAL_UINT8(Controller::UNMAPPED, f.controller.getKeyNote(128));
+    f.readings[200] = PRESSED_READING;
+    f.scan();
+    f.readings[200] = IDLE_READING;
+    f.scan();
+    TEST_ASSERT_EQUAL_UINT32(0, f.midi.bytes.size());
+
+    // Transposing a key's note past 127 unmaps it rather than wrapping
+    f.controller.setBaseNote(12);
+    TEST_ASSERT_EQUAL_UINT8(127, f.controller.getKeyNote(115));
+    TEST_ASSERT_EQUAL_UINT8(Controller::UNMAPPED, f.controller.getKeyNote(116));
+    f.controller.setBaseNote(0);
+
+    f.controller.setKeyNote(299, 64);
+    f.readings[299] = PRESSED_READING;
+    f.scan();
+    TEST_ASSERT_EQUAL_UINT32(3, f.midi.bytes.size());
+    TEST_ASSERT_TRUE(f.midi.contains(0x90, 64));
+
+    // A whole-map replacement applies from the next press
+    std::vector<uint8_t> offsets(KEYS, 0);
+    offsets[256] = 12;
+    f.controller.setNoteMap(offsets.data());
+    f.readings[256] = PRESSED_READING;
+    f.scan();
+    TEST_ASSERT_TRUE(f.midi.contains(0x90, 12));
+    TEST_ASSERT_EQUAL_UINT8(0, f.controller.getKeyNote(299));
+}
+
+void test_controller_latchesNoteThroughTransposition(void) {
+    ControllerFixture<8> f(60);
+    f.readings[2] = PRESSED_READING;
+    f.scan();
+    TEST_ASSERT_TRUE(f.midi.contains(0x90, 62));
+
+    // Transpose while the key is held: aftertouch and note-off stay on 62
+    f.controller.setBaseNote(48);
+    f.readings[2] = HARD_READING;
+    f.scan();
+    TEST_ASSERT_TRUE(f.midi.contains(0xA0, 62));
+    f.readings[2] = IDLE_READING;
+    f.scan();
+    TEST_ASSERT_TRUE(f.midi.contains(0x80, 62));
+    TEST_ASSERT_FALSE(f.midi.contains(0x80, 50));
+
+    // The next press uses the new base note
+    f.readings[2] = PRESSED_READING;
+    f.scan();
+    TEST_ASSERT_TRUE(f.midi.contains(0x90, 50));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_composite_concatenatesScannersInOrder);
+    RUN_TEST(test_composite_servicesEachScannerOnItsOwnSchedule);
+    RUN_TEST(test_composite_reportsMergedFrameOnlyWhenEveryScannerHasANewOne);
+    RUN_TEST(test_controller_mapsKeysBeyond255);
+    RUN_TEST(test_controller_latchesNoteThroughTransposition);
+    return UNITY_END();
+}
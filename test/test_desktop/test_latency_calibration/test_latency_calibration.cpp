@@ -0,0 +1,154 @@
+/**
+ * Audio period calibration search and cache (lib/linux/latency_calibration.hpp)
+ *
+ * Runs LatencyCalibration with a scripted benchmark and soak instead of the
+ * clock and an ALSA device. Checks that period sizes the benchmark rules out
+ * are never soaked, that the rest are soaked smallest latency first (longer
+ * periods first on a tie), that the first clean candidate gets the safety
+ * margin, and that results are cached per setup, except for the fallback
+ * used when nothing soaked cleanly.
+ */
+
+#include <unity.h>
+#include <latency_calibration.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+
+using linux::AlsaLatencyConfig;
+using linux::LatencyCalibration;
+
+static constexpr unsigned int SAMPLE_RATE = 48000;
+static constexpr unsigned int CHANNELS = 2;
+static constexpr uint8_t MAX_VOICES = 2;
+
+static char cachePath[64];
+
+void setUp(void) {
+    std::strcpy(cachePath, "/tmp/latency_calibration_testXXXXXX");
+    int fd = mkstemp(cachePath);
+    close(fd);
+    unlink(cachePath);   // Start without a cache file
+}
+
+void tearDown(void) {
+    unlink(cachePath);
+}
+
+/**
+ * @brief Scripted device: period sizes up to slowestFrames render too slowly,
+ *        and configurations queueing fewer than stableFrames xrun
+ */
+struct ScriptedDevice {
+    unsigned int slowestFrames = 0;
+    unsigned int stableFrames = 0;
+    std::vector<unsigned int> unopenable;       // Period sizes the device refuses
+    std::vector<unsigned int> benchmarked;
+    std::vector<AlsaLatencyConfig> soaked;
+
+    LatencyCalibration makeCalibration(const char* device = "hw:0") {
+        LatencyCalibration calibration(device, SAMPLE_RATE, CHANNELS, MAX_VOICES,
+            [this](platform::SynthApplication&, const AlsaLatencyConfig& config, uint32_t& xruns) {
+                for (unsigned int frames : unopenable) {
+                    if (config.periodFrames == frames) {
+                        return false;
+                    }
+                }
+                soaked.push_back(config);
+                xruns = config.queuedFrames() < stableFrames ? 3 : 0;
+                return true;
+            },
+            cachePath);
+        calibration.setBenchmark([this](platform::SynthApplication&, unsigned int periodFrames) {
+            benchmarked.push_back(periodFrames);
+            double periodNs = 1e9 * periodFrames / SAMPLE_RATE;
+            return periodFrames <= slowestFrames ? 0.6 * periodNs : 0.1 * periodNs;
+        });
+        return calibration;
+    }
+};
+
+void test_calibrate_soaksCandidatesLowestLatencyFirst(void) {
+    ScriptedDevice device;
+    device.slowestFrames = 32;
+    device.stableFrames = 256;
+    LatencyCalibration calibration = device.makeCalibration();
+    AlsaLatencyConfig chosen = calibration.calibrate();
+
+    const unsigned int expectedBenchmarks[] = {32, 64, 128, 256, 512};
+    TEST_ASSERT_EQUAL_UINT32(5, device.benchmarked.size());
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expectedBenchmarks, device.benchmarked.data(), 5);
+
+    // 32 is too slow to render; at 256 queued frames 128 x 2 beats 64 x 4
+    const AlsaLatencyConfig expectedSoaks[] = {{64, 2}, {64, 3}, {128, 2}};
+    TEST_ASSERT_EQUAL_UINT32(3, device.soaked.size());
+    for (size_t i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(expectedSoaks[i] == device.soaked[i]);
+    }
+
+    // One safety period on top of the first clean candidate
+    TEST_ASSERT_EQUAL_UINT32(128, chosen.periodFrames);
+    TEST_ASSERT_EQUAL_UINT32(2 + LatencyCalibration::SAFETY_PERIODS, chosen.periods);
+}
+
+void test_calibrate_skipsConfigurationsTheDeviceRefuses(void) {
+    ScriptedDevice device;
+    device.stableFrames = 0;
+    device.unopenable = {32, 64};
+    AlsaLatencyConfig chosen = device.makeCalibration().calibrate();
+    TEST_ASSERT_EQUAL_UINT32(1, device.soaked.size());
+    TEST_ASSERT_EQUAL_UINT32(128, chosen.periodFrames);
+    TEST_ASSERT_EQUAL_UINT32(3, chosen.periods);
+}
+
+void test_cache_roundTripsPerSetup(void) {
+    ScriptedDevice device;
+    device.stableFrames = 256;
+    AlsaLatencyConfig chosen = device.makeCalibration().calibrate();
+
+    AlsaLatencyConfig cached;
+    TEST_ASSERT_TRUE(device.makeCalibration().loadCached(cached));
+    TEST_ASSERT_TRUE(chosen == cached);
+
+    // Another device, render rate or resampler quality is another entry
+    TEST_ASSERT_FALSE(device.makeCalibration("hw:1").loadCached(cached));
+    LatencyCalibration resampled = device.makeCalibration();
+    resampled.setRenderRate(32000, platform::ResamplerQuality::High);
+    TEST_ASSERT_FALSE(resampled.loadCached(cached));
+
+    device.stableFrames = 512;
+    AlsaLatencyConfig resampledChosen = resampled.calibrate();
+    LatencyCalibration fastResampled = device.makeCalibration();
+    fastResampled.setRenderRate(32000, platform::ResamplerQuality::Fast);
+    TEST_ASSERT_FALSE(fastResampled.loadCached(cached));
+    LatencyCalibration highResampled = device.makeCalibration();
+    highResampled.setRenderRate(32000, platform::ResamplerQuality::High);
+    TEST_ASSERT_TRUE(highResampled.loadCached(cached));
+    TEST_ASSERT_TRUE(resampledChosen == cached);
+
+    // Adding an entry keeps the others
+    TEST_ASSERT_TRUE(device.makeCalibration().loadCached(cached));
+    TEST_ASSERT_TRUE(chosen == cached);
+}
+
+void test_unstableFallback_isNotCached(void) {
+    ScriptedDevice device;
+    device.stableFrames = 100000;   // Every candidate xruns
+    AlsaLatencyConfig chosen = device.makeCalibration().calibrate();
+    TEST_ASSERT_EQUAL_UINT32(512, chosen.periodFrames);
+    TEST_ASSERT_EQUAL_UINT32(4, chosen.periods);
+    TEST_ASSERT_EQUAL_UINT32(15, device.soaked.size());
+
+    AlsaLatencyConfig cached;
+    TEST_ASSERT_FALSE(device.makeCalibration().loadCached(cached));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_calibrate_soaksCandidatesLowestLatencyFirst);
+    RUN_TEST(test_calibrate_skipsConfigurationsTheDeviceRefuses);
+    RUN_TEST(test_cache_roundTripsPerSetup);
+    RUN_TEST(test_unstableFallback_isNotCached);
+    return UNITY_END();
+}
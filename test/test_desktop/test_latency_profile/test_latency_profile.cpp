@@ -0,0 +1,203 @@
+/**
+ * Latency profiles and period-independent rendering
+ *
+ * A latency profile only changes how many frames the audio sink asks for per
+ * period. These tests check that the setLatencyProfile command reaches the
+ * sink's callback (and that unknown names never do), and that renderAudio()
+ * output does not depend on how the frames are split into calls: one long
+ * period renders the same samples as several short ones, with queued param
+ * changes taking effect at the same sub-block boundary.
+ */
+
+#include <unity.h>
+#include <synth_application.hpp>
+#include <latency_profile.hpp>
+#include <performance_timer.hpp>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+static constexpr unsigned int SAMPLE_RATE = 48000;
+static constexpr unsigned int CHANNELS = 2;
+static constexpr uint8_t MAX_VOICES = 4;
+static constexpr unsigned int SUB_BLOCK = platform::SynthApplication::RENDER_BLOCK_FRAMES;
+
+using Timer = features::LapTimer<features::NoOpTimingPolicy, 12>;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * @brief SynthApplication with its command output captured
+ */
+struct Fixture {
+    std::unique_ptr<platform::SynthApplication> synth;
+    std::string output;
+    Timer timer;
+
+    Fixture() : synth(std::make_unique<platform::SynthApplication>(SAMPLE_RATE, CHANNELS, MAX_VOICES)) {
+        synth->setCommandOutput(capture, this);
+    }
+
+    static void capture(const char* data, size_t length, void* context) {
+        static_cast<Fixture*>(context)->output.append(data, length);
+    }
+
+    void send(const char* line) {
+        synth->processCommandBytes(line, std::strlen(line));
+    }
+
+    void noteOn(uint8_t note) {
+        for (uint8_t byte : {uint8_t(0x90), note, uint8_t(100)}) {
+            synth->processMidiByte(byte);
+        }
+    }
+
+    /**
+     * @brief Append frames to out, rendered in calls of at most period frames
+     */
+    void render(std::vector<float>& out, unsigned int frames, unsigned int period) {
+        while (frames > 0) {
+            const unsigned int n = std::min(frames, period);
+            const size_t start = out.size();
+            out.resize(start + n * CHANNELS);
+            synth->renderAudio(out.data() + start, n, timer);
+            timer.end();
+            timer.reset();
+            frames -= n;
+        }
+    }
+};
+
+/**
+ * @brief Play a note, change a param after `before` frames, render `after` more
+ *
+ * The rendering before and after the change is split into calls of at most
+ * period frames.
+ */
+static std::vector<float> renderWithParamChange(unsigned int before, unsigned int after,
+                                                unsigned int period, const char* change) {
+    Fixture f;
+    std::vector<float> out;
+    f.noteOn(60);
+    f.render(out, before, period);
+    if (change) {
+        f.send(change);
+    }
+    f.render(out, after, period);
+    return out;
+}
+
+static const char* const CUTOFF_CHANGE = R"({"cmd":"setParam","param":"baseCutoff","value":300})" "\n";
+
+void test_parseLatencyProfile_knownNames(void) {
+    for (features::LatencyProfile expected : {features::LatencyProfile::LowLatency,
+                                              features::LatencyProfile::Efficiency}) {
+        const char* name = features::latencyProfileName(expected);
+        features::LatencyProfile parsed = features::LatencyProfile::LowLatency;
+        TEST_ASSERT_TRUE(features::parseLatencyProfile(name, std::strlen(name), parsed));
+        TEST_ASSERT_EQUAL(static_cast<int>(expected), static_cast<int>(parsed));
+    }
+}
+
+void test_parseLatencyProfile_rejectsUnknownNames(void) {
+    features::LatencyProfile parsed = features::LatencyProfile::Efficiency;
+    TEST_ASSERT_FALSE(features::parseLatencyProfile("turbo", 5, parsed));
+    TEST_ASSERT_FALSE(features::parseLatencyProfile("lowLatencyX", 11, parsed));
+    TEST_ASSERT_FALSE(features::parseLatencyProfile("efficiency", 9, parsed));  // Prefix only
+    TEST_ASSERT_EQUAL(static_cast<int>(features::LatencyProfile::Efficiency), static_cast<int>(parsed));
+}
+
+void test_setLatencyProfile_reachesCallback(void) {
+    Fixture f;
+    std::vector<features::LatencyProfile> requested;
+    f.synth->setLatencyProfileCallback([&requested](features::LatencyProfile profile) {
+        requested.push_back(profile);
+        return true;
+    });
+
+    f.send(R"({"cmd":"setLatencyProfile","profile":"efficiency"})" "\n"
+           R"({"cmd":"setLatencyProfile","profile":"lowLatency"})" "\n");
+
+    TEST_ASSERT_EQUAL_UINT32(2, requested.size());
+    TEST_ASSERT_EQUAL(static_cast<int>(features::LatencyProfile::Efficiency), static_cast<int>(requested[0]));
+    TEST_ASSERT_EQUAL(static_cast<int>(features::LatencyProfile::LowLatency), static_cast<int>(requested[1]));
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, f.output.find(R"("ack":"setLatencyProfile")"));
+    TEST_ASSERT_EQUAL(std::string::npos, f.output.find("error"));
+}
+
+void test_setLatencyProfile_unknownNameRejected(void) {
+    Fixture f;
+    int calls = 0;
+    f.synth->setLatencyProfileCallback([&calls](features::LatencyProfile) {
+        calls++;
+        return true;
+    });
+
+    f.send(R"({"cmd":"setLatencyProfile","profile":"turbo"})" "\n"
+           R"({"cmd":"setLatencyProfile"})" "\n");
+
+    TEST_ASSERT_EQUAL_INT(0, calls);
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, f.output.find("unknown latency profile"));
+    TEST_ASSERT_EQUAL(std::string::npos, f.output.find(R"("ack":"setLatencyProfile")"));
+}
+
+void test_setLatencyProfile_unsupportedSinkReportsError(void) {
+    Fixture f;
+    f.send(R"({"cmd":"setLatencyProfile","profile":"efficiency"})" "\n");
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, f.output.find("latency profiles not supported"));
+
+    f.output.clear();
+    f.synth->setLatencyProfileCallback([](features::LatencyProfile) { return false; });
+    f.send(R"({"cmd":"setLatencyProfile","profile":"efficiency"})" "\n");
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, f.output.find("latency profiles not supported"));
+}
+
+void test_renderAudio_periodDoesNotChangeOutput(void) {
+    // Efficiency and low latency periods on Linux, a sub-block, and periods
+    // that split sub-blocks
+    const unsigned int frames = 1024;
+    std::vector<float> reference = renderWithParamChange(0, frames, frames, nullptr);
+    for (unsigned int period : {512u, 128u, SUB_BLOCK, 48u, 7u}) {
+        std::vector<float> split = renderWithParamChange(0, frames, period, nullptr);
+        TEST_ASSERT_EQUAL_UINT32(reference.size(), split.size());
+        TEST_ASSERT_EQUAL_FLOAT_ARRAY(reference.data(), split.data(), reference.size());
+    }
+}
+
+void test_renderAudio_paramChangeAppliesAtSameSubBlock(void) {
+    // The change is queued between calls, 8 sub-blocks in, and applied at the
+    // start of the next sub-block whatever the period
+    const unsigned int before = 8 * SUB_BLOCK;
+    const unsigned int after = 1024;
+    std::vector<float> unchanged = renderWithParamChange(before, after, after, nullptr);
+    std::vector<float> reference = renderWithParamChange(before, after, after, CUTOFF_CHANGE);
+
+    // Identical up to the change, different after it
+    const size_t boundary = before * CHANNELS;
+    TEST_ASSERT_EQUAL_FLOAT_ARRAY(unchanged.data(), reference.data(), boundary);
+    bool differs = false;
+    for (size_t i = boundary; i < reference.size(); i++) {
+        differs |= reference[i] != unchanged[i];
+    }
+    TEST_ASSERT_TRUE_MESSAGE(differs, "baseCutoff change had no effect on the output");
+
+    for (unsigned int period : {512u, 128u, SUB_BLOCK}) {
+        std::vector<float> split = renderWithParamChange(before, after, period, CUTOFF_CHANGE);
+        TEST_ASSERT_EQUAL_UINT32(reference.size(), split.size());
+        TEST_ASSERT_EQUAL_FLOAT_ARRAY(reference.data(), split.data(), reference.size());
+    }
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_parseLatencyProfile_knownNames);
+    RUN_TEST(test_parseLatencyProfile_rejectsUnknownNames);
+    RUN_TEST(test_setLatencyProfile_reachesCallback);
+    RUN_TEST(test_setLatencyProfile_unknownNameRejected);
+    RUN_TEST(test_setLatencyProfile_unsupportedSinkReportsError);
+    RUN_TEST(test_renderAudio_periodDoesNotChangeOutput);
+    RUN_TEST(test_renderAudio_paramChangeAppliesAtSameSubBlock);
+    return UNITY_END();
+}
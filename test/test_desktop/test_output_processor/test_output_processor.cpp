@@ -0,0 +1,142 @@
+/**
+ * Fused output stage (lib/synth/output_processor.hpp)
+ *
+ * OutputProcessor::process() clips, post-filters and hands each sample to a
+ * sink writer in one pass. These tests run the chain it replaced, one pass
+ * per stage (clip the block in place, filter it, then apply gain and convert
+ * it to the sink format), and check that both produce the same output, for
+ * every clip mode, across several blocks so the filter state carries over.
+ */
+
+#include <unity.h>
+#include <output_processor.hpp>
+#include <biquad_filter.hpp>
+#include <sample_format.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using synth::OutputProcessor;
+
+static constexpr float SAMPLE_RATE = 48000.0f;
+static constexpr unsigned int BLOCK_FRAMES = 64;
+static constexpr unsigned int BLOCKS = 4;
+static constexpr float DRIVE = 0.7f;
+static constexpr float GAIN = 0.8f;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+using ShapeFn = float (*)(float);
+
+// Indexed by OutputProcessor::ClipMode
+static const ShapeFn SHAPES[] = {
+    synth::TanhClipping::shape,
+    synth::WaveFoldClipping::shape,
+    synth::SoftWaveFoldClipping::shape,
+};
+static_assert(sizeof(SHAPES) / sizeof(SHAPES[0]) == static_cast<size_t>(OutputProcessor::ClipMode::COUNT),
+              "one shape per clip mode");
+
+static std::vector<float> testSignal(size_t count) {
+    std::vector<float> signal(count);
+    for (size_t i = 0; i < count; i++) {
+        // Quiet passages and peaks well past full scale, to reach every fold
+        signal[i] = 2.5f * std::sin(0.05f * static_cast<float>(i)) * static_cast<float>(i % 5) / 4.0f;
+    }
+    return signal;
+}
+
+/**
+ * @brief The previous output stage: one pass each for clipping and filtering
+ */
+struct ChainedOutputStage {
+    ShapeFn shape;
+    synth::BiquadFilter postFilter{SAMPLE_RATE};
+
+    explicit ChainedOutputStage(ShapeFn shape) : shape(shape) {
+        postFilter.setMode(synth::BiquadFilter::Mode::LOWPASS);
+        postFilter.setCutoff(10000.0f);
+        postFilter.setQ(0.707f);
+    }
+
+    void process(float* block, unsigned int frames) {
+        const float drive = 0.1f * std::pow(100.0f, DRIVE);
+        for (unsigned int i = 0; i < frames; i++) {
+            block[i] = shape(block[i] * drive);
+        }
+        for (unsigned int i = 0; i < frames; i++) {
+            block[i] = postFilter.processSample(block[i]);
+        }
+    }
+};
+
+static OutputProcessor makeProcessor(size_t mode) {
+    OutputProcessor processor(DRIVE, SAMPLE_RATE);
+    processor.setModeIndex(mode);
+    return processor;
+}
+
+void test_fusedFloatOutput_matchesChainedStages(void) {
+    std::vector<float> input = testSignal(BLOCK_FRAMES * BLOCKS);
+    for (size_t mode = 0; mode < static_cast<size_t>(OutputProcessor::ClipMode::COUNT); mode++) {
+        OutputProcessor fused = makeProcessor(mode);
+        ChainedOutputStage chained(SHAPES[mode]);
+        for (unsigned int block = 0; block < BLOCKS; block++) {
+            const float* in = input.data() + block * BLOCK_FRAMES;
+            float out[BLOCK_FRAMES * 2];
+            fused.process(in, BLOCK_FRAMES, platform::FloatSampleWriter(out, 2));
+
+            float expected[BLOCK_FRAMES * 2];
+            float mono[BLOCK_FRAMES];
+            std::copy(in, in + BLOCK_FRAMES, mono);
+            chained.process(mono, BLOCK_FRAMES);
+            for (unsigned int i = 0; i < BLOCK_FRAMES; i++) {
+                expected[2 * i] = expected[2 * i + 1] = mono[i];
+            }
+            TEST_ASSERT_EQUAL_FLOAT_ARRAY(expected, out, BLOCK_FRAMES * 2);
+        }
+    }
+}
+
+template<typename Format>
+static void checkFusedMatchesChained(bool dithered) {
+    using Sample = typename Format::Sample;
+    std::vector<float> input = testSignal(BLOCK_FRAMES * BLOCKS);
+    for (size_t mode = 0; mode < static_cast<size_t>(OutputProcessor::ClipMode::COUNT); mode++) {
+        OutputProcessor fused = makeProcessor(mode);
+        ChainedOutputStage chained(SHAPES[mode]);
+        platform::TpdfDither fusedDither(99);
+        platform::TpdfDither chainedDither(99);
+        for (unsigned int block = 0; block < BLOCKS; block++) {
+            const float* in = input.data() + block * BLOCK_FRAMES;
+            Sample out[BLOCK_FRAMES * 2];
+            fused.process(in, BLOCK_FRAMES, platform::SampleWriter<Format>(
+                out, 2, GAIN, dithered ? &fusedDither : nullptr));
+
+            Sample expected[BLOCK_FRAMES * 2];
+            float mono[BLOCK_FRAMES];
+            std::copy(in, in + BLOCK_FRAMES, mono);
+            chained.process(mono, BLOCK_FRAMES);
+            platform::convertMonoToStereo<Format>(mono, expected, BLOCK_FRAMES, GAIN,
+                                                  dithered ? &chainedDither : nullptr);
+            TEST_ASSERT_EQUAL_MEMORY(expected, out, sizeof(out));
+        }
+    }
+}
+
+void test_fusedIntegerOutput_matchesChainedStages(void) {
+    for (bool dithered : {false, true}) {
+        checkFusedMatchesChained<platform::S16Format>(dithered);
+        checkFusedMatchesChained<platform::S24In32Format>(dithered);
+        checkFusedMatchesChained<platform::S32Format>(dithered);
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fusedFloatOutput_matchesChainedStages);
+    RUN_TEST(test_fusedIntegerOutput_matchesChainedStages);
+    return UNITY_END();
+}
@@ -0,0 +1,230 @@
+/**
+ * Render path benchmark: templated voice pool vs. the previous indirections
+ *
+ * The previous render loop visited voices through a std::function over
+ * std::unique_ptr slots, and clipped through a virtual processBuffer picked
+ * from a vector of unique_ptrs, in a pass of its own. That shape is rebuilt
+ * here from the same voices and filters and timed against
+ * PolyphonicSynthTarget's template visitor and OutputProcessor's fused
+ * process(). Both render identical audio, which is checked; the timings are
+ * printed, not asserted, since they depend on the machine. The same goes for
+ * an app built for a compile-time sample rate against the runtime-rate one.
+ */
+
+#include <unity.h>
+#include <synth_application.hpp>
+#include <polyphonic_synth_target.hpp>
+#include <output_processor.hpp>
+#include <performance_timer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+static constexpr float SAMPLE_RATE = 48000.0f;
+static constexpr uint8_t VOICES = 8;
+static constexpr unsigned int BLOCK_FRAMES = platform::SynthApplication::RENDER_BLOCK_FRAMES;
+static constexpr unsigned int BLOCKS = 4000;
+static constexpr int ROUNDS = 5;   // Alternated; the fastest round of each counts
+
+using Timer = features::LapTimer<features::NoOpTimingPolicy, 12>;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * @brief The clipper interface the output stage used to dispatch through
+ */
+struct LegacyClipper {
+    virtual ~LegacyClipper() = default;
+    virtual void processBuffer(float* buffer, unsigned int numFrames, float drive) const = 0;
+};
+
+struct LegacyTanhClipper : LegacyClipper {
+    void processBuffer(float* buffer, unsigned int numFrames, float drive) const override {
+        for (unsigned int i = 0; i < numFrames; ++i) {
+            buffer[i] = synth::TanhClipping::shape(buffer[i] * drive);
+        }
+    }
+};
+
+/**
+ * @brief Voice mix + clip + post-filter as the previous code structured it
+ */
+struct LegacyRenderer {
+    std::vector<std::unique_ptr<synth::WavetableSynth>> voices;
+    std::vector<std::unique_ptr<LegacyClipper>> clippers;
+    synth::BiquadFilter postFilter{SAMPLE_RATE};
+
+    LegacyRenderer() {
+        for (uint8_t i = 0; i < VOICES; i++) {
+            voices.push_back(std::make_unique<synth::WavetableSynth>(SAMPLE_RATE));
+        }
+        clippers.push_back(std::make_unique<LegacyTanhClipper>());
+        postFilter.setMode(synth::BiquadFilter::Mode::LOWPASS);
+        postFilter.setCutoff(10000.0f);
+        postFilter.setQ(0.707f);
+    }
+
+    void forEachVoice(std::function<void(synth::WavetableSynth&)> func) {
+        for (auto& voice : voices) {
+            func(*voice);
+        }
+    }
+
+    void render(float* mono, unsigned int frames, float drive, Timer& timer) {
+        for (unsigned int frame = 0; frame < frames; ++frame) {
+            float sample = 0.0f;
+            forEachVoice([&sample, &timer](synth::WavetableSynth& voice) {
+                sample += voice.nextSample(timer);
+            });
+            mono[frame] = sample;
+        }
+        clippers[0]->processBuffer(mono, frames, drive);
+        for (unsigned int frame = 0; frame < frames; ++frame) {
+            mono[frame] = postFilter.processSample(mono[frame]);
+        }
+    }
+};
+
+/**
+ * @brief The same work through the templated pool and fused output stage
+ */
+struct CurrentRenderer {
+    platform::PolyphonicSynthTarget<synth::WavetableSynth> pool{VOICES, SAMPLE_RATE};
+    synth::OutputProcessor output{0.5f, SAMPLE_RATE};
+    float mix[BLOCK_FRAMES];
+
+    void render(float* mono, unsigned int frames, Timer& timer) {
+        for (unsigned int frame = 0; frame < frames; ++frame) {
+            float sample = 0.0f;
+            pool.forEachVoice([&sample, &timer](synth::WavetableSynth& voice) {
+                sample += voice.nextSample(timer);
+            });
+            mix[frame] = sample;
+        }
+        output.process(mix, frames, [mono](unsigned int frame, float sample) {
+            mono[frame] = sample;
+        });
+    }
+};
+
+template<typename Render>
+static double nsPerFrame(Render&& render) {
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int block = 0; block < BLOCKS; block++) {
+        render();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+           (static_cast<double>(BLOCKS) * BLOCK_FRAMES);
+}
+
+void test_benchmark_templatedRenderPath(void) {
+    LegacyRenderer legacy;
+    CurrentRenderer current;
+    // One note per voice, the same in both
+    for (uint8_t i = 0; i < VOICES; i++) {
+        uint8_t note = static_cast<uint8_t>(48 + 5 * i);
+        current.pool.noteOn(note, 100);
+        legacy.voices[i]->trigger(440.0f * std::pow(2.0f, (note - 69) / 12.0f), 100 / 127.0f);
+    }
+    // OutputProcessor maps its normalized drive exponentially
+    const float drive = 0.1f * std::pow(100.0f, current.output.getDrive());
+
+    Timer timer;
+    // Each round's blocks are kept, so every frame can be compared
+    std::vector<float> legacyOut(BLOCKS * BLOCK_FRAMES);
+    std::vector<float> currentOut(BLOCKS * BLOCK_FRAMES);
+    double legacyNs = 1e9;
+    double currentNs = 1e9;
+    for (int round = 0; round < ROUNDS; round++) {
+        float* legacyBlock = legacyOut.data();
+        legacyNs = std::min(legacyNs, nsPerFrame([&] {
+            legacy.render(legacyBlock, BLOCK_FRAMES, drive, timer);
+            legacyBlock += BLOCK_FRAMES;
+        }));
+        float* currentBlock = currentOut.data();
+        currentNs = std::min(currentNs, nsPerFrame([&] {
+            current.render(currentBlock, BLOCK_FRAMES, timer);
+            currentBlock += BLOCK_FRAMES;
+        }));
+        TEST_ASSERT_EQUAL_FLOAT_ARRAY(legacyOut.data(), currentOut.data(), BLOCKS * BLOCK_FRAMES);
+    }
+    TEST_ASSERT_TRUE(std::any_of(currentOut.begin(), currentOut.end(), [](float sample) { return sample != 0.0f; }));
+
+    platform::SynthApplication app(static_cast<unsigned int>(SAMPLE_RATE), 2, VOICES);
+    for (uint8_t i = 0; i < VOICES; i++) {
+        const uint8_t noteOn[] = {0x90, static_cast<uint8_t>(48 + 5 * i), 100};
+        for (uint8_t byte : noteOn) {
+            app.processMidiByte(byte);
+        }
+    }
+    float stereo[BLOCK_FRAMES * 2];
+    double appNs = 1e9;
+    for (int round = 0; round < ROUNDS; round++) {
+        appNs = std::min(appNs, nsPerFrame([&] {
+            app.renderAudio(stereo, BLOCK_FRAMES, timer);
+            timer.end();
+            timer.reset();
+        }));
+    }
+
+    printf("\n%-40s %10s\n", "8 voices, 32-frame blocks", "ns/frame");
+    printf("%-40s %10.1f\n", "std::function + unique_ptr + virtual", legacyNs);
+    printf("%-40s %10.1f\n", "template visitor + inline voices", currentNs);
+    printf("%-40s %10.1f\n", "SynthApplication::renderAudio (stereo)", appNs);
+    printf("speedup: %.2fx\n", legacyNs / currentNs);
+}
+
+template<typename App>
+static double renderNotes(App& app, float* stereo, double& sum) {
+    for (uint8_t i = 0; i < VOICES; i++) {
+        const uint8_t noteOn[] = {0x90, static_cast<uint8_t>(48 + 5 * i), 100};
+        for (uint8_t byte : noteOn) {
+            app.processMidiByte(byte);
+        }
+    }
+    Timer timer;
+    double ns = 1e9;
+    for (int round = 0; round < ROUNDS; round++) {
+        ns = std::min(ns, nsPerFrame([&] {
+            app.renderAudio(stereo, BLOCK_FRAMES, timer);
+            sum += stereo[0];
+            timer.end();
+            timer.reset();
+        }));
+    }
+    return ns;
+}
+
+void test_benchmark_fixedSampleRate(void) {
+    using FixedApp = platform::BasicSynthApplication<synth::WavetableSynth, synth::OutputProcessor, 0,
+                                                     synth::FixedSampleRate<48000>>;
+    platform::SynthApplication runtimeApp(static_cast<unsigned int>(SAMPLE_RATE), 2, VOICES);
+    FixedApp fixedApp(44100, 2, VOICES);   // Built for 48 kHz, whatever is asked for
+    TEST_ASSERT_EQUAL_UINT32(48000, fixedApp.getSampleRate());
+
+    float runtimeOut[BLOCK_FRAMES * 2];
+    float fixedOut[BLOCK_FRAMES * 2];
+    double runtimeSum = 0.0;
+    double fixedSum = 0.0;
+    double runtimeNs = renderNotes(runtimeApp, runtimeOut, runtimeSum);
+    double fixedNs = renderNotes(fixedApp, fixedOut, fixedSum);
+
+    printf("\n%-40s %10s\n", "8 voices, 32-frame blocks, stereo", "ns/frame");
+    printf("%-40s %10.1f\n", "runtime sample rate", runtimeNs);
+    printf("%-40s %10.1f\n", "FixedSampleRate<48000>", fixedNs);
+
+    TEST_ASSERT_EQUAL_FLOAT(static_cast<float>(runtimeSum), static_cast<float>(fixedSum));
+    TEST_ASSERT_TRUE(runtimeSum != 0.0);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_benchmark_templatedRenderPath);
+    RUN_TEST(test_benchmark_fixedSampleRate);
+    return UNITY_END();
+}
@@ -0,0 +1,348 @@
+/**
+ * Real-time safety scenarios
+ *
+ * Runs scripted MIDI + render sequences through SynthApplication with the
+ * RtSafetyGuard interposers linked in, and fails if anything on the simulated
+ * audio thread allocates, frees, opens a file, writes, or waits on a mutex or
+ * condition variable. Each scenario mirrors what the Linux audio callback does
+ * per block: feed the pending MIDI bytes, then render.
+ *
+ * On failure the guard's report (counts and a backtrace per call site) is
+ * printed, which points straight at the offending code.
+ *
+ * MIDI program changes are covered too: the audio thread only records the
+ * request, and the program is loaded (through ProgramStorage, which may parse
+ * JSON and open files) by pushParamChanges() on the control side. Clipboard
+ * pastes are applied to the voices at once but saved there too.
+ */
+
+#define RT_SAFETY_GUARD_INTERPOSE
+#include <rt_safety_guard.hpp>
+
+#include <unity.h>
+#include <synth_application.hpp>
+#include <performance_timer.hpp>
+#include <telemetry_sink.hpp>
+#include <program_storage.hpp>
+#include <program_data.hpp>
+#include <preset_clipboard.hpp>
+#include <fixed_vector.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static constexpr unsigned int SAMPLE_RATE = 48000;
+static constexpr unsigned int CHANNELS = 2;
+static constexpr unsigned int BLOCK_FRAMES = 128;
+static constexpr uint8_t MAX_VOICES = 8;
+
+using Timer = features::LapTimer<features::NoOpTimingPolicy, 12>;
+
+/**
+ * @brief MIDI bytes delivered just before a given block is rendered
+ */
+struct ScriptedEvent {
+    unsigned int block;
+    std::vector<uint8_t> bytes;
+};
+
+/**
+ * @brief Render a scripted scenario with every block inside a guard scope
+ *
+ * Setup (construction, buffers, the script itself) happens outside the scope;
+ * only the per-block work the audio thread would do is checked.
+ */
+static void runScenario(const char* name, platform::SynthApplication& synth,
+                        const std::vector<ScriptedEvent>& script, unsigned int blocks,
+                        unsigned int frames = BLOCK_FRAMES) {
+    std::vector<float> buffer(frames * CHANNELS);
+    Timer timer;
+    size_t next = 0;
+
+    linux::RtSafetyGuard::reset();
+    for (unsigned int block = 0; block < blocks; block++) {
+        linux::RtSafetyGuard::Scope realtime;
+        while (next < script.size() && script[next].block == block) {
+            for (uint8_t byte : script[next].bytes) {
+                synth.processMidiByte(byte);
+            }
+            next++;
+        }
+        synth.renderAudio(buffer.data(), frames, timer);
+        timer.end();
+        timer.reset();
+    }
+
+    if (linux::RtSafetyGuard::violationCount() > 0) {
+        printf("\nScenario '%s':\n", name);
+        linux::RtSafetyGuard::report(stdout);
+    }
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, linux::RtSafetyGuard::violationCount(),
+                                     "Audio thread must not allocate or block");
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * @brief Storage whose programs differ in baseCutoff, and which allocates like the real ones
+ */
+class CountingProgramStorage : public features::ProgramStorage {
+public:
+    bool loadProgram(uint8_t program, VoiceIterator forEachVoice) override {
+        loads.push_back(program);
+        midi::ProgramData data;
+        data.set("baseCutoff", 100.0f * program);
+        midi::applyProgramToVoices(data, forEachVoice);
+        return true;
+    }
+    bool saveProgram(uint8_t program, VoiceIterator forEachVoice) override {
+        midi::ProgramData data;
+        data.captureFromVoices(forEachVoice);
+        saves.push_back({program, data.get("baseCutoff")});
+        return true;
+    }
+
+    std::vector<uint8_t> loads;
+    std::vector<std::pair<uint8_t, float>> saves;   // Program and its baseCutoff
+};
+
+struct alignas(64) Overaligned {
+    float data[16];
+};
+
+void test_guard_detectsViolationsOnlyInsideScope(void) {
+    TEST_ASSERT_TRUE(linux::RtSafetyGuard::isActive());
+    linux::RtSafetyGuard::reset();
+
+    // Outside a scope nothing is recorded
+    void* outside = malloc(16);
+    free(outside);
+    TEST_ASSERT_EQUAL_UINT32(0, linux::RtSafetyGuard::violationCount());
+
+    {
+        linux::RtSafetyGuard::Scope realtime;
+        void* p = malloc(16);
+        free(p);
+        // Through a volatile so the optimizer can't elide the pair
+        int* volatile q = new int(1);
+        delete q;
+        void* a = aligned_alloc(64, 64);
+        free(a);
+        void* m = nullptr;
+        if (posix_memalign(&m, 64, 64) == 0) {
+            free(m);
+        }
+        auto* volatile overaligned = new Overaligned;
+        delete overaligned;
+        FILE* f = fopen("/dev/null", "w");
+        if (f) {
+            fclose(f);
+        }
+    }
+    // fopen() allocates its FILE through malloc too
+    TEST_ASSERT_TRUE(linux::RtSafetyGuard::violationCount(linux::RtViolation::Malloc) >= 1);
+    TEST_ASSERT_TRUE(linux::RtSafetyGuard::violationCount(linux::RtViolation::Free) >= 1);
+    TEST_ASSERT_EQUAL_UINT32(2, linux::RtSafetyGuard::violationCount(linux::RtViolation::AlignedAlloc));
+    TEST_ASSERT_EQUAL_UINT32(2, linux::RtSafetyGuard::violationCount(linux::RtViolation::OperatorNew));
+    TEST_ASSERT_EQUAL_UINT32(2, linux::RtSafetyGuard::violationCount(linux::RtViolation::OperatorDelete));
+    TEST_ASSERT_EQUAL_UINT32(1, linux::RtSafetyGuard::violationCount(linux::RtViolation::Open));
+    TEST_ASSERT_TRUE(linux::RtSafetyGuard::siteCount() >= 5);
+    linux::RtSafetyGuard::reset();
+}
+
+void test_idleRender_isRealtimeSafe(void) {
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES);
+    runScenario("idle", synth, {}, 500);
+}
+
+void test_noteBursts_areRealtimeSafe(void) {
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES);
+    std::vector<ScriptedEvent> script;
+    for (unsigned int i = 0; i < 40; i++) {
+        uint8_t note = static_cast<uint8_t>(48 + (i * 7) % 24);
+        script.push_back({i * 10, {0x90, note, 100}});
+        script.push_back({i * 10 + 6, {0x80, note, 0}});
+    }
+    runScenario("note bursts", synth, script, 420);
+}
+
+void test_voiceStealing_isRealtimeSafe(void) {
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES);
+    std::vector<ScriptedEvent> script;
+    // Twice as many held notes as voices, several per block
+    for (unsigned int i = 0; i < 2 * MAX_VOICES; i++) {
+        script.push_back({i / 4, {0x90, static_cast<uint8_t>(40 + i), 90}});
+    }
+    for (unsigned int i = 0; i < 2 * MAX_VOICES; i++) {
+        script.push_back({100, {0x80, static_cast<uint8_t>(40 + i), 0}});
+    }
+    runScenario("voice stealing", synth, script, 200);
+}
+
+void test_controllers_areRealtimeSafe(void) {
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES);
+    std::vector<ScriptedEvent> script;
+    script.push_back({0, {0x90, 60, 100, 64, 100}});   // Running status chord
+    for (unsigned int i = 0; i < 100; i++) {
+        uint8_t value = static_cast<uint8_t>(i % 128);
+        script.push_back({i + 1, {0xE0, 0, value}});        // Pitch bend
+        script.push_back({i + 1, {0xA0, 60, value}});       // Polyphonic aftertouch
+        script.push_back({i + 1, {0xB0, 1, value}});        // Mod wheel
+        script.push_back({i + 1, {0xB0, 74, value}});       // Brightness
+    }
+    script.push_back({110, {0xB0, 123, 0}});                // All notes off
+    runScenario("controllers", synth, script, 150);
+}
+
+void test_audioTaps_areRealtimeSafe(void) {
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES);
+    synth.setAudioTap(true, -1);
+    synth.setAudioTap(true, 0, 2);
+    std::vector<ScriptedEvent> script = {{0, {0x90, 60, 100}}, {50, {0x80, 60, 0}}};
+    runScenario("audio taps", synth, script, 100);
+
+    // The consumer side runs outside the scope, as it would on another thread
+    features::NoTelemetrySink<features::AudioMeterStats> sink;
+    synth.pollAudioTaps(sink);
+}
+
+void test_anyBlockSize_isRealtimeSafe(void) {
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES);
+    synth.setAudioTap(true, 0);
+    std::vector<ScriptedEvent> script = {{0, {0x90, 60, 100}}};
+    // Sink periods need not be multiples of the internal render block
+    for (unsigned int frames : {1u, 32u, 64u, 100u, 256u, 1024u}) {
+        runScenario("block sizes", synth, script, 50, frames);
+    }
+}
+
+void test_resampledOutput_isRealtimeSafe(void) {
+    // Engine at 32 kHz, device at 44.1 kHz
+    platform::SynthApplication synth(32000, CHANNELS, MAX_VOICES);
+    synth.setOutputRate(44100, platform::ResamplerQuality::High);
+    std::vector<ScriptedEvent> script = {{0, {0x90, 60, 100}}, {20, {0x80, 60, 0}}};
+    for (unsigned int frames : {1u, 100u, 441u}) {
+        runScenario("resampled output", synth, script, 40, frames);
+    }
+}
+
+void test_queuedParamBatches_areRealtimeSafe(void) {
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES);
+    // Commands are parsed on the control side; the audio thread only applies
+    // the queued batch at the start of the next block
+    synth.processCommand(R"({"cmd":"setParams","params":{"baseCutoff":321,"filterQ":4,"ampEnvRelease":0.5}})");
+    synth.processCommand(R"({"cmd":"setParam","param":"vibratoDepth","value":0.25})");
+    synth.getVoicePool().forEachVoice([](synth::WavetableSynth& voice) {
+        TEST_ASSERT_NOT_EQUAL(321.0f, voice.getBaseCutoff());
+    });
+
+    std::vector<ScriptedEvent> script = {{0, {0x90, 60, 100}}};
+    runScenario("queued params", synth, script, 10);
+    synth.getVoicePool().forEachVoice([](synth::WavetableSynth& voice) {
+        TEST_ASSERT_EQUAL_FLOAT(321.0f, voice.getBaseCutoff());
+        TEST_ASSERT_EQUAL_FLOAT(4.0f, voice.getFilter().getQ());
+        TEST_ASSERT_EQUAL_FLOAT(0.5f, voice.getAmpEnvelope().getReleaseTime());
+        TEST_ASSERT_EQUAL_FLOAT(0.25f, voice.getVibratoDepth());
+    });
+}
+
+void test_programChange_isRealtimeSafe(void) {
+    auto owned = std::make_unique<CountingProgramStorage>();
+    CountingProgramStorage* storage = owned.get();
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES, std::move(owned));
+    TEST_ASSERT_EQUAL_UINT32(1, storage->loads.size());   // The startup program
+
+    std::vector<ScriptedEvent> script = {{0, {0x90, 60, 100}}, {2, {0xC0, 5}}, {3, {0xC0, 7}}};
+    runScenario("program change", synth, script, 6);
+    TEST_ASSERT_EQUAL_UINT32(1, storage->loads.size());
+
+    // The control side loads the newest request and queues it for the next block
+    synth.pushParamChanges(1000);
+    TEST_ASSERT_EQUAL_UINT32(2, storage->loads.size());
+    TEST_ASSERT_EQUAL_UINT8(7, storage->loads.back());
+    runScenario("program applied", synth, {}, 1);
+    synth.getVoicePool().forEachVoice([](synth::WavetableSynth& voice) {
+        TEST_ASSERT_EQUAL_FLOAT(700.0f, voice.getBaseCutoff());
+    });
+    synth.pushParamChanges(2000);
+    TEST_ASSERT_EQUAL_UINT32(2, storage->loads.size());
+}
+
+void test_clipboardPaste_savesOnControlSide(void) {
+    auto owned = std::make_unique<CountingProgramStorage>();
+    CountingProgramStorage* storage = owned.get();
+    platform::SynthApplication synth(SAMPLE_RATE, CHANNELS, MAX_VOICES, std::move(owned));
+    synth.setClipboard(std::make_unique<linux::PresetClipboard>());
+    synth.processMidiByte(0xC0);
+    synth.processMidiByte(5);
+    synth.pushParamChanges(1000);
+    runScenario("program 5", synth, {}, 1);
+
+    // Copy, change the cutoff, paste back: the voices change at once, the save waits
+    std::vector<ScriptedEvent> script = {{0, {0xB0, 103, 127}}, {1, {0xB0, 74, 0}}, {2, {0xB0, 104, 127}}};
+    runScenario("clipboard paste", synth, script, 4);
+    TEST_ASSERT_EQUAL_UINT32(0, storage->saves.size());
+    synth.getVoicePool().forEachVoice([](synth::WavetableSynth& voice) {
+        TEST_ASSERT_EQUAL_FLOAT(500.0f, voice.getBaseCutoff());
+    });
+
+    synth.pushParamChanges(2000);
+    TEST_ASSERT_EQUAL_UINT32(1, storage->saves.size());
+    TEST_ASSERT_EQUAL_UINT8(5, storage->saves[0].first);
+    TEST_ASSERT_EQUAL_FLOAT(500.0f, storage->saves[0].second);
+    synth.pushParamChanges(3000);
+    TEST_ASSERT_EQUAL_UINT32(1, storage->saves.size());
+}
+
+void test_staticSynthApplication_neverAllocates(void) {
+    // The RP2350 configuration: constructed in static storage, with callbacks
+    // and external params, must not touch the heap at all, setup included
+    using StaticApp = platform::StaticSynthApplication<MAX_VOICES>;
+    static features::StaticStorage<StaticApp> storage;
+    static float aftertouchRatio = 5.0f;
+    uint8_t baseNote = 0;
+
+    linux::RtSafetyGuard::reset();
+    StaticApp* synth = nullptr;
+    {
+        linux::RtSafetyGuard::Scope realtime;
+        synth = storage.emplace(SAMPLE_RATE, CHANNELS, MAX_VOICES, static_cast<features::ProgramStorage*>(nullptr));
+        synth->setBaseNoteCallback([&baseNote](uint8_t note) { baseNote = note; });
+        synth->registerExternalParam("aftertouchMinRatio",
+            [](float value) { aftertouchRatio = value; },
+            []() { return aftertouchRatio; });
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, linux::RtSafetyGuard::violationCount(linux::RtViolation::Malloc));
+    TEST_ASSERT_EQUAL_UINT32(0, linux::RtSafetyGuard::violationCount(linux::RtViolation::OperatorNew));
+
+    synth->processCommand(R"({"cmd":"setBaseNote","note":48})");
+    synth->processCommand(R"({"cmd":"setParam","param":"aftertouchMinRatio","value":7})");
+    TEST_ASSERT_EQUAL_UINT8(48, baseNote);
+    TEST_ASSERT_EQUAL_FLOAT(7.0f, aftertouchRatio);
+
+    // Polyphony beyond the compile-time capacity is capped, not allocated
+    StaticApp capped(SAMPLE_RATE, CHANNELS, MAX_VOICES + 4);
+    TEST_ASSERT_EQUAL_UINT8(MAX_VOICES, capped.getVoicePool().getVoiceCount());
+
+    features::MemoryReport report;
+    synth->reportMemory(report);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(StaticApp), report.total());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_guard_detectsViolationsOnlyInsideScope);
+    RUN_TEST(test_idleRender_isRealtimeSafe);
+    RUN_TEST(test_noteBursts_areRealtimeSafe);
+    RUN_TEST(test_voiceStealing_isRealtimeSafe);
+    RUN_TEST(test_controllers_areRealtimeSafe);
+    RUN_TEST(test_audioTaps_areRealtimeSafe);
+    RUN_TEST(test_anyBlockSize_isRealtimeSafe);
+    RUN_TEST(test_resampledOutput_isRealtimeSafe);
+    RUN_TEST(test_queuedParamBatches_areRealtimeSafe);
+    RUN_TEST(test_programChange_isRealtimeSafe);
+    RUN_TEST(test_clipboardPaste_savesOnControlSide);
+    RUN_TEST(test_staticSynthApplication_neverAllocates);
+    return UNITY_END();
+}
@@ -0,0 +1,144 @@
+/**
+ * Float to integer sample conversion (lib/platform/sample_format.hpp)
+ *
+ * Checks full-scale mapping and saturation for each format (NaN and
+ * infinities included), and that the SIMD path built on this machine matches
+ * the scalar per-sample conversion exactly, dither included, for every
+ * channel layout and for lengths that leave a scalar tail.
+ */
+
+#include <unity.h>
+#include <sample_format.hpp>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace platform;
+using sample_format_detail::convertOne;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static std::vector<float> testSignal(size_t count) {
+    std::vector<float> signal(count);
+    for (size_t i = 0; i < count; i++) {
+        // Covers silence, small values and overdriven peaks beyond +-1
+        signal[i] = 1.3f * std::sin(0.37f * static_cast<float>(i)) * static_cast<float>(i % 7) / 6.0f;
+    }
+    return signal;
+}
+
+void test_fullScale_saturatesToFormatRange(void) {
+    const float in[8] = {1.0f, -1.0f, 2.0f, -2.0f, 0.5f, -0.5f, 0.0f, 1e-9f};
+    int16_t s16[8];
+    int32_t s24[8];
+    int32_t s32[8];
+    convertInterleaved<S16Format>(in, s16, 8);
+    convertInterleaved<S24In32Format>(in, s24, 8);
+    convertInterleaved<S32Format>(in, s32, 8);
+
+    const int16_t expected16[8] = {32767, -32768, 32767, -32768, 16384, -16384, 0, 0};
+    TEST_ASSERT_EQUAL_INT16_ARRAY(expected16, s16, 8);
+
+    TEST_ASSERT_EQUAL_INT32(8388607 * 256, s24[0]);
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, s24[1]);
+    TEST_ASSERT_EQUAL_INT32(4194304 * 256, s24[4]);
+    for (int i = 0; i < 8; i++) {
+        TEST_ASSERT_EQUAL_INT32(0, s24[i] & 0xFF);
+    }
+
+    TEST_ASSERT_EQUAL_INT32(2147483520, s32[0]);   // Largest float below 2^31
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, s32[1]);
+    TEST_ASSERT_EQUAL_INT32(2147483520, s32[2]);
+    TEST_ASSERT_EQUAL_INT32(1073741824, s32[4]);
+}
+
+template<typename Format>
+static void checkNonFinite(typename Format::Sample max, typename Format::Sample min) {
+    // Enough samples for the vector path, and a scalar tail
+    const float in[6] = {NAN, INFINITY, -INFINITY, -NAN, NAN, INFINITY};
+    const typename Format::Sample expected[6] = {0, max, min, 0, 0, max};
+    typename Format::Sample out[6];
+    convertInterleaved<Format>(in, out, 6);
+    TEST_ASSERT_EQUAL_MEMORY(expected, out, sizeof(out));
+    for (int i = 0; i < 6; i++) {
+        TEST_ASSERT_TRUE(convertOne<Format>(in[i], 1.0f, nullptr, 0) == expected[i]);
+    }
+
+    // Adding dither leaves a NaN a NaN
+    TpdfDither dither;
+    TEST_ASSERT_TRUE(convertOne<Format>(NAN, 1.0f, &dither, 0) == 0);
+}
+
+void test_nonFinite_convertsToZeroOrSaturates(void) {
+    checkNonFinite<S16Format>(INT16_MAX, INT16_MIN);
+    checkNonFinite<S24In32Format>(8388607 * 256, INT32_MIN);
+    checkNonFinite<S32Format>(2147483520, INT32_MIN);
+}
+
+template<typename Format>
+static void checkMatchesScalar(size_t count, bool dithered) {
+    const float gain = 0.8f;
+    std::vector<float> stereo = testSignal(count * 2);
+    std::vector<typename Format::Sample> out(count * 2);
+    std::vector<typename Format::Sample> expected(count * 2);
+
+    // Scalar reference: sample i draws from dither lane i % 4
+    TpdfDither referenceDither(1234);
+    TpdfDither* ref = dithered ? &referenceDither : nullptr;
+    TpdfDither dither(1234);
+    TpdfDither* dut = dithered ? &dither : nullptr;
+
+    for (size_t i = 0; i < count * 2; i++) {
+        expected[i] = convertOne<Format>(stereo[i], gain, ref, static_cast<int>(i & 3));
+    }
+    convertInterleaved<Format>(stereo.data(), out.data(), count * 2, gain, dut);
+    TEST_ASSERT_EQUAL_MEMORY(expected.data(), out.data(), count * 2 * sizeof(out[0]));
+
+    for (size_t i = 0; i < count; i++) {
+        expected[i] = convertOne<Format>(stereo[2 * i], gain, ref, static_cast<int>(i & 3));
+    }
+    convertLeftChannel<Format>(stereo.data(), out.data(), count, gain, dut);
+    TEST_ASSERT_EQUAL_MEMORY(expected.data(), out.data(), count * sizeof(out[0]));
+
+    for (size_t i = 0; i < count; i++) {
+        expected[2 * i] = expected[2 * i + 1] = convertOne<Format>(stereo[i], gain, ref, static_cast<int>(i & 3));
+    }
+    convertMonoToStereo<Format>(stereo.data(), out.data(), count, gain, dut);
+    TEST_ASSERT_EQUAL_MEMORY(expected.data(), out.data(), count * 2 * sizeof(out[0]));
+}
+
+void test_vectorPath_matchesScalar(void) {
+    for (size_t count : {0u, 1u, 3u, 4u, 127u, 256u}) {
+        for (bool dithered : {false, true}) {
+            checkMatchesScalar<S16Format>(count, dithered);
+            checkMatchesScalar<S24In32Format>(count, dithered);
+            checkMatchesScalar<S32Format>(count, dithered);
+        }
+    }
+}
+
+void test_dither_isTriangularWithinOneLsb(void) {
+    TpdfDither dither;
+    const int SAMPLES = 40000;
+    double sum = 0.0;
+    int nearZero = 0;
+    for (int i = 0; i < SAMPLES; i++) {
+        float d = dither.next(i & 3);
+        TEST_ASSERT_TRUE(d >= -1.0f && d < 1.0f);
+        sum += d;
+        nearZero += std::fabs(d) < 0.5f;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.0f, static_cast<float>(sum / SAMPLES));
+    // Triangular PDF: 75% of values within +-0.5 LSB (uniform would be 50%)
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.75f, static_cast<float>(nearZero) / SAMPLES);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fullScale_saturatesToFormatRange);
+    RUN_TEST(test_nonFinite_convertsToZeroOrSaturates);
+    RUN_TEST(test_vectorPath_matchesScalar);
+    RUN_TEST(test_dither_isTriangularWithinOneLsb);
+    return UNITY_END();
+}
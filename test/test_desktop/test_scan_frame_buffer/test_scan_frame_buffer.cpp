@@ -0,0 +1,61 @@
+/**
+ * Scan frame publishing (lib/midi/scan_frame_buffer.hpp)
+ *
+ * Checks that each published key scan is reported to the consumer exactly
+ * once, and that a consumer that falls behind gets the newest frame, intact,
+ * with the skipped frames visible as a sequence gap.
+ */
+
+#include <unity.h>
+#include <scan_frame_buffer.hpp>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_scanFrameBuffer_shouldReportEachFrameOnce(void) {
+    // Arrange
+    midi::ScanFrameBuffer<4> frames;
+    midi::ScanFrame frame;
+    TEST_ASSERT_FALSE_MESSAGE(frames.acquire(0, frame), "No frame before the first publish");
+
+    // Act
+    uint16_t* out = frames.writeBuffer();
+    for (uint16_t i = 0; i < 4; i++) out[i] = 100 + i;
+    uint32_t seq = frames.publish(1234);
+
+    // Assert
+    TEST_ASSERT_TRUE(frames.acquire(0, frame));
+    TEST_ASSERT_EQUAL_UINT32(seq, frame.sequence);
+    TEST_ASSERT_EQUAL_UINT16(4, frame.keyCount);
+    TEST_ASSERT_EQUAL_UINT16(103, frame.readings[3]);
+    TEST_ASSERT_TRUE(frame.timestampUs == 1234);
+    TEST_ASSERT_FALSE_MESSAGE(frames.acquire(frame.sequence, frame), "Same frame must not be reported twice");
+}
+
+void test_scanFrameBuffer_shouldSkipToNewestFrame(void) {
+    // Arrange - producer publishes three frames before the consumer looks
+    midi::ScanFrameBuffer<2> frames;
+    midi::ScanFrame frame;
+    for (uint16_t n = 1; n <= 3; n++) {
+        uint16_t* out = frames.writeBuffer();
+        out[0] = n;
+        out[1] = n;
+        frames.publish(n);
+    }
+
+    // Act
+    TEST_ASSERT_TRUE(frames.acquire(0, frame));
+
+    // Assert - newest frame, intact, with a sequence gap showing the skipped ones
+    TEST_ASSERT_EQUAL_UINT32(3, frame.sequence);
+    TEST_ASSERT_EQUAL_UINT16(3, frame.readings[0]);
+    TEST_ASSERT_EQUAL_UINT16(3, frame.readings[1]);
+    TEST_ASSERT_EQUAL_UINT32(3, frames.latestSequence());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_scanFrameBuffer_shouldReportEachFrameOnce);
+    RUN_TEST(test_scanFrameBuffer_shouldSkipToNewestFrame);
+    return UNITY_END();
+}
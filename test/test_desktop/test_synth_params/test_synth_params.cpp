@@ -0,0 +1,118 @@
+/**
+ * Synth voice parameter registry (lib/synth/synth_params.hpp)
+ *
+ * Checks the lookups built from SYNTH_PARAMS at compile time: the name hash
+ * table resolves every name (and nothing that merely shares a prefix), the
+ * CC table points each assigned CC at its parameter, the CC curves reproduce
+ * the formulas handleCC used before the registry, and ProgramData's JSON
+ * form covers the whole table.
+ */
+
+#include <unity.h>
+#include <synth_params.hpp>
+#include <program_data.hpp>
+#include <json.hpp>
+#include <cmath>
+#include <cstdint>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Order of the hand-written parameter lists the registry replaced
+static const char* const PREVIOUS_PARAM_ORDER[] = {
+    "waveformShape", "baseCutoff", "filterQ", "filterMode", "filterEnvAmount", "filterEnvAttack",
+    "filterEnvDecay", "filterEnvSustain", "filterEnvRelease", "ampEnvAttack", "ampEnvDecay",
+    "ampEnvSustain", "ampEnvRelease", "vibratoRate", "vibratoDepth", "tremoloRate", "tremoloDepth",
+    "baseCutoff_atMod", "filterEnvAmount_atMod", "vibratoDepth_atMod", "tremoloDepth_atMod",
+};
+
+void test_findParam_resolvesEveryNameInOrder(void) {
+    TEST_ASSERT_EQUAL(sizeof(PREVIOUS_PARAM_ORDER) / sizeof(PREVIOUS_PARAM_ORDER[0]), synth::PARAM_COUNT);
+    for (size_t i = 0; i < synth::PARAM_COUNT; i++) {
+        const char* name = PREVIOUS_PARAM_ORDER[i];
+        TEST_ASSERT_EQUAL_STRING(name, synth::SYNTH_PARAMS[i].name);
+        TEST_ASSERT_EQUAL_PTR_MESSAGE(&synth::SYNTH_PARAMS[i], synth::findParam(name), name);
+        TEST_ASSERT_EQUAL_MESSAGE(i, synth::paramIndex(*synth::findParam(name)), name);
+    }
+    TEST_ASSERT_EQUAL(2, synth::paramIndex("filterQ"));
+
+    // Names are matched by length, as they arrive from the command parser
+    const char* line = R"("baseCutoff_atMod")";
+    TEST_ASSERT_EQUAL_PTR(synth::findParam("baseCutoff"), synth::findParam(line + 1, 10));
+    TEST_ASSERT_EQUAL_PTR(synth::findParam("baseCutoff_atMod"), synth::findParam(line + 1, 16));
+
+    // Prefixes and extensions of real names must not match
+    TEST_ASSERT_NULL(synth::findParam("baseCut"));
+    TEST_ASSERT_NULL(synth::findParam("filterQQ"));
+    TEST_ASSERT_NULL(synth::findParam(""));
+    TEST_ASSERT_NULL(synth::findParam("aftertouchRange"));   // A keyboard param, not a voice param
+}
+
+void test_findParamByCC_pointsEachCCAtItsParam(void) {
+    size_t assigned = 0;
+    for (const synth::ParamDescriptor& param : synth::SYNTH_PARAMS) {
+        if (param.cc != synth::NO_CC) {
+            TEST_ASSERT_EQUAL_PTR_MESSAGE(&param, synth::findParamByCC(param.cc), param.name);
+            assigned++;
+        }
+    }
+    size_t mapped = 0;
+    for (int cc = 0; cc < 128; cc++) {
+        if (synth::findParamByCC(static_cast<uint8_t>(cc))) {
+            mapped++;
+        }
+    }
+    TEST_ASSERT_EQUAL(assigned, mapped);
+    TEST_ASSERT_NULL(synth::findParamByCC(synth::NO_CC));
+}
+
+void test_ccCurves_matchPreviousMapping(void) {
+    for (int value = 0; value < 128; value++) {
+        float n = static_cast<float>(value) / 127.0f;
+        uint8_t v = static_cast<uint8_t>(value);
+        TEST_ASSERT_FLOAT_WITHIN(1e-5f, n, synth::findParamByCC(1)->fromCC(v));
+        TEST_ASSERT_FLOAT_WITHIN(1e-2f, 100.0f * std::pow(100.0f, n), synth::findParamByCC(20)->fromCC(v));
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.1f + n * 19.9f, synth::findParamByCC(21)->fromCC(v));
+        TEST_ASSERT_FLOAT_WITHIN(1e-5f, n, synth::findParamByCC(25)->fromCC(v));
+        TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.001f + n * 2.0f, synth::findParamByCC(71)->fromCC(v));
+        TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.01f + n * 5.0f, synth::findParamByCC(72)->fromCC(v));
+        TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.01f + n * 5.0f, synth::findParamByCC(73)->fromCC(v));
+    }
+    TEST_ASSERT_EQUAL_STRING("baseCutoff", synth::findParamByCC(20)->name);
+    // Output processor and action CCs are not voice params
+    for (uint8_t cc : {0, 63, 70, 74, 96, 102, 103, 104, 127}) {
+        TEST_ASSERT_NULL(synth::findParamByCC(cc));
+    }
+}
+
+void test_programData_jsonRoundTripAndDefaults(void) {
+    midi::ProgramData program;
+    program.set("baseCutoff", 222.5f);
+    program.set("filterMode", 3.0f);
+    TEST_ASSERT_FALSE(program.set("noSuchParam", 1.0f));
+
+    nlohmann::json j = program;
+    TEST_ASSERT_EQUAL(synth::PARAM_COUNT, j.size());
+    TEST_ASSERT_TRUE(j["filterMode"].is_number_integer());
+    TEST_ASSERT_EQUAL(3, j["filterMode"].get<int>());
+
+    midi::ProgramData copy = j.get<midi::ProgramData>();
+    for (size_t i = 0; i < synth::PARAM_COUNT; i++) {
+        TEST_ASSERT_EQUAL_FLOAT(program.values[i], copy.values[i]);
+    }
+
+    // Fields missing from an older patch keep their defaults
+    midi::ProgramData partial = nlohmann::json::parse(R"({"filterQ": 2.5})").get<midi::ProgramData>();
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, partial.get("filterQ"));
+    TEST_ASSERT_EQUAL_FLOAT(1000.0f, partial.get("baseCutoff"));
+    TEST_ASSERT_EQUAL_FLOAT(0.7f, partial.get("ampEnvSustain"));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_findParam_resolvesEveryNameInOrder);
+    RUN_TEST(test_findParamByCC_pointsEachCCAtItsParam);
+    RUN_TEST(test_ccCurves_matchPreviousMapping);
+    RUN_TEST(test_programData_jsonRoundTripAndDefaults);
+    return UNITY_END();
+}
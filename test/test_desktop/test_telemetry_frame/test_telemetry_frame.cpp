@@ -0,0 +1,67 @@
+/**
+ * Binary telemetry framing (lib/features/telemetry_frame.hpp)
+ *
+ * Checks that a frame containing every byte that needs escaping survives a
+ * text stream it is interleaved with, and decodes back to the same fields.
+ */
+
+#include <unity.h>
+#include <telemetry_frame.hpp>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void appendBytes(const uint8_t* data, size_t length, void* context) {
+    auto* out = static_cast<std::vector<uint8_t>*>(context);
+    out->insert(out->end(), data, data + length);
+}
+
+void test_telemetryFrame_shouldRoundTripThroughTextStream(void) {
+    // Arrange - a frame whose fields contain every byte that needs escaping
+    std::vector<uint8_t> stream;
+    const char* log = "log\r\n";
+    stream.insert(stream.end(), log, log + 5);
+    features::TelemetryFrameWriter writer(appendBytes, &stream);
+    writer.begin(features::TelemetryType::KeyScan);
+    writer.putU8(features::telemetry_frame::END);
+    writer.putU8(features::telemetry_frame::ESC);
+    writer.putU16(0x0A0A);
+    writer.putF32(1.5f);
+    writer.finish();
+
+    // Act
+    features::TelemetryStreamDecoder<64, 64> decoder;
+    int lines = 0;
+    int frames = 0;
+    for (uint8_t byte : stream) {
+        auto result = decoder.feed(byte);
+        if (result == features::TelemetryStreamDecoder<64, 64>::Result::TextLine) {
+            TEST_ASSERT_EQUAL_STRING("log", decoder.line());
+            lines++;
+        } else if (result == features::TelemetryStreamDecoder<64, 64>::Result::Frame) {
+            TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(features::TelemetryType::KeyScan),
+                                    static_cast<uint8_t>(decoder.frameType()));
+            features::TelemetryFrameReader r = decoder.payload();
+            TEST_ASSERT_EQUAL_UINT8(features::telemetry_frame::END, r.getU8());
+            TEST_ASSERT_EQUAL_UINT8(features::telemetry_frame::ESC, r.getU8());
+            TEST_ASSERT_EQUAL_UINT16(0x0A0A, r.getU16());
+            TEST_ASSERT_EQUAL_FLOAT(1.5f, r.getF32());
+            TEST_ASSERT_FALSE(r.overflowed());
+            frames++;
+        }
+    }
+
+    // Assert - no raw newline may leak into the encoded frame
+    TEST_ASSERT_EQUAL_INT(1, lines);
+    TEST_ASSERT_EQUAL_INT(1, frames);
+    for (size_t i = 5; i < stream.size(); i++) {
+        TEST_ASSERT_NOT_EQUAL('\n', stream[i]);
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_telemetryFrame_shouldRoundTripThroughTextStream);
+    return UNITY_END();
+}
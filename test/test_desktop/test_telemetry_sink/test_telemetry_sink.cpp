@@ -0,0 +1,183 @@
+/**
+ * Linux telemetry sink ring (lib/linux/linux_telemetry_sink.hpp)
+ *
+ * The audio thread hands messages to the sink's ring and never waits for the
+ * writer thread. These tests hold the writer inside its output function so
+ * the ring fills deterministically, then check that the overflow is dropped
+ * and counted rather than blocking, and that everything queued before the
+ * overflow still comes out, in order, once the writer resumes. Output
+ * functions get whole messages only: one too large for the sink's buffer is
+ * dropped and counted, never split.
+ */
+
+#include <unity.h>
+#include <linux_telemetry_sink.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+struct Counter {
+    uint32_t value;
+};
+
+inline void to_json(features::JsonWriter& w, const Counter& c) {
+    w.beginObject();
+    w.field("value", c.value);
+    w.endObject();
+}
+
+inline void to_binary(features::TelemetryFrameWriter& w, const Counter& c) {
+    w.begin(features::TelemetryType::Timing);
+    w.putU32(c.value);
+}
+
+/**
+ * @brief Message whose JSON text is about `length` bytes long
+ */
+struct Padded {
+    uint32_t length;
+};
+
+inline void to_json(features::JsonWriter& w, const Padded& p) {
+    static char padding[2 * 16384];
+    std::memset(padding, 'x', sizeof(padding));
+    w.beginObject();
+    w.key("pad").value(padding, p.length);
+    w.endObject();
+}
+
+inline void to_binary(features::TelemetryFrameWriter& w, const Padded& p) {
+    w.begin(features::TelemetryType::Timing);
+    w.putU32(p.length);
+}
+
+/**
+ * @brief Output function that can hold the writer thread until released
+ */
+struct GatedOutput {
+    std::atomic<bool> open{true};
+    std::atomic<int> entered{0};
+    std::vector<std::string> messages;   // Writer thread only, until the sink is destroyed
+
+    static void write(const char* data, size_t length, void* context) {
+        auto* self = static_cast<GatedOutput*>(context);
+        self->entered++;
+        while (!self->open.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        self->messages.emplace_back(data, length);
+    }
+
+    bool waitEntered(int count) const {
+        for (int i = 0; i < 2000 && entered.load() < count; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return entered.load() >= count;
+    }
+};
+
+void test_fullRing_dropsAndCountsWithoutBlocking(void) {
+    static constexpr size_t CAPACITY = 8;
+    static constexpr uint32_t SENT = 20;
+    GatedOutput output;
+    output.open = false;
+    {
+        linux::LinuxTelemetrySink<Counter, CAPACITY> sink(GatedOutput::write, &output);
+
+        // The writer takes message 0 and blocks in the output function,
+        // still holding its slot
+        sink.sendTelemetry(Counter{0});
+        TEST_ASSERT_TRUE(output.waitEntered(1));
+
+        // Returns while the writer is still held (a blocking ring would hang here)
+        for (uint32_t i = 1; i < SENT; i++) {
+            sink.sendTelemetry(Counter{i});
+        }
+
+        // One slot is always kept free: CAPACITY - 1 messages fit
+        TEST_ASSERT_EQUAL_UINT32(SENT - (CAPACITY - 1), sink.getDroppedCount());
+
+        output.open = true;
+    }   // Destruction flushes what was queued
+
+    TEST_ASSERT_EQUAL_UINT32(CAPACITY - 1, output.messages.size());
+    for (size_t i = 0; i < output.messages.size(); i++) {
+        TEST_ASSERT_EQUAL_STRING(("{\"value\":" + std::to_string(i) + "}\n").c_str(),
+                                 output.messages[i].c_str());
+    }
+}
+
+void test_drainedRing_acceptsMessagesAgain(void) {
+    static constexpr size_t CAPACITY = 4;
+    GatedOutput output;
+    {
+        linux::LinuxTelemetrySink<Counter, CAPACITY> sink(GatedOutput::write, &output);
+        for (uint32_t round = 0; round < 5; round++) {
+            for (uint32_t i = 0; i < CAPACITY - 1; i++) {
+                sink.sendTelemetry(Counter{round * 10 + i});
+            }
+            TEST_ASSERT_TRUE(output.waitEntered(static_cast<int>((round + 1) * (CAPACITY - 1))));
+            // Give the writer time to publish the freed slots
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        TEST_ASSERT_EQUAL_UINT32(0, sink.getDroppedCount());
+    }
+    TEST_ASSERT_EQUAL_UINT32(5 * (CAPACITY - 1), output.messages.size());
+    TEST_ASSERT_EQUAL_STRING("{\"value\":42}\n", output.messages.back().c_str());
+}
+
+void test_oversizedMessage_isDroppedNotSplit(void) {
+    using Sink = linux::LinuxTelemetrySink<Padded>;
+    static constexpr uint32_t LARGE = Sink::OUTPUT_BUFFER_SIZE - 100;   // Fits with the JSON around it
+    GatedOutput output;
+    {
+        Sink sink(GatedOutput::write, &output);
+        sink.sendTelemetry(Padded{LARGE});
+        sink.sendTelemetry(Padded{Sink::OUTPUT_BUFFER_SIZE + 1});
+        sink.sendTelemetry(Padded{3});
+        TEST_ASSERT_TRUE(output.waitEntered(2));
+        TEST_ASSERT_EQUAL_UINT32(1, sink.getOversizedCount());
+        TEST_ASSERT_EQUAL_UINT32(0, sink.getDroppedCount());
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, output.messages.size());
+    TEST_ASSERT_EQUAL_UINT32(LARGE + strlen("{\"pad\":\"\"}\n"), output.messages[0].size());
+    TEST_ASSERT_EQUAL_STRING("{\"pad\":\"xxx\"}\n", output.messages[1].c_str());
+}
+
+void test_fileTarget_receivesJsonLines(void) {
+    char path[] = "/tmp/telemetry_sink_testXXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT_TRUE(fd >= 0);
+    close(fd);
+    {
+        linux::LinuxTelemetrySink<Counter> sink(path);
+        sink.sendTelemetry(Counter{1});
+        sink.sendTelemetry(Counter{2});
+    }
+    FILE* in = fopen(path, "r");
+    TEST_ASSERT_NOT_NULL(in);
+    char text[64] = {};
+    size_t n = fread(text, 1, sizeof(text) - 1, in);
+    fclose(in);
+    unlink(path);
+    text[n] = '\0';
+    TEST_ASSERT_EQUAL_STRING("{\"value\":1}\n{\"value\":2}\n", text);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fullRing_dropsAndCountsWithoutBlocking);
+    RUN_TEST(test_drainedRing_acceptsMessagesAgain);
+    RUN_TEST(test_oversizedMessage_isDroppedNotSplit);
+    RUN_TEST(test_fileTarget_receivesJsonLines);
+    return UNITY_END();
+}
@@ -0,0 +1,168 @@
+/**
+ * Voice arena (lib/features/voice_arena.hpp) and arena-backed voice pools
+ *
+ * Checks that the arena places objects of mixed types aligned, refuses what
+ * doesn't fit, and destroys everything on clear() so the whole region can be
+ * reused; and that a PolyphonicSynthTarget rebuilt with a heavier engine
+ * trades polyphony for it inside the same region, without touching the heap.
+ */
+
+#define RT_SAFETY_GUARD_INTERPOSE
+#include <rt_safety_guard.hpp>
+
+#include <unity.h>
+#include <voice_arena.hpp>
+#include <polyphonic_synth_target.hpp>
+#include <sawtooth_synth.hpp>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+static constexpr float SAMPLE_RATE = 48000.0f;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static std::vector<int> destroyed;
+
+template<int Id, size_t Align>
+struct alignas(Align) Tracked {
+    char payload[Align * 3];
+    ~Tracked() { destroyed.push_back(Id); }
+};
+
+/**
+ * @brief The lightest possible engine: a sine with a gate
+ */
+class SineVoice final : public synth::EngineVoice {
+public:
+    explicit SineVoice(float sampleRate) : sampleRate_(sampleRate) {}
+    void trigger(float frequencyHz, float volume) override { frequency_ = frequencyHz; volume_ = volume; active_ = true; }
+    void release() override { active_ = false; }
+    void setFrequency(float frequencyHz) override { frequency_ = frequencyHz; }
+    void setVolume(float volume) override { volume_ = volume; }
+    void setPitchBend(float) override {}
+    float getPitchBendRange() const override { return 2.0f; }
+    void setPitchBendRange(float) override {}
+    bool isActive() const override { return active_; }
+    void setAftertouch(float) override {}
+    float nextSample() override {
+        if (!active_) {
+            return 0.0f;
+        }
+        phase_ += frequency_ / sampleRate_;
+        phase_ -= std::floor(phase_);
+        return volume_ * std::sin(2.0f * static_cast<float>(M_PI) * phase_);
+    }
+
+private:
+    float sampleRate_;
+    float frequency_ = 440.0f;
+    float volume_ = 0.0f;
+    float phase_ = 0.0f;
+    bool active_ = false;
+};
+
+void test_arena_placesAlignedAndClearsEverything(void) {
+    features::VoiceArena arena(1024);
+    destroyed.clear();
+
+    auto* a = arena.create<Tracked<1, 1>>();
+    auto* b = arena.create<Tracked<2, 64>>();
+    auto* c = arena.create<Tracked<3, 8>>();
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_EQUAL_UINT32(0, reinterpret_cast<uintptr_t>(b) % 64);
+    TEST_ASSERT_EQUAL_UINT32(0, reinterpret_cast<uintptr_t>(c) % 8);
+    TEST_ASSERT_EQUAL_UINT32(3, arena.count());
+
+    // Fill up; the arena refuses rather than overflowing
+    size_t created = 3;
+    while (arena.create<Tracked<4, 64>>()) {
+        created++;
+    }
+    TEST_ASSERT_TRUE(arena.used() <= arena.capacity());
+    TEST_ASSERT_EQUAL_UINT32(created, arena.count());
+
+    // Newest first, and the whole region is free again
+    arena.clear();
+    TEST_ASSERT_EQUAL_UINT32(created, destroyed.size());
+    TEST_ASSERT_EQUAL_INT(4, destroyed.front());
+    TEST_ASSERT_EQUAL_INT(1, destroyed.back());
+    TEST_ASSERT_EQUAL_UINT32(0, arena.used());
+    size_t refilled = 0;
+    while (arena.create<Tracked<4, 64>>()) {
+        refilled++;
+    }
+    TEST_ASSERT_TRUE(refilled >= created - 3);
+}
+
+void test_rebuild_tradesPolyphonyForEngineWeight(void) {
+    static constexpr size_t SLOTS = 32;
+    static constexpr uint8_t HEAVY_VOICES = 4;
+    features::VoiceArena arena(features::VoiceArena::bytesFor<synth::WavetableSynth>(HEAVY_VOICES));
+    platform::PolyphonicSynthTarget<synth::EngineVoice, SLOTS> pool(arena);
+    TEST_ASSERT_EQUAL_UINT8(0, pool.getVoiceCount());
+    pool.noteOn(60, 100);   // No voices yet: ignored
+
+    // The light engine gets several times the polyphony from the same bytes
+    uint8_t lightVoices = pool.rebuild<SineVoice>(SLOTS, SAMPLE_RATE);
+    TEST_ASSERT_TRUE(lightVoices >= 3 * HEAVY_VOICES);
+    TEST_ASSERT_EQUAL_UINT8(lightVoices, pool.getVoiceCount());
+
+    // Switching to the heavy engine gets as many voices as the region was sized for
+    TEST_ASSERT_EQUAL_UINT8(HEAVY_VOICES, pool.rebuild<synth::WavetableSynth>(SLOTS, SAMPLE_RATE));
+    TEST_ASSERT_EQUAL_UINT8(HEAVY_VOICES, pool.getVoiceCount());
+
+    // Voices play through the engine interface, stealing included
+    for (uint8_t note = 60; note < 60 + HEAVY_VOICES + 2; note++) {
+        pool.noteOn(note, 100);
+    }
+    float energy = 0.0f;
+    for (int i = 0; i < 256; i++) {
+        pool.forEachVoice([&energy](synth::EngineVoice& voice) {
+            float sample = voice.nextSample();
+            energy += sample * sample;
+        });
+    }
+    TEST_ASSERT_TRUE(energy > 0.0f);
+
+    // Mixed engines share one pool: whatever space is left takes light voices
+    pool.rebuild<synth::WavetableSynth>(HEAVY_VOICES - 1, SAMPLE_RATE);
+    uint8_t light = pool.addVoices<SineVoice>(SLOTS, SAMPLE_RATE);
+    TEST_ASSERT_TRUE(light > 0);
+    TEST_ASSERT_EQUAL_UINT8(HEAVY_VOICES - 1 + light, pool.getVoiceCount());
+}
+
+void test_rebuild_neverTouchesHeap(void) {
+    static unsigned char region[features::VoiceArena::bytesFor<synth::WavetableSynth>(8)];
+    features::VoiceArena arena(region, sizeof(region));
+    platform::PolyphonicSynthTarget<synth::EngineVoice, 16> pool(arena);
+
+    linux::RtSafetyGuard::reset();
+    {
+        linux::RtSafetyGuard::Scope realtime;
+        for (int program = 0; program < 10; program++) {
+            if (program % 2) {
+                pool.rebuild<SineVoice>(16, SAMPLE_RATE);
+            } else {
+                pool.rebuild<synth::WavetableSynth>(16, SAMPLE_RATE);
+            }
+            pool.noteOn(60, 100);
+            pool.forEachVoice([](synth::EngineVoice& voice) { voice.nextSample(); });
+        }
+    }
+    if (linux::RtSafetyGuard::violationCount() > 0) {
+        linux::RtSafetyGuard::report(stdout);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, linux::RtSafetyGuard::violationCount());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_arena_placesAlignedAndClearsEverything);
+    RUN_TEST(test_rebuild_tradesPolyphonyForEngineWeight);
+    RUN_TEST(test_rebuild_neverTouchesHeap);
+    return UNITY_END();
+}
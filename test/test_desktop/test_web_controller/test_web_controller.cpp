@@ -0,0 +1,230 @@
+/**
+ * Control panel commands through SynthApplication's web controller
+ *
+ * Commands arrive in chunks on the control side, while param changes are
+ * applied by the audio thread between blocks. These tests check that the
+ * startup program is loaded and reported, that commands later in a chunk see
+ * the changes made earlier in it (a program load replaces them, a program
+ * save or getParams reports them, whether or not a block has been rendered
+ * in between), and that paramsDelta pushes carry just the changed params.
+ */
+
+#include <unity.h>
+#include <synth_application.hpp>
+#include <performance_timer.hpp>
+#include <program_storage.hpp>
+#include <program_data.hpp>
+#include <json.hpp>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+static constexpr unsigned int SAMPLE_RATE = 48000;
+static constexpr unsigned int CHANNELS = 2;
+static constexpr uint8_t MAX_VOICES = 4;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * @brief Program storage kept in memory; unknown slots load the defaults
+ */
+class MemoryProgramStorage : public features::ProgramStorage {
+public:
+    bool loadProgram(uint8_t program, VoiceIterator forEachVoice) override {
+        auto it = programs.find(program);
+        midi::applyProgramToVoices(it != programs.end() ? it->second : midi::ProgramData(), forEachVoice);
+        return it != programs.end();
+    }
+
+    bool saveProgram(uint8_t program, VoiceIterator forEachVoice) override {
+        programs[program].captureFromVoices(forEachVoice);
+        return true;
+    }
+
+    std::map<uint8_t, midi::ProgramData> programs;
+};
+
+/**
+ * @brief SynthApplication with in-memory storage and its command output captured
+ */
+struct Fixture {
+    MemoryProgramStorage* storage;
+    std::unique_ptr<platform::SynthApplication> synth;
+    std::string output;
+
+    Fixture() {
+        auto owned = std::make_unique<MemoryProgramStorage>();
+        storage = owned.get();
+        midi::ProgramData program;
+        program.set("baseCutoff", 333.0f);
+        storage->programs[3] = program;
+        program.set("baseCutoff", 111.0f);
+        program.set("vibratoRate", 7.5f);
+        storage->programs[1] = program;      // Loaded at startup
+        synth = std::make_unique<platform::SynthApplication>(SAMPLE_RATE, CHANNELS, MAX_VOICES, std::move(owned));
+        synth->setCommandOutput(capture, this);
+    }
+
+    static void capture(const char* data, size_t length, void* context) {
+        static_cast<Fixture*>(context)->output.append(data, length);
+    }
+
+    void send(const std::string& chunk) {
+        synth->processCommandBytes(chunk.data(), chunk.size());
+    }
+
+    void render() {
+        float buffer[64 * CHANNELS];
+        features::LapTimer<features::NoOpTimingPolicy, 12> timer;
+        synth->renderAudio(buffer, 64, timer);
+    }
+
+    /**
+     * @brief The messages of a type sent since the last call, oldest first
+     */
+    std::vector<nlohmann::json> take(const char* type) {
+        std::vector<nlohmann::json> messages;
+        size_t start = 0;
+        size_t end;
+        while ((end = output.find('\n', start)) != std::string::npos) {
+            nlohmann::json message = nlohmann::json::parse(output.substr(start, end - start));
+            if (message.value("type", "") == type) {
+                messages.push_back(message);
+            }
+            start = end + 1;
+        }
+        output.clear();
+        return messages;
+    }
+
+    float voiceParam(const char* name) {
+        float value = 0.0f;
+        synth->getVoicePool().forEachVoice([name, &value](synth::WavetableSynth& voice) {
+            value = synth::findParam(name)->get(voice);
+        });
+        return value;
+    }
+};
+
+void test_construction_loadsStartupProgram(void) {
+    Fixture f;
+    TEST_ASSERT_EQUAL_FLOAT(111.0f, f.voiceParam("baseCutoff"));
+    TEST_ASSERT_EQUAL_FLOAT(7.5f, f.voiceParam("vibratoRate"));
+
+    f.send(R"({"cmd":"getParams"})" "\n");
+    std::vector<nlohmann::json> params = f.take("params");
+    TEST_ASSERT_EQUAL_UINT32(1, params.size());
+    TEST_ASSERT_EQUAL_FLOAT(111.0f, params[0]["baseCutoff"].get<float>());
+    TEST_ASSERT_EQUAL_FLOAT(7.5f, params[0]["vibratoRate"].get<float>());
+}
+
+void test_loadProgram_replacesEarlierChangesInChunk(void) {
+    Fixture f;
+    f.send(R"({"cmd":"setParam","param":"baseCutoff","value":999})" "\n"
+           R"({"cmd":"setParam","param":"filterQ","value":9})" "\n"
+           R"({"cmd":"loadProgram","bank":0,"program":3})" "\n");
+    std::vector<nlohmann::json> params = f.take("params");
+    TEST_ASSERT_EQUAL_UINT32(1, params.size());
+    TEST_ASSERT_EQUAL_FLOAT(333.0f, params[0]["baseCutoff"].get<float>());
+    TEST_ASSERT_EQUAL_FLOAT(midi::ProgramData().get("filterQ"), params[0]["filterQ"].get<float>());
+
+    f.render();
+    TEST_ASSERT_EQUAL_FLOAT(333.0f, f.voiceParam("baseCutoff"));
+    TEST_ASSERT_EQUAL_FLOAT(midi::ProgramData().get("filterQ"), f.voiceParam("filterQ"));
+}
+
+void test_saveProgram_includesEarlierChangesInChunk(void) {
+    Fixture f;
+    f.send(R"({"cmd":"setParam","param":"baseCutoff","value":444})" "\n"
+           R"({"cmd":"saveProgram","bank":0,"program":5})" "\n");
+    TEST_ASSERT_EQUAL_FLOAT(444.0f, f.storage->programs[5].get("baseCutoff"));
+
+    // Saved from the params, not the voices, which haven't rendered since
+    TEST_ASSERT_NOT_EQUAL(444.0f, f.voiceParam("baseCutoff"));
+}
+
+void test_getParams_includesEarlierChangesInChunk(void) {
+    Fixture f;
+    f.send(R"({"cmd":"setParam","param":"baseCutoff","value":555})" "\n"
+           R"({"cmd":"getParams"})" "\n");
+    std::vector<nlohmann::json> params = f.take("params");
+    TEST_ASSERT_EQUAL_UINT32(1, params.size());
+    TEST_ASSERT_EQUAL_FLOAT(555.0f, params[0]["baseCutoff"].get<float>());
+
+    // More separate changes than the queue holds, with no block rendered
+    for (int i = 1; i <= 12; i++) {
+        f.send(R"({"cmd":"setParam","param":"filterQ","value":)" + std::to_string(i) + "}\n");
+    }
+    f.send(R"({"cmd":"getParams"})" "\n");
+    params = f.take("params");
+    TEST_ASSERT_EQUAL_UINT32(1, params.size());
+    TEST_ASSERT_EQUAL_FLOAT(12.0f, params[0]["filterQ"].get<float>());
+    TEST_ASSERT_EQUAL_FLOAT(555.0f, params[0]["baseCutoff"].get<float>());
+
+    // What didn't fit is handed over once the audio thread makes room
+    f.render();
+    f.synth->pushParamChanges(0);
+    f.render();
+    TEST_ASSERT_EQUAL_FLOAT(12.0f, f.voiceParam("filterQ"));
+    f.send(R"({"cmd":"getParams"})" "\n");
+    params = f.take("params");
+    TEST_ASSERT_EQUAL_FLOAT(12.0f, params[0]["filterQ"].get<float>());
+}
+
+/**
+ * @brief Check a paramsDelta message holds exactly the expected params and values
+ */
+static void assertDelta(const nlohmann::json& delta, const std::map<std::string, float>& expected) {
+    TEST_ASSERT_EQUAL_UINT32(expected.size() + 1, delta.size());   // Plus "type"
+    for (const auto& entry : expected) {
+        TEST_ASSERT_TRUE_MESSAGE(delta.contains(entry.first), entry.first.c_str());
+        TEST_ASSERT_EQUAL_FLOAT(entry.second, delta[entry.first].get<float>());
+    }
+}
+
+void test_paramsDelta_reportsOnlyChangedParams(void) {
+    Fixture f;
+    f.synth->setParamPushInterval(100);
+
+    // The startup program changed every param
+    TEST_ASSERT_TRUE(f.synth->pushParamChanges(1000));
+    std::vector<nlohmann::json> deltas = f.take("paramsDelta");
+    TEST_ASSERT_EQUAL_UINT32(1, deltas.size());
+    TEST_ASSERT_EQUAL_UINT32(synth::PARAM_COUNT + 1, deltas[0].size());
+
+    // Queued batches are reported once the audio thread has applied them
+    f.send(R"({"cmd":"setParams","params":{"baseCutoff":321,"filterQ":4}})" "\n");
+    f.take("cmdResponse");
+    f.render();
+    TEST_ASSERT_TRUE(f.synth->pushParamChanges(1100));
+    deltas = f.take("paramsDelta");
+    TEST_ASSERT_EQUAL_UINT32(1, deltas.size());
+    assertDelta(deltas[0], {{"baseCutoff", 321.0f}, {"filterQ", 4.0f}});
+
+    // So are MIDI CCs, at most once per interval
+    for (uint8_t byte : {0xB0, 20, 64}) {
+        f.synth->processMidiByte(byte);
+    }
+    f.render();
+    TEST_ASSERT_FALSE(f.synth->pushParamChanges(1150));   // Within the interval
+    TEST_ASSERT_TRUE(f.synth->pushParamChanges(1200));
+    deltas = f.take("paramsDelta");
+    TEST_ASSERT_EQUAL_UINT32(1, deltas.size());
+    assertDelta(deltas[0], {{"baseCutoff", synth::findParamByCC(20)->fromCC(64)}});
+
+    TEST_ASSERT_FALSE(f.synth->pushParamChanges(1400));   // Nothing changed
+    TEST_ASSERT_EQUAL_UINT32(0, f.output.size());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_construction_loadsStartupProgram);
+    RUN_TEST(test_loadProgram_replacesEarlierChangesInChunk);
+    RUN_TEST(test_saveProgram_includesEarlierChangesInChunk);
+    RUN_TEST(test_getParams_includesEarlierChangesInChunk);
+    RUN_TEST(test_paramsDelta_reportsOnlyChangedParams);
+    return UNITY_END();
+}
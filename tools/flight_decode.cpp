@@ -0,0 +1,165 @@
+/**
+ * Pressence flight recorder decoder
+ *
+ * Dumps the events in a flight recorder file (written by the Linux build with
+ * --flight-recorder=<file>) as text, oldest first. Works on the file of a
+ * running, stopped or crashed process.
+ *
+ * Build (from the repository root):
+ *   g++ -std=c++17 -O2 -Ilib/features -Ilib/linux -Ilib/platform tools/flight_decode.cpp -o flight_decode
+ *
+ * Usage:
+ *   ./flight_decode flight.bin                 # Everything in the ring
+ *   ./flight_decode flight.bin --seconds 5     # Last 5 seconds
+ *   ./flight_decode flight.bin --xrun          # 2 seconds either side of the last xrun
+ *   ./flight_decode flight.bin --xrun --seconds 0.5
+ *
+ * Times are printed relative to the anchor (the last event, or the xrun).
+ */
+
+#include <mmap_flight_recorder.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+using features::FlightEvent;
+namespace flight_record = linux::flight_record;
+using flight_record::Event;
+
+static const char* eventName(uint8_t event) {
+    switch (static_cast<FlightEvent>(event)) {
+        case FlightEvent::MidiIn:        return "midi_in";
+        case FlightEvent::VoiceAllocate: return "voice_alloc";
+        case FlightEvent::VoiceSteal:    return "voice_steal";
+        case FlightEvent::VoiceRelease:  return "voice_release";
+        case FlightEvent::ProgramChange: return "program";
+        case FlightEvent::BlockRender:   return "render";
+        case FlightEvent::Xrun:          return "XRUN";
+    }
+    return "unknown";
+}
+
+static void printDetails(const Event& e) {
+    switch (static_cast<FlightEvent>(e.event)) {
+        case FlightEvent::MidiIn:
+            printf("0x%02X", e.a);
+            break;
+        case FlightEvent::VoiceAllocate:
+        case FlightEvent::VoiceRelease:
+            printf("note %u voice %u", e.a, e.b);
+            break;
+        case FlightEvent::VoiceSteal:
+            printf("note %u voice %u (stole note %u)", e.a, e.b, e.value);
+            break;
+        case FlightEvent::ProgramChange:
+            printf("program %u", e.a);
+            break;
+        case FlightEvent::BlockRender:
+            printf("%u frames in %.1f us", e.b, e.value / 1000.0);
+            break;
+        case FlightEvent::Xrun:
+            printf("xrun #%u", e.value);
+            break;
+        default:
+            printf("a=%u b=%u value=%u", e.a, e.b, e.value);
+            break;
+    }
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s <file> [--seconds N] [--xrun]\n", program);
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    double seconds = -1.0;
+    bool aroundXrun = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--xrun") == 0) {
+            aroundXrun = true;
+        } else if (path == nullptr) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (path == nullptr) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (aroundXrun && seconds < 0) {
+        seconds = 2.0;
+    }
+
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(in);
+
+    flight_record::Recording recording;
+    if (!flight_record::decode(data.data(), data.size(), recording)) {
+        fprintf(stderr, "%s: not a flight recorder file (or unsupported version)\n", path);
+        return 1;
+    }
+    const flight_record::Header* header = recording.header;
+    const std::vector<Event>& events = recording.events;
+
+    printf("# %s: %zu events (%llu recorded, ring of %llu)\n", path, events.size(),
+           static_cast<unsigned long long>(recording.recorded),
+           static_cast<unsigned long long>(header->capacity));
+    if (recording.unpublished > 0) {
+        printf("# %zu events were being written when recording stopped\n", recording.unpublished);
+    }
+    if (recording.torn > 0) {
+        printf("# %zu slots skipped as inconsistent\n", recording.torn);
+    }
+    if (events.empty()) {
+        return 0;
+    }
+
+    // Choose the anchor: the last xrun, or the newest event
+    uint64_t anchorNs = events.back().timestampNs;
+    if (aroundXrun) {
+        auto it = std::find_if(events.rbegin(), events.rend(),
+                               [](const Event& e) { return e.event == static_cast<uint8_t>(FlightEvent::Xrun); });
+        if (it == events.rend()) {
+            printf("# no xrun recorded\n");
+            return 0;
+        }
+        anchorNs = it->timestampNs;
+    }
+
+    // Anchor wall-clock time
+    uint64_t anchorRealtimeNs = header->startRealtimeNs + (anchorNs - header->startMonotonicNs);
+    time_t anchorSeconds = static_cast<time_t>(anchorRealtimeNs / 1'000'000'000ULL);
+    char when[64];
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&anchorSeconds));
+    printf("# anchor (%s) at %s.%06llu\n", aroundXrun ? "last xrun" : "last event", when,
+           static_cast<unsigned long long>(anchorRealtimeNs % 1'000'000'000ULL / 1000));
+
+    const int64_t windowNs = seconds < 0 ? INT64_MAX : static_cast<int64_t>(seconds * 1e9);
+    for (const Event& e : events) {
+        int64_t offsetNs = static_cast<int64_t>(e.timestampNs - anchorNs);
+        if (offsetNs < -windowNs || (aroundXrun && offsetNs > windowNs)) {
+            continue;
+        }
+        printf("%+12.6f  %-13s  ", offsetNs / 1e9, eventName(e.event));
+        printDetails(e);
+        printf("\n");
+    }
+    return 0;
+}
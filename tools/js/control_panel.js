@@ -46,8 +46,9 @@ window.controlPanel = (function() {
     // Current parameter values
     let currentParams = {};
     
-    // Debounce timer for parameter changes
+    // Debounced parameter changes, sent together as one setParams command
     let sendTimer = null;
+    let pendingParams = {};
     const SEND_DELAY = 50; // ms
     
     /**
@@ -257,15 +258,23 @@ window.controlPanel = (function() {
     
     /**
      * Schedule parameter send with debouncing
+     *
+     * Changes made within SEND_DELAY of each other (e.g. dragging a knob, or
+     * several knobs) are coalesced and sent as one setParams command, which
+     * the device applies at a single audio block boundary.
      */
     function scheduleParamSend(paramName, value) {
+        pendingParams[paramName] = value;
         if (sendTimer) {
             clearTimeout(sendTimer);
         }
         
         sendTimer = setTimeout(() => {
+            sendTimer = null;
+            const params = pendingParams;
+            pendingParams = {};
             if (window.serialManager && window.serialManager.isConnected()) {
-                window.serialManager.setParam(paramName, value);
+                window.serialManager.setParams(params);
             }
         }, SEND_DELAY);
     }
@@ -325,6 +334,21 @@ window.controlPanel = (function() {
         });
     }
     
+    /**
+     * Update knobs for a paramsDelta message (changed params only)
+     * @param {Object} changes Changed parameter values from device
+     */
+    function applyParamChanges(changes) {
+        for (const key of Object.keys(changes)) {
+            if (key === 'type') continue;
+            // A pending local edit is newer than what the device reports
+            if (key in pendingParams) continue;
+            const container = document.querySelector(`.knob-container[data-param="${key}"]`);
+            if (!container) continue;
+            markKnobValue(container, key, changes[key], key.endsWith('_atMod'));
+        }
+    }
+    
     /**
      * Create a parameter group section
      * @param {string} title Section title
@@ -386,6 +410,7 @@ window.controlPanel = (function() {
         PARAMS: PARAMS,
         init: init,
         updateFromDevice: updateFromDevice,
+        applyParamChanges: applyParamChanges,
         createKnob: createKnob,
         createDualKnob: createDualKnob
     };
@@ -2,7 +2,8 @@
  * Pressence Serial Connection Manager
  * 
  * Provides Web Serial API wrapper for bidirectional communication
- * with the Pressence synthesizer.
+ * with the Pressence synthesizer. Incoming bytes are split into text lines
+ * (logs and JSON) and binary telemetry frames by telemetry_codec.js.
  */
 
 window.serialManager = (function() {
@@ -10,7 +11,6 @@ window.serialManager = (function() {
     let reader = null;
     let writer = null;
     let keepReading = false;
-    let lineBuffer = '';
     
     // Callbacks for received data
     let onLineReceived = null;
@@ -120,6 +120,17 @@ window.serialManager = (function() {
         return send({ cmd: 'setParam', param: param, value: value });
     }
     
+    /**
+     * Send several parameters in one setParams command
+     *
+     * The device applies them together and replies with a single
+     * cmdResponse listing any rejected names in "errors".
+     * @param {Object} params Map of parameter name to value
+     */
+    async function setParams(params) {
+        return send({ cmd: 'setParams', params: params });
+    }
+    
     /**
      * Request current parameters
      */
@@ -146,8 +157,50 @@ window.serialManager = (function() {
     }
     
     /**
-     * Set callback for received lines
-     * @param {Function} callback Function(line, parsedJson)
+     * Switch key scan telemetry to deltas for a range of keys
+     * @param {Object} options {first, count, maxRate, deadband, keyframeInterval};
+     *        omitted fields use the device defaults
+     */
+    async function subscribeKeyScan(options = {}) {
+        return send(Object.assign({ cmd: 'subscribeKeyScan' }, options));
+    }
+    
+    /**
+     * Return to full key scan frames every scan
+     */
+    async function unsubscribeKeyScan() {
+        return send({ cmd: 'unsubscribeKeyScan' });
+    }
+    
+    /**
+     * Trade audio latency for efficiency
+     * @param {string} profile 'lowLatency' or 'efficiency'
+     */
+    async function setLatencyProfile(profile) {
+        return send({ cmd: 'setLatencyProfile', profile: profile });
+    }
+    
+    /**
+     * Start audio meter/spectrum telemetry for the output or one voice
+     * @param {number} voice Voice index, or -1 for the output
+     * @param {number} decimation Keep every Nth sample (narrows the spectrum)
+     */
+    async function subscribeAudioTap(voice = -1, decimation = 1) {
+        return send({ cmd: 'subscribeAudioTap', voice: voice, decimation: decimation });
+    }
+    
+    /**
+     * Stop audio meter telemetry
+     * @param {number} voice Voice index, or -1 for the output
+     */
+    async function unsubscribeAudioTap(voice = -1) {
+        return send({ cmd: 'unsubscribeAudioTap', voice: voice });
+    }
+    
+    /**
+     * Set callback for received lines and telemetry frames
+     * @param {Function} callback Function(line, parsedJson); binary telemetry
+     *        frames are delivered with an empty line and the decoded object
      */
     function setLineCallback(callback) {
         onLineReceived = callback;
@@ -165,9 +218,21 @@ window.serialManager = (function() {
      * Internal read loop
      */
     async function readLoop() {
-        const textDecoder = new TextDecoderStream();
-        const readableStreamClosed = port.readable.pipeTo(textDecoder.writable);
-        reader = textDecoder.readable.getReader();
+        reader = port.readable.getReader();
+        const push = telemetryCodec.createStreamDecoder(
+            (line) => {
+                line = line.trim();
+                if (line.length > 0) {
+                    processLine(line);
+                }
+            },
+            (decoded) => {
+                // Binary telemetry frames arrive already decoded
+                if (onLineReceived) {
+                    onLineReceived('', decoded);
+                }
+            }
+        );
         
         try {
             while (keepReading) {
@@ -177,18 +242,7 @@ window.serialManager = (function() {
                     break;
                 }
                 
-                lineBuffer += value;
-                
-                // Process complete lines
-                let newlineIndex;
-                while ((newlineIndex = lineBuffer.indexOf('\n')) !== -1) {
-                    const line = lineBuffer.substring(0, newlineIndex).trim();
-                    lineBuffer = lineBuffer.substring(newlineIndex + 1);
-                    
-                    if (line.length > 0) {
-                        processLine(line);
-                    }
-                }
+                push(value);
             }
         } catch (error) {
             console.error('Read error:', error);
@@ -222,9 +276,15 @@ window.serialManager = (function() {
         disconnect: disconnect,
         send: send,
         setParam: setParam,
+        setParams: setParams,
         getParams: getParams,
         saveProgram: saveProgram,
         loadProgram: loadProgram,
+        subscribeKeyScan: subscribeKeyScan,
+        unsubscribeKeyScan: unsubscribeKeyScan,
+        setLatencyProfile: setLatencyProfile,
+        subscribeAudioTap: subscribeAudioTap,
+        unsubscribeAudioTap: unsubscribeAudioTap,
         setLineCallback: setLineCallback,
         setStatusCallback: setStatusCallback
     };
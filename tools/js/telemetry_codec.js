@@ -0,0 +1,267 @@
+/**
+ * Pressence Telemetry Codec
+ *
+ * Splits the raw serial byte stream into text lines and binary telemetry
+ * frames, and decodes binary frames into the same objects the JSON telemetry
+ * produces. Mirrors lib/features/telemetry_frame.hpp and the to_binary()
+ * functions next to each telemetry struct's to_json().
+ */
+
+window.telemetryCodec = (function() {
+    const VERSION = 1;
+    const END = 0xC0;
+    const ESC = 0xDB;
+    const ESC_END = 0xDC;
+    const ESC_ESC = 0xDD;
+    const ESC_LF = 0xDE;
+
+    const TYPE_KEY_SCAN = 1;
+    const TYPE_TIMING = 2;
+    const TYPE_KEY_SCAN_DELTA = 3;
+    const TYPE_AUDIO_METER = 4;
+
+    const MAX_LINE = 65536;
+    const MAX_FRAME = 65536;
+
+    /**
+     * CRC-16/CCITT-FALSE over a byte range
+     */
+    function crc16(bytes, length) {
+        let crc = 0xFFFF;
+        for (let i = 0; i < length; i++) {
+            crc ^= bytes[i] << 8;
+            for (let bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+                crc &= 0xFFFF;
+            }
+        }
+        return crc;
+    }
+
+    /**
+     * Little-endian field reader over a frame payload
+     */
+    function createReader(bytes) {
+        const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+        const textDecoder = new TextDecoder();
+        let pos = 0;
+
+        function need(n) {
+            if (pos + n > bytes.length) {
+                throw new Error('Truncated telemetry frame');
+            }
+        }
+
+        return {
+            u8() { need(1); return view.getUint8(pos++); },
+            bool() { return this.u8() !== 0; },
+            u16() { need(2); const v = view.getUint16(pos, true); pos += 2; return v; },
+            u32() { need(4); const v = view.getUint32(pos, true); pos += 4; return v; },
+            u64() {
+                // Exact up to 2^53, which covers any realistic cycle count
+                const lo = this.u32();
+                const hi = this.u32();
+                return hi * 4294967296 + lo;
+            },
+            f32() { need(4); const v = view.getFloat32(pos, true); pos += 4; return v; },
+            string() {
+                const len = this.u8();
+                need(len);
+                const s = textDecoder.decode(bytes.subarray(pos, pos + len));
+                pos += len;
+                return s;
+            }
+        };
+    }
+
+    function decodeKeyScan(r) {
+        const keyCount = r.u16();
+        const data = {
+            type: 'keyScan',
+            keyCount: keyCount,
+            isCalibrated: r.bool(),
+            calibrationCount: r.u16(),
+            noteOnThreshold: r.f32(),
+            noteOffThreshold: r.f32()
+        };
+        const array = (read) => Array.from({ length: keyCount }, read);
+        data.readings = array(() => r.u16());
+        data.baselines = array(() => r.f32());
+        data.ratios = array(() => r.f32());
+        data.noteStates = array(() => r.bool());
+        data.aftertouchValues = array(() => r.u8());
+        return data;
+    }
+
+    function decodeKeyScanDelta(r) {
+        const data = {
+            type: 'keyScanDelta',
+            keyCount: r.u16(),
+            isCalibrated: r.bool(),
+            calibrationCount: r.u16(),
+            noteOnThreshold: r.f32(),
+            noteOffThreshold: r.f32(),
+            keyframe: r.bool()
+        };
+        const count = r.u16();
+        const array = (read) => Array.from({ length: count }, read);
+        data.keys = array(() => r.u16());
+        data.readings = array(() => r.u16());
+        data.baselines = array(() => r.f32());
+        data.ratios = array(() => r.f32());
+        data.noteStates = array(() => r.bool());
+        data.aftertouchValues = array(() => r.u8());
+        return data;
+    }
+
+    function decodeAudioMeter(r) {
+        const voice = (r.u16() << 16) >> 16;  // int16
+        const data = {
+            type: 'audioMeter',
+            source: voice < 0 ? 'output' : 'voice',
+            voice: voice,
+            decimation: r.u16(),
+            sampleRate: r.f32(),
+            peak: r.f32(),
+            rms: r.f32(),
+            droppedBlocks: r.u32()
+        };
+        const bandCount = r.u8();
+        data.bands = Array.from({ length: bandCount }, () => r.f32());
+        return data;
+    }
+
+    function decodeTiming(r) {
+        const data = {
+            type: 'timing',
+            unit: r.string(),
+            lapCount: r.u32(),
+            droppedSpans: r.u32(),
+            spans: []
+        };
+        const spanCount = r.u8();
+        for (let i = 0; i < spanCount; i++) {
+            data.spans.push({
+                name: r.string(),
+                min: r.u64(),
+                max: r.u64(),
+                total: r.u64(),
+                count: r.u32()
+            });
+        }
+        return data;
+    }
+
+    /**
+     * Decode an unescaped frame (version .. crc) into a telemetry object
+     * @returns {Object|null} Decoded object, or null if the frame is invalid
+     */
+    function decodeFrame(frame) {
+        if (frame.length < 4 || frame[0] !== VERSION) {
+            return null;
+        }
+        const expected = frame[frame.length - 2] | (frame[frame.length - 1] << 8);
+        if (crc16(frame, frame.length - 2) !== expected) {
+            return null;
+        }
+        const r = createReader(frame.subarray(2, frame.length - 2));
+        try {
+            switch (frame[1]) {
+                case TYPE_KEY_SCAN: return decodeKeyScan(r);
+                case TYPE_TIMING: return decodeTiming(r);
+                case TYPE_KEY_SCAN_DELTA: return decodeKeyScanDelta(r);
+                case TYPE_AUDIO_METER: return decodeAudioMeter(r);
+                default: return null;
+            }
+        } catch (e) {
+            console.warn('Telemetry frame decode error:', e.message);
+            return null;
+        }
+    }
+
+    /**
+     * Create a byte stream splitter
+     * @param {Function} onLine Called with each text line (string, '\r' removed)
+     * @param {Function} onFrame Called with each decoded binary telemetry object
+     * @returns {Function} push(Uint8Array) to feed received bytes
+     */
+    function createStreamDecoder(onLine, onFrame) {
+        const textDecoder = new TextDecoder();
+        let line = new Uint8Array(256);
+        let lineLength = 0;
+        const frame = new Uint8Array(MAX_FRAME);
+        let frameLength = 0;
+        let inFrame = false;
+        let escaped = false;
+        let frameValid = true;
+
+        function appendLineByte(byte) {
+            if (lineLength === line.length) {
+                if (line.length >= MAX_LINE) return;
+                const grown = new Uint8Array(line.length * 2);
+                grown.set(line);
+                line = grown;
+            }
+            line[lineLength++] = byte;
+        }
+
+        return function push(bytes) {
+            for (let i = 0; i < bytes.length; i++) {
+                let byte = bytes[i];
+
+                if (byte === END) {
+                    if (inFrame && frameLength > 0) {
+                        inFrame = false;
+                        const decoded = frameValid ? decodeFrame(frame.subarray(0, frameLength)) : null;
+                        if (decoded) {
+                            onFrame(decoded);
+                        } else {
+                            console.warn('Dropped invalid telemetry frame');
+                        }
+                    } else {
+                        inFrame = true;
+                        escaped = false;
+                        frameLength = 0;
+                        frameValid = true;
+                    }
+                    continue;
+                }
+
+                if (inFrame) {
+                    if (escaped) {
+                        escaped = false;
+                        if (byte === ESC_END) byte = END;
+                        else if (byte === ESC_ESC) byte = ESC;
+                        else if (byte === ESC_LF) byte = 0x0A;
+                        else frameValid = false;
+                    } else if (byte === ESC) {
+                        escaped = true;
+                        continue;
+                    }
+                    if (frameLength < MAX_FRAME) {
+                        frame[frameLength++] = byte;
+                    } else {
+                        frameValid = false;
+                    }
+                    continue;
+                }
+
+                if (byte === 0x0D) {
+                    continue;
+                }
+                if (byte === 0x0A) {
+                    onLine(textDecoder.decode(line.subarray(0, lineLength)));
+                    lineLength = 0;
+                    continue;
+                }
+                appendLineByte(byte);
+            }
+        };
+    }
+
+    // Public API
+    return {
+        createStreamDecoder: createStreamDecoder,
+        decodeFrame: decodeFrame
+    };
+})();
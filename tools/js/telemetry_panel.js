@@ -16,14 +16,18 @@ window.telemetryPanel = (function() {
     let logsEl = null;
     let infoGridEl = null;
     let timingBarsEl = null;
+    let audioMeterEl = null;
     let rawJsonEl = null;
     let autoScrollEnabled = true;
     
     // Raw JSON storage
     const rawJsonData = {
         keyScan: null,
+        keyScanDelta: null,
         timing: null,
+        audioMeter: null,
         params: null,
+        paramsDelta: null,
         cmdResponse: null
     };
     
@@ -50,6 +54,10 @@ window.telemetryPanel = (function() {
                         <h3>Audio Timing</h3>
                         <div id="timingBars"></div>
                     </div>
+                    <div class="timing-panel" id="audioMeterPanel" style="display: none;">
+                        <h3>Audio Output</h3>
+                        <div id="audioMeter"></div>
+                    </div>
                 </div>
             </div>
             <div class="log-panel">
@@ -67,8 +75,11 @@ window.telemetryPanel = (function() {
                     <h3>Raw JSON</h3>
                     <select id="jsonTypeSelect">
                         <option value="keyScan">keyScan</option>
+                        <option value="keyScanDelta">keyScanDelta</option>
                         <option value="timing">timing</option>
+                        <option value="audioMeter">audioMeter</option>
                         <option value="params">params</option>
+                        <option value="paramsDelta">paramsDelta</option>
                         <option value="cmdResponse">cmdResponse</option>
                     </select>
                 </div>
@@ -82,6 +93,7 @@ window.telemetryPanel = (function() {
         logsEl = document.getElementById('logs');
         infoGridEl = document.getElementById('infoGrid');
         timingBarsEl = document.getElementById('timingBars');
+        audioMeterEl = document.getElementById('audioMeter');
         rawJsonEl = document.getElementById('rawJson');
         
         // Setup event handlers
@@ -110,12 +122,24 @@ window.telemetryPanel = (function() {
                 updateInfo();
                 break;
                 
+            case 'keyScanDelta':
+                rawJsonData.keyScanDelta = data;
+                telemetryData = mergeKeyScanDelta(telemetryData, data);
+                rawJsonData.keyScan = telemetryData;
+                updateInfo();
+                break;
+                
             case 'timing':
                 timingData = data;
                 rawJsonData.timing = data;
                 updateTimingDisplay();
                 break;
                 
+            case 'audioMeter':
+                rawJsonData.audioMeter = data;
+                updateAudioMeterDisplay(data);
+                break;
+                
             case 'params':
                 rawJsonData.params = data;
                 // Forward to control panel
@@ -124,6 +148,14 @@ window.telemetryPanel = (function() {
                 }
                 break;
                 
+            case 'paramsDelta':
+                rawJsonData.paramsDelta = data;
+                // Only the changed params; the rest keep their values
+                if (window.controlPanel) {
+                    window.controlPanel.applyParamChanges(data);
+                }
+                break;
+                
             case 'cmdResponse':
                 rawJsonData.cmdResponse = data;
                 break;
@@ -132,6 +164,43 @@ window.telemetryPanel = (function() {
         updateRawJsonDisplay();
     }
     
+    /**
+     * Apply a keyScanDelta message to the last full key scan state
+     * 
+     * Delta arrays are packed: entry i belongs to key delta.keys[i]. Until a
+     * full frame or keyframe has been seen, unsent keys read as zero.
+     * @param {Object|null} state Previous keyScan-shaped state
+     * @param {Object} delta keyScanDelta message
+     * @returns {Object} Updated keyScan-shaped state
+     */
+    function mergeKeyScanDelta(state, delta) {
+        const n = delta.keyCount;
+        if (!state || state.keyCount !== n) {
+            state = {
+                type: 'keyScan',
+                keyCount: n,
+                readings: new Array(n).fill(0),
+                baselines: new Array(n).fill(0),
+                ratios: new Array(n).fill(0),
+                noteStates: new Array(n).fill(false),
+                aftertouchValues: new Array(n).fill(0)
+            };
+        }
+        state.isCalibrated = delta.isCalibrated;
+        state.calibrationCount = delta.calibrationCount;
+        state.noteOnThreshold = delta.noteOnThreshold;
+        state.noteOffThreshold = delta.noteOffThreshold;
+        delta.keys.forEach((key, i) => {
+            if (key >= n) return;
+            state.readings[key] = delta.readings[i];
+            state.baselines[key] = delta.baselines[i];
+            state.ratios[key] = delta.ratios[i];
+            state.noteStates[key] = delta.noteStates[i];
+            state.aftertouchValues[key] = delta.aftertouchValues[i];
+        });
+        return state;
+    }
+    
     /**
      * Add a log message
      * @param {string} message Message text
@@ -200,6 +269,36 @@ window.telemetryPanel = (function() {
         timingBarsEl.innerHTML = html;
     }
     
+    /**
+     * Update audio meter display: peak/RMS bars and a band spectrum (dBFS)
+     * @param {Object} data audioMeter message
+     */
+    function updateAudioMeterDisplay(data) {
+        if (!audioMeterEl || !data.bands) return;
+        
+        document.getElementById('audioMeterPanel').style.display = 'block';
+        
+        const FLOOR_DB = -90;
+        const toPercent = (db) => Math.max(0, Math.min(100, (1 - db / FLOOR_DB) * 100));
+        const source = data.voice >= 0 ? `Voice ${data.voice}` : 'Output';
+        
+        let html = `<div class="timing-legend">${source}: peak ${data.peak.toFixed(1)} dBFS, RMS ${data.rms.toFixed(1)} dBFS</div>`;
+        html += '<div class="timing-bar">';
+        html += `<div class="timing-segment" style="flex: ${toPercent(data.rms)}; background: hsl(120, 60%, 45%);" title="RMS"></div>`;
+        html += `<div class="timing-segment" style="flex: ${toPercent(data.peak) - toPercent(data.rms)}; background: hsl(50, 80%, 50%);" title="Peak"></div>`;
+        html += `<div class="timing-segment" style="flex: ${100 - toPercent(data.peak)};"></div>`;
+        html += '</div>';
+        
+        html += '<div style="display: flex; align-items: flex-end; height: 60px; gap: 1px; margin-top: 6px;">';
+        for (const band of data.bands) {
+            html += `<div style="flex: 1; height: ${toPercent(band)}%; background: hsl(200, 60%, 50%);"></div>`;
+        }
+        html += '</div>';
+        html += `<div class="timing-legend">0 - ${(data.sampleRate / 2000).toFixed(1)} kHz</div>`;
+        
+        audioMeterEl.innerHTML = html;
+    }
+    
     /**
      * Update raw JSON display
      */
@@ -0,0 +1,92 @@
+"""
+Static RAM report, per subsystem, from a firmware ELF.
+
+Sums the sizes of the .data and .bss symbols (which, with every object in
+static storage, is all the RAM the firmware uses apart from the stacks) and
+groups them by subsystem using the symbol names. The split inside the synth
+(voices, buffers, telemetry, JSON) is in the RAM report the firmware logs at
+startup, from sizeof() of each member.
+
+As a PlatformIO extra_scripts post-script it prints the report after every
+link. Standalone:
+
+    python3 tools/ram_report.py .pio/build/waveshare_2350b/firmware.elf [--nm arm-none-eabi-nm]
+"""
+import re
+import subprocess
+import sys
+
+# First match wins; symbol names are demangled
+SUBSYSTEMS = [
+    ("synth", r"synthAppStorage|^platform::"),
+    ("audio sink", r"audioSinkStorage|Rp2350AudioSink|I2sAudioSink"),
+    ("keys", r"scannerStorage|keyboardStorage|CapacitiveScanner|MidiKeyboardController"),
+    ("telemetry", r"Sink(Storage)?\b|sharedTimingStats|[Tt]elemetry"),
+    ("json", r"webcontrol::|[Jj]son"),
+    ("storage", r"programStorageStorage|ProgramStorage"),
+    ("stdio/usb", r"stdio|usb|tud_|tusb"),
+]
+
+RAM_SYMBOL_TYPES = set("bBdDsS")
+
+
+def read_symbols(nm, elf):
+    output = subprocess.run([nm, "-S", "-C", "--size-sort", elf], check=True,
+                            capture_output=True, text=True).stdout
+    for line in output.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) == 4 and fields[2] in RAM_SYMBOL_TYPES:
+            yield fields[3], int(fields[1], 16)
+
+
+def subsystem_of(name):
+    for subsystem, pattern in SUBSYSTEMS:
+        if re.search(pattern, name):
+            return subsystem
+    return "other"
+
+
+def report(nm, elf, out=sys.stdout):
+    totals = {}
+    largest = {}
+    for name, size in read_symbols(nm, elf):
+        subsystem = subsystem_of(name)
+        totals[subsystem] = totals.get(subsystem, 0) + size
+        if size > largest.get(subsystem, ("", 0))[1]:
+            largest[subsystem] = (name, size)
+    out.write("RAM by subsystem (.data + .bss, %s):\n" % elf)
+    for subsystem, size in sorted(totals.items(), key=lambda item: -item[1]):
+        out.write("  %-12s %8d bytes   largest: %s\n" % (subsystem, size, largest[subsystem][0]))
+    out.write("  %-12s %8d bytes\n" % ("total", sum(totals.values())))
+
+
+def main(argv):
+    nm = "nm"
+    args = []
+    for arg in argv[1:]:
+        if arg.startswith("--nm="):
+            nm = arg[len("--nm="):]
+        else:
+            args.append(arg)
+    if "--nm" in args:
+        index = args.index("--nm")
+        nm = args[index + 1]
+        del args[index:index + 2]
+    if len(args) != 1:
+        sys.stderr.write(__doc__)
+        return 2
+    report(nm, args[0])
+    return 0
+
+
+try:
+    Import("env")  # noqa: F821 - defined when run by PlatformIO
+except NameError:
+    if __name__ == "__main__":
+        sys.exit(main(sys.argv))
+else:
+    def _print_report(source, target, env):
+        nm = re.sub(r"g(cc|\+\+)$", "nm", env.subst("$CC"))
+        report(nm, str(target[0]))
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", _print_report)  # noqa: F821
@@ -0,0 +1,193 @@
+/**
+ * Pressence telemetry decoder
+ *
+ * Reads a device's serial output (JSON Lines, binary telemetry frames, or a
+ * mix of both) and writes every telemetry message to stdout as JSON Lines,
+ * in the same shape the firmware's to_json() produces. Non-JSON text (logs)
+ * goes to stderr, so stdout can be piped straight into analysis scripts.
+ *
+ * Build (from the repository root):
+ *   g++ -std=c++17 -O2 -Ilib/features -Ilib/nlohmann tools/telemetry_decode.cpp -o telemetry_decode
+ *
+ * Usage:
+ *   stty -F /dev/ttyACM0 raw && ./telemetry_decode < /dev/ttyACM0
+ *   ./telemetry_decode capture.bin
+ */
+
+#include <telemetry_frame.hpp>
+#include <json.hpp>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using features::TelemetryFrameReader;
+using features::TelemetryType;
+
+static nlohmann::json decodeKeyScan(TelemetryFrameReader& r) {
+    uint16_t keyCount = r.getU16();
+    nlohmann::json j = {
+        {"type", "keyScan"},
+        {"keyCount", keyCount}
+    };
+    j["isCalibrated"] = r.getBool();
+    j["calibrationCount"] = r.getU16();
+    j["noteOnThreshold"] = r.getF32();
+    j["noteOffThreshold"] = r.getF32();
+
+    std::vector<uint16_t> readings(keyCount);
+    std::vector<float> baselines(keyCount);
+    std::vector<float> ratios(keyCount);
+    std::vector<bool> noteStates(keyCount);
+    std::vector<uint8_t> aftertouch(keyCount);
+    for (auto& v : readings) v = r.getU16();
+    for (auto& v : baselines) v = r.getF32();
+    for (auto& v : ratios) v = r.getF32();
+    for (size_t i = 0; i < keyCount; i++) noteStates[i] = r.getBool();
+    for (auto& v : aftertouch) v = r.getU8();
+
+    j["readings"] = readings;
+    j["baselines"] = baselines;
+    j["ratios"] = ratios;
+    j["noteStates"] = noteStates;
+    j["aftertouchValues"] = aftertouch;
+    return j;
+}
+
+static nlohmann::json decodeKeyScanDelta(TelemetryFrameReader& r) {
+    nlohmann::json j = {
+        {"type", "keyScanDelta"},
+        {"keyCount", r.getU16()}
+    };
+    j["isCalibrated"] = r.getBool();
+    j["calibrationCount"] = r.getU16();
+    j["noteOnThreshold"] = r.getF32();
+    j["noteOffThreshold"] = r.getF32();
+    j["keyframe"] = r.getBool();
+
+    uint16_t count = r.getU16();
+    std::vector<uint16_t> keys(count);
+    std::vector<uint16_t> readings(count);
+    std::vector<float> baselines(count);
+    std::vector<float> ratios(count);
+    std::vector<bool> noteStates(count);
+    std::vector<uint8_t> aftertouch(count);
+    for (auto& v : keys) v = r.getU16();
+    for (auto& v : readings) v = r.getU16();
+    for (auto& v : baselines) v = r.getF32();
+    for (auto& v : ratios) v = r.getF32();
+    for (size_t i = 0; i < count; i++) noteStates[i] = r.getBool();
+    for (auto& v : aftertouch) v = r.getU8();
+
+    j["keys"] = keys;
+    j["readings"] = readings;
+    j["baselines"] = baselines;
+    j["ratios"] = ratios;
+    j["noteStates"] = noteStates;
+    j["aftertouchValues"] = aftertouch;
+    return j;
+}
+
+static nlohmann::json decodeAudioMeter(TelemetryFrameReader& r) {
+    int16_t voice = static_cast<int16_t>(r.getU16());
+    nlohmann::json j = {
+        {"type", "audioMeter"},
+        {"source", voice < 0 ? "output" : "voice"},
+        {"voice", voice}
+    };
+    j["decimation"] = r.getU16();
+    j["sampleRate"] = r.getF32();
+    j["peak"] = r.getF32();
+    j["rms"] = r.getF32();
+    j["droppedBlocks"] = r.getU32();
+    std::vector<float> bands(r.getU8());
+    for (auto& v : bands) v = r.getF32();
+    j["bands"] = bands;
+    return j;
+}
+
+static nlohmann::json decodeTiming(TelemetryFrameReader& r) {
+    char text[features::telemetry_frame::MAX_STRING + 1];
+    r.getString(text, sizeof(text));
+    nlohmann::json j = {
+        {"type", "timing"},
+        {"unit", text}
+    };
+    j["lapCount"] = r.getU32();
+    j["droppedSpans"] = r.getU32();
+    nlohmann::json spans = nlohmann::json::array();
+    uint8_t spanCount = r.getU8();
+    for (uint8_t i = 0; i < spanCount; i++) {
+        r.getString(text, sizeof(text));
+        nlohmann::json span = {{"name", text}};
+        span["min"] = r.getU64();
+        span["max"] = r.getU64();
+        span["total"] = r.getU64();
+        span["count"] = r.getU32();
+        spans.push_back(span);
+    }
+    j["spans"] = spans;
+    return j;
+}
+
+int main(int argc, char** argv) {
+    FILE* in = stdin;
+    if (argc > 1) {
+        in = fopen(argv[1], "rb");
+        if (!in) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    // Decoder buffers are large; keep them off the stack
+    auto decoder = std::make_unique<features::TelemetryStreamDecoder<>>();
+    unsigned long badFrames = 0;
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        switch (decoder->feed(static_cast<uint8_t>(c))) {
+            case features::TelemetryStreamDecoder<>::Result::TextLine: {
+                const char* line = decoder->line();
+                if (line[0] == '{') {
+                    printf("%s\n", line);
+                    fflush(stdout);
+                } else {
+                    fprintf(stderr, "%s\n", line);
+                }
+                break;
+            }
+            case features::TelemetryStreamDecoder<>::Result::Frame: {
+                TelemetryFrameReader r = decoder->payload();
+                nlohmann::json j;
+                switch (decoder->frameType()) {
+                    case TelemetryType::KeyScan: j = decodeKeyScan(r); break;
+                    case TelemetryType::Timing:  j = decodeTiming(r); break;
+                    case TelemetryType::KeyScanDelta: j = decodeKeyScanDelta(r); break;
+                    case TelemetryType::AudioMeter: j = decodeAudioMeter(r); break;
+                    default:
+                        badFrames++;
+                        continue;
+                }
+                if (r.overflowed()) {
+                    badFrames++;
+                    break;
+                }
+                printf("%s\n", j.dump().c_str());
+                fflush(stdout);
+                break;
+            }
+            case features::TelemetryStreamDecoder<>::Result::BadFrame:
+                badFrames++;
+                break;
+            case features::TelemetryStreamDecoder<>::Result::None:
+                break;
+        }
+    }
+
+    if (badFrames > 0) {
+        fprintf(stderr, "telemetry_decode: dropped %lu invalid frames\n", badFrames);
+    }
+    if (in != stdin) {
+        fclose(in);
+    }
+    return 0;
+}